@@ -6,11 +6,16 @@
 void CLI_Init(UART_HandleTypeDef *huart);
 void CLI_Process(void);
 
+/*
+ * ls [katalog]  - bez katalogu: nagrania z indeksu (vc_rec_index.h), inaczej f_readdir
+ * play <nazwa>  - nagranie z indeksu, jedna ramka na CLI_Process do CLI_PlayFrame
+ * stop
+ */
+void CLI_PlayFrame(const int16_t *pcm, uint16_t n_samples, uint16_t channels);
+
 /*
 TODO:
-play _
 cd
-ls
 mkdir
 */
 #endif
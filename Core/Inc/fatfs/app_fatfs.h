@@ -4,11 +4,16 @@
 #include "ff.h"
 #include <stdint.h>
 #include <string.h>
+#include "voicecmd/vc_data_if.h"
+#include "fatfs/vc_wav_writer.h"
 
 // Dane na pendrivie zmieniasz w FATFS/Target/ffconf.h
 // zmiana formatu pendrive: f_mkfs (i inne w sekcji Volume Management and System Configuration)
 
 int fatfs_init();
-void write_wav_header(FIL *file, uint32_t sample_rate, uint16_t bits_per_sample, uint16_t channels, uint32_t data_size);
+vc_status_t write_wav_header(FIL *file, uint32_t sample_rate, uint16_t bits_per_sample, uint16_t channels, uint32_t data_size);
+// Nagłówek WAV z polami fmt wziętymi z metadanych strumienia (codec_id = WAV fmt, np. 7 dla G.711 µ-law).
+// VC_E_PARAM: kodek bez formatu WAV, VC_E_IO: błąd zapisu.
+vc_status_t write_wav_header_meta(FIL *file, const vc_stream_meta_t *m, uint32_t data_size);
 
 #endif
@@ -0,0 +1,60 @@
+#ifndef VC_REC_INDEX_H
+#define VC_REC_INDEX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ff.h"
+#include <stdint.h>
+#include "voicecmd/vc_data_if.h"
+#include "fatfs/vc_wav_writer.h"
+#include "fatfs/vc_vcmd_writer.h"
+
+/*
+ * Indeks nagrań na nośniku (RECINDEX.BIN w katalogu głównym, format: vc_index_header_t).
+ * Uzupełniany przy każdym zamknięciu nagrania (vc_index_put: wpis + skrót + licznik,
+ * trzy krótkie zapisy; ta sama nazwa nadpisuje poprzedni wpis). ls i odtwarzanie po nazwie
+ * nie przeglądają katalogów: wyszukiwanie czyta tablicę skrótów (4 B na nagranie,
+ * 128 na sektor) i jeden wpis; lista czyta wpisy ciągiem - bez otwierania nagrań.
+ * Pliki zapisane poza indeksem (np. z komputera) nie są w nim widoczne.
+ */
+
+#define VC_INDEX_PATH      "RECINDEX.BIN"
+#define VC_INDEX_CAPACITY  4096u   /* nagrań (16 KiB skrótów, tworzone przy pierwszym wpisie) */
+
+/* Podsumowanie VAD nagrania (0 = bez analizy). */
+typedef struct {
+    uint32_t speech_ms;
+    uint16_t speech_segments;
+} vc_index_vad_t;
+
+typedef void (*vc_index_visit_t)(void *ctx, const vc_index_entry_t *e);
+
+/* FNV-1a nazwy (nigdy 0). */
+uint32_t    vc_index_hash(const char *name);
+
+/* Wpis z zamkniętego writera (rozmiary, kodek, czas trwania); vad może być NULL. */
+void        vc_index_entry_wav(vc_index_entry_t *e, const char *name, const vc_wav_writer_t *w,
+                               const vc_index_vad_t *vad);
+void        vc_index_entry_vcmd(vc_index_entry_t *e, const char *name, const vc_vcmd_writer_t *w,
+                                const vc_index_vad_t *vad);
+
+/* Dodaje albo nadpisuje (ta sama nazwa) wpis; tworzy indeks przy pierwszym użyciu.
+ * VC_E_FULL: VC_INDEX_CAPACITY wpisów. */
+vc_status_t vc_index_put(vc_index_entry_t *e);
+
+/* Wpis o nazwie name. VC_E_EMPTY: brak (także brak pliku indeksu). */
+vc_status_t vc_index_find(const char *name, vc_index_entry_t *out);
+
+/* Usuwa wpis (skrót = 0); plik nagrania zostaje. */
+vc_status_t vc_index_remove(const char *name);
+
+/* Wszystkie wpisy w kolejności dodania (bez usuniętych). */
+vc_status_t vc_index_foreach(vc_index_visit_t fn, void *ctx);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* VC_REC_INDEX_H */
@@ -0,0 +1,41 @@
+#ifndef VC_RECOVER_H
+#define VC_RECOVER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ff.h"
+#include <stdint.h>
+#include "voicecmd/vc_data_if.h"
+
+/*
+ * Naprawa nagrań przerwanych zanikiem zasilania (przy kolejnym montowaniu).
+ * Plik niezamknięty ma nagłówek z ostatniego punktu kontrolnego (rozmiary 0, gdy punktu
+ * nie było) i rozmiar z ostatniego f_sync - z rezerwacją f_expand cały zarezerwowany obszar.
+ * Naprawa: długość danych z nagłówka (0 / poza plikiem: do końca pliku), obcięta do pełnych
+ * bloków (VCMD zmiennej długości: do ostatniego poprawnego prefiksu), f_truncate i nagłówek
+ * z tymi rozmiarami. VCMD po naprawie: bez indeksu, przełączeń i CRC (czytnik szuka
+ * przez przejście po blokach).
+ * Plik zamknięty poprawnie (WAV: rozmiary RIFF/'data' zgodne z f_size, VCMD: index_offset != 0)
+ * jest tylko czytany (jeden sektor nagłówka + wpis katalogu); czytnik (mapa klastrów, kodek)
+ * otwierany jest tylko dla plików, które mogą wymagać naprawy.
+ */
+
+typedef struct {
+    uint32_t scanned;     /* pliki .WAV / .VCM */
+    uint32_t repaired;
+    uint32_t failed;      /* nie do odczytania jako nagranie albo błąd zapisu */
+} vc_recover_stats_t;
+
+/* Sprawdza i w razie potrzeby naprawia jedno nagranie. *repaired = 1, gdy plik zmieniono. */
+vc_status_t vc_recover_file(const char *path, uint8_t *repaired);
+
+/* vc_recover_file dla wszystkich .WAV/.VCM w katalogu dir ("" = główny). stats może być NULL. */
+vc_status_t vc_recover_dir(const char *dir, vc_recover_stats_t *stats);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* VC_RECOVER_H */
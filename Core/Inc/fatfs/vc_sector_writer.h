@@ -0,0 +1,74 @@
+#ifndef VC_SECTOR_WRITER_H
+#define VC_SECTOR_WRITER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ff.h"
+#include <stdint.h>
+#include "voicecmd/vc_data_if.h"
+#include "fatfs/vc_stream_sink.h"
+
+/*
+ * Buforowany zapis sekwencyjny pliku - wspólna warstwa writerów WAV i VCMD.
+ * Dane trafiają do bufora o wielokrotności sektora; do f_write idą tylko całe
+ * bufory, zawsze od offsetu wyrównanego do sektora - FatFs pisze je wtedy
+ * bezpośrednio (disk_write wielu sektorów), bez kopiowania przez okno FIL.
+ * Nagłówek pliku (zapisany na początku jako zaślepka) jest poprawiany przy
+ * zamknięciu: na miejscu w buforze albo jednym f_lseek + f_write.
+ *
+ * Tryb nagrywania z rezerwacją (vc_sector_writer_reserve): f_expand przydziela od razu
+ * ciągły obszar klastrów, zapis idzie sekwencyjnie w jego wnętrzu - bez szukania wolnych
+ * klastrów i zapisów FAT w trakcie nagrania (stały czas f_write). Przy zamknięciu plik
+ * jest przycinany (f_truncate) do faktycznie zapisanych danych. Po przekroczeniu rezerwacji
+ * FatFs dokłada klastry jak zwykle (licznik overflow_bytes).
+ *
+ * Punkt kontrolny (vc_sector_writer_checkpoint): niepełny bufor jest zapisywany bez
+ * zwalniania (kolejny flush zapisze te sektory ponownie od wyrównanego offsetu), nagłówek
+ * poprawiany, a f_sync utrwala rozmiar pliku i FAT. Koszt ograniczony: <= 4 KiB danych,
+ * sektor nagłówka i f_sync (wpis katalogu, okno FAT, CTRL_SYNC cache diskio).
+ */
+
+#define VC_SECTOR_BYTES          512u
+#define VC_SECTOR_WRITER_SECTORS 8u                                     /* 4 KiB na zapis */
+#define VC_SECTOR_WRITER_BYTES   (VC_SECTOR_WRITER_SECTORS * VC_SECTOR_BYTES)
+
+typedef struct {
+    vc_stream_sink_t sink;    /* ujście synchroniczne (vc_stream_sink.h) */
+    FIL      file;
+    uint32_t flushed_bytes;   /* bajty pliku już wysłane do f_write */
+    uint32_t reserved_bytes;  /* rozmiar obszaru z f_expand (0 = bez rezerwacji) */
+    uint32_t overflow_bytes;  /* bajty zapisane za rezerwacją */
+    uint32_t writes;          /* wywołania f_write z danymi (bez poprawek nagłówka) */
+    uint16_t fill;            /* zajętość buf (< VC_SECTOR_WRITER_BYTES poza flush) */
+    uint8_t  is_open;
+    uint8_t  buf[VC_SECTOR_WRITER_BYTES] __attribute__((aligned(4)));
+} vc_sector_writer_t;
+
+vc_status_t vc_sector_writer_open(vc_sector_writer_t *w, const char *path);
+vc_status_t vc_sector_writer_write(vc_sector_writer_t *w, const void *data, uint32_t len);
+
+/* Rezerwuje ciągły obszar bytes (zaokrąglone do sektora) - tylko przed pierwszym f_write
+ * (nagłówek jeszcze w buforze). VC_E_FULL: brak tak dużego ciągłego obszaru - zapis
+ * działa dalej bez rezerwacji; VC_E_STATE: dane już zapisane. */
+vc_status_t vc_sector_writer_reserve(vc_sector_writer_t *w, uint32_t bytes);
+
+/* Bieżący rozmiar pliku (zapisane + buforowane bajty). */
+static inline uint32_t vc_sector_writer_tell(const vc_sector_writer_t *w)
+{
+    return w->flushed_bytes + w->fill;
+}
+
+/* Punkt kontrolny: wszystkie dotąd zapisane bajty + header na nośniku, f_sync. */
+vc_status_t vc_sector_writer_checkpoint(vc_sector_writer_t *w, const void *header, uint16_t header_len);
+
+/* Zapisuje resztę bufora, przycina plik z rezerwacją, nadpisuje header_len bajtów
+ * od początku pliku i zamyka. header == NULL: bez poprawki. */
+vc_status_t vc_sector_writer_close(vc_sector_writer_t *w, const void *header, uint16_t header_len);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* VC_SECTOR_WRITER_H */
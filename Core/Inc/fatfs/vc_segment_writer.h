@@ -0,0 +1,96 @@
+#ifndef VC_SEGMENT_WRITER_H
+#define VC_SEGMENT_WRITER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ff.h"
+#include <stdint.h>
+#include "voicecmd/vc_data_if.h"
+#include "voicecmd/vc_codec.h"
+#include "fatfs/vc_stream_sink.h"
+#include "fatfs/vc_write_behind.h"
+#include "fatfs/vc_wav_writer.h"
+#include "fatfs/vc_vcmd_writer.h"
+#include "fatfs/vc_recover.h"
+
+/*
+ * Nagranie segmentowane: katalog dir z plikami S000.WAV, S001.WAV, ... (albo .VCM) po
+ * segment_ms każdy i manifestem MANIFEST.BIN (vc_manifest_header_t + wpis na segment).
+ * Każdy segment to samodzielny plik z pełnym nagłówkiem - naprawa (vc_seg_recover),
+ * wysyłanie i przetwarzanie na hoście idą segmentami.
+ *
+ * Zapis przez kolejkę write-behind: na granicy segmentu producent zamyka writer
+ * (nagłówek końcowy, VCMD: indeks) i otwiera następny na tym samym pierścieniu
+ * (vc_wb_rotate), a zamknięcie/otwarcie plików i wpis manifestu robi zadanie zapisu.
+ * Każdy zamknięty segment trafia też do indeksu nagrań (vc_rec_index.h).
+ * Ramki nie giną: gdy w pierścieniu brak miejsca na ogon segmentu albo poprzednia
+ * rotacja jeszcze trwa, segment jest wydłużany o kolejne ramki.
+ * G.722: stan kodera ciągnie się przez granicę, dekoder segmentu startuje od zera
+ * (kilka ms przejściowych na początku segmentu).
+ */
+
+#define VC_SEG_DIR_MAX        16u      /* nazwa katalogu nagrania (8.3) z '\0' */
+#define VC_SEG_MANIFEST_NAME  "MANIFEST.BIN"
+
+typedef enum {
+    VC_SEG_WAV  = 0,
+    VC_SEG_VCMD = 1,
+} vc_seg_container_t;
+
+typedef struct {
+    vc_stream_sink_t     sink;            /* ujście writerów segmentów -> q */
+    vc_wb_t             *q;
+    vc_seg_container_t   container;
+    const vc_codec_t    *codec;           /* koder (ważny do vc_seg_close) */
+    vc_stream_meta_t     meta;
+    union {
+        vc_wav_writer_t  wav;
+        vc_vcmd_writer_t vcmd;
+    } w;
+
+    char                 dir[VC_SEG_DIR_MAX];
+    char                 next_path[VC_WB_PATH_MAX];
+    uint32_t             segment_frames;
+    uint32_t             seg_frames;      /* ramki w bieżącym segmencie */
+    uint32_t             total_frames;
+    uint32_t             reserve_bytes;   /* rezerwacja segmentu (z pierwszego) */
+    uint32_t             ckpt_ms;
+    uint16_t             segment;         /* numer bieżącego segmentu */
+    uint8_t              rotating;        /* writer zamykany na granicy segmentu */
+    uint8_t              is_open;
+    uint32_t             deferred;        /* ramki dopisane ponad segment_frames (brak miejsca) */
+
+    vc_manifest_header_t mhdr;            /* kontekst zadania zapisu */
+    vc_manifest_entry_t  pending;         /* wpis segmentu zamykanego przez zadanie zapisu */
+} vc_seg_writer_t;
+
+/* Otwiera nagranie (kontekst zadania zapisu): katalog, manifest, pierwszy segment
+ * przez kolejkę q (vc_wb_open) z rezerwacją na segment_ms. */
+vc_status_t vc_seg_open(vc_seg_writer_t *s, vc_wb_t *q, const char *dir,
+                        vc_seg_container_t container, const vc_codec_t *codec, uint32_t segment_ms);
+
+/* Punkt kontrolny co interval_ms w każdym segmencie (vc_wav/vcmd_writer_set_checkpoint). */
+void        vc_seg_set_checkpoint(vc_seg_writer_t *s, uint32_t interval_ms);
+
+/* Producent: jedna zakodowana ramka; na granicy segmentu rotacja. VC_E_FULL: ramka
+ * odrzucona przez pełny pierścień (jak vc_wav_writer_write / vc_vcmd_writer_write_block). */
+vc_status_t vc_seg_write_frame(vc_seg_writer_t *s, const uint8_t *frame, uint16_t len);
+
+/* Koniec nagrania (kontekst zadania zapisu, producent zatrzymany): ostatni segment
+ * i jego wpis manifestu (VC_MANIFEST_F_LAST). */
+vc_status_t vc_seg_close(vc_seg_writer_t *s);
+
+/* Po zaniku zasilania (montowanie, katalog nie jest zapisywany): vc_recover_dir(dir, stats),
+ * potem wpisy manifestu i indeksu dla segmentów bez wpisu - z naprawionych nagłówków,
+ * VC_MANIFEST_F_RECOVERED; ostatni segment dostaje VC_MANIFEST_F_LAST. Manifest z F_LAST:
+ * tylko naprawa plików. VC_E_EMPTY: katalog bez manifestu (nie nagranie segmentowane,
+ * pliki bez zmian). */
+vc_status_t vc_seg_recover(const char *dir, vc_recover_stats_t *stats);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* VC_SEGMENT_WRITER_H */
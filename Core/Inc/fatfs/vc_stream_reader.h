@@ -0,0 +1,103 @@
+#ifndef VC_STREAM_READER_H
+#define VC_STREAM_READER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ff.h"
+#include <stdint.h>
+#include "voicecmd/vc_data_if.h"
+#include "voicecmd/vc_codec.h"
+
+/*
+ * Odczyt nagrań WAV (fmt/fact/data) i VCMD do odtwarzania.
+ * Plik czytany jest wyłącznie wielosektorowymi f_read od offsetów wyrównanych do
+ * sektora prosto do bufora (FatFs omija wtedy okno FIL). Bloki kodeka wydawane są
+ * jako wskaźniki do tego bufora - bez kopii; kopiowany jest tylko blok przecinający
+ * granicę bufora (do obszaru carry tuż przed sektorami, <= VC_READER_CARRY_BYTES).
+ * Przy otwarciu budowana jest mapa klastrów pliku (fast seek, _USE_FASTSEEK): f_lseek
+ * i przejścia między klastrami w f_read nie czytają wtedy łańcucha FAT - skok w godzinnym
+ * nagraniu kosztuje tyle samo co na początku. Plik zbyt pofragmentowany na tablicę:
+ * zwykły tryb (łańcuch FAT).
+ */
+
+#define VC_READER_SECTOR_BYTES  512u
+#define VC_READER_SECTORS       8u                                       /* 4 KiB na f_read */
+#define VC_READER_READ_BYTES    (VC_READER_SECTORS * VC_READER_SECTOR_BYTES)
+/* najdłuższy blok: ramka PCM16 stereo (+ prefiks długości VCMD); wielokrotność 4 B,
+ * żeby obszar sektorów był wyrównany do słowa (DMA jednostki CRC) */
+#define VC_READER_CLMT_WORDS    64u     /* mapa klastrów: 1 + 2 x liczba fragmentów (do 31) */
+#define VC_READER_CARRY_BYTES   ((VC_PCM16_BYTES_PER_FRAME * VC_MAX_CHANNELS + VC_VCMD_LEN_PREFIX_BYTES + 3u) & ~3u)
+
+typedef enum {
+    VC_READER_WAV  = 0,
+    VC_READER_VCMD = 1,
+} vc_reader_kind_t;
+
+typedef struct {
+    FIL              file;
+    vc_reader_kind_t kind;
+    vc_stream_meta_t meta;          /* z fmt (WAV) albo z nagłówka (VCMD) */
+    vc_codec_t       dec;           /* dekoder otwarty z meta */
+
+    uint32_t data_start;            /* offset payloadu w pliku */
+    uint32_t data_bytes;            /* rozmiar payloadu */
+    uint32_t data_pos;              /* bajty payloadu już wydane */
+    uint16_t block_bytes;           /* rozmiar bloku (ramki kodeka); zmienna długość: max */
+    uint8_t  len_prefixed;          /* VCMD + kodek F_VARIABLE: bloki z prefiksem uint16 */
+    uint8_t  is_open;
+    uint8_t  fast_seek;             /* mapa klastrów aktywna (file.cltbl) */
+    uint32_t frame_idx;             /* indeks następnego bloku */
+
+    /* VCMD v2: indeks bloków i przełączenia kodeka */
+    vc_vcmd_header_t hdr;
+    const uint32_t  *index;         /* indeks w RAM (vc_reader_load_index) albo NULL */
+    vc_vcmd_switch_t switches[VC_VCMD_MAX_SWITCHES];
+    uint16_t         switch_count;
+    uint16_t         next_switch;   /* pierwszy jeszcze niezastosowany wpis switches[] */
+
+    DWORD    clmt[VC_READER_CLMT_WORDS]; /* CLMT: clmt[0] = rozmiar, dalej pary (długość, klaster) */
+
+    /* Okno bufora: buf[win_start .. win_end) odpowiada plikowi od win_file_pos. */
+    uint32_t win_file_pos;
+    uint16_t win_start;
+    uint16_t win_end;
+    uint16_t pos;                   /* bieżąca pozycja w buf */
+    uint8_t  buf[VC_READER_CARRY_BYTES + VC_READER_READ_BYTES] __attribute__((aligned(4)));
+} vc_stream_reader_t;
+
+/* Otwiera plik, rozpoznaje WAV/VCMD, parsuje nagłówek i otwiera dekoder. */
+vc_status_t vc_reader_open(vc_stream_reader_t *r, const char *path);
+
+/* Następny blok kodeka (wskaźnik do bufora czytnika, ważny do kolejnego wywołania).
+ * Ostatni blok może być krótszy. VC_E_EMPTY na końcu danych. */
+vc_status_t vc_reader_next_block(vc_stream_reader_t *r, const uint8_t **block, uint16_t *len);
+
+/* Dekoduje następny blok do pcm (>= frame_samples * channels próbek, przeplatane).
+ * *n_samples = liczba próbek na kanał (ostatni, niepełny blok: proporcjonalnie mniej). */
+vc_status_t vc_reader_read_frame(vc_stream_reader_t *r, int16_t *pcm, uint16_t *n_samples);
+
+/* Skok do ramki frame_idx (kolejny next_block/read_frame zwraca tę ramkę).
+ * Kodek stałej długości: offset liczony wprost (także w segmentach między przełączeniami).
+ * Zmienna długość: wpis indeksu + jeden f_lseek, dalej doczytanie < index_interval bloków
+ * z bufora. Dekoder jest otwierany na nowo (stan G.722 dogania po kilku ms). */
+vc_status_t vc_reader_seek_frame(vc_stream_reader_t *r, uint32_t frame_idx);
+
+/* Wczytuje indeks VCMD do buf (cap wpisów) - seek bez dodatkowego odczytu wpisu z pliku.
+ * buf musi być ważny do vc_reader_close. VC_E_FULL gdy indeks się nie mieści. */
+vc_status_t vc_reader_load_index(vc_stream_reader_t *r, uint32_t *buf, uint32_t cap);
+
+/* Sprawdza CRC payloadu VCMD (hdr.crc32) - przebieg przez cały payload połówkami obszaru
+ * sektorów: odczyt jednej połowy trwa, gdy jednostka CRC (DMA) liczy drugą.
+ * Pozycja odtwarzania zostaje zachowana. VC_E_STATE: WAV albo plik bez CRC,
+ * VC_E_CRC: niezgodność. */
+vc_status_t vc_reader_verify_crc(vc_stream_reader_t *r);
+
+void        vc_reader_close(vc_stream_reader_t *r);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* VC_STREAM_READER_H */
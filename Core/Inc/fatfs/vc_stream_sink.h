@@ -0,0 +1,69 @@
+#ifndef VC_STREAM_SINK_H
+#define VC_STREAM_SINK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "voicecmd/vc_data_if.h"
+
+/*
+ * Ujście bajtów pliku nagrania dla writerów WAV/VCMD. Implementacja osadza
+ * vc_stream_sink_t jako pierwsze pole swojej struktury (jak vc_codec_t.ops):
+ *  - vc_sector_writer_t - zapis synchroniczny (f_write w wywołaniu),
+ *  - vc_wb_t            - write-behind: kolejka sektorów opróżniana przez zadanie zapisu.
+ * Otwarcie zależy od implementacji; dalej writer używa tylko ops.
+ */
+
+typedef struct vc_stream_sink vc_stream_sink_t;
+
+typedef struct {
+    /* Dopisuje len bajtów w całości albo wcale (VC_E_FULL - ramka odrzucona). */
+    vc_status_t (*write)(vc_stream_sink_t *s, const void *data, uint32_t len);
+    /* Bajty, które write przyjmie teraz bez blokowania (UINT32_MAX: bez limitu). */
+    uint32_t    (*space)(const vc_stream_sink_t *s);
+    /* Ciągła rezerwacja miejsca w pliku (NULL: brak). */
+    vc_status_t (*reserve)(vc_stream_sink_t *s, uint32_t bytes);
+    /* Punkt kontrolny: header opisuje wszystkie dotąd zapisane bajty - dane, nagłówek
+     * i rozmiar pliku w katalogu (f_sync) trafiają na nośnik. Może się wykonać później
+     * (write-behind: w zadaniu zapisu). NULL: brak. */
+    vc_status_t (*checkpoint)(vc_stream_sink_t *s, const void *header, uint16_t header_len);
+    /* Zapisuje resztę danych, nadpisuje nagłówek (header == NULL: bez poprawki), zamyka. */
+    vc_status_t (*close)(vc_stream_sink_t *s, const void *header, uint16_t header_len);
+} vc_stream_sink_ops_t;
+
+struct vc_stream_sink {
+    const vc_stream_sink_ops_t *ops;
+};
+
+static inline vc_status_t vc_sink_write(vc_stream_sink_t *s, const void *data, uint32_t len)
+{
+    return s->ops->write(s, data, len);
+}
+
+static inline uint32_t vc_sink_space(const vc_stream_sink_t *s)
+{
+    return s->ops->space ? s->ops->space(s) : UINT32_MAX;
+}
+
+static inline vc_status_t vc_sink_reserve(vc_stream_sink_t *s, uint32_t bytes)
+{
+    return s->ops->reserve ? s->ops->reserve(s, bytes) : VC_E_STATE;
+}
+
+static inline vc_status_t vc_sink_checkpoint(vc_stream_sink_t *s, const void *header, uint16_t header_len)
+{
+    return s->ops->checkpoint ? s->ops->checkpoint(s, header, header_len) : VC_E_STATE;
+}
+
+static inline vc_status_t vc_sink_close(vc_stream_sink_t *s, const void *header, uint16_t header_len)
+{
+    return s->ops->close(s, header, header_len);
+}
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* VC_STREAM_SINK_H */
@@ -0,0 +1,78 @@
+#ifndef VC_VCMD_WRITER_H
+#define VC_VCMD_WRITER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "voicecmd/vc_data_if.h"
+#include "voicecmd/vc_codec.h"
+#include "voicecmd/vc_crc32.h"
+#include "fatfs/vc_sector_writer.h"
+
+/*
+ * Zapis kontenera VCMD: [nagłówek v2][payload][indeks bloków][tablica przełączeń].
+ * Indeks (offset co index_interval-tego bloku) trzymany jest w stałym buforze RAM;
+ * po zapełnieniu co drugi wpis jest usuwany, a interwał podwajany - bufor wystarcza
+ * na dowolnie długie nagranie, kosztem dłuższego doczytania po skoku.
+ * Kodeki stałej długości nie potrzebują indeksu (offset = ramka * rozmiar bloku),
+ * ale jest zapisywany zawsze - czytnik korzysta z niego dla ramek zmiennej długości.
+ * CRC payloadu (z prefiksami długości) liczone przyrostowo przy każdym bloku (vc_crc32.h).
+ * Punkty kontrolne (vc_vcmd_writer_set_checkpoint): nagłówek z bieżącymi data_bytes,
+ * total_blocks, total_samples (bez indeksu, przełączeń i CRC - te dopiero przy zamknięciu)
+ * + f_sync. Odtworzony po awarii plik nie ma tablicy przełączeń - nagranie adaptacyjne
+ * dekoduje się poprawnie tylko do pierwszego przełączenia.
+ */
+
+#define VC_VCMD_INDEX_MAX       1024u   /* wpisów w RAM (4 KiB) */
+#define VC_VCMD_INDEX_INTERVAL  50u     /* początkowo wpis co 1 s (50 ramek po 20 ms) */
+
+typedef struct {
+    vc_sector_writer_t      out;           /* ujście vc_vcmd_writer_open */
+    vc_stream_sink_t       *sink;          /* &out.sink albo ujście z vc_vcmd_writer_open_sink */
+    vc_vcmd_header_t        hdr;
+    uint8_t                 len_prefixed;  /* kodek F_VARIABLE: bloki z prefiksem uint16 */
+    uint16_t                block_max;     /* max bajtów bloku z prefiksem (rezerwacja) */
+    vc_crc32_t              crc;           /* -> hdr.crc32 przy zamknięciu */
+    uint32_t                index_interval;
+    uint32_t                index_count;
+    uint32_t                index[VC_VCMD_INDEX_MAX];
+    const vc_vcmd_switch_t *switches;      /* log trybu adaptacyjnego (vc_codec_select_t.log) */
+    uint16_t                switch_count;
+    uint32_t                ckpt_every;    /* próbki między punktami kontrolnymi; 0 = wyłączone */
+    uint32_t                ckpt_next;     /* total_samples następnego punktu */
+} vc_vcmd_writer_t;
+
+/* Nagłówek (kodek, kanały, ramka, codec_opts) z otwartego kodera. */
+vc_status_t vc_vcmd_writer_open(vc_vcmd_writer_t *w, const char *path, const vc_codec_t *codec);
+
+/* Jak open, ale do otwartego już ujścia (out nieużywany). */
+vc_status_t vc_vcmd_writer_open_sink(vc_vcmd_writer_t *w, vc_stream_sink_t *sink, const vc_codec_t *codec);
+
+/* Tryb nagrywania: ciągła rezerwacja na duration_ms przy maksymalnym rozmiarze ramki
+ * kodeka z open (plus indeks i tablica przełączeń), zaraz po open. W trybie adaptacyjnym
+ * to szacunek dla kodeka startowego - po przekroczeniu zapis działa dalej bez rezerwacji. */
+vc_status_t vc_vcmd_writer_reserve_ms(vc_vcmd_writer_t *w, uint32_t duration_ms);
+
+/* Dopisuje jeden blok (zakodowaną ramkę) razem z prefiksem długości - w całości albo
+ * wcale: VC_E_FULL, gdy ujście write-behind nie ma miejsca (blok pominięty). */
+vc_status_t vc_vcmd_writer_write_block(vc_vcmd_writer_t *w, const uint8_t *block, uint16_t len);
+
+/* Punkt kontrolny co interval_ms nagrania (liczone z total_samples); 0 wyłącza. */
+void        vc_vcmd_writer_set_checkpoint(vc_vcmd_writer_t *w, uint32_t interval_ms);
+
+/* Punkt kontrolny teraz (write-behind: VC_E_AGAIN gdy poprzedni jeszcze czeka). */
+vc_status_t vc_vcmd_writer_checkpoint(vc_vcmd_writer_t *w);
+
+/* Tablica przełączeń kodeka zapisywana przy zamknięciu (wskaźnik musi być ważny do close). */
+void        vc_vcmd_writer_set_switches(vc_vcmd_writer_t *w, const vc_vcmd_switch_t *log, uint16_t count);
+
+/* Dopisuje indeks i tablicę przełączeń, poprawia nagłówek i zamyka plik. */
+vc_status_t vc_vcmd_writer_close(vc_vcmd_writer_t *w);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* VC_VCMD_WRITER_H */
@@ -0,0 +1,70 @@
+#ifndef VC_WAV_WRITER_H
+#define VC_WAV_WRITER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ff.h"
+#include <stdint.h>
+#include "voicecmd/vc_data_if.h"
+#include "fatfs/vc_sector_writer.h"
+
+/*
+ * Strumieniowy zapis WAV na pendrive (bufor sektorowy: vc_sector_writer_t,
+ * albo dowolne ujście vc_stream_sink_t, np. kolejka write-behind).
+ * Nagłówek jest rezerwowany na początku pierwszego bufora; rozmiary RIFF/data
+ * (i 'fact') poprawiane przy zamknięciu.
+ * Tryb odporny na zanik zasilania (vc_wav_writer_set_checkpoint): co interval_ms danych
+ * nagłówek z bieżącymi rozmiarami + f_sync; po awarii vc_recover_dir (vc_recover.h)
+ * przycina plik do ostatniego punktu kontrolnego.
+ */
+
+#define VC_WAV_HEADER_MAX_BYTES  60u   /* RIFF(12) + fmt(8+20) + fact(12) + data(8) */
+
+typedef struct {
+    vc_sector_writer_t out;            /* ujście vc_wav_writer_open */
+    vc_stream_sink_t  *sink;           /* &out.sink albo ujście z vc_wav_writer_open_sink */
+    vc_stream_meta_t   meta;
+    uint32_t           data_bytes;     /* bajty payloadu 'data' zapisane do tej pory */
+    uint16_t           header_bytes;   /* rozmiar nagłówka (offset danych) */
+    uint32_t           ckpt_every;     /* bajty danych między punktami kontrolnymi; 0 = wyłączone */
+    uint32_t           ckpt_next;      /* data_bytes następnego punktu */
+} vc_wav_writer_t;
+
+/* Buduje nagłówek WAV dla metadanych strumienia (fmt zależnie od kodeka):
+ *  PCM16  - fmt 16 B, bez 'fact',
+ *  G.711  - fmt 18 B (cbSize = 0) + 'fact',
+ *  IMA    - fmt 20 B (cbSize = 2, wSamplesPerBlock) + 'fact',
+ *  G.722  - fmt 20 B (cbSize = 2, codec_opts) + 'fact'.
+ * Zwraca liczbę bajtów (<= VC_WAV_HEADER_MAX_BYTES) lub 0 dla kodeka bez formatu WAV (LPC). */
+uint16_t    vc_wav_build_header(const vc_stream_meta_t *m, uint32_t data_size, uint8_t *out);
+
+vc_status_t vc_wav_writer_open(vc_wav_writer_t *w, const char *path, const vc_stream_meta_t *m);
+
+/* Jak open, ale do otwartego już ujścia (out nieużywany). */
+vc_status_t vc_wav_writer_open_sink(vc_wav_writer_t *w, vc_stream_sink_t *sink, const vc_stream_meta_t *m);
+
+/* Tryb nagrywania: ciągła rezerwacja na duration_ms (avg_bytes_per_sec), zaraz po open.
+ * Dłuższe nagranie działa dalej, tylko bez gwarancji ciągłości. */
+vc_status_t vc_wav_writer_reserve_ms(vc_wav_writer_t *w, uint32_t duration_ms);
+
+/* Punkt kontrolny co interval_ms nagrania (liczone z avg_bytes_per_sec); 0 wyłącza. */
+void        vc_wav_writer_set_checkpoint(vc_wav_writer_t *w, uint32_t interval_ms);
+
+/* Punkt kontrolny teraz: nagłówek z rozmiarami dotąd zapisanych danych + f_sync
+ * (write-behind: zlecenie dla zadania zapisu, VC_E_AGAIN gdy poprzednie czeka). */
+vc_status_t vc_wav_writer_checkpoint(vc_wav_writer_t *w);
+
+/* Dopisuje len bajtów payloadu (np. ramki z compress_data). VC_E_FULL: ujście
+ * write-behind pełne, ramka odrzucona w całości (nagłówek jej nie liczy). */
+vc_status_t vc_wav_writer_write(vc_wav_writer_t *w, const void *data, uint32_t len);
+
+/* Zapisuje resztę bufora, poprawia nagłówek i zamyka plik. */
+vc_status_t vc_wav_writer_close(vc_wav_writer_t *w);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* VC_WAV_WRITER_H */
@@ -0,0 +1,135 @@
+#ifndef VC_WRITE_BEHIND_H
+#define VC_WRITE_BEHIND_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ff.h"
+#include <stdint.h>
+#include "voicecmd/vc_data_if.h"
+#include "fatfs/vc_stream_sink.h"
+
+/*
+ * Zapis write-behind: producent (tor audio, także z przerwania DMA I2S) dopisuje
+ * zakodowane ramki do pierścienia buforów sektorowych i nigdy nie czeka na USB;
+ * zadanie zapisu (vc_storage_task w pętli głównej, obok MX_USB_HOST_Process) zapisuje
+ * wszystkie pełne bufory jednym wielosektorowym f_write, kiedy pendrive jest gotowy.
+ *
+ * Kolejka SPSC bez blokad: producent zmienia tylko wr_pos, konsument tylko rd_pos
+ * (pozycje w bajtach, rosnące modulo 2^32); dane publikowane po barierze pamięci.
+ *
+ * Pojemność: VC_WB_RING_BYTES = 32 KiB, czyli ok. 1 s PCM16 mono 16 kHz (32 kB/s),
+ * 0,5 s stereo, kilka s dla ADPCM/G.711 - z zapasem na przestój USB 200 ms.
+ * Polityka przepełnienia: ramka, która się nie mieści, jest odrzucana w całości
+ * (VC_E_FULL, liczniki dropped_*); zapisane dane pozostają ciągiem pełnych ramek,
+ * a nagłówek pliku liczy tylko przyjęte ramki. Wcześniej przyjęte dane nie giną nigdy.
+ *
+ * Punkty kontrolne (vc_sink_checkpoint, np. vc_wav_writer_set_checkpoint): producent tylko
+ * odkłada kopię nagłówka i pozycję wr_pos; zadanie zapisu wykonuje punkt po opróżnieniu
+ * pełnych buforów - niepełny bufor zapisywany bez zwalniania, nagłówek, f_sync. Jeden punkt
+ * na wywołanie vc_wb_service; gdy poprzedni jeszcze czeka, nowy jest odrzucany (VC_E_AGAIN).
+ *
+ * Rotacja plików (vc_wb_rotate, nagrania segmentowane): producent kończy plik na wr_pos
+ * i przeskakuje do granicy bufora - nowy plik zaczyna się od wyrównanej pozycji pierścienia,
+ * więc jego zapisy też są wyrównane do sektora. Zamknięcie starego pliku i otwarcie nowego
+ * robi zadanie zapisu; w tym czasie producent pisze już nowy plik do pierścienia.
+ */
+
+#define VC_WB_BUF_BYTES   4096u                              /* bufor sektorowy (8 x 512 B) */
+#ifndef VC_WB_BUFS
+#define VC_WB_BUFS        8u                                 /* potęga 2 */
+#endif
+#define VC_WB_RING_BYTES  (VC_WB_BUF_BYTES * VC_WB_BUFS)
+#define VC_WB_MAX_OPEN    2u                                 /* kolejki obsługiwane przez vc_storage_task */
+#define VC_WB_CKPT_HEADER_MAX  64u                           /* nagłówek WAV (60 B) / VCMD (64 B) */
+#define VC_WB_PATH_MAX    32u                                /* ścieżka pliku po rotacji */
+
+typedef struct {
+    uint32_t high_water_bytes;   /* max zajętość pierścienia */
+    uint32_t dropped_frames;     /* ramki odrzucone (pełny pierścień) */
+    uint32_t dropped_bytes;
+    uint32_t writes;             /* wywołania f_write */
+    uint32_t written_bytes;
+    uint32_t io_errors;
+    uint32_t checkpoints;        /* wykonane punkty kontrolne */
+    uint32_t checkpoints_skipped;/* odrzucone: poprzedni jeszcze czekał */
+    uint32_t rotations;          /* zamknięte pliki po vc_wb_rotate */
+} vc_wb_stats_t;
+
+/* Zadanie zapisu, po zamknięciu pliku przy rotacji (st: wynik zamknięcia). */
+typedef void (*vc_wb_rotate_hook_t)(void *ctx, vc_status_t st);
+
+typedef struct {
+    vc_stream_sink_t   sink;        /* ujście dla vc_wav_writer / vc_vcmd_writer (*_open_sink) */
+    FIL                file;
+    volatile uint32_t  wr_pos;      /* producent: bajty przyjęte */
+    volatile uint32_t  rd_pos;      /* konsument: bajty zapisane do pliku */
+    uint32_t           reserved_bytes;
+    volatile uint8_t   finishing;   /* po vc_wb_finish: write czeka na miejsce zamiast odrzucać */
+    uint8_t            is_open;
+    volatile uint8_t   ckpt_pending;/* producent ustawia, zadanie zapisu zeruje po f_sync */
+    uint16_t           ckpt_len;
+    uint32_t           ckpt_pos;    /* wr_pos opisany nagłówkiem ckpt_header */
+    uint8_t            ckpt_header[VC_WB_CKPT_HEADER_MAX];
+    uint32_t           file_base;   /* pozycja pierścienia = offset 0 bieżącego pliku */
+    volatile uint8_t   rot_pending; /* producent ustawia, zadanie zapisu zeruje po otwarciu nowego */
+    uint8_t            rot_closed;  /* stary plik zamknięty, nowy jeszcze nie otwarty */
+    uint16_t           rot_len;
+    uint32_t           rot_pos;     /* koniec starego pliku */
+    uint32_t           rot_next;    /* początek nowego (wyrównany do bufora) */
+    uint32_t           rot_reserve; /* f_expand nowego pliku; 0 = bez rezerwacji */
+    uint8_t            rot_header[VC_WB_CKPT_HEADER_MAX];
+    char               rot_path[VC_WB_PATH_MAX];
+    vc_wb_rotate_hook_t rot_hook;
+    void              *rot_hook_ctx;
+    vc_wb_stats_t      stats;
+    uint8_t            ring[VC_WB_RING_BYTES] __attribute__((aligned(4)));
+} vc_wb_t;
+
+/* Otwiera plik (kontekst zadania zapisu) i rejestruje kolejkę w vc_storage_task. */
+vc_status_t vc_wb_open(vc_wb_t *q, const char *path);
+
+/* Producent: dopisuje ramkę w całości albo wcale (VC_E_FULL). */
+vc_status_t vc_wb_push(vc_wb_t *q, const void *data, uint32_t len);
+
+/* Wolne miejsce w pierścieniu (dla producenta). */
+uint32_t    vc_wb_space(const vc_wb_t *q);
+
+/* Producent: zleca punkt kontrolny - header opisuje wszystkie dotąd przyjęte bajty.
+ * VC_E_AGAIN: poprzedni punkt jeszcze nie wykonany. */
+vc_status_t vc_wb_checkpoint(vc_wb_t *q, const void *header, uint16_t header_len);
+
+/* Producent: kończy bieżący plik na obecnym wr_pos (header = jego nagłówek końcowy)
+ * i kieruje dalsze dane do next_path (rezerwacja reserve_bytes). Zajmuje do 4 KiB
+ * pierścienia na wyrównanie. VC_E_AGAIN: poprzednia rotacja trwa, VC_E_FULL: brak miejsca. */
+vc_status_t vc_wb_rotate(vc_wb_t *q, const void *header, uint16_t header_len,
+                         const char *next_path, uint32_t reserve_bytes);
+
+/* Funkcja wołana przez zadanie zapisu po zamknięciu pliku przy rotacji (NULL: brak). */
+void        vc_wb_set_rotate_hook(vc_wb_t *q, vc_wb_rotate_hook_t hook, void *ctx);
+
+/* Konsument: zapisuje pełne bufory (ciągły obszar pierścienia = jeden f_write),
+ * potem zleconą rotację i punkt kontrolny. Zwraca liczbę zapisanych bajtów danych. */
+uint32_t    vc_wb_service(vc_wb_t *q);
+
+/* Koniec nagrywania (producent zatrzymany): ogon writera przy zamknięciu (bajt pad,
+ * indeks, tablica przełączeń) czeka na miejsce, obsługując kolejkę w miejscu wywołania. */
+void        vc_wb_finish(vc_wb_t *q);
+
+/* Zamknięcie (kontekst zadania zapisu): zapis wszystkiego, poprawka nagłówka, f_truncate
+ * rezerwacji, f_close. Zwykle przez vc_wav_writer_close / vc_vcmd_writer_close. */
+vc_status_t vc_wb_close(vc_wb_t *q, const void *header, uint16_t header_len);
+
+/* Nośnik odłączony (albo symulacja zaniku zasilania w testach): kolejka porzucona bez
+ * zapisu i f_close, dane z pierścienia tracone; plik do naprawy przy montowaniu. */
+void        vc_wb_abort(vc_wb_t *q);
+
+/* Zadanie zapisu: obsługuje wszystkie otwarte kolejki. Wywoływane w pętli głównej. */
+void        vc_storage_task(void);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* VC_WRITE_BEHIND_H */
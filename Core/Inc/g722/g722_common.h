@@ -27,6 +27,10 @@
 
 #pragma once
 
+/* FILTEZ uses the packed-SIMD path when ARM_MATH_DSP is defined, i.e. when
+   the including .c file has pulled in arm_math.h first; otherwise the plain
+   C loop is used.  Both give identical results. */
+
 #if !defined(FALSE)
 #define FALSE 0
 #endif
@@ -53,68 +57,66 @@ static inline void block4(struct g722_band *band, int d)
     int wd1;
     int wd2;
     int wd3;
+    int sg0;
+    int ap1;
+    int ap2;
+    int sz;
     int i;
+    int16_t *dl;
 
     /* Block 4, RECONS */
-    band->d[0] = d;
     band->r[0] = saturate(band->s + d);
 
     /* Block 4, PARREC */
     band->p[0] = saturate(band->sz + d);
 
     /* Block 4, UPPOL2 */
-    for (i = 0;  i < 3;  i++)
-        band->sg[i] = band->p[i] >> 15;
     wd1 = saturate(band->a[1] << 2);
 
-    wd2 = (band->sg[0] == band->sg[1])  ?  -wd1  :  wd1;
+    wd2 = ((band->p[0] >> 15) == (band->p[1] >> 15))  ?  -wd1  :  wd1;
     if (wd2 > 32767)
         wd2 = 32767;
-    wd3 = (wd2 >> 7) + ((band->sg[0] == band->sg[2])  ?  128  :  -128);
+    wd3 = (wd2 >> 7) + (((band->p[0] >> 15) == (band->p[2] >> 15))  ?  128  :  -128);
     wd3 += (band->a[2]*32512) >> 15;
     if (wd3 > 12288)
         wd3 = 12288;
     else if (wd3 < -12288)
         wd3 = -12288;
-    band->ap[2] = wd3;
+    ap2 = wd3;
 
     /* Block 4, UPPOL1 */
-    band->sg[0] = band->p[0] >> 15;
-    band->sg[1] = band->p[1] >> 15;
-    wd1 = (band->sg[0] == band->sg[1])  ?  192  :  -192;
+    wd1 = ((band->p[0] >> 15) == (band->p[1] >> 15))  ?  192  :  -192;
     wd2 = (band->a[1]*32640) >> 15;
 
-    band->ap[1] = saturate(wd1 + wd2);
-    wd3 = saturate(15360 - band->ap[2]);
-    if (band->ap[1] > wd3)
-        band->ap[1] = wd3;
-    else if (band->ap[1] < -wd3)
-        band->ap[1] = -wd3;
+    ap1 = saturate(wd1 + wd2);
+    wd3 = saturate(15360 - ap2);
+    if (ap1 > wd3)
+        ap1 = wd3;
+    else if (ap1 < -wd3)
+        ap1 = -wd3;
 
-    /* Block 4, UPZERO */
+    /* Block 4, UPZERO (b[] is updated in place, it is only read here) */
     wd1 = (d == 0)  ?  0  :  128;
-    band->sg[0] = d >> 15;
-    for (i = 1;  i < 7;  i++)
+    sg0 = d >> 15;
+    dl = &band->dl[band->dpos];
+    for (i = 0;  i < G722_DLINE_TAPS;  i++)
     {
-        band->sg[i] = band->d[i] >> 15;
-        wd2 = (band->sg[i] == band->sg[0])  ?  wd1  :  -wd1;
+        wd2 = ((dl[i] >> 15) == sg0)  ?  wd1  :  -wd1;
         wd3 = (band->b[i]*32640) >> 15;
-        band->bp[i] = saturate(wd2 + wd3);
+        band->b[i] = saturate(wd2 + wd3);
     }
 
-    /* Block 4, DELAYA */
-    for (i = 6;  i > 0;  i--)
-    {
-        band->d[i] = band->d[i - 1];
-        band->b[i] = band->bp[i];
-    }
-    
-    for (i = 2;  i > 0;  i--)
-    {
-        band->r[i] = band->r[i - 1];
-        band->p[i] = band->p[i - 1];
-        band->a[i] = band->ap[i];
-    }
+    /* Block 4, DELAYA - the d[] line is circular, only the head moves */
+    band->dpos = (band->dpos == 0)  ?  (G722_DLINE_TAPS - 1)  :  (band->dpos - 1);
+    band->dl[band->dpos] = (int16_t) d;
+    band->dl[band->dpos + G722_DLINE_TAPS] = (int16_t) d;
+
+    band->r[2] = band->r[1];
+    band->r[1] = band->r[0];
+    band->p[2] = band->p[1];
+    band->p[1] = band->p[0];
+    band->a[2] = (int16_t) ap2;
+    band->a[1] = (int16_t) ap1;
 
     /* Block 4, FILTEP */
     wd1 = saturate(band->r[1] + band->r[1]);
@@ -124,13 +126,29 @@ static inline void block4(struct g722_band *band, int d)
     band->sp = saturate(wd1 + wd2);
 
     /* Block 4, FILTEZ */
-    band->sz = 0;
-    for (i = 6;  i > 0;  i--)
+    dl = &band->dl[band->dpos];
+    sz = 0;
+#if defined(ARM_MATH_DSP)
+    /* Two taps per iteration: QADD16 gives the saturated 2*d[i] of both lanes
+       at once, the lane products map onto SMULBB/SMULTT.  Every product is
+       still truncated separately (>> 15), so the sum stays bit-exact - a
+       dual-MAC (SMLAD) would not be. */
+    for (i = 0;  i < G722_DLINE_TAPS;  i += 2)
     {
-        wd1 = saturate(band->d[i] + band->d[i]);
-        band->sz += (band->b[i]*wd1) >> 15;
+        int32_t dd = (int32_t) __QADD16((uint32_t) read_q15x2(&dl[i]), (uint32_t) read_q15x2(&dl[i]));
+        int32_t bb = read_q15x2(&band->b[i]);
+
+        sz += ((int16_t) bb*(int16_t) dd) >> 15;
+        sz += ((bb >> 16)*(dd >> 16)) >> 15;
     }
-    band->sz = saturate(band->sz);
+#else
+    for (i = 0;  i < G722_DLINE_TAPS;  i++)
+    {
+        wd1 = saturate(dl[i] + dl[i]);
+        sz += (band->b[i]*wd1) >> 15;
+    }
+#endif
+    band->sz = saturate(sz);
 
     /* Block 4, PREDIC */
     band->s = saturate(band->sp + band->sz);
@@ -35,6 +35,9 @@ typedef void G722_DEC_CTX;
 #define _G722_DEC_CTX_DEFINED
 #endif
 
+/* Initialises caller-provided state (no allocation), e.g. embedded in a
+   vc_codec_t.  Returns s, or NULL when s is NULL. */
+G722_DEC_CTX *g722_decoder_init(G722_DEC_CTX *s, int rate, int options);
 G722_DEC_CTX *g722_decoder_new(int rate, int options);
 int g722_decoder_destroy(G722_DEC_CTX *s);
 int g722_decode(G722_DEC_CTX *s, const uint8_t g722_data[], int len, int16_t amp[]);
@@ -35,6 +35,9 @@ typedef void G722_ENC_CTX;
 #define _G722_ENC_CTX_DEFINED
 #endif
 
+/* Initialises caller-provided state (no allocation), e.g. embedded in a
+   vc_codec_t.  Returns s, or NULL when s is NULL. */
+G722_ENC_CTX *g722_encoder_init(G722_ENC_CTX *s, int rate, int options);
 G722_ENC_CTX *g722_encoder_new(int rate, int options);
 int g722_encoder_destroy(G722_ENC_CTX *s);
 int g722_encode(G722_ENC_CTX *s, const int16_t amp[], int len, uint8_t g722_data[]);
@@ -22,6 +22,8 @@
 
 #pragma once
 
+#include <stdint.h>
+
 /*! \page g722_page G.722 encoding and decoding
 \section g722_page_sec_1 What does it do?
 The G.722 module is a bit exact implementation of the ITU G.722 specification for all three
@@ -40,21 +42,26 @@ typedef struct g722_encode_state G722_ENC_CTX;
 typedef struct g722_decode_state G722_DEC_CTX;
 #define _G722_DEC_CTX_DEFINED
 
+/* Band state is kept in int16_t: every field is saturated to 16 bits by the
+   ITU algorithm (det <= 32064, nb <= 22528), so narrowing is bit-exact and
+   halves the footprint.  The zero-predictor delay line d[1..6] is circular:
+   dl[] holds it twice so dl[dpos..dpos+5] is always a contiguous window
+   (d[1] first) and DELAYA becomes a single index decrement. */
+#define G722_DLINE_TAPS 6
+
 struct g722_band
 {
-    int s;
-    int sp;
-    int sz;
-    int r[3];
-    int a[3];
-    int ap[3];
-    int p[3];
-    int d[7];
-    int b[7];
-    int bp[7];
-    int sg[7];
-    int nb;
-    int det;
+    int16_t s;
+    int16_t sp;
+    int16_t sz;
+    int16_t r[3];
+    int16_t a[3];
+    int16_t p[3];
+    int16_t b[G722_DLINE_TAPS];             /* b[i - 1] = ITU b[i] */
+    int16_t dl[2*G722_DLINE_TAPS];
+    int16_t dpos;
+    int16_t nb;
+    int16_t det;
 };
 
 struct g722_encode_state
@@ -0,0 +1,73 @@
+#ifndef PORT_DISKIO_IMAGE_H
+#define PORT_DISKIO_IMAGE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ff_gen_drv.h"
+#include <stdint.h>
+#include "voicecmd/vc_data_if.h"
+
+/*
+ * Sterownik diskio FatFs na pliku obrazu dysku - tylko build hosta (VC_HOST_BUILD).
+ * Ten sam kod zapisu (writery WAV/VCMD, write-behind, indeks, naprawa) działa wtedy na
+ * prawdziwym FatFs bez pendrive'a: FATFS_LinkDriver(&IMG_Driver, path), f_mkfs, f_mount.
+ * Na żądanie można wstrzyknąć opóźnienie (stałe + na sektor, okresowe przestoje jak
+ * porządkowanie bloków w pendrive) i błąd N-tej operacji. Liczniki opisują wzorzec
+ * dostępu: żądania sekwencyjne, zapisy FAT vs obszaru danych, rozkład rozmiarów.
+ */
+
+#define PORT_IMG_SECTOR_BYTES  512u
+#define PORT_IMG_SIZE_BUCKETS  6u    /* sektorów na żądanie: 1, 2-7, 8-15, 16-63, 64-127, >= 128 */
+
+/* Opóźnienia w us (rzeczywiste uśpienie wątku), błędy: numer operacji od 1, 0 = nigdy. */
+typedef struct {
+    uint32_t read_us;           /* na żądanie disk_read */
+    uint32_t write_us;          /* na żądanie disk_write */
+    uint32_t sector_us;         /* + na każdy sektor (przepustowość nośnika) */
+    uint32_t sync_us;           /* CTRL_SYNC */
+    uint32_t stall_every;       /* co stall_every-ty zapis dodatkowo stall_us */
+    uint32_t stall_us;
+    uint32_t fail_read_at;
+    uint32_t fail_write_at;
+    uint8_t  fail_sticky;       /* po pierwszym błędzie wszystkie operacje RES_ERROR (wyjęty nośnik) */
+} port_img_faults_t;
+
+typedef struct {
+    uint32_t reads;
+    uint32_t read_sectors;
+    uint32_t seq_reads;         /* żądanie od sektora, na którym skończyło się poprzednie */
+    uint32_t writes;
+    uint32_t write_sectors;
+    uint32_t seq_writes;
+    uint32_t fat_writes;        /* zapisy poniżej obszaru danych: FAT, FSInfo (FAT32: katalogi
+                                   leżą w obszarze danych i nie są tu liczone) */
+    uint32_t syncs;
+    uint32_t errors;            /* wstrzyknięte błędy */
+    uint32_t read_sizes[PORT_IMG_SIZE_BUCKETS];
+    uint32_t write_sizes[PORT_IMG_SIZE_BUCKETS];
+    uint64_t delay_us;          /* suma wstrzykniętych opóźnień */
+} port_img_stats_t;
+
+extern const Diskio_drvTypeDef IMG_Driver;
+
+/* Otwiera obraz; sectors > 0: tworzy nowy (pusty, do f_mkfs) o tym rozmiarze,
+ * 0: istniejący plik. */
+vc_status_t port_img_open(const char *path, uint32_t sectors);
+void        port_img_close(void);
+
+/* NULL = bez opóźnień i błędów. Liczniki operacji dla fail_*_at liczone od tego wywołania. */
+void        port_img_set_faults(const port_img_faults_t *f);
+
+/* Pierwszy sektor obszaru danych (FATFS.database po f_mount) - granica fat_writes. */
+void        port_img_set_data_start(uint32_t sector);
+
+void        port_img_get_stats(port_img_stats_t *s);
+void        port_img_reset_stats(void);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* PORT_DISKIO_IMAGE_H */
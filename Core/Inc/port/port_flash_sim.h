@@ -0,0 +1,40 @@
+#ifndef PORT_FLASH_SIM_H
+#define PORT_FLASH_SIM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "port/port_storage_flash.h"
+
+/*
+ * Symulator NOR flash w RAM dla port_storage_flash (host, testy): programowanie tylko
+ * bit 1 -> 0 słowami (inaczej naruszenie i VC_E_IO), kasowanie sektora trwa erase_polls
+ * wywołań erase_poll, w tym czasie programowanie jest błędem. Zanik zasilania po
+ * cut_after zaprogramowanych bajtach: zapis urwany w połowie, dalej każda operacja
+ * VC_E_IO do port_flash_sim_power_cycle (przerwane kasowanie zostawia pół sektora).
+ */
+
+typedef struct {
+    port_flash_dev_t dev;          /* pierwsze pole - przekazywane do port_flash_mount */
+    uint8_t  *mem;
+    uint32_t  erase_polls;
+    uint32_t  cut_after;           /* 0 = bez zaniku */
+    int16_t   erasing;
+    uint32_t  busy;
+    uint8_t   dead;
+    uint32_t  programmed;          /* bajty od inicjalizacji */
+    uint32_t  violations;
+    uint32_t  erase_count[PORT_FLASH_MAX_SECTORS];
+} port_flash_sim_t;
+
+/* mem: sectors * sector_bytes (stan po fabryce: 0xFF). */
+void port_flash_sim_init(port_flash_sim_t *sim, uint8_t *mem, uint32_t sector_bytes, uint16_t sectors);
+void port_flash_sim_power_cycle(port_flash_sim_t *sim);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* PORT_FLASH_SIM_H */
@@ -0,0 +1,175 @@
+#ifndef PORT_STORAGE_FLASH_H
+#define PORT_STORAGE_FLASH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "voicecmd/vc_data_if.h"
+#include "fatfs/vc_stream_sink.h"
+
+/*
+ * Krótkie nagrania (komendy, zapowiedzi) w wewnętrznej pamięci flash - bez opóźnień USB.
+ * Log dopisywany: każdy sektor zaczyna się nagłówkiem (licznik kasowań, numer kolejny),
+ * dalej rekordy (nagłówek 16 B z CRC-32 + payload) dopisywane tylko na koniec. Nagranie to
+ * ciąg rekordów OPEN (nazwa), DATA (kolejne bajty pliku), HEADER (nowy nagłówek pliku -
+ * punkt kontrolny / zamknięcie; obowiązuje ostatni), CLOSE. Flash nie nadpisuje bajtów,
+ * więc poprawka nagłówka WAV/VCMD jest rekordem, a czytnik podstawia ją przy odczycie.
+ * Usunięcie to rekord DELETE; sektor bez żywych nagrań jest kasowany, ale zawsze od
+ * najstarszego (DELETE nie może zniknąć przed danymi, które usuwa). Gdy kończy się
+ * skasowane miejsce, service przenosi żywe rekordy najstarszego sektora na koniec logu
+ * (GC; rekord DATA niesie offset w pliku, więc kopie są równoważne) - jeden skasowany
+ * sektor jest na to zawsze zarezerwowany i writer go nie dostaje.
+ *
+ * Zapis (port_flash_writer_t, to samo ujście vc_stream_sink_t co vc_sector_writer_t)
+ * tylko programuje wcześniej skasowane sektory - kasowanie (F407: 128 KiB ~1-2 s, pamięć
+ * flash w tym czasie nie odpowiada na odczyt, więc stoi też CPU) wykonuje wyłącznie
+ * port_flash_service z pętli głównej, gdy żaden writer ani czytnik nie jest otwarty
+ * (czytnik trzyma offsety rekordów w urządzeniu - GC / kasowanie by je unieważniły)
+ * i tor audio nie działa (port_flash_suspend: przerwania DMA I2S/USB czekałyby na flash
+ * razem z tablicą wektorów, bufory DMA zostałyby nadpisane).
+ * Wyrównywanie zużycia: mapa liczników kasowań w RAM (odtwarzana z nagłówków sektorów),
+ * nowy sektor = skasowany o najmniejszym liczniku; sektor ze statycznym nagraniem
+ * zostaje przeniesiony, gdy jego licznik odstaje od największego. Zasilanie zanikające w trakcie rekordu:
+ * rekord bez poprawnego CRC kończy sektor, nagranie bez CLOSE jest czytelne do ostatniego
+ * pełnego rekordu DATA (z ostatnim nagłówkiem z punktu kontrolnego).
+ */
+
+#define PORT_FLASH_MAX_SECTORS   8u
+#define PORT_FLASH_MAX_FILES     32u
+#define PORT_FLASH_NAME_MAX      16u      /* z '\0' */
+#define PORT_FLASH_CHUNK_BYTES   512u     /* payload rekordu DATA (bufor writera) */
+#define PORT_FLASH_HEADER_MAX    64u      /* najdłuższa poprawka nagłówka (WAV/VCMD) */
+#define PORT_FLASH_SECTOR_MAGIC  0x564C4F47u   /* 'VLOG' */
+
+/* Urządzenie: sectors x sector_bytes od base (odczyt wprost z pamięci). program: offset
+ * i len wyrównane do 4 B, tylko bity 1 -> 0; erase_start nie czeka na koniec kasowania,
+ * erase_poll: VC_E_AGAIN w trakcie, VC_OK po końcu. */
+typedef struct port_flash_dev {
+    const uint8_t *base;
+    uint32_t       sector_bytes;
+    uint16_t       sectors;
+    vc_status_t  (*program)(struct port_flash_dev *d, uint32_t offset, const void *data, uint32_t len);
+    vc_status_t  (*erase_start)(struct port_flash_dev *d, uint16_t sector);
+    vc_status_t  (*erase_poll)(struct port_flash_dev *d);
+} port_flash_dev_t;
+
+typedef enum {
+    PORT_FLASH_S_DIRTY  = 0,   /* do skasowania */
+    PORT_FLASH_S_ERASED = 1,   /* skasowany, nagłówek z licznikiem - gotowy do przydziału */
+    PORT_FLASH_S_LOG    = 2,   /* w logu (ostatni przydzielony = aktywny) */
+} port_flash_sector_state_t;
+
+typedef struct {
+    uint32_t erase_count;
+    uint32_t seq;              /* kolejność przydziału (LOG) */
+    uint32_t used;             /* offset końca logu w sektorze */
+    uint8_t  state;            /* port_flash_sector_state_t */
+    uint8_t  files;            /* żywe nagrania z rekordami w sektorze */
+} port_flash_sector_t;
+
+typedef struct {
+    char     name[PORT_FLASH_NAME_MAX];
+    uint16_t id;               /* 0: wolny wpis */
+    uint8_t  closed;           /* jest rekord CLOSE (bez niego: przerwane nagranie) */
+    uint8_t  sector_mask;      /* sektory z rekordami nagrania */
+    uint32_t bytes;            /* bajty pliku (suma DATA) */
+    uint32_t header_at;        /* offset w urządzeniu payloadu ostatniego HEADER (0 = brak) */
+    uint16_t header_len;
+} port_flash_file_t;
+
+typedef struct {
+    port_flash_dev_t  *dev;
+    port_flash_sector_t sector[PORT_FLASH_MAX_SECTORS];
+    port_flash_file_t  file[PORT_FLASH_MAX_FILES];
+    uint16_t file_count;
+    uint16_t next_id;
+    uint32_t next_seq;
+    int16_t  active;           /* sektor, do którego dopisujemy (-1: brak) */
+    int16_t  erasing;          /* sektor w trakcie kasowania (-1: brak) */
+    uint8_t  writers;          /* otwarte writery (kasowanie wstrzymane) */
+    uint8_t  readers;          /* otwarte czytniki (GC i kasowanie wstrzymane) */
+    uint8_t  suspends;         /* aktywne tory audio (GC i kasowanie wstrzymane) */
+    uint32_t erases;           /* kasowania od montowania */
+    uint32_t relocated;        /* bajty payloadu przeniesione przez GC od montowania */
+    uint32_t gc_idle;          /* stan logu, przy którym GC nie miał nic do zrobienia */
+} port_flash_t;
+
+typedef struct {
+    vc_stream_sink_t sink;     /* pierwsze pole (vc_stream_sink.h) */
+    port_flash_t    *fs;
+    uint16_t         file;     /* indeks w fs->file */
+    uint16_t         fill;
+    uint8_t          is_open;
+    uint8_t          buf[PORT_FLASH_CHUNK_BYTES] __attribute__((aligned(4)));
+} port_flash_writer_t;
+
+typedef struct {
+    port_flash_t *fs;
+    uint16_t      id;
+    uint16_t      header_len;
+    uint32_t      header_at;
+    uint32_t      bytes;
+    uint32_t      pos;         /* pozycja w pliku */
+    int16_t       sector;      /* bieżący sektor logu (-1: koniec) */
+    uint32_t      at;          /* następny rekord w sektorze */
+    uint32_t      rec_at;      /* payload bieżącego rekordu DATA (offset w urządzeniu) */
+    uint16_t      rec_len;
+    uint16_t      rec_pos;
+} port_flash_reader_t;
+
+typedef struct {
+    uint32_t free_bytes;       /* miejsce dla writera (bez sektora rezerwy GC) */
+    uint16_t erased_sectors;
+    uint16_t dirty_sectors;
+    uint16_t files;
+    uint32_t erase_min;
+    uint32_t erase_max;
+} port_flash_stats_t;
+
+/* Odtwarza mapę sektorów i nagrań z nośnika (sektory nieznane / uszkodzone -> DIRTY). */
+vc_status_t port_flash_mount(port_flash_t *fs, port_flash_dev_t *dev);
+
+/* Pętla główna: kończy trwające kasowanie, zaczyna następne albo przenosi jeden sektor (GC)
+ * - tylko bez otwartych writerów i czytników. VC_E_AGAIN: praca trwa albo czeka na ich
+ * zamknięcie, VC_OK: nic do zrobienia. */
+vc_status_t port_flash_service(port_flash_t *fs);
+
+/* Przed startem toru audio (DMA I2S / USB): wstrzymuje GC i kasowanie do port_flash_resume;
+ * trwające kasowanie jest najpierw kończone (do ~2 s). Wywołania się zagnieżdżają.
+ * VC_E_IO: kasowanie zakończone błędem (wstrzymanie i tak obowiązuje). */
+vc_status_t port_flash_suspend(port_flash_t *fs);
+void        port_flash_resume(port_flash_t *fs);
+
+/* Usuwa wszystkie nagrania (sektory do skasowania przez service; liczniki zostają). */
+vc_status_t port_flash_format(port_flash_t *fs);
+
+/* Nowe nagranie name (istniejące o tej nazwie jest usuwane); dalej przez w->sink.
+ * VC_E_FULL: brak skasowanego miejsca albo wolnego wpisu nagrania. */
+vc_status_t port_flash_writer_open(port_flash_t *fs, port_flash_writer_t *w, const char *name);
+
+vc_status_t port_flash_delete(port_flash_t *fs, const char *name);
+
+/* Odczyt pliku nagrania z podstawionym ostatnim nagłówkiem (HEADER). Do close service
+ * nie przenosi ani nie kasuje sektorów. */
+vc_status_t port_flash_reader_open(port_flash_t *fs, port_flash_reader_t *r, const char *name);
+/* *got < len tylko na końcu pliku. */
+vc_status_t port_flash_read(port_flash_reader_t *r, void *buf, uint32_t len, uint32_t *got);
+void        port_flash_reader_close(port_flash_reader_t *r);
+
+void        port_flash_get_stats(const port_flash_t *fs, port_flash_stats_t *st);
+
+#ifndef VC_HOST_BUILD
+/* Sektory 8-11 STM32F407 (0x08080000, 4 x 128 KiB). Program musi się kończyć poniżej -
+ * w STM32F407VGTX_FLASH.ld: FLASH LENGTH = 512K oraz po sekcji .data
+ *   ASSERT(LOADADDR(.data) + SIZEOF(.data) <= 0x08080000, "program nachodzi na log flash")
+ * Bez tego NULL, gdy obraz (koniec _sidata + .data) sięga sektora 8. */
+port_flash_dev_t *port_flash_stm32(void);
+#endif
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* PORT_STORAGE_FLASH_H */
@@ -16,6 +16,8 @@
 #include "voicecmd/vc_data_if.h"
 #include "voicecmd/vc_encoders.h"
 #include "voicecmd/vc_decoders.h"
+#include "voicecmd/vc_codec.h"
+#include "voicecmd/vc_codec_select.h"
 #include "voicecmd/vc_filters.h"
 #include <stdio.h>
 #include <math.h>
@@ -72,6 +74,59 @@ void test_ima_adpcm_compression(void);
 
 void test_g722_compression(void);
 
+/**
+ * @brief Test kompresji G.711 (µ-law / A-law) - błąd rekonstrukcji i współczynnik 2:1.
+ */
+void test_g711_compression(void);
+
+/**
+ * @brief Pomiar cykli (DWT) kodowania/dekodowania G.722 64 kb/s na ramkę 20 ms.
+ */
+void test_g722_cycles(void);
+
+/**
+ * @brief G.722 64/56/48 kb/s z pakowaniem i bez - rozmiar ramki, metadane, dekoder z metadanych.
+ */
+void test_g722_modes(void);
+
+/**
+ * @brief G.722 64/56/48 kb/s z pakowaniem i bez: CRC strumienia i zdekodowanego PCM (3 s
+ *        sygnału całkowitoliczbowego) porównane z implementacją referencyjną SpanDSP.
+ */
+void test_g722_bitexact(void);
+
+/**
+ * @brief Ukrywanie strat (PLC): ramki z błędnym CRC / obcięte -> ciągłe wyjście, SNR ukrytych ramek.
+ */
+void test_plc_concealment(void);
+
+/**
+ * @brief IMA-ADPCM z przeszukiwaniem w przód vs zachłanny - SNR i cykle DWT na blok.
+ */
+void test_ima_lookahead(void);
+
+/**
+ * @brief Stereo (IMA MS-IMA, G.722, PCM16): kodowanie 2-kanałowe, SNR osobno dla L i R.
+ */
+void test_stereo_compression(void);
+
+/**
+ * @brief Adaptacyjny wybór kodeka (segSNR + limit CPU) - przełączenia i rozmiar względem PCM16.
+ */
+void test_codec_select(void);
+
+/**
+ * @brief Kodowanie wsadowe (compress_frames) vs ramka-po-ramce: zgodność bajtów i cykle DWT;
+ *        PCM16 / G.711 z ramkami po 160 próbek: encode_frames i decode_frames bez offsetów.
+ */
+void test_batch_compression(void);
+
+/**
+ * @brief LPC + Rice: 3 s (mowa dźwięczna, prawie cisza, szum pełnej skali) - bezstratność,
+ *        rozmiar względem PCM16 w każdym odcinku, najgorsze cykle DWT enc/dec wobec 20 ms.
+ */
+void test_lpc_roundtrip(void);
+
 /**
  * @brief Uruchamia wszystkie testy kodeków.
  */
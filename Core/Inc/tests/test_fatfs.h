@@ -1,6 +1,61 @@
 #ifndef TEST_FATFS_H
 #define TEST_FATFS_H
 
+/**
+ * @brief Zapis IMA-ADPCM przez vc_wav_writer i odczyt przez vc_stream_reader (zgodność, czas).
+ */
+void test_wav_roundtrip(void);
+
+/**
+ * @brief VCMD (LPC, ramki zmiennej długości) z indeksem: czas losowych skoków seek_frame
+ *        z mapą klastrów (fast seek) i bez.
+ */
+void test_vcmd_seek(void);
+
+/**
+ * @brief CRC32 4 KiB: cykle DWT slice-by-8 vs jednostka CRC (DMA), zgodność wyników
+ *        i weryfikacja CRC pliku VCMD z test_vcmd_seek.
+ */
+void test_crc32_speed(void);
+
+/**
+ * @brief Nagranie 30 s PCM16 z rezerwacją f_expand i bez: najgorszy czas zapisu ramki 20 ms.
+ */
+void test_prealloc_latency(void);
+
+/**
+ * @brief Write-behind: 10 s PCM16 w tempie 20 ms/ramkę z przestojem zapisu 200 ms co 2 s
+ *        - zgubione ramki, high-water mark kolejki, liczba f_write.
+ */
+void test_write_behind_stall(void);
+
+/**
+ * @brief 1 MiB zapisu i odczytu po 512 B przez f_write/f_read: liczniki cache diskio
+ *        (transfery MSC vs żądania FatFs) i przepustowość.
+ */
+void test_diskio_cache(void);
+
+/**
+ * @brief Nagranie 7,5 s PCM16 z punktem kontrolnym co 1 s przerwane bez zamknięcia
+ *        (symulacja zaniku zasilania): naprawa vc_recover_file, odzyskana długość,
+ *        najgorszy czas ramki z punktem kontrolnym; ponowne sprawdzenie bez zmian.
+ */
+void test_checkpoint_recovery(void);
+
+/**
+ * @brief Nagranie 7 s PCM16 w segmentach po 2 s (write-behind, 20 ms/ramkę): zgubione
+ *        ramki, ciągłość ramek między segmentami i zgodność manifestu z plikami; zanik
+ *        zasilania w trzecim segmencie i vc_seg_recover: naprawione pliki, wpis otwartego
+ *        segmentu w manifeście (F_LAST | F_RECOVERED), ramki do ostatniego punktu kontrolnego.
+ */
+void test_segment_rotation(void);
+
+/**
+ * @brief 300 pustych nagrań w jednym katalogu dopisanych do indeksu: czas wyszukania
+ *        po nazwie przez indeks vs liniowy f_readdir, poprawność wpisów i listy.
+ */
+void test_rec_index(void);
+
 void run_fatfs_test();
 
 #endif
@@ -0,0 +1,17 @@
+#ifndef TEST_IMG_BENCH_H
+#define TEST_IMG_BENCH_H
+
+/**
+ * @brief Benchmark zapisu na hoście przez prawdziwy FatFs i obraz dysku
+ *        (port_diskio_image.h): świeży FAT32 (klaster 32 KiB), 60 s nagrania
+ *        bezpośrednim f_write po ramce, writerem WAV (bez i z f_expand) i VCMD LPC,
+ *        odczyt czytnikiem. Dla każdego przypadku: MB/s, wywołania f_write, żądania
+ *        i sektory diskio, udział żądań sekwencyjnych, zapisy FAT (bez katalogów), rozkład
+ *        rozmiarów żądań. Dalej writer WAV z opóźnieniem pendrive'a i z błędem zapisu
+ *        (status + naprawa vc_recover_file); test_storage_bench bez i z opóźnieniem
+ *        pendrive'a. Tylko VC_HOST_BUILD.
+ * @param image Ścieżka pliku obrazu (tworzony od nowa).
+ */
+void run_img_bench(const char *image);
+
+#endif
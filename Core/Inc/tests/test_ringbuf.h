@@ -0,0 +1,20 @@
+#ifndef TEST_RINGBUF_H
+#define TEST_RINGBUF_H
+
+/**
+ * @brief Kolejka SPSC w jednym kontekście: odrzucenie pojemności nie będącej potęgą 2,
+ *        push_n/pop_n przez koniec tablicy, pełna i pusta kolejka, span do końca
+ *        tablicy (commit / release części), kolejność elementów; koszt push+pop [cyk].
+ */
+void test_spsc_basic(void);
+
+/**
+ * @brief (host) Producent i konsument w osobnych wątkach, losowe wsady przez push_n /
+ *        write_span i pop_n / read_span, pojemność 64: numery kolejne bez luk
+ *        i dane wskazywane przez slot zapisane przed publikacją.
+ */
+void test_spsc_stress(void);
+
+void run_ringbuf_test(void);
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef TEST_STORAGE_BENCH_H
+#define TEST_STORAGE_BENCH_H
+
+/**
+ * @brief Benchmark nośnika przez FatFs na zamontowanym wolumenie: sekwencyjny zapis
+ *        i odczyt pliku 2 MiB porcjami 512 B - 32 KiB (kB/s), f_sync co 256 KiB,
+ *        losowe f_lseek bez i z mapą klastrów (fast seek). Dla f_write, f_sync, f_read
+ *        i f_lseek: liczba wywołań, percentyle p50/p90/p99/p99.9 (histogram
+ *        log-liniowy, dokładność ~25%) i maksimum; na koniec najgorszy przestój.
+ *        Ten sam kod na hoście przez port_diskio_image (wywoływany z run_img_bench).
+ * @param drive Prefiks wolumenu ("" - domyślny, np. "0:").
+ */
+void test_storage_bench(const char *drive);
+
+/**
+ * @brief Montuje pendrive (USB MSC, sterownik dołączony w MX_FATFS_Init) i uruchamia
+ *        test_storage_bench; wyniki przez UART.
+ */
+void run_storage_bench(void);
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef TEST_STORAGE_FLASH_H
+#define TEST_STORAGE_FLASH_H
+
+#include "port/port_storage_flash.h"
+
+/**
+ * @brief Zapowiedzi 3/4/4 s PCM16 writerem WAV do logu we flash: najgorszy czas ramki,
+ *        odczyt i porównanie próbek oraz nagłówka, usunięcie, service w trakcie odczytu
+ *        (GC wstrzymany do zamknięcia czytnika) i przy aktywnym torze audio
+ *        (port_flash_suspend), GC i kasowanie w service
+ *        i ponowny zapis w odzyskanym miejscu; liczniki kasowań sektorów.
+ * @param dev Urządzenie flash (port_flash_stm32() albo symulator).
+ */
+void test_flash_log(port_flash_dev_t *dev);
+
+/**
+ * @brief (host) Zanik zasilania w trakcie nagrania z punktami kontrolnymi co 250 ms
+ *        oraz w trakcie kasowania i GC: ponowne montowanie, odzyskane bajty, zgodność nagłówka.
+ */
+void test_flash_power_cut(void);
+
+/**
+ * @brief (host) 300 cykli zapis 2 s / usunięcie obok statycznej zapowiedzi: rozrzut
+ *        liczników kasowań sektorów.
+ */
+void test_flash_wear(void);
+
+void run_storage_flash_test(void);
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef VC_CODEC_H
+#define VC_CODEC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "voicecmd/vc_data_if.h"
+#include "voicecmd/vc_encoders.h"
+
+/*
+ * Wspólny interfejs kodeków: tablica operacji (vc_codec_ops_t) + rejestr
+ * wyszukiwany po vc_codec_id_t. Tor nagrywania/odtwarzania woła tylko
+ * vc_codec_*(), więc nowy kodek = nowa tablica ops + wpis w rejestrze
+ * (vc_codec.c), bez zmian w compress_data()/decompress_data().
+ *
+ * Stan kodeka leży w vc_codec_t (bez malloc), rozmiar <= VC_CODEC_STATE_BYTES.
+ */
+
+#define VC_CODEC_STATE_BYTES  (384u * VC_MAX_CHANNELS)   /* G.722 stereo: 2 x stan SpanDSP */
+
+typedef enum {
+    VC_CODEC_DIR_ENC = 0,
+    VC_CODEC_DIR_DEC = 1,
+} vc_codec_dir_t;
+
+/* Flagi vc_codec_ops_t.flags */
+enum {
+    VC_CODEC_F_VARIABLE     = 1u << 0, /* ramki o zmiennej długości (wymaga offsetów przy dekodowaniu) */
+    VC_CODEC_F_INTERLEAVED  = 1u << 1, /* kodek próbkowy: stereo = płaski strumień n * channels próbek */
+    VC_CODEC_F_MULTICHANNEL = 1u << 2, /* adapter sam obsługuje kanały (stan na kanał, własny układ ramki) */
+};
+
+typedef struct vc_codec_ops {
+    vc_codec_id_t id;
+    const char   *name;
+    uint16_t      state_bytes;
+    uint16_t      flags;
+    uint16_t      delay_samples;  /* opóźnienie wyjścia dekodera względem wejścia kodera */
+
+    vc_status_t (*open)(void *st, const vc_enc_cfg_t *cfg, vc_codec_dir_t dir);
+    void        (*close)(void *st);                                       /* może być NULL */
+
+    /* Jedna ramka n próbek; *out_len = liczba bajtów ramki. */
+    vc_status_t (*encode_frame)(void *st, const int16_t *pcm, uint16_t n,
+                                uint8_t *out, uint16_t *out_len);
+    /* Jedna ramka in_len bajtów -> n próbek. */
+    vc_status_t (*decode_frame)(void *st, const uint8_t *in, uint16_t in_len,
+                                int16_t *pcm, uint16_t n);
+
+    /* Opcjonalna szybka ścieżka wieloramkowa (NULL -> pętla po *_frame).
+     * offsets[n_frames + 1]: początek każdej ramki w out/in, ostatni = suma. */
+    vc_status_t (*encode_frames)(void *st, const int16_t *pcm, uint16_t n, uint16_t n_frames,
+                                 uint8_t *out, uint32_t out_cap,
+                                 uint32_t *offsets, uint32_t *out_len);
+    vc_status_t (*decode_frames)(void *st, const uint8_t *in, const uint32_t *offsets,
+                                 uint16_t n_frames, int16_t *pcm, uint16_t n);
+
+    /* Dopisuje resztki bitstreamu na końcu strumienia (NULL -> nic). */
+    vc_status_t (*flush)(void *st, uint8_t *out, uint16_t *out_len);
+
+    void        (*meta)(const vc_enc_cfg_t *cfg, vc_stream_meta_t *m);
+    uint16_t    (*max_bytes_per_frame)(const vc_enc_cfg_t *cfg);
+} vc_codec_ops_t;
+
+/* Otwarta instancja kodeka (koder albo dekoder). */
+typedef struct vc_codec {
+    const vc_codec_ops_t *ops;
+    vc_enc_cfg_t   cfg;
+    vc_codec_dir_t dir;
+    uint16_t       frame_samples;      /* samples_per_block albo VC_FRAME_SAMPLES (na kanał) */
+    uint16_t       channels;           /* 1..VC_MAX_CHANNELS; PCM przeplatany (L R L R ...) */
+    uint32_t       state[VC_CODEC_STATE_BYTES / sizeof(uint32_t)];
+} vc_codec_t;
+
+/* Rejestr */
+const vc_codec_ops_t *vc_codec_find(vc_codec_id_t id);
+
+vc_status_t vc_codec_open(vc_codec_t *c, const vc_enc_cfg_t *cfg, vc_codec_dir_t dir);
+void        vc_codec_close(vc_codec_t *c);
+
+/* Konfiguracja dekodera z metadanych strumienia (np. z nagłówka WAV/VCMD):
+ * kodek, samples_per_block, dla G.722 bitrate i pakowanie z codec_opts. */
+vc_status_t vc_codec_cfg_from_meta(const vc_stream_meta_t *m, vc_enc_cfg_t *cfg);
+
+/* Koduje n_frames kolejnych ramek (frame_samples próbek na kanał, przeplatane) do out.
+ * offsets (opcjonalnie) dostaje n_frames + 1 pozycji; *out_len = suma bajtów. */
+vc_status_t vc_codec_encode_frames(vc_codec_t *c, const int16_t *pcm, uint16_t n_frames,
+                                   uint8_t *out, uint32_t out_cap,
+                                   uint32_t *offsets, uint32_t *out_len);
+
+/* Dekoduje n_frames ramek. offsets == NULL dozwolone tylko dla ramek stałej długości
+ * (max_bytes_per_frame). */
+vc_status_t vc_codec_decode_frames(vc_codec_t *c, const uint8_t *in, const uint32_t *offsets,
+                                   uint16_t n_frames, int16_t *pcm);
+
+vc_status_t vc_codec_flush(vc_codec_t *c, uint8_t *out, uint16_t *out_len);
+void        vc_codec_meta(const vc_codec_t *c, vc_stream_meta_t *m);
+uint16_t    vc_codec_max_bytes_per_frame(const vc_codec_t *c);
+
+/* Liczba kanałów ramki (channels == 0 traktowane jak mono). */
+static inline uint16_t vc_frame_channels(const vc_pcm_meta_t *frm)
+{
+    return (frm && frm->channels) ? frm->channels : 1u;
+}
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* VC_CODEC_H */
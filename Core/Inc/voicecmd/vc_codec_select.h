@@ -0,0 +1,84 @@
+#ifndef VC_CODEC_SELECT_H
+#define VC_CODEC_SELECT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "voicecmd/vc_data_if.h"
+#include "voicecmd/vc_codec.h"
+#include "arm_math.h"
+
+/*
+ * Adaptacyjny wybór kodeka/bitrate'u na nagranie.
+ * Co eval_every_frames ramek bieżąca ramka jest próbnie kodowana i dekodowana
+ * każdym kandydatem (na świeżym stanie, rozgrzanym poprzednią ramką) i mierzony
+ * jest segmentowy SNR względem źródła. Wybierany jest najtańszy (B/s) kandydat,
+ * który spełnia target_snr_db i mieści się w cpu_cap_cycles. Przełączenia trafiają
+ * do log[] (vc_vcmd_switch_t) - kontener VCMD zapisuje je razem z danymi.
+ */
+
+#define VC_SELECT_N_CANDIDATES   5u
+#define VC_SELECT_MAX_SWITCHES   VC_VCMD_MAX_SWITCHES  /* po zapełnieniu logu kodek zostaje zamrożony */
+#define VC_SEGSNR_SUBFRAME       80u     /* 5 ms */
+#define VC_SEGSNR_MIN_DB         (-10.0f)
+#define VC_SEGSNR_MAX_DB         35.0f
+
+typedef struct {
+    vc_enc_cfg_t cfg;
+    uint32_t     bytes_per_sec;    /* koszt zapisu */
+    uint32_t     enc_cycles;       /* koszt CPU kodowania ramki (szacunek, aktualizowany pomiarem) */
+} vc_select_candidate_t;
+
+typedef struct {
+    float32_t target_snr_db;       /* np. 20 dB */
+    float32_t hysteresis_db;       /* zapas wymagany przy zejściu na tańszy kodek */
+    uint32_t  cpu_cap_cycles;      /* max cykli kodowania na ramkę; 0 = bez limitu */
+    uint16_t  eval_every_frames;   /* co ile ramek próba (50 = 1 s); 0 -> 50 */
+    uint32_t  (*cycles)(void);     /* licznik cykli (np. DWT->CYCCNT); NULL = tylko szacunki */
+} vc_select_cfg_t;
+
+typedef struct {
+    vc_select_cfg_t       cfg;
+    vc_select_candidate_t cand[VC_SELECT_N_CANDIDATES];  /* od najtańszego */
+    float32_t             last_snr_db[VC_SELECT_N_CANDIDATES];
+
+    vc_codec_t active;             /* bieżący koder */
+    uint8_t    active_idx;
+    uint32_t   frame_idx;
+    uint32_t   byte_pos;           /* bajty wyprodukowane od początku nagrania */
+
+    vc_vcmd_switch_t log[VC_SELECT_MAX_SWITCHES];
+    uint16_t         n_switches;
+
+    /* Robocze (próby kandydatów) - poza stosem.
+     * src = [poprzednia ramka | bieżąca ramka]; poprzednia rozgrzewa stan kandydata. */
+    int16_t    src[2u * VC_FRAME_SAMPLES];
+    bool       have_prev;
+    vc_codec_t trial_enc;
+    vc_codec_t trial_dec;
+    uint8_t    trial_bytes[2u * VC_PCM_FRAME_BYTES];
+    int16_t    trial_pcm[2u * VC_FRAME_SAMPLES];
+} vc_codec_select_t;
+
+/* Domyślne: 20 dB, 1 dB histerezy, bez limitu CPU, próba co 1 s. */
+void        vc_select_default_cfg(vc_select_cfg_t *cfg);
+vc_status_t vc_select_init(vc_codec_select_t *s, const vc_select_cfg_t *cfg);
+
+/* Koduje jedną ramkę (VC_FRAME_SAMPLES) aktywnym kodekiem, wcześniej - jeśli
+ * przypada próba - ewentualnie przełącza kodek. out >= VC_PCM_FRAME_BYTES.
+ * *switched = true, gdy ta ramka zaczyna nowy wpis w log[]. */
+vc_status_t vc_select_encode(vc_codec_select_t *s, const int16_t *pcm,
+                             uint8_t *out, uint16_t *out_len, bool *switched);
+
+/* Segmentowy SNR [dB] (podramki VC_SEGSNR_SUBFRAME, obcinane do MIN..MAX).
+ * Podramki ciszy są pomijane; *active = liczba uwzględnionych (0 -> wynik nieistotny). */
+float32_t   vc_segsnr_db(const int16_t *ref, const int16_t *test, uint16_t n, uint16_t *active);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* VC_CODEC_SELECT_H */
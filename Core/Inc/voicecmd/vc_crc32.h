@@ -0,0 +1,66 @@
+#ifndef VC_CRC32_H
+#define VC_CRC32_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/*
+ * CRC-32 payloadu kontenerów (vc_vcmd_header_t.crc32), liczone przyrostowo ramka po ramce.
+ * Wariant jednostki CRC STM32F4: wielomian 0x04C11DB7, init 0xFFFFFFFF, bez odbicia
+ * i bez końcowego XOR (CRC-32/MPEG-2), dane jako słowa 32-bit little-endian (pierwszy
+ * idzie najstarszy bajt słowa). Niepełne ostatnie słowo dopełniane zerami.
+ * Dzięki temu backend programowy (slice-by-8, host i target) i sprzętowy (CRC->DR,
+ * duże porcje przez DMA2 pamięć->pamięć) dają ten sam wynik.
+ *
+ * Konteksty (vc_crc32_t) są niezależne i mogą być używane z różnych poziomów przerwań
+ * (writer VCMD w torze audio, verify_crc w pętli głównej), ale jeden kontekst - tylko
+ * z jednego. Jednostkę CRC zajmuje jedno wywołanie naraz (sekcja z PRIMASK); kto ją
+ * zastanie zajętą - przerwanie w trakcie update innego kontekstu albo czekający
+ * update_async - liczy programowo, z tym samym wynikiem.
+ */
+
+#ifndef VC_CRC32_USE_HW
+#  if defined(USE_HAL_DRIVER) && defined(STM32F407xx)
+#    define VC_CRC32_USE_HW 1
+#  else
+#    define VC_CRC32_USE_HW 0
+#  endif
+#endif
+
+#define VC_CRC32_INIT           0xFFFFFFFFu
+#define VC_CRC32_POLY           0x04C11DB7u
+#define VC_CRC32_DMA_MIN_BYTES  256u      /* krótsze porcje: słowa wpisywane do CRC->DR przez CPU */
+
+typedef struct {
+    uint32_t crc;
+    uint32_t pending;       /* bajty niepełnego słowa (little-endian) */
+    uint8_t  n_pending;
+} vc_crc32_t;
+
+void     vc_crc32_init(vc_crc32_t *c);
+void     vc_crc32_update(vc_crc32_t *c, const void *data, uint32_t len);
+
+/* Jak update, ale z HW zwraca od razu po starcie DMA (dane wyrównane do 4 B, len % 4 == 0,
+ * bez bajtów zaległych, >= VC_CRC32_DMA_MIN_BYTES, jednostka wolna - inaczej liczy
+ * synchronicznie). Dane nie mogą się zmienić do vc_crc32_wait / kolejnego vc_crc32_* na
+ * tym kontekście; do tego czasu pozostałe konteksty liczą programowo. Bez HW: zwykły update. */
+void     vc_crc32_update_async(vc_crc32_t *c, const void *data, uint32_t len);
+void     vc_crc32_wait(vc_crc32_t *c);
+
+/* Wynik (dopełnia zaległe bajty zerami). Kontekst można dalej aktualizować tylko po init. */
+uint32_t vc_crc32_final(vc_crc32_t *c);
+
+/* Jednorazowo dla całego bufora. */
+uint32_t vc_crc32(const void *data, uint32_t len);
+
+/* Jądro programowe: n_words słów od stanu crc (slice-by-8). */
+uint32_t vc_crc32_words_sw(uint32_t crc, const uint32_t *words, uint32_t n_words);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* VC_CRC32_H */
@@ -29,6 +29,7 @@ extern "C" {
 /* ====== Ustalenia globalne ====== */
 #define VC_FS_HZ                 16000u     /* częstotliwość próbkowania */
 #define VC_CHANNELS              1u         /* mono */
+#define VC_MAX_CHANNELS          2u         /* stereo (drugi mikrofon: referencja / beamforming) */
 #define VC_PCM_BITS              16u
 #define VC_PCM_BYTES_PER_SAMPLE  2u
 #define VC_FRAME_MS              20u        /* ramka robocza */
@@ -70,8 +71,11 @@ typedef enum {
 /* ====== Identyfikatory kodeków/formatów ====== */
 typedef enum {
     VC_CODEC_PCM16   = 1,   /* Linear PCM 16-bit, WAV fmt=1 */
-    VC_CODEC_G722   = 7,   /* G.711 µ-law, WAV fmt=7 */
+    VC_CODEC_G711A   = 6,   /* G.711 A-law, WAV fmt=6 */
+    VC_CODEC_G711U   = 7,   /* G.711 µ-law, WAV fmt=7 */
     VC_CODEC_IMA_ADPCM = 0x11, /* IMA ADPCM, WAV fmt=0x11 (ADPCM Microsoft/IMA) */
+    VC_CODEC_G722    = 0x65, /* G.722 ADPCM 64 kb/s, WAV fmt=0x65 */
+    VC_CODEC_LPC_RICE = 0x4C50, /* bezstratny LPC + Rice ('LP'), tylko kontener VCMD */
 } vc_codec_id_t;
 
 /* ====== Ramka PCM dla przekazu A<->B i B<->A ====== */
@@ -84,8 +88,8 @@ typedef enum {
 typedef struct VC_PACKED {
     uint32_t frame_idx;         /* ++ co ramkę (diagnostyka) */
     uint32_t sample_rate_hz;    /* = VC_FS_HZ */
-    uint16_t channels;          /* = 1 */
-    uint16_t len_samples;       /* zwykle = VC_FRAME_SAMPLES (320) */
+    uint16_t channels;          /* 1 (mono) / 2 (stereo, próbki przeplatane L R); 0 = 1 */
+    uint16_t len_samples;       /* na kanał, zwykle = VC_FRAME_SAMPLES (320) */
 } vc_pcm_meta_t;
 
 //VC_STATIC_ASSERT(sizeof(int16_t) == 2, int16_must_be_2_bytes);
@@ -94,16 +98,20 @@ typedef struct VC_PACKED {
 typedef struct VC_PACKED {
     vc_codec_id_t codec_id;     /* patrz vc_codec_id_t */
     uint32_t sample_rate_hz;    /* 16000 */
-    uint16_t channels;          /* 1 */
+    uint16_t channels;          /* 1 / 2 (IMA: bloki MS-IMA ze słowami 4B przeplatanymi per kanał) */
     /* Dla PCM/G.711: */
     uint16_t bits_per_sample;   /* 16 (PCM) / 8 (G.711) lub 0 jeśli nie dotyczy */
     uint16_t block_align;       /* 2 (PCM16 mono) / 1 (G.711) / dla ADPCM: block_bytes */
     uint32_t avg_bytes_per_sec; /* 32000 (PCM16) / 16000 (G.711) / ~ (ADPCM zależnie od block) */
     /* Dla ADPCM: */
     uint16_t samples_per_block; /* np. 320 (ADPCM); 0 gdy nie dotyczy */
-    uint16_t reserved;          /* wyrównanie */
+    uint16_t codec_opts;        /* opcje trybu kodeka (G.722: VC_G722_OPT_*); 0 = domyślne */
 } vc_stream_meta_t;
 
+/* ====== vc_stream_meta_t.codec_opts dla G.722 ====== */
+#define VC_G722_OPT_BITS_MASK  0x000Fu  /* bity na słowo kodowe: 8 (64k) / 7 (56k) / 6 (48k); 0 = 8 */
+#define VC_G722_OPT_PACKED     0x0010u  /* słowa 6/7-bit ciasno upakowane (G722_PACKED) */
+
 /* ====== Kawałki strumienia (uogólnienie) ====== */
 typedef struct VC_PACKED {
     uint32_t seq;         /* ++ dla każdego chunku/bloku/ramki */
@@ -133,16 +141,113 @@ typedef struct VC_PACKED {
     uint16_t reserved0;
     uint32_t total_samples;   /* dla PCM/G711; dla ADPCM: total_samples po dekodowaniu */
     uint32_t total_blocks;    /* dla ADPCM/Speex (opcjonalnie) */
-    uint32_t crc32;           /* CRC całego payloadu danych (0 = brak) */
+    uint32_t crc32;           /* CRC całego payloadu danych (vc_crc32.h; 0 = brak) */
     uint32_t flags;           /* bity opcji (np. indeks obecny) */
-    /* ... (opcjonalnie) rozszerzenia lub indeks bloków */
+    /* --- v2 (header_bytes >= sizeof(vc_vcmd_header_t)) --- */
+    uint32_t data_bytes;      /* rozmiar payloadu; 0 = do końca pliku (nagranie nie zamknięte) */
+    uint16_t frame_samples;   /* próbki ramki na kanał (0 = domyślne kodeka) */
+    uint16_t codec_opts;      /* jak vc_stream_meta_t.codec_opts */
+    uint32_t index_offset;    /* offset indeksu w pliku (VC_VCMD_FLAG_HAS_INDEX) */
+    uint32_t index_interval;  /* wpis indeksu co index_interval bloków */
+    uint32_t index_entries;   /* liczba wpisów uint32 (offset bloku względem początku danych) */
+    uint32_t switch_offset;   /* offset tablicy vc_vcmd_switch_t (VC_VCMD_FLAG_HAS_SWITCHES) */
+    uint32_t switch_count;
+    /* ... (opcjonalnie) dalsze rozszerzenia */
 } vc_vcmd_header_t;
 
+#define VC_VCMD_VERSION          0x0002u
+#define VC_VCMD_HEADER_V1_BYTES  36u      /* do pola flags włącznie */
+#define VC_VCMD_MAX_SWITCHES     64u      /* max wpisów tablicy przełączeń kodeka */
+
+/* Układ pliku VCMD: [nagłówek][payload data_bytes][indeks][tablica przełączeń].
+ * Payload VCMD (od header_bytes): ramki kodeków stałej długości jedna za drugą
+ * (vc_codec_max_bytes_per_frame), kodeki o zmiennej długości (VC_CODEC_F_VARIABLE, LPC)
+ * - każda ramka poprzedzona długością uint16 LE. */
+#define VC_VCMD_LEN_PREFIX_BYTES  2u
+
 /* ====== Flagi VCMD ====== */
 enum {
-    VC_VCMD_FLAG_HAS_INDEX = 1u << 0, /* załączony indeks bloków */
+    VC_VCMD_FLAG_HAS_INDEX    = 1u << 0, /* załączony indeks bloków */
+    VC_VCMD_FLAG_HAS_SWITCHES = 1u << 1, /* załączona tablica przełączeń kodeka (tryb adaptacyjny) */
 };
 
+/* Punkt przełączenia kodeka (tryb adaptacyjny): od ramki frame_idx, zaczynającej
+ * się byte_offset bajtów od początku danych, obowiązuje codec_id + codec_opts. */
+typedef struct VC_PACKED {
+    uint32_t frame_idx;
+    uint32_t byte_offset;
+    uint16_t codec_id;        /* vc_codec_id_t */
+    uint16_t codec_opts;      /* jak vc_stream_meta_t.codec_opts */
+} vc_vcmd_switch_t;
+
+/* ====== Manifest nagrania segmentowanego (lekki, little-endian) ====== */
+/* Katalog nagrania: segmenty S000.WAV / S000.VCM, ... (każdy samodzielny plik) + MANIFEST.BIN:
+ * [vc_manifest_header_t][vc_manifest_entry_t x entry_count]. Wpis dopisywany po zamknięciu
+ * segmentu, entry_count poprawiany razem z nim. */
+#define VC_MANIFEST_MAGIC    0x56435347u /* 'V''C''S''G' */
+#define VC_MANIFEST_VERSION  0x0001u
+typedef struct VC_PACKED {
+    uint32_t magic;           /* VC_MANIFEST_MAGIC */
+    uint16_t version;
+    uint16_t header_bytes;    /* offset pierwszego wpisu */
+    uint16_t entry_bytes;     /* rozmiar wpisu (dla rozszerzeń) */
+    uint16_t container;       /* 0 = WAV, 1 = VCMD */
+    uint32_t codec_id;        /* vc_codec_id_t */
+    uint32_t sample_rate_hz;
+    uint16_t channels;
+    uint16_t frame_samples;   /* próbki ramki na kanał */
+    uint32_t segment_frames;  /* docelowa długość segmentu (ostatni krótszy) */
+    uint32_t entry_count;
+} vc_manifest_header_t;
+
+typedef struct VC_PACKED {
+    uint16_t segment;         /* numer w nazwie pliku */
+    uint16_t flags;           /* VC_MANIFEST_F_* */
+    uint32_t first_frame;     /* indeks pierwszej ramki w całym nagraniu */
+    uint32_t frames;
+    uint32_t data_bytes;      /* payload segmentu (bez nagłówka) */
+    uint32_t crc32;           /* CRC payloadu (VCMD: hdr.crc32; 0 = brak) */
+} vc_manifest_entry_t;
+
+enum {
+    VC_MANIFEST_F_IO_ERROR  = 1u << 0, /* błąd zapisu/zamknięcia segmentu - plik do weryfikacji */
+    VC_MANIFEST_F_LAST      = 1u << 1, /* ostatni segment nagrania */
+    VC_MANIFEST_F_RECOVERED = 1u << 2, /* wpis odtworzony po zaniku zasilania (vc_seg_recover) */
+};
+
+/* ====== Indeks nagrań na nośniku (lekki, little-endian) ====== */
+/* RECINDEX.BIN: [vc_index_header_t][hash[capacity] uint32][vc_index_entry_t x entry_count].
+ * Wyszukiwanie po nazwie czyta tylko tablicę skrótów (4 B na nagranie) i pasujący wpis.
+ * Skrót 0 = wpis usunięty. */
+#define VC_INDEX_MAGIC    0x56434958u /* 'V''C''I''X' */
+#define VC_INDEX_VERSION  0x0001u
+typedef struct VC_PACKED {
+    uint32_t magic;           /* VC_INDEX_MAGIC */
+    uint16_t version;
+    uint16_t header_bytes;
+    uint16_t entry_bytes;
+    uint16_t reserved0;
+    uint32_t capacity;        /* sloty tablicy skrótów */
+    uint32_t hash_offset;     /* offset tablicy skrótów */
+    uint32_t entry_offset;    /* offset pierwszego wpisu */
+    uint32_t entry_count;     /* wpisy (także usunięte) */
+} vc_index_header_t;
+
+typedef struct VC_PACKED {
+    uint32_t name_hash;       /* FNV-1a nazwy (0 -> 1); 0 = wpis usunięty */
+    char     name[VC_MAX_PATH]; /* ścieżka względem katalogu głównego, z '\0' */
+    uint32_t duration_ms;
+    uint32_t codec_id;        /* vc_codec_id_t */
+    uint32_t sample_rate_hz;
+    uint16_t channels;
+    uint16_t container;       /* 0 = WAV, 1 = VCMD */
+    uint32_t data_offset;     /* offset payloadu w pliku */
+    uint32_t data_bytes;
+    uint32_t speech_ms;       /* VAD: czas mowy (0 = bez analizy) */
+    uint16_t speech_segments; /* VAD: liczba odcinków mowy */
+    uint16_t flags;           /* zarezerwowane */
+} vc_index_entry_t;
+
 /* ====== Minimalny kontrakt kolejek SPSC ====== */
 typedef struct {
     volatile uint32_t write_idx; /* producent */
@@ -163,7 +268,7 @@ A -> B (nagrywanie):
 
 B -> C (nagrywanie):
  - PCM:   vc_stream_meta_t{PCM16} + vc_stream_chunk_t (640 B/ramkę)
- - G.711: vc_stream_meta_t{G711U} + vc_g711_frame_t   (320 B/ramkę)
+ - G.711: vc_stream_meta_t{G711U/G711A} + vc_g711_frame_t   (320 B/ramkę)
  - ADPCM: vc_stream_meta_t{IMA_ADPCM, samples_per_block=256, block_align=vc_ima_block_bytes_mono(256)}
           + vc_ima_adpcm_block_t (kolejne bloki ADPCM)
 
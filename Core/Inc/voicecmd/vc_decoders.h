@@ -11,6 +11,7 @@ extern "C" {
 #include "arm_math.h"
 #include "voicecmd/vc_encoders.h"
 #include "g722_decoder.h"
+#include "voicecmd/vc_plc.h"
 
 
 /* Dekoder jednego bloku IMA (MS-IMA, mono, low-nibble-first).
@@ -22,13 +23,37 @@ uint16_t vc_ima_decode_block_mono(const uint8_t *block,
                                   uint16_t spb,
                                   int16_t *out_pcm);
 
-void decompress_data(vc_pcm_meta_t *frm, int16_t *samples, vc_enc_cfg_t *cfg);
+/* Blok wielokanałowy MS-IMA -> PCM przeplatane; channels == 1 -> vc_ima_decode_block_mono. */
+uint16_t vc_ima_decode_block(const uint8_t *block,
+                             uint16_t spb,
+                             uint16_t channels,
+                             int16_t *out_pcm);
+
+/* Wiele bloków naraz; offsets [n_blocks + 1] lub NULL (bloki stałej długości jeden za drugim). */
+uint32_t vc_ima_decode_blocks_mono(const uint8_t *in,
+                                   uint16_t spb,
+                                   uint16_t n_blocks,
+                                   const uint32_t *offsets,
+                                   int16_t *out_pcm);
+
+uint16_t decompress_data(struct vc_codec *codec, vc_pcm_meta_t *frm, const uint8_t *in, uint16_t in_len,
+                         int16_t *samples);
+/* Dekodowanie z ukrywaniem strat: jeśli frame_ok == false (np. zły CRC bloku),
+ * in == NULL, długość nie zgadza się z kodekiem albo dekoder zgłosi błąd, ramka jest
+ * syntetyzowana przez PLC. Pierwsza dobra ramka po stracie jest przenikana z sygnału
+ * zastępczego. Zawsze zwraca frm->len_samples
+ * (0 tylko przy błędnych parametrach). */
+uint16_t decompress_data_plc(struct vc_codec *codec, vc_plc_t *plc, vc_pcm_meta_t *frm,
+                             const uint8_t *in, uint16_t in_len, bool frame_ok, int16_t *samples);
+uint32_t decompress_frames(struct vc_codec *codec, vc_pcm_meta_t *frm, const uint8_t *in,
+                           const uint32_t *offsets, uint16_t n_frames, int16_t *samples);
 
 static G722_DEC_CTX *dec = NULL;
 
 void g722_init_64k_dec(void);
 void g722_deinit_dec(void);
 int g722_decode_20ms_64k(const uint8_t *in160, int16_t *pcm320_out);
+int g722_decode_frames_64k(const uint8_t *in, uint16_t n_frames, int16_t *pcm_out);
 
 #ifdef __cplusplus
 } /* extern "C" */
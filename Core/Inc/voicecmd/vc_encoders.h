@@ -9,17 +9,36 @@ extern "C" {
 #include "voicecmd/vc_data_if.h"
 #include "arm_math.h"
 #include "g722_encoder.h"
+#include "voicecmd/vc_g711.h"
+#include "voicecmd/vc_lpc.h"
 
 #define VC_MAX_FRAME_SAMPLES      320
 #define VC_PCM16_BYTES_PER_FRAME  (VC_MAX_FRAME_SAMPLES * 2)
 /* dla IMA-ADPCM mono: 4B nagłówka + ceil((N-1)/2) = 4 + 160 = 164 */
 #define VC_IMA_MONO_BYTES_PER_FRAME 164
 #define VC_G722_BYTES_PER_FRAME 160
+/* opóźnienie filtrów QMF koder+dekoder G.722 (próbki 16 kHz) */
+#define VC_G722_DELAY_SAMPLES   22
+/* compress_frames(): tyle ramek konwertuje float->int16 na raz (bufor statyczny) */
+#define VC_BATCH_MAX_FRAMES     8
 
 
+/* Przeszukiwanie w przód dla IMA (vc_ima_encode_block_mono_search). */
+#define VC_IMA_SEARCH_MAX_DEPTH 4
+
+typedef struct {
+    uint8_t  depth;         /* próbki w przód: 1 = najbliższy kod, 2..3 typowo, host do VC_IMA_SEARCH_MAX_DEPTH */
+    uint8_t  branch;        /* kandydaci (najbliższe kody) na poziom: 1..16 */
+    uint32_t node_budget;   /* max węzłów na blok (0 = bez limitu); potem zachłannie */
+} vc_ima_search_t;
+
 typedef struct {
-    vc_codec_id_t codec;          /* VC_CODEC_PCM16 / VC_CODEC_IMA_ADPCM / (opcjonalnie VC_CODEC_G711U) */
+    vc_codec_id_t codec;          /* VC_CODEC_PCM16 / VC_CODEC_IMA_ADPCM / VC_CODEC_G711U / VC_CODEC_G711A / VC_CODEC_G722 / VC_CODEC_LPC_RICE */
     uint16_t      samples_per_block; /* dla IMA-ADPCM: zwykle = 320 (Twoja ramka) ; 0 dla PCM/G.711 */
+    uint32_t      bitrate_bps;    /* G.722: 64000 / 56000 / 48000; 0 = 64000 */
+    uint8_t       packed;         /* G.722 56/48k: 1 = słowa upakowane bitowo (G722_PACKED), 0 = bajt na słowo */
+    uint16_t      channels;       /* 0/1 = mono, 2 = stereo (PCM przeplatany); LPC tylko mono */
+    vc_ima_search_t ima_search;   /* IMA: depth <= 1 -> standardowy koder zachłanny */
 } vc_enc_cfg_t;
 
 typedef struct {
@@ -27,11 +46,20 @@ typedef struct {
     uint8_t index;      /* 0..88 */
 } vc_ima_state_t;
 
-void compress_data(vc_pcm_meta_t *frm, float32_t *samples, vc_enc_cfg_t *cfg);
+struct vc_codec; /* voicecmd/vc_codec.h */
+
+uint16_t compress_data(struct vc_codec *codec, vc_pcm_meta_t *frm, float32_t *samples, uint8_t *out);
+uint32_t compress_frames(struct vc_codec *codec, vc_pcm_meta_t *frm, const float32_t *samples, uint16_t n_frames,
+                         uint8_t *out, uint32_t out_cap, uint32_t *offsets);
 
 void vc_meta_ima_adpcm_make(vc_stream_meta_t *m);
+void vc_meta_g722_make(vc_stream_meta_t *m);
+void vc_meta_g722_mode_make(vc_stream_meta_t *m, uint32_t bitrate_bps, uint8_t packed, uint16_t frame_samples);
+uint8_t  vc_g722_bits_per_code(uint32_t bitrate_bps);
+uint16_t vc_g722_frame_bytes(uint32_t bitrate_bps, uint8_t packed, uint16_t frame_samples);
 
 uint16_t vc_ima_block_bytes_mono(uint16_t spb);
+uint16_t vc_ima_block_bytes(uint16_t spb, uint16_t channels);
 void vc_meta_pcm16_make(vc_stream_meta_t *m);
 
 /* ========== Tabele IMA ========== */
@@ -54,6 +82,29 @@ uint16_t vc_ima_encode_block_mono(int16_t *pcm,
                                                uint8_t *out_block,
                                                vc_ima_state_t *st /* może być NULL – wtedy lokalny reset */);
 
+/* Blok wielokanałowy MS-IMA (przeplatane pcm, st[channels]); channels == 1 -> blok mono. */
+uint16_t vc_ima_encode_block(const int16_t *pcm,
+                             uint16_t spb,
+                             uint16_t channels,
+                             uint8_t *out_block,
+                             vc_ima_state_t *st,
+                             const vc_ima_search_t *search);
+
+uint16_t vc_ima_encode_block_mono_search(const int16_t *pcm,
+                                         uint16_t spb,
+                                         uint8_t *out_block,
+                                         vc_ima_state_t *st,
+                                         const vc_ima_search_t *search);
+
+/* n_blocks kolejnych bloków naraz; offsets (opcjonalnie) [n_blocks + 1]. Zwraca sumę bajtów, 0 przy błędzie. */
+uint32_t vc_ima_encode_blocks_mono(const int16_t *pcm,
+                                   uint16_t spb,
+                                   uint16_t n_blocks,
+                                   uint8_t *out,
+                                   uint32_t out_cap,
+                                   uint32_t *offsets,
+                                   vc_ima_state_t *st);
+
 
 
 static G722_ENC_CTX *enc = NULL;
@@ -63,6 +114,7 @@ void g722_init_64k_enc(void);
 void g722_deinit_enc(void);
 
 int g722_encode_20ms_64k(const int16_t *pcm320, uint8_t *out160);
+int g722_encode_frames_64k(const int16_t *pcm, uint16_t n_frames, uint8_t *out, uint32_t *offsets);
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -0,0 +1,36 @@
+#ifndef VC_G711_H
+#define VC_G711_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "voicecmd/vc_data_if.h"
+
+/* G.711: 1 bajt na próbkę -> 320 B / ramka 20 ms @16 kHz (2:1 względem PCM16) */
+#define VC_G711_BYTES_PER_FRAME 320
+
+/* Tablice dekodera (256 wpisów, wartości w skali PCM16) */
+extern const int16_t VC_G711U_DECODE_TABLE[256];
+extern const int16_t VC_G711A_DECODE_TABLE[256];
+
+/* Kodowanie blokowe PCM16 -> G.711 (µ-law / A-law).
+ * Segment wyznaczany instrukcją CLZ, bez pętli wyszukiwania.
+ * Zwraca liczbę zapisanych bajtów (= n). */
+uint16_t vc_g711u_encode(const int16_t *pcm, uint16_t n, uint8_t *out);
+uint16_t vc_g711a_encode(const int16_t *pcm, uint16_t n, uint8_t *out);
+
+/* Dekodowanie blokowe G.711 -> PCM16 (lookup w tablicy 256 wpisów).
+ * Zwraca liczbę wypisanych próbek (= n). */
+uint16_t vc_g711u_decode(const uint8_t *in, uint16_t n, int16_t *pcm);
+uint16_t vc_g711a_decode(const uint8_t *in, uint16_t n, int16_t *pcm);
+
+/* Metadane strumienia G.711 (codec = VC_CODEC_G711U lub VC_CODEC_G711A). */
+void vc_meta_g711_make(vc_stream_meta_t *m, vc_codec_id_t codec);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* VC_G711_H */
@@ -0,0 +1,51 @@
+#ifndef VC_LPC_H
+#define VC_LPC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "voicecmd/vc_data_if.h"
+
+/*
+ * Bezstratny kodek LPC + Rice (w stylu FLAC) dla ramek PCM16 mono.
+ *
+ * Każda ramka (zwykle 320 próbek) jest kodowana niezależnie:
+ *  - predyktor stały rzędu 0..3 albo LPC rzędu 4/8/12
+ *    (autokorelacja arm_dot_prod_f32 + arm_levinson_durbin_f32,
+ *     współczynniki kwantowane do int16 z przesunięciem 'shift'),
+ *  - residuum w 4 partycjach, każda z własnym parametrem Rice'a,
+ *  - gdy kodowanie nic nie daje, ramka idzie "verbatim" (PCM16 LE).
+ *
+ * Format ramki (bity MSB-first, ramka wyrównana do bajtu):
+ *   [2b typ][6b rząd]
+ *   LPC:    [4b shift][4b 0] + rząd * [16b współczynnik]
+ *   stały/LPC: rząd * [16b próbka rozbiegowa]
+ *   partycje: [5b k] + Rice(zigzag(r)); k = 31 -> [5b w] + surowe w-bit zigzag
+ *   verbatim: n * int16 LE
+ *
+ * Rozmiar ramki jest zmienny, więc kodek pasuje tylko do kontenera VCMD.
+ */
+
+#define VC_LPC_MAX_ORDER           12
+#define VC_LPC_PARTITIONS          4
+/* najgorszy przypadek = verbatim: 1 B nagłówka + 2 B na próbkę */
+#define VC_LPC_MAX_BYTES_PER_FRAME (1 + 2 * 320)
+
+/* Koduje jedną ramkę. out musi mieć >= 1 + 2*n bajtów.
+ * Zwraca liczbę zapisanych bajtów (0 przy błędzie parametrów). */
+uint16_t vc_lpc_encode_frame(const int16_t *pcm, uint16_t n, uint8_t *out);
+
+/* Dekoduje jedną ramkę o długości in_len bajtów do n próbek.
+ * Zwraca n lub 0, gdy dane są uszkodzone (np. wyjście poza in_len). */
+uint16_t vc_lpc_decode_frame(const uint8_t *in, uint16_t in_len, uint16_t n, int16_t *pcm);
+
+/* Metadane strumienia (block_align = 0 -> bloki o zmiennej długości). */
+void vc_meta_lpc_make(vc_stream_meta_t *m);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* VC_LPC_H */
@@ -0,0 +1,54 @@
+#ifndef VC_PLC_H
+#define VC_PLC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "voicecmd/vc_data_if.h"
+
+/*
+ * Ukrywanie utraconych ramek (PLC) po stronie dekodera, w duchu ITU-T G.711 App. I:
+ *  - przy pierwszej złej ramce estymacja okresu tonu z historii wyjścia (autokorelacja),
+ *  - powtarzanie ostatniego okresu (z wygładzonym szwem), pełna głośność przez 10 ms,
+ *    potem wygaszanie 20% / 10 ms -> cisza po 60 ms,
+ *  - na pierwszej dobrej ramce przenikanie (VC_PLC_RECOVER_SAMPLES) z sygnału zastępczego.
+ * Działa na wyjściu PCM16, więc jest wspólne dla wszystkich kodeków.
+ */
+
+#define VC_PLC_HIST_SAMPLES     (2u * VC_FRAME_SAMPLES) /* historia wyjścia: 40 ms */
+#define VC_PLC_PITCH_MIN        40u                     /* 400 Hz @16 kHz */
+#define VC_PLC_PITCH_MAX        280u                    /* ~57 Hz @16 kHz */
+#define VC_PLC_CORR_WINDOW      160u                    /* okno korelacji: 10 ms */
+#define VC_PLC_OLA_MAX          64u                     /* max długość wygładzenia szwu (1/4 okresu) */
+#define VC_PLC_RECOVER_SAMPLES  80u                     /* przenikanie po powrocie: 5 ms */
+#define VC_PLC_HOLD_SAMPLES     160u                    /* pełna głośność: 10 ms */
+#define VC_PLC_FADE_SAMPLES     800u                    /* wygaszanie do zera: 50 ms */
+
+typedef struct {
+    int16_t  hist[VC_PLC_HIST_SAMPLES];  /* ostatnie próbki wyjścia (dobre lub zastępcze) */
+    int16_t  period[VC_PLC_PITCH_MAX];   /* okres powtarzany w trakcie utraty */
+    uint16_t pitch;                      /* długość okresu [próbki] */
+    uint16_t phase;                      /* pozycja w period */
+    uint32_t lost_samples;               /* próbki ukryte w bieżącej serii (0 = brak utraty) */
+    uint32_t concealed_frames;           /* statystyka: wszystkie ukryte ramki */
+} vc_plc_t;
+
+void vc_plc_init(vc_plc_t *p);
+
+/* Wypełnia pcm[n] sygnałem zastępczym (ramka utracona/uszkodzona). */
+void vc_plc_conceal(vc_plc_t *p, int16_t *pcm, uint16_t n);
+
+/* Poprawnie zdekodowana ramka: po utracie przenika jej początek z sygnału
+ * zastępczego (modyfikuje pcm), następnie dopisuje ją do historii. */
+void vc_plc_good(vc_plc_t *p, int16_t *pcm, uint16_t n);
+
+/* Okres tonu w hist[VC_PLC_HIST_SAMPLES] (VC_PLC_PITCH_MIN..MAX). */
+uint16_t vc_plc_estimate_pitch(const int16_t *hist);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* VC_PLC_H */
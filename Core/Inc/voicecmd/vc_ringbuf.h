@@ -0,0 +1,51 @@
+#ifndef VC_RINGBUF_H
+#define VC_RINGBUF_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "voicecmd/vc_data_if.h"
+
+/*
+ * Kolejka SPSC wskaźników (vc_spsc_fifo_t) bez blokad: jeden producent i jeden konsument,
+ * każdy może działać w przerwaniu (np. DMA I2S -> pętla główna). Producent zmienia tylko
+ * write_idx, konsument tylko read_idx; indeksy rosną modulo 2^32, slot = idx & (capacity - 1),
+ * więc capacity musi być potęgą 2 i cała tablica jest używana (bez pustego slotu).
+ *
+ * Publikacja: sloty zapisane -> bariera (__DMB) -> nowy write_idx; zwolnienie: sloty
+ * odczytane -> bariera -> nowy read_idx. Druga strona czyta indeks przed barierą, a sloty
+ * po niej. Na hoście (VC_HOST_BUILD) bariera to __sync_synchronize - testy z wątkami.
+ *
+ * Operacje wsadowe przenoszą do n slotów jednym przesunięciem indeksu (jedna bariera).
+ * Span: ciągły fragment tablicy slotów (do końca tablicy) do wypełnienia / odczytu bez
+ * kopiowania, np. jako lista deskryptorów dla DMA; potem commit / release n slotów.
+ */
+
+/* capacity: potęga 2 (>= 2). VC_E_PARAM: inna pojemność albo brak tablicy. */
+vc_status_t vc_spsc_init(vc_spsc_fifo_t *q, void **slots, uint32_t capacity);
+void        vc_spsc_reset(vc_spsc_fifo_t *q);   /* obie strony zatrzymane */
+
+uint32_t    vc_spsc_count(const vc_spsc_fifo_t *q);   /* zajęte (dokładne dla konsumenta) */
+uint32_t    vc_spsc_space(const vc_spsc_fifo_t *q);   /* wolne (dokładne dla producenta) */
+
+/* Producent. push: VC_E_FULL bez zmian; push_n: liczba dodanych (do wolnego miejsca). */
+vc_status_t vc_spsc_push(vc_spsc_fifo_t *q, void *item);
+uint32_t    vc_spsc_push_n(vc_spsc_fifo_t *q, void *const *items, uint32_t n);
+/* *span = pierwszy wolny slot, wynik = wolne sloty ciągiem; potem commit n <= wynik. */
+uint32_t    vc_spsc_write_span(vc_spsc_fifo_t *q, void ***span);
+void        vc_spsc_write_commit(vc_spsc_fifo_t *q, uint32_t n);
+
+/* Konsument. pop: VC_E_EMPTY bez zmian; pop_n: liczba pobranych. */
+vc_status_t vc_spsc_pop(vc_spsc_fifo_t *q, void **item);
+uint32_t    vc_spsc_pop_n(vc_spsc_fifo_t *q, void **items, uint32_t n);
+/* *span = najstarszy slot, wynik = zajęte sloty ciągiem (podgląd); potem release n <= wynik. */
+uint32_t    vc_spsc_read_span(vc_spsc_fifo_t *q, void ***span);
+void        vc_spsc_read_release(vc_spsc_fifo_t *q, uint32_t n);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* VC_RINGBUF_H */
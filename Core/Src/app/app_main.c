@@ -7,6 +7,9 @@
 #include <tests/test_conversion_320.h>
 #include <tests/test_encoders.h>
 #include "tests/test_fatfs.h"
+#include "tests/test_storage_flash.h"
+#include "tests/test_storage_bench.h"
+#include "tests/test_ringbuf.h"
 
 
 
@@ -26,6 +29,15 @@ int app_main(){
     // Test funkcji kompresji kodeków
     // run_encoders_test();
 
+    // Test nagrań w wewnętrznej pamięci flash (sektory 8-11)
+    // run_storage_flash_test();
+
+    // Benchmark pendrive: MB/s i opóźnienia f_write/f_sync/f_read/f_lseek
+    // run_storage_bench();
+
+    // Test kolejki SPSC (wsady, span, koszt push+pop)
+    // run_ringbuf_test();
+
     
     return 0;
 }
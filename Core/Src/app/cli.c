@@ -1,23 +1,143 @@
 #include "app/cli.h"
+#include "fatfs/vc_rec_index.h"
+#include "fatfs/vc_stream_reader.h"
+#include "voicecmd/vc_codec.h"
 #include <string.h>
 #include <stdio.h>
 
-#define CLI_BUFFER_SIZE 64
+#define CLI_BUFFER_SIZE (8 + VC_MAX_PATH)   // "play " + nazwa nagrania
 
 static UART_HandleTypeDef *cli_huart;
 static char cli_buffer[CLI_BUFFER_SIZE];
+static char cli_line[CLI_BUFFER_SIZE];
+static volatile uint8_t cli_line_ready = 0;
 static uint8_t cli_index = 0;
 static uint8_t rx_char;
 
+static FATFS cli_fs;
+static uint8_t cli_mounted = 0;
+static vc_stream_reader_t cli_reader;      // odtwarzane nagranie (cli_reader.is_open)
+static int16_t cli_pcm[VC_FRAME_SAMPLES * VC_MAX_CHANNELS];
+
 void CLI_Init(UART_HandleTypeDef *huart)
 {
     cli_huart = huart;
     HAL_UART_Receive_IT(cli_huart, &rx_char, 1); // start first RX interrupt
 }
 
+// Brak toru audio: ramki odtwarzania trafiają tutaj (nadpisać w aplikacji)
+__attribute__((weak)) void CLI_PlayFrame(const int16_t *pcm, uint16_t n_samples, uint16_t channels)
+{
+    (void)pcm; (void)n_samples; (void)channels;
+}
+
+static uint8_t CLI_Mount(void)
+{
+    if (!cli_mounted && f_mount(&cli_fs, "", 1) == FR_OK) cli_mounted = 1;
+    if (!cli_mounted) printf("Brak nosnika!\r\n");
+    return cli_mounted;
+}
+
+static void CLI_LsEntry(void *ctx, const vc_index_entry_t *e)
+{
+    const vc_codec_ops_t *ops = vc_codec_find((vc_codec_id_t)e->codec_id);
+    uint32_t s = e->duration_ms / 1000u;
+    (void)ctx;
+    printf("%-24s %3lu:%02lu %-10s %ux%lu Hz", e->name, (unsigned long)(s / 60u), (unsigned long)(s % 60u),
+           ops ? ops->name : "?", e->channels, (unsigned long)e->sample_rate_hz);
+    if (e->speech_segments)
+        printf("  mowa %lu ms / %u", (unsigned long)e->speech_ms, e->speech_segments);
+    printf("\r\n");
+}
+
+// Bez indeksu (nośnik zapisany poza urządzeniem): zwykła lista katalogu
+static void CLI_LsDir(const char *path)
+{
+    DIR dir;
+    FILINFO fi;
+    if (f_opendir(&dir, path) != FR_OK)
+    {
+        printf("Brak katalogu %s\r\n", path);
+        return;
+    }
+    while (f_readdir(&dir, &fi) == FR_OK && fi.fname[0])
+        printf("%s%s\r\n", fi.fname, (fi.fattrib & AM_DIR) ? "/" : "");
+    f_closedir(&dir);
+}
+
+static void CLI_Ls(const char *path)
+{
+    if (*path || vc_index_foreach(CLI_LsEntry, NULL) == VC_E_EMPTY)
+        CLI_LsDir(path);
+}
+
+static void CLI_Play(const char *name)
+{
+    vc_index_entry_t e;
+    if (cli_reader.is_open) vc_reader_close(&cli_reader);
+    // Nazwa z indeksu: bez przeglądania katalogów
+    if (vc_index_find(name, &e) != VC_OK)
+    {
+        printf("Brak nagrania %s\r\n", name);
+        return;
+    }
+    if (vc_reader_open(&cli_reader, e.name) != VC_OK)
+    {
+        printf("Blad odczytu %s\r\n", e.name);
+        return;
+    }
+    if ((uint32_t)cli_reader.dec.frame_samples * cli_reader.dec.channels
+            > sizeof(cli_pcm) / sizeof(cli_pcm[0]))
+    {
+        printf("Za dluga ramka %s\r\n", e.name);
+        vc_reader_close(&cli_reader);
+        return;
+    }
+    printf("Odtwarzanie %s (%lu ms)\r\n", e.name, (unsigned long)e.duration_ms);
+}
+
+static void CLI_Execute(char *line)
+{
+    if (strncmp(line, "cd ", 3) == 0)
+    {
+        char *folder = line + 3;
+        printf("Zmieniono folder na %s\r\n", folder);
+    }
+    else if (strcmp(line, "ls") == 0 || strncmp(line, "ls ", 3) == 0)
+    {
+        if (CLI_Mount()) CLI_Ls(line[2] ? line + 3 : "");
+    }
+    else if (strncmp(line, "play ", 5) == 0)
+    {
+        if (CLI_Mount()) CLI_Play(line + 5);
+    }
+    else if (strcmp(line, "stop") == 0)
+    {
+        if (cli_reader.is_open) vc_reader_close(&cli_reader);
+    }
+    else
+    {
+    	printf("Command unknown!\r\n");
+    }
+}
+
+// Pętla główna: polecenie z ISR i jedna ramka odtwarzania na wywołanie
 void CLI_Process(void)
 {
-    // nothing to do here in polling mode
+    if (cli_line_ready)
+    {
+        CLI_Execute(cli_line);
+        cli_line_ready = 0;
+    }
+
+    if (cli_reader.is_open)
+    {
+        uint16_t n;
+        if (vc_reader_read_frame(&cli_reader, cli_pcm, &n) == VC_OK)
+            CLI_PlayFrame(cli_pcm, n, cli_reader.meta.channels);
+        else
+            vc_reader_close(&cli_reader);
+    }
 }
 
 // ISR callback (called by HAL when RX interrupt fires)
@@ -29,17 +149,11 @@ void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
         {
             cli_buffer[cli_index] = '\0'; // end string
 
-            if (cli_index > 0)
+            // FatFs nie w przerwaniu: linia przekazywana do CLI_Process
+            if (cli_index > 0 && !cli_line_ready)
             {
-                if (strncmp(cli_buffer, "cd ", 3) == 0)
-                {
-                    char *folder = cli_buffer + 3;
-                    printf("Zmieniono folder na %s\r\n", folder);
-                }
-                else
-                {
-                	printf("Command unknown!\r\n");
-                }
+                memcpy(cli_line, cli_buffer, cli_index + 1u);
+                cli_line_ready = 1;
             }
 
             cli_index = 0; // reset buffer
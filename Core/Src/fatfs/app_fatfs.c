@@ -1,67 +1,89 @@
 #include "fatfs/app_fatfs.h"
+#include "fatfs/vc_recover.h"
+#include "fatfs/vc_rec_index.h"
+#include "fatfs/vc_segment_writer.h"
+#include "voicecmd/vc_encoders.h"
 
 
 int fatfs_init(){
     FATFS fs;
-    FIL file;
+    static vc_wav_writer_t writer;   // ~4.6 KB - poza stosem
     FRESULT res;
 
     // Zamontuj system plików na pendrive
     res = f_mount(&fs, "", 1);
     if(res != FR_OK) return -1;
 
-    // Otwórz plik WAV do zapisu
-    res = f_open(&file, "test.wav", FA_WRITE | FA_CREATE_ALWAYS);
-    if(res != FR_OK) return -1;
-
-    uint32_t sample_rate = 44100;   // 44.1 kHz
-    uint16_t bits_per_sample = 16;  // 16-bit
-    uint16_t channels = 1;          // mono
-
-    // Przykładowe dane: 1 sekunda ciszy
-    uint32_t num_samples = sample_rate * channels;
-    uint32_t data_size = num_samples * (bits_per_sample / 8);
+    // Nagrania przerwane zanikiem zasilania: przycięcie do ostatniego punktu kontrolnego
+    vc_recover_dir("", NULL);
+    // ... i segmentowane (katalogi z manifestem): segmenty i brakujące wpisy manifestu
+    DIR dir;
+    FILINFO fi;
+    if (f_opendir(&dir, "") == FR_OK) {
+        while (f_readdir(&dir, &fi) == FR_OK && fi.fname[0])
+            if (fi.fattrib & AM_DIR) vc_seg_recover(fi.fname, NULL);
+        f_closedir(&dir);
+    }
 
-    // Zapisz nagłówek WAV
-    write_wav_header(&file, sample_rate, bits_per_sample, channels, data_size);
+    // Metadane: PCM16, 16 kHz, mono
+    vc_stream_meta_t meta;
+    vc_meta_pcm16_make(&meta);
 
-    // Zapisz dane audio (cisza)
-    uint8_t sample_data[2] = {0, 0}; // 16-bit zero
-    for(uint32_t i = 0; i < num_samples; i++) {
-        f_write(&file, sample_data, sizeof(sample_data), NULL);
+    // Otwórz plik WAV do zapisu (nagłówek rezerwowany w buforze writera)
+    if (vc_wav_writer_open(&writer, "test.wav", &meta) != VC_OK) {
+        f_mount(NULL, "", 1);
+        return -1;
+    }
+    // Ciągły obszar na całe nagranie (brak miejsca: zapis bez rezerwacji)
+    vc_wav_writer_reserve_ms(&writer, 1000);
+    // Punkt kontrolny (nagłówek + f_sync) co 250 ms nagrania
+    vc_wav_writer_set_checkpoint(&writer, 250);
+
+    // Przykładowe dane: 1 sekunda ciszy, ramkami po 20 ms
+    static const uint8_t silence[VC_FRAME_SAMPLES * 2] = { 0 };
+    uint32_t num_frames = meta.sample_rate_hz / VC_FRAME_SAMPLES;
+    int ret = 0;
+    for (uint32_t i = 0; i < num_frames; i++) {
+        if (vc_wav_writer_write(&writer, silence, sizeof(silence)) != VC_OK) { ret = -1; break; }
     }
 
-    // Zamknij plik
-    f_close(&file);
+    // Zamknij plik (poprawia rozmiary w nagłówku) i dopisz go do indeksu nagrań;
+    // nieudany zapis lub zamknięcie - bez wpisu w indeksie
+    if (vc_wav_writer_close(&writer) != VC_OK) ret = -1;
+    if (ret == 0) {
+        vc_index_entry_t entry;
+        vc_index_entry_wav(&entry, "test.wav", &writer, NULL);
+        vc_index_put(&entry);
+    }
 
     // Odmontuj pendrive
     f_mount(NULL, "", 1);
 
-    return 0;
+    return ret;
 }
 
-void write_wav_header(FIL *file, uint32_t sample_rate, uint16_t bits_per_sample, uint16_t channels, uint32_t data_size) {
-    uint32_t chunk_size = 36 + data_size;
-    uint16_t block_align = channels * bits_per_sample / 8;
-    uint32_t byte_rate = sample_rate * block_align;
-
-    f_lseek(file, 0);
-
-    f_write(file, "RIFF", 4, NULL);
-    f_write(file, &chunk_size, 4, NULL);
-    f_write(file, "WAVE", 4, NULL);
-    f_write(file, "fmt ", 4, NULL);
+vc_status_t write_wav_header(FIL *file, uint32_t sample_rate, uint16_t bits_per_sample, uint16_t channels, uint32_t data_size) {
+    vc_stream_meta_t m = {
+        .codec_id          = VC_CODEC_PCM16,
+        .sample_rate_hz    = sample_rate,
+        .channels          = channels,
+        .bits_per_sample   = bits_per_sample,
+        .block_align       = (uint16_t)(channels * bits_per_sample / 8),
+        .avg_bytes_per_sec = sample_rate * (uint32_t)(channels * bits_per_sample / 8),
+        .samples_per_block = 0,
+        .codec_opts        = 0,
+    };
+    return write_wav_header_meta(file, &m, data_size);
+}
 
-    uint32_t subchunk1_size = 16;
-    uint16_t audio_format = 1; // PCM
-    f_write(file, &subchunk1_size, 4, NULL);
-    f_write(file, &audio_format, 2, NULL);
-    f_write(file, &channels, 2, NULL);
-    f_write(file, &sample_rate, 4, NULL);
-    f_write(file, &byte_rate, 4, NULL);
-    f_write(file, &block_align, 2, NULL);
-    f_write(file, &bits_per_sample, 2, NULL);
+vc_status_t write_wav_header_meta(FIL *file, const vc_stream_meta_t *m, uint32_t data_size) {
+    // Cały nagłówek (fmt zależny od kodeka, patrz vc_wav_build_header) jednym f_write.
+    uint8_t header[VC_WAV_HEADER_MAX_BYTES];
+    uint16_t len = vc_wav_build_header(m, data_size, header);
+    if (len == 0) return VC_E_PARAM;
 
-    f_write(file, "data", 4, NULL);
-    f_write(file, &data_size, 4, NULL);
+    UINT bw = 0;   // FatFs zapisuje *bw bez sprawdzania NULL
+    if (f_lseek(file, 0) != FR_OK) return VC_E_IO;
+    if (f_write(file, header, len, &bw) != FR_OK || bw != len) return VC_E_IO;
+    return VC_OK;
 }
@@ -0,0 +1,239 @@
+#include "fatfs/vc_rec_index.h"
+#include <string.h>
+
+#define VC_INDEX_HASH_BATCH   (512u / sizeof(uint32_t))   /* skróty na jeden f_read */
+#define VC_INDEX_ENTRY_BATCH  5u                          /* wpisy na jeden f_read (foreach) */
+
+static uint32_t         s_ix_hashes[VC_INDEX_HASH_BATCH];
+static vc_index_entry_t s_ix_entries[VC_INDEX_ENTRY_BATCH];
+
+uint32_t vc_index_hash(const char *name)
+{
+    uint32_t h = 2166136261u;
+    while (*name) {
+        h ^= (uint8_t)*name++;
+        h *= 16777619u;
+    }
+    return h ? h : 1u;
+}
+
+static void vc_index_entry_init(vc_index_entry_t *e, const char *name, const vc_index_vad_t *vad)
+{
+    memset(e, 0, sizeof(*e));
+    strncpy(e->name, name, sizeof(e->name) - 1u);
+    if (vad) {
+        e->speech_ms       = vad->speech_ms;
+        e->speech_segments = vad->speech_segments;
+    }
+}
+
+void vc_index_entry_wav(vc_index_entry_t *e, const char *name, const vc_wav_writer_t *w,
+                        const vc_index_vad_t *vad)
+{
+    if (!e || !name || !w) return;
+    vc_index_entry_init(e, name, vad);
+
+    const vc_stream_meta_t *m = &w->meta;
+    uint32_t spb = m->samples_per_block ? m->samples_per_block : 1u;
+    uint64_t samples = m->block_align ? (uint64_t)(w->data_bytes / m->block_align) * spb : 0u;
+    e->duration_ms    = m->sample_rate_hz ? (uint32_t)(samples * 1000u / m->sample_rate_hz) : 0u;
+    e->codec_id       = m->codec_id;
+    e->sample_rate_hz = m->sample_rate_hz;
+    e->channels       = m->channels;
+    e->container      = 0;
+    e->data_offset    = w->header_bytes;
+    e->data_bytes     = w->data_bytes;
+}
+
+void vc_index_entry_vcmd(vc_index_entry_t *e, const char *name, const vc_vcmd_writer_t *w,
+                         const vc_index_vad_t *vad)
+{
+    if (!e || !name || !w) return;
+    vc_index_entry_init(e, name, vad);
+
+    const vc_vcmd_header_t *h = &w->hdr;
+    e->duration_ms    = h->sample_rate_hz ? (uint32_t)((uint64_t)h->total_samples * 1000u / h->sample_rate_hz) : 0u;
+    e->codec_id       = h->codec_id;
+    e->sample_rate_hz = h->sample_rate_hz;
+    e->channels       = h->channels;
+    e->container      = 1;
+    e->data_offset    = h->header_bytes;
+    e->data_bytes     = h->data_bytes;
+}
+
+static vc_status_t vc_index_rw(FIL *f, uint32_t off, void *buf, UINT len, uint8_t write)
+{
+    UINT n = 0;
+    if (f_lseek(f, off) != FR_OK) return VC_E_IO;
+    FRESULT fr = write ? f_write(f, buf, len, &n) : f_read(f, buf, len, &n);
+    return (fr == FR_OK && n == len) ? VC_OK : VC_E_IO;
+}
+
+/* Nowy indeks: nagłówek i wyzerowana tablica skrótów (FatFs nie zeruje klastrów). */
+static vc_status_t vc_index_create(FIL *f, vc_index_header_t *h)
+{
+    memset(h, 0, sizeof(*h));
+    h->magic        = VC_INDEX_MAGIC;
+    h->version      = VC_INDEX_VERSION;
+    h->header_bytes = sizeof(vc_index_header_t);
+    h->entry_bytes  = sizeof(vc_index_entry_t);
+    h->capacity     = VC_INDEX_CAPACITY;
+    h->hash_offset  = sizeof(vc_index_header_t);
+    h->entry_offset = h->hash_offset + VC_INDEX_CAPACITY * sizeof(uint32_t);
+
+    if (vc_index_rw(f, 0, h, sizeof(*h), 1) != VC_OK) return VC_E_IO;
+    memset(s_ix_hashes, 0, sizeof(s_ix_hashes));
+    for (uint32_t i = 0; i < VC_INDEX_CAPACITY; i += VC_INDEX_HASH_BATCH) {
+        UINT n = 0;
+        if (f_write(f, s_ix_hashes, sizeof(s_ix_hashes), &n) != FR_OK || n != sizeof(s_ix_hashes)) return VC_E_IO;
+    }
+    return VC_OK;
+}
+
+enum { VC_INDEX_RO = 0, VC_INDEX_RW = 1, VC_INDEX_RW_CREATE = 2 };
+
+/* Otwiera indeks i czyta nagłówek (VC_INDEX_RW_CREATE: brak pliku - nowy).
+ * VC_E_EMPTY: brak pliku. */
+static vc_status_t vc_index_open(FIL *f, vc_index_header_t *h, uint8_t mode)
+{
+    FRESULT fr = f_open(f, VC_INDEX_PATH, (mode == VC_INDEX_RO) ? FA_READ : (FA_READ | FA_WRITE | FA_OPEN_EXISTING));
+    if (fr == FR_NO_FILE && mode == VC_INDEX_RW_CREATE) {
+        if (f_open(f, VC_INDEX_PATH, FA_READ | FA_WRITE | FA_CREATE_ALWAYS) != FR_OK) return VC_E_IO;
+        vc_status_t st = vc_index_create(f, h);
+        if (st != VC_OK) f_close(f);
+        return st;
+    }
+    if (fr == FR_NO_FILE) return VC_E_EMPTY;
+    if (fr != FR_OK) return VC_E_IO;
+
+    if (vc_index_rw(f, 0, h, sizeof(*h), 0) != VC_OK || h->magic != VC_INDEX_MAGIC
+        || h->entry_bytes < sizeof(vc_index_entry_t) || h->entry_count > h->capacity) {
+        f_close(f);
+        return VC_E_PARAM;
+    }
+    return VC_OK;
+}
+
+/* Szuka name: skróty partiami po sektorze, przy zgodnym skrócie porównanie nazwy we wpisie.
+ * *slot = numer wpisu; VC_E_EMPTY: brak. */
+static vc_status_t vc_index_lookup(FIL *f, const vc_index_header_t *h, const char *name,
+                                   uint32_t *slot, vc_index_entry_t *out)
+{
+    const uint32_t hash = vc_index_hash(name);
+    for (uint32_t base = 0; base < h->entry_count; base += VC_INDEX_HASH_BATCH) {
+        uint32_t n = h->entry_count - base;
+        if (n > VC_INDEX_HASH_BATCH) n = VC_INDEX_HASH_BATCH;
+        if (vc_index_rw(f, h->hash_offset + base * sizeof(uint32_t), s_ix_hashes,
+                        n * sizeof(uint32_t), 0) != VC_OK) {
+            return VC_E_IO;
+        }
+        for (uint32_t i = 0; i < n; i++) {
+            if (s_ix_hashes[i] != hash) continue;
+            if (vc_index_rw(f, h->entry_offset + (base + i) * h->entry_bytes, out, sizeof(*out), 0) != VC_OK) {
+                return VC_E_IO;
+            }
+            if (strncmp(out->name, name, sizeof(out->name)) == 0) {
+                *slot = base + i;
+                return VC_OK;
+            }
+        }
+    }
+    return VC_E_EMPTY;
+}
+
+vc_status_t vc_index_put(vc_index_entry_t *e)
+{
+    vc_index_header_t h;
+    vc_index_entry_t old;
+    FIL f;
+    uint32_t slot;
+
+    if (!e || !e->name[0]) return VC_E_PARAM;
+    e->name[sizeof(e->name) - 1u] = '\0';
+    e->name_hash = vc_index_hash(e->name);
+
+    vc_status_t st = vc_index_open(&f, &h, VC_INDEX_RW_CREATE);
+    if (st != VC_OK) return st;
+
+    st = vc_index_lookup(&f, &h, e->name, &slot, &old);
+    if (st == VC_OK) {
+        st = vc_index_rw(&f, h.entry_offset + slot * h.entry_bytes, e, sizeof(*e), 1);
+    } else if (st == VC_E_EMPTY) {
+        /* Wpis, skrót, licznik - po zaniku zasilania w trakcie indeks pozostaje spójny. */
+        slot = h.entry_count;
+        if (slot >= h.capacity) st = VC_E_FULL;
+        else st = vc_index_rw(&f, h.entry_offset + slot * h.entry_bytes, e, sizeof(*e), 1);
+        if (st == VC_OK) st = vc_index_rw(&f, h.hash_offset + slot * sizeof(uint32_t), &e->name_hash, sizeof(uint32_t), 1);
+        if (st == VC_OK) {
+            h.entry_count++;
+            st = vc_index_rw(&f, 0, &h, sizeof(h), 1);
+        }
+    }
+    if (f_close(&f) != FR_OK && st == VC_OK) st = VC_E_IO;
+    return st;
+}
+
+vc_status_t vc_index_find(const char *name, vc_index_entry_t *out)
+{
+    vc_index_header_t h;
+    FIL f;
+    uint32_t slot;
+
+    if (!name || !out) return VC_E_PARAM;
+    vc_status_t st = vc_index_open(&f, &h, VC_INDEX_RO);
+    if (st != VC_OK) return st;
+    st = vc_index_lookup(&f, &h, name, &slot, out);
+    f_close(&f);
+    return st;
+}
+
+vc_status_t vc_index_remove(const char *name)
+{
+    static const uint32_t zero = 0;
+    vc_index_header_t h;
+    vc_index_entry_t e;
+    FIL f;
+    uint32_t slot;
+
+    if (!name) return VC_E_PARAM;
+    vc_status_t st = vc_index_open(&f, &h, VC_INDEX_RW);
+    if (st != VC_OK) return st;
+
+    st = vc_index_lookup(&f, &h, name, &slot, &e);
+    if (st == VC_OK) st = vc_index_rw(&f, h.hash_offset + slot * sizeof(uint32_t), (void *)&zero, sizeof(zero), 1);
+    if (st == VC_OK) st = vc_index_rw(&f, h.entry_offset + slot * h.entry_bytes, (void *)&zero, sizeof(zero), 1);
+    if (f_close(&f) != FR_OK && st == VC_OK) st = VC_E_IO;
+    return st;
+}
+
+vc_status_t vc_index_foreach(vc_index_visit_t fn, void *ctx)
+{
+    vc_index_header_t h;
+    FIL f;
+
+    if (!fn) return VC_E_PARAM;
+    vc_status_t st = vc_index_open(&f, &h, VC_INDEX_RO);
+    if (st != VC_OK) return st;
+
+    for (uint32_t base = 0; st == VC_OK && base < h.entry_count; base += VC_INDEX_ENTRY_BATCH) {
+        uint32_t n = h.entry_count - base;
+        if (n > VC_INDEX_ENTRY_BATCH) n = VC_INDEX_ENTRY_BATCH;
+        if (h.entry_bytes == sizeof(vc_index_entry_t)) {
+            st = vc_index_rw(&f, h.entry_offset + base * h.entry_bytes, s_ix_entries, n * sizeof(vc_index_entry_t), 0);
+        } else {
+            /* Dłuższe wpisy (nowsza wersja): tylko znana część każdego. */
+            for (uint32_t i = 0; st == VC_OK && i < n; i++) {
+                st = vc_index_rw(&f, h.entry_offset + (base + i) * h.entry_bytes, &s_ix_entries[i],
+                                 sizeof(vc_index_entry_t), 0);
+            }
+        }
+        for (uint32_t i = 0; st == VC_OK && i < n; i++) {
+            if (s_ix_entries[i].name_hash) {
+                s_ix_entries[i].name[sizeof(s_ix_entries[i].name) - 1u] = '\0';
+                fn(ctx, &s_ix_entries[i]);
+            }
+        }
+    }
+    f_close(&f);
+    return st;
+}
@@ -0,0 +1,218 @@
+#include "fatfs/vc_recover.h"
+#include "fatfs/vc_stream_reader.h"
+#include "fatfs/vc_wav_writer.h"
+#include <string.h>
+
+static vc_stream_reader_t s_recover_reader;   /* ~5 KB - poza stosem */
+static int16_t s_recover_pcm[VC_FRAME_SAMPLES * VC_MAX_CHANNELS];
+static uint8_t s_recover_sector[512];         /* pierwszy sektor pliku (szybka ścieżka) */
+
+static uint32_t vc_recover_get32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/* Nagranie zamknięte poprawnie po jednym sektorze nagłówka i rozmiarze pliku - bez czytnika
+ * (mapa klastrów, bufor 4 KiB, kodek). 0: nie wiadomo, decyduje pełna ścieżka. */
+static uint8_t vc_recover_is_closed(const char *path)
+{
+    FIL f;
+    UINT br = 0;
+    if (f_open(&f, path, FA_READ | FA_OPEN_EXISTING) != FR_OK) return 0;
+    uint32_t size = (uint32_t)f_size(&f);
+    FRESULT fr = f_read(&f, s_recover_sector, sizeof(s_recover_sector), &br);
+    f_close(&f);
+    if (fr != FR_OK) return 0;
+    const uint8_t *p = s_recover_sector;
+
+    /* VCMD: index_offset != 0 tylko po vc_vcmd_writer_close / naprawie. */
+    if (br >= sizeof(vc_vcmd_header_t) && vc_recover_get32(p) == VC_VCMD_MAGIC) {
+        vc_vcmd_header_t h;
+        memcpy(&h, p, sizeof(h));
+        return (h.header_bytes >= sizeof(h) && h.index_offset != 0u && h.index_offset <= size) ? 1u : 0u;
+    }
+
+    /* WAV: RIFF i 'data' zgodne z rozmiarem pliku, dane w pełnych blokach. */
+    if (br < 12u || memcmp(p, "RIFF", 4) != 0 || memcmp(p + 8, "WAVE", 4) != 0) return 0;
+    if (vc_recover_get32(p + 4) != size - 8u) return 0;
+    uint32_t align = 0;
+    uint8_t have_fmt = 0;
+    for (uint32_t off = 12; off + 8u <= br; ) {
+        uint32_t len = vc_recover_get32(p + off + 4);
+        if (len > size) return 0;
+        if (memcmp(p + off, "fmt ", 4) == 0 && off + 8u + 14u <= br) {
+            align = (uint32_t)p[off + 20u] | ((uint32_t)p[off + 21u] << 8);
+            have_fmt = 1;
+        } else if (memcmp(p + off, "data", 4) == 0) {
+            return (have_fmt && off + 8u + len + (len & 1u) == size && (!align || len % align == 0u)) ? 1u : 0u;
+        }
+        off += 8u + len + (len & 1u);
+    }
+    return 0;
+}
+
+/* Naprawa w miejscu: obcięcie do data_end i nowy nagłówek (WAV: bajt wyrównania po danych). */
+static vc_status_t vc_recover_rewrite(FIL *f, uint32_t data_end, uint8_t pad,
+                                      const void *header, uint16_t header_len)
+{
+    static const uint8_t zero = 0;
+    UINT bw = 0;
+    if (f_lseek(f, data_end) != FR_OK) return VC_E_IO;
+    if (pad && (f_write(f, &zero, 1, &bw) != FR_OK || bw != 1)) return VC_E_IO;
+    if (f_truncate(f) != FR_OK) return VC_E_IO;
+    if (f_lseek(f, 0) != FR_OK || f_write(f, header, header_len, &bw) != FR_OK || bw != header_len) return VC_E_IO;
+    return VC_OK;
+}
+
+/* Plan naprawy z fazy odczytu (czytnik i zapis nie mogą mieć pliku otwartego naraz, _FS_LOCK). */
+typedef struct {
+    uint32_t data_end;          /* offset końca danych po naprawie */
+    uint8_t  pad;               /* WAV: bajt wyrównania 'data' */
+    uint8_t  compare;           /* WAV: naprawa tylko przy różnicy nagłówka / rozmiaru pliku */
+    uint16_t header_len;        /* 0 = bez zmian */
+    uint8_t  header[VC_WAV_HEADER_MAX_BYTES > sizeof(vc_vcmd_header_t) ? VC_WAV_HEADER_MAX_BYTES
+                                                                        : sizeof(vc_vcmd_header_t)];
+} vc_recover_plan_t;
+
+static void vc_recover_plan_wav(vc_stream_reader_t *r, vc_recover_plan_t *p)
+{
+    uint32_t len = r->data_bytes;
+    if (r->meta.block_align) len -= len % r->meta.block_align;
+
+    /* Nagłówek innej postaci (np. dodatkowe chunki): nie nasze nagranie - bez zmian. */
+    uint16_t hb = vc_wav_build_header(&r->meta, len, p->header);
+    if (hb == 0 || hb != r->data_start) return;
+
+    p->header_len = hb;
+    p->data_end   = r->data_start + len;
+    p->pad        = (uint8_t)(len & 1u);
+    p->compare    = 1;
+}
+
+static void vc_recover_plan_vcmd(vc_stream_reader_t *r, vc_recover_plan_t *p)
+{
+    vc_vcmd_header_t h = r->hdr;
+    if (h.index_offset != 0u) return;   /* zamknięty przez vc_vcmd_writer_close */
+
+    uint32_t len, blocks;
+    if (r->len_prefixed) {
+        /* Do ostatniego bloku z poprawnym prefiksem, który się dekoduje (ostatni sektor
+         * przed awarią mógł trafić na nośnik tylko częściowo). */
+        const uint8_t decode = ((uint32_t)r->dec.frame_samples * r->dec.channels
+                                <= sizeof(s_recover_pcm) / sizeof(s_recover_pcm[0])) ? 1u : 0u;
+        const uint8_t *b;
+        uint16_t n;
+        blocks = 0;
+        len = 0;
+        for (;;) {
+            vc_status_t bst = decode ? vc_reader_read_frame(r, s_recover_pcm, &n)
+                                     : vc_reader_next_block(r, &b, &n);
+            if (bst != VC_OK) break;
+            blocks++;
+            len = r->data_pos;
+        }
+    } else {
+        blocks = r->block_bytes ? r->data_bytes / r->block_bytes : 0u;
+        len    = blocks * r->block_bytes;
+    }
+
+    h.data_bytes     = len;
+    h.total_blocks   = blocks;
+    h.total_samples  = blocks * h.frame_samples;
+    h.crc32          = 0;
+    h.flags         &= ~(uint32_t)(VC_VCMD_FLAG_HAS_INDEX | VC_VCMD_FLAG_HAS_SWITCHES);
+    h.index_offset   = h.header_bytes + len;   /* != 0: plik zamknięty */
+    h.index_interval = 0;
+    h.index_entries  = 0;
+    h.switch_offset  = h.index_offset;
+    h.switch_count   = 0;
+
+    p->header_len = (h.header_bytes < sizeof(h)) ? h.header_bytes : (uint16_t)sizeof(h);
+    memcpy(p->header, &h, p->header_len);
+    p->data_end   = h.header_bytes + len;
+}
+
+vc_status_t vc_recover_file(const char *path, uint8_t *repaired)
+{
+    uint8_t dummy;
+    if (!path) return VC_E_PARAM;
+    if (!repaired) repaired = &dummy;
+    *repaired = 0;
+    if (vc_recover_is_closed(path)) return VC_OK;
+
+    /* Parsowanie nagłówka czytnikiem (ta sama tolerancja rozmiarów co przy odtwarzaniu). */
+    vc_stream_reader_t *r = &s_recover_reader;
+    vc_status_t st = vc_reader_open(r, path);
+    if (st != VC_OK) return st;
+
+    vc_recover_plan_t plan;
+    memset(&plan, 0, sizeof(plan));
+    if (r->kind == VC_READER_WAV) vc_recover_plan_wav(r, &plan);
+    else                          vc_recover_plan_vcmd(r, &plan);
+    vc_reader_close(r);
+    if (plan.header_len == 0) return VC_OK;
+
+    FIL f;
+    if (f_open(&f, path, FA_READ | FA_WRITE | FA_OPEN_EXISTING) != FR_OK) return VC_E_IO;
+
+    if (plan.compare) {
+        uint8_t have[sizeof(plan.header)];
+        UINT br = 0;
+        if (f_read(&f, have, plan.header_len, &br) != FR_OK || br != plan.header_len) st = VC_E_IO;
+        else if (memcmp(have, plan.header, plan.header_len) == 0
+                 && (uint32_t)f_size(&f) == plan.data_end + plan.pad) {
+            f_close(&f);
+            return VC_OK;
+        }
+    }
+    if (st == VC_OK) {
+        *repaired = 1;
+        st = vc_recover_rewrite(&f, plan.data_end, plan.pad, plan.header, plan.header_len);
+    }
+    if (f_close(&f) != FR_OK && st == VC_OK) st = VC_E_IO;
+    return st;
+}
+
+/* Rozszerzenie nazwy 8.3 bez względu na wielkość liter. */
+static uint8_t vc_recover_is_recording(const char *name)
+{
+    const char *dot = strrchr(name, '.');
+    if (!dot) return 0;
+    char ext[4] = { 0 };
+    for (uint32_t i = 0; i < 3u && dot[1 + i]; i++) {
+        char c = dot[1 + i];
+        ext[i] = (c >= 'a' && c <= 'z') ? (char)(c - 'a' + 'A') : c;
+    }
+    return (strcmp(ext, "WAV") == 0 || strcmp(ext, "VCM") == 0) ? 1u : 0u;
+}
+
+vc_status_t vc_recover_dir(const char *dir, vc_recover_stats_t *stats)
+{
+    vc_recover_stats_t local;
+    DIR d;
+    FILINFO fi;
+    char path[64];
+
+    if (!dir) return VC_E_PARAM;
+    if (!stats) stats = &local;
+    memset(stats, 0, sizeof(*stats));
+    if (f_opendir(&d, dir) != FR_OK) return VC_E_IO;
+
+    size_t dl = strlen(dir);
+    while (f_readdir(&d, &fi) == FR_OK && fi.fname[0]) {
+        if ((fi.fattrib & AM_DIR) || !vc_recover_is_recording(fi.fname)) continue;
+        if (dl + 1u + strlen(fi.fname) + 1u > sizeof(path)) continue;
+
+        memcpy(path, dir, dl);
+        size_t n = dl;
+        if (dl && dir[dl - 1u] != '/') path[n++] = '/';
+        strcpy(path + n, fi.fname);
+
+        uint8_t rep = 0;
+        stats->scanned++;
+        if (vc_recover_file(path, &rep) != VC_OK) stats->failed++;
+        else if (rep) stats->repaired++;
+    }
+    f_closedir(&d);
+    return VC_OK;
+}
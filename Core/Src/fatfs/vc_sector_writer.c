@@ -0,0 +1,174 @@
+#include "fatfs/vc_sector_writer.h"
+#include <stddef.h>
+#include <string.h>
+
+static vc_status_t vc_sector_sink_write(vc_stream_sink_t *s, const void *data, uint32_t len)
+{
+    return vc_sector_writer_write((vc_sector_writer_t *)s, data, len);
+}
+
+static vc_status_t vc_sector_sink_reserve(vc_stream_sink_t *s, uint32_t bytes)
+{
+    return vc_sector_writer_reserve((vc_sector_writer_t *)s, bytes);
+}
+
+static vc_status_t vc_sector_sink_checkpoint(vc_stream_sink_t *s, const void *header, uint16_t header_len)
+{
+    return vc_sector_writer_checkpoint((vc_sector_writer_t *)s, header, header_len);
+}
+
+static vc_status_t vc_sector_sink_close(vc_stream_sink_t *s, const void *header, uint16_t header_len)
+{
+    return vc_sector_writer_close((vc_sector_writer_t *)s, header, header_len);
+}
+
+static const vc_stream_sink_ops_t vc_sector_sink_ops = {
+    .write      = vc_sector_sink_write,
+    .space      = NULL,
+    .reserve    = vc_sector_sink_reserve,
+    .checkpoint = vc_sector_sink_checkpoint,
+    .close      = vc_sector_sink_close,
+};
+
+vc_status_t vc_sector_writer_open(vc_sector_writer_t *w, const char *path)
+{
+    if (!w || !path) return VC_E_PARAM;
+
+    memset(w, 0, offsetof(vc_sector_writer_t, buf));
+    w->sink.ops = &vc_sector_sink_ops;
+    if (f_open(&w->file, path, FA_WRITE | FA_CREATE_ALWAYS) != FR_OK) return VC_E_IO;
+    w->is_open = 1;
+    return VC_OK;
+}
+
+static void vc_sector_writer_account(vc_sector_writer_t *w, uint32_t n)
+{
+    uint32_t end = w->flushed_bytes + n;
+    if (w->reserved_bytes && end > w->reserved_bytes) {
+        w->overflow_bytes += (w->flushed_bytes >= w->reserved_bytes) ? n : end - w->reserved_bytes;
+    }
+    w->flushed_bytes = end;
+    w->writes++;
+}
+
+vc_status_t vc_sector_writer_reserve(vc_sector_writer_t *w, uint32_t bytes)
+{
+    if (!w || !w->is_open || bytes == 0) return VC_E_PARAM;
+    if (w->flushed_bytes != 0 || w->reserved_bytes != 0) return VC_E_STATE;
+
+    bytes = (bytes + VC_SECTOR_BYTES - 1u) & ~(VC_SECTOR_BYTES - 1u);
+
+    /* opt = 1: klastry przydzielane od razu (łańcuch FAT zapisany teraz, nie w trakcie nagrania). */
+    FRESULT fr = f_expand(&w->file, bytes, 1);
+    if (fr == FR_DENIED) return VC_E_FULL;
+    if (fr != FR_OK) return VC_E_IO;
+    w->reserved_bytes = bytes;
+    return VC_OK;
+}
+
+/* Wysyła bufor do f_write; poza zamknięciem zawsze pełny, więc offset pliku
+ * pozostaje wyrównany do sektora. */
+static vc_status_t vc_sector_writer_flush(vc_sector_writer_t *w)
+{
+    if (w->fill == 0) return VC_OK;
+
+    UINT bw = 0;
+    if (f_write(&w->file, w->buf, w->fill, &bw) != FR_OK || bw != w->fill) return VC_E_IO;
+    vc_sector_writer_account(w, w->fill);
+    w->fill = 0;
+    return VC_OK;
+}
+
+vc_status_t vc_sector_writer_write(vc_sector_writer_t *w, const void *data, uint32_t len)
+{
+    if (!w || !w->is_open || (!data && len)) return VC_E_PARAM;
+
+    const uint8_t *src = (const uint8_t *)data;
+
+    while (len) {
+        /* Pusty bufor i co najmniej sektor danych: całe sektory prosto ze źródła. */
+        if (w->fill == 0 && len >= VC_SECTOR_BYTES) {
+            uint32_t n = len & ~(VC_SECTOR_BYTES - 1u);
+            UINT bw = 0;
+            if (f_write(&w->file, src, n, &bw) != FR_OK || bw != n) return VC_E_IO;
+            vc_sector_writer_account(w, n);
+            src += n;
+            len -= n;
+            continue;
+        }
+
+        uint32_t n = VC_SECTOR_WRITER_BYTES - w->fill;
+        if (n > len) n = len;
+        memcpy(w->buf + w->fill, src, n);
+        w->fill = (uint16_t)(w->fill + n);
+        src += n;
+        len -= n;
+
+        if (w->fill == VC_SECTOR_WRITER_BYTES) {
+            vc_status_t st = vc_sector_writer_flush(w);
+            if (st != VC_OK) return st;
+        }
+    }
+    return VC_OK;
+}
+
+vc_status_t vc_sector_writer_checkpoint(vc_sector_writer_t *w, const void *header, uint16_t header_len)
+{
+    if (!w || !w->is_open) return VC_E_PARAM;
+
+    UINT bw = 0;
+    if (header && w->flushed_bytes == 0 && header_len <= w->fill) {
+        memcpy(w->buf, header, header_len);   /* nagłówek wciąż w buforze */
+        header = NULL;
+    }
+
+    /* Niepełny bufor na nośnik, wskaźnik pliku z powrotem na jego początek. */
+    if (w->fill) {
+        if (f_write(&w->file, w->buf, w->fill, &bw) != FR_OK || bw != w->fill
+            || f_lseek(&w->file, w->flushed_bytes) != FR_OK) {
+            return VC_E_IO;
+        }
+    }
+    if (header) {
+        if (f_lseek(&w->file, 0) != FR_OK
+            || f_write(&w->file, header, header_len, &bw) != FR_OK || bw != header_len
+            || f_lseek(&w->file, w->flushed_bytes) != FR_OK) {
+            return VC_E_IO;
+        }
+    }
+    return (f_sync(&w->file) == FR_OK) ? VC_OK : VC_E_IO;
+}
+
+/* Rezerwacja: plik przycinany do zapisanych danych (wskaźnik stoi na ich końcu). */
+static vc_status_t vc_sector_writer_trim(vc_sector_writer_t *w)
+{
+    if (w->reserved_bytes == 0 || w->flushed_bytes >= w->reserved_bytes) return VC_OK;
+    return (f_truncate(&w->file) == FR_OK) ? VC_OK : VC_E_IO;
+}
+
+vc_status_t vc_sector_writer_close(vc_sector_writer_t *w, const void *header, uint16_t header_len)
+{
+    if (!w || !w->is_open) return VC_E_PARAM;
+
+    vc_status_t st;
+    if (header && w->flushed_bytes == 0 && header_len <= w->fill) {
+        /* Cały plik wciąż w buforze: nagłówek poprawiany na miejscu, jeden zapis. */
+        memcpy(w->buf, header, header_len);
+        st = vc_sector_writer_flush(w);
+        if (st == VC_OK) st = vc_sector_writer_trim(w);
+    } else {
+        st = vc_sector_writer_flush(w);
+        if (st == VC_OK) st = vc_sector_writer_trim(w);
+        if (st == VC_OK && header) {
+            UINT bw = 0;
+            if (f_lseek(&w->file, 0) != FR_OK
+                || f_write(&w->file, header, header_len, &bw) != FR_OK || bw != header_len) {
+                st = VC_E_IO;
+            }
+        }
+    }
+
+    if (f_close(&w->file) != FR_OK && st == VC_OK) st = VC_E_IO;
+    w->is_open = 0;
+    return st;
+}
@@ -0,0 +1,367 @@
+#include "fatfs/vc_segment_writer.h"
+#include "fatfs/vc_rec_index.h"
+#include "fatfs/vc_recover.h"
+#include "fatfs/vc_stream_reader.h"
+#include <string.h>
+
+static vc_stream_reader_t s_seg_reader;   /* vc_seg_recover, ~5 KB - poza stosem */
+
+/* "dir/name" do out (VC_WB_PATH_MAX). */
+static void vc_seg_path(char *out, const char *dir, const char *name)
+{
+    size_t dl = strlen(dir);
+    memcpy(out, dir, dl);
+    out[dl] = '/';
+    strcpy(out + dl + 1u, name);
+}
+
+/* Ścieżka segmentu: dir/Snnn.WAV | dir/Snnn.VCM (co najmniej 3 cyfry). */
+static void vc_seg_segment_path(const char *dir, vc_seg_container_t container, uint16_t segment, char *out)
+{
+    char name[13];
+    char digits[5];
+    uint32_t n = 0, v = segment;
+    do {
+        digits[n++] = (char)('0' + v % 10u);
+        v /= 10u;
+    } while (v || n < 3u);
+
+    uint32_t p = 0;
+    name[p++] = 'S';
+    while (n) name[p++] = digits[--n];
+    strcpy(name + p, (container == VC_SEG_WAV) ? ".WAV" : ".VCM");
+    vc_seg_path(out, dir, name);
+}
+
+/* Manifest: e == NULL - nowy plik z samym nagłówkiem, inaczej dopisanie wpisu
+ * i poprawka entry_count (kontekst zadania zapisu). */
+static vc_status_t vc_seg_manifest_write(const char *dir, vc_manifest_header_t *mh, const vc_manifest_entry_t *e)
+{
+    char path[VC_WB_PATH_MAX];
+    FIL f;
+    UINT bw = 0;
+    vc_status_t st = VC_OK;
+
+    vc_seg_path(path, dir, VC_SEG_MANIFEST_NAME);
+    if (f_open(&f, path, FA_WRITE | (e ? FA_OPEN_EXISTING : FA_CREATE_ALWAYS)) != FR_OK) return VC_E_IO;
+
+    if (e) {
+        uint32_t off = mh->header_bytes + mh->entry_count * (uint32_t)mh->entry_bytes;
+        if (f_lseek(&f, off) != FR_OK || f_write(&f, e, sizeof(*e), &bw) != FR_OK || bw != sizeof(*e)) {
+            st = VC_E_IO;
+        } else {
+            mh->entry_count++;
+        }
+    }
+    if (st == VC_OK && (f_lseek(&f, 0) != FR_OK
+                        || f_write(&f, mh, sizeof(*mh), &bw) != FR_OK || bw != sizeof(*mh))) {
+        st = VC_E_IO;
+    }
+    if (f_close(&f) != FR_OK && st == VC_OK) st = VC_E_IO;
+    return st;
+}
+
+/* Wpis zamykanego segmentu (z writera, tuż przed vc_sink_close). */
+static void vc_seg_fill_entry(const vc_seg_writer_t *s, vc_manifest_entry_t *e, uint16_t flags)
+{
+    e->segment     = s->segment;
+    e->flags       = flags;
+    e->first_frame = s->total_frames - s->seg_frames;
+    e->frames      = s->seg_frames;
+    if (s->container == VC_SEG_WAV) {
+        e->data_bytes = s->w.wav.data_bytes;
+        e->crc32      = 0;
+    } else {
+        e->data_bytes = s->w.vcmd.hdr.data_bytes;
+        e->crc32      = s->w.vcmd.hdr.crc32;
+    }
+}
+
+/* Wpis indeksu nagrań (vc_rec_index.h) dla zamkniętego segmentu; data_offset = nagłówek pliku. */
+static void vc_seg_index(const char *dir, const vc_manifest_header_t *mh, uint32_t data_offset,
+                         const vc_manifest_entry_t *m)
+{
+    char path[VC_WB_PATH_MAX];
+    vc_index_entry_t e;
+
+    vc_seg_segment_path(dir, (vc_seg_container_t)mh->container, m->segment, path);
+    memset(&e, 0, sizeof(e));
+    strncpy(e.name, path, sizeof(e.name) - 1u);
+    e.duration_ms    = mh->sample_rate_hz
+                     ? (uint32_t)((uint64_t)m->frames * mh->frame_samples * 1000u / mh->sample_rate_hz) : 0u;
+    e.codec_id       = mh->codec_id;
+    e.sample_rate_hz = mh->sample_rate_hz;
+    e.channels       = mh->channels;
+    e.container      = mh->container;
+    e.data_offset    = data_offset;
+    e.data_bytes     = m->data_bytes;
+    vc_index_put(&e);
+}
+
+static uint32_t vc_seg_data_offset(const vc_seg_writer_t *s)
+{
+    uint8_t hdr[VC_WAV_HEADER_MAX_BYTES];
+    return (s->container == VC_SEG_WAV) ? vc_wav_build_header(&s->meta, 0, hdr) : (uint32_t)sizeof(vc_vcmd_header_t);
+}
+
+/* Zadanie zapisu: stary segment zamknięty - wpis do manifestu i indeksu nagrań. */
+static void vc_seg_rotated(void *ctx, vc_status_t st)
+{
+    vc_seg_writer_t *s = (vc_seg_writer_t *)ctx;
+    if (st != VC_OK) s->pending.flags |= VC_MANIFEST_F_IO_ERROR;
+    vc_seg_manifest_write(s->dir, &s->mhdr, &s->pending);
+    vc_seg_index(s->dir, &s->mhdr, vc_seg_data_offset(s), &s->pending);
+}
+
+static vc_status_t vc_seg_sink_write(vc_stream_sink_t *k, const void *data, uint32_t len)
+{
+    return vc_wb_push(((vc_seg_writer_t *)k)->q, data, len);
+}
+
+static uint32_t vc_seg_sink_space(const vc_stream_sink_t *k)
+{
+    return vc_wb_space(((const vc_seg_writer_t *)k)->q);
+}
+
+static vc_status_t vc_seg_sink_reserve(vc_stream_sink_t *k, uint32_t bytes)
+{
+    vc_seg_writer_t *s = (vc_seg_writer_t *)k;
+    s->reserve_bytes = bytes;   /* kolejne segmenty: rezerwacja przy rotacji */
+    return vc_sink_reserve(&s->q->sink, bytes);
+}
+
+static vc_status_t vc_seg_sink_checkpoint(vc_stream_sink_t *k, const void *header, uint16_t header_len)
+{
+    return vc_wb_checkpoint(((vc_seg_writer_t *)k)->q, header, header_len);
+}
+
+static vc_status_t vc_seg_sink_close(vc_stream_sink_t *k, const void *header, uint16_t header_len)
+{
+    vc_seg_writer_t *s = (vc_seg_writer_t *)k;
+    if (s->rotating) {
+        vc_seg_fill_entry(s, &s->pending, 0);
+        return vc_wb_rotate(s->q, header, header_len, s->next_path, s->reserve_bytes);
+    }
+    return vc_wb_close(s->q, header, header_len);
+}
+
+static const vc_stream_sink_ops_t vc_seg_sink_ops = {
+    .write      = vc_seg_sink_write,
+    .space      = vc_seg_sink_space,
+    .reserve    = vc_seg_sink_reserve,
+    .checkpoint = vc_seg_sink_checkpoint,
+    .close      = vc_seg_sink_close,
+};
+
+/* Writer kolejnego segmentu na ujściu s->sink (nagłówek trafia do pierścienia). */
+static vc_status_t vc_seg_open_writer(vc_seg_writer_t *s)
+{
+    vc_status_t st;
+    if (s->container == VC_SEG_WAV) {
+        st = vc_wav_writer_open_sink(&s->w.wav, &s->sink, &s->meta);
+        if (st == VC_OK && s->ckpt_ms) vc_wav_writer_set_checkpoint(&s->w.wav, s->ckpt_ms);
+    } else {
+        st = vc_vcmd_writer_open_sink(&s->w.vcmd, &s->sink, s->codec);
+        if (st == VC_OK && s->ckpt_ms) vc_vcmd_writer_set_checkpoint(&s->w.vcmd, s->ckpt_ms);
+    }
+    return st;
+}
+
+static vc_status_t vc_seg_close_writer(vc_seg_writer_t *s)
+{
+    return (s->container == VC_SEG_WAV) ? vc_wav_writer_close(&s->w.wav) : vc_vcmd_writer_close(&s->w.vcmd);
+}
+
+vc_status_t vc_seg_open(vc_seg_writer_t *s, vc_wb_t *q, const char *dir,
+                        vc_seg_container_t container, const vc_codec_t *codec, uint32_t segment_ms)
+{
+    if (!s || !q || !dir || !codec || !codec->ops || !codec->frame_samples) return VC_E_PARAM;
+    if (strlen(dir) + 1u + 12u >= VC_WB_PATH_MAX || strlen(dir) >= VC_SEG_DIR_MAX) return VC_E_PARAM;
+
+    s->sink.ops      = &vc_seg_sink_ops;
+    s->q             = q;
+    s->container     = container;
+    s->codec         = codec;
+    vc_codec_meta(codec, &s->meta);
+    if (container == VC_SEG_WAV) {
+        uint8_t hdr[VC_WAV_HEADER_MAX_BYTES];
+        if (vc_wav_build_header(&s->meta, 0, hdr) == 0) return VC_E_PARAM;   /* LPC: tylko VCMD */
+    }
+    strcpy(s->dir, dir);
+    uint64_t frames  = (uint64_t)segment_ms * s->meta.sample_rate_hz / 1000u / codec->frame_samples;
+    s->segment_frames = frames ? (uint32_t)frames : 1u;
+    s->seg_frames    = 0;
+    s->total_frames  = 0;
+    s->reserve_bytes = 0;
+    s->ckpt_ms       = 0;
+    s->segment       = 0;
+    s->rotating      = 0;
+    s->deferred      = 0;
+
+    FRESULT fr = f_mkdir(dir);
+    if (fr != FR_OK && fr != FR_EXIST) return VC_E_IO;
+
+    memset(&s->mhdr, 0, sizeof(s->mhdr));
+    s->mhdr.magic          = VC_MANIFEST_MAGIC;
+    s->mhdr.version        = VC_MANIFEST_VERSION;
+    s->mhdr.header_bytes   = sizeof(vc_manifest_header_t);
+    s->mhdr.entry_bytes    = sizeof(vc_manifest_entry_t);
+    s->mhdr.container      = (uint16_t)container;
+    s->mhdr.codec_id       = codec->cfg.codec;
+    s->mhdr.sample_rate_hz = s->meta.sample_rate_hz;
+    s->mhdr.channels       = codec->channels;
+    s->mhdr.frame_samples  = codec->frame_samples;
+    s->mhdr.segment_frames = s->segment_frames;
+    if (vc_seg_manifest_write(s->dir, &s->mhdr, NULL) != VC_OK) return VC_E_IO;
+
+    char path[VC_WB_PATH_MAX];
+    vc_seg_segment_path(s->dir, s->container, 0, path);
+    vc_status_t st = vc_wb_open(q, path);
+    if (st != VC_OK) return st;
+    vc_wb_set_rotate_hook(q, vc_seg_rotated, s);
+
+    st = vc_seg_open_writer(s);
+    if (st != VC_OK) {
+        vc_wb_close(q, NULL, 0);
+        return st;
+    }
+    /* Brak ciągłego miejsca: zapis bez rezerwacji. */
+    if (container == VC_SEG_WAV) vc_wav_writer_reserve_ms(&s->w.wav, segment_ms);
+    else                         vc_vcmd_writer_reserve_ms(&s->w.vcmd, segment_ms);
+    s->is_open = 1;
+    return VC_OK;
+}
+
+void vc_seg_set_checkpoint(vc_seg_writer_t *s, uint32_t interval_ms)
+{
+    if (!s) return;
+    s->ckpt_ms = interval_ms;
+    if (!s->is_open) return;
+    if (s->container == VC_SEG_WAV) vc_wav_writer_set_checkpoint(&s->w.wav, interval_ms);
+    else                            vc_vcmd_writer_set_checkpoint(&s->w.vcmd, interval_ms);
+}
+
+/* Granica segmentu: tylko gdy pierścień pomieści ogon (VCMD: indeks i przełączenia,
+ * WAV: bajt wyrównania), przeskok do granicy bufora i nagłówek następnego segmentu. */
+static vc_status_t vc_seg_rotate(vc_seg_writer_t *s)
+{
+    uint32_t tail = (s->container == VC_SEG_WAV) ? 1u
+                  : s->w.vcmd.index_count * sizeof(uint32_t) + s->w.vcmd.switch_count * sizeof(vc_vcmd_switch_t);
+    if (s->q->rot_pending || vc_wb_space(s->q) < tail + VC_WB_BUF_BYTES + VC_WB_CKPT_HEADER_MAX) return VC_E_AGAIN;
+
+    vc_seg_segment_path(s->dir, s->container, (uint16_t)(s->segment + 1u), s->next_path);
+    s->rotating = 1;
+    vc_status_t st = vc_seg_close_writer(s);
+    s->rotating = 0;
+    if (st != VC_OK) return st;
+
+    s->segment++;
+    s->seg_frames = 0;
+    return vc_seg_open_writer(s);
+}
+
+vc_status_t vc_seg_write_frame(vc_seg_writer_t *s, const uint8_t *frame, uint16_t len)
+{
+    if (!s || !s->is_open || !frame || len == 0) return VC_E_PARAM;
+
+    if (s->seg_frames >= s->segment_frames) {
+        vc_status_t rst = vc_seg_rotate(s);
+        if (rst == VC_E_AGAIN) s->deferred++;
+        else if (rst != VC_OK) return rst;
+    }
+
+    vc_status_t st = (s->container == VC_SEG_WAV) ? vc_wav_writer_write(&s->w.wav, frame, len)
+                                                  : vc_vcmd_writer_write_block(&s->w.vcmd, frame, len);
+    if (st == VC_OK) {
+        s->seg_frames++;
+        s->total_frames++;
+    }
+    return st;
+}
+
+vc_status_t vc_seg_close(vc_seg_writer_t *s)
+{
+    if (!s || !s->is_open) return VC_E_PARAM;
+
+    /* Wpis ostatniego segmentu osobno - pending może jeszcze czekać na zadanie zapisu. */
+    vc_manifest_entry_t last;
+    vc_seg_fill_entry(s, &last, VC_MANIFEST_F_LAST);
+
+    vc_wb_finish(s->q);
+    vc_status_t st = vc_seg_close_writer(s);   /* vc_wb_close: najpierw zaległa rotacja */
+    s->is_open = 0;
+
+    if (s->container == VC_SEG_VCMD) last.crc32 = s->w.vcmd.hdr.crc32;
+    if (st != VC_OK) last.flags |= VC_MANIFEST_F_IO_ERROR;
+    vc_status_t mst = vc_seg_manifest_write(s->dir, &s->mhdr, &last);
+    vc_seg_index(s->dir, &s->mhdr, vc_seg_data_offset(s), &last);
+    return (st != VC_OK) ? st : mst;
+}
+
+vc_status_t vc_seg_recover(const char *dir, vc_recover_stats_t *stats)
+{
+    char path[VC_WB_PATH_MAX];
+    vc_manifest_header_t mh;
+    vc_manifest_entry_t prev, e;
+    uint8_t have_prev = 0;
+    uint32_t next_frame = 0;
+    uint16_t seg = 0;
+    FIL f;
+    UINT br = 0;
+
+    if (!dir || strlen(dir) + 1u + 12u >= VC_WB_PATH_MAX) return VC_E_PARAM;
+    vc_seg_path(path, dir, VC_SEG_MANIFEST_NAME);
+    if (f_open(&f, path, FA_READ | FA_OPEN_EXISTING) != FR_OK) return VC_E_EMPTY;
+    if (f_read(&f, &mh, sizeof(mh), &br) != FR_OK || br != sizeof(mh) || mh.magic != VC_MANIFEST_MAGIC
+        || mh.entry_bytes != sizeof(e) || mh.header_bytes < sizeof(mh)) {
+        f_close(&f);
+        return VC_E_IO;
+    }
+    /* Ostatni wpis: nagranie zamknięte (F_LAST) albo punkt startu - nadpisywany razem z F_LAST. */
+    if (mh.entry_count) {
+        uint32_t off = mh.header_bytes + (mh.entry_count - 1u) * (uint32_t)mh.entry_bytes;
+        if (f_lseek(&f, off) != FR_OK || f_read(&f, &prev, sizeof(prev), &br) != FR_OK || br != sizeof(prev)) {
+            f_close(&f);
+            return VC_E_IO;
+        }
+        have_prev  = 1;
+        mh.entry_count--;
+        next_frame = prev.first_frame + prev.frames;
+        seg        = (uint16_t)(prev.segment + 1u);
+    }
+    f_close(&f);
+
+    vc_status_t st = vc_recover_dir(dir, stats);
+    if (st != VC_OK || (have_prev && (prev.flags & VC_MANIFEST_F_LAST))) return st;
+
+    /* Segmenty bez wpisu (zamknięte tuż przed awarią i ten otwarty w jej chwili) - już
+     * naprawione przez vc_recover_dir, więc nagłówek podaje ich długość. */
+    for (;; seg++) {
+        vc_seg_segment_path(dir, (vc_seg_container_t)mh.container, seg, path);
+        vc_stream_reader_t *r = &s_seg_reader;
+        if (vc_reader_open(r, path) != VC_OK) break;
+
+        memset(&e, 0, sizeof(e));
+        e.segment     = seg;
+        e.flags       = VC_MANIFEST_F_RECOVERED;
+        e.first_frame = next_frame;
+        e.data_bytes  = r->data_bytes;
+        if (r->kind == VC_READER_VCMD) {
+            e.frames = r->hdr.total_blocks;
+            e.crc32  = r->hdr.crc32;
+        } else {
+            e.frames = r->block_bytes ? (r->data_bytes + r->block_bytes - 1u) / r->block_bytes : 0u;
+        }
+        uint32_t data_offset = r->data_start;
+        vc_reader_close(r);
+
+        if (have_prev && vc_seg_manifest_write(dir, &mh, &prev) != VC_OK) return VC_E_IO;
+        vc_seg_index(dir, &mh, data_offset, &e);
+        prev       = e;
+        have_prev  = 1;
+        next_frame += e.frames;
+    }
+    if (!have_prev) return VC_OK;
+    prev.flags |= VC_MANIFEST_F_LAST;
+    return vc_seg_manifest_write(dir, &mh, &prev);
+}
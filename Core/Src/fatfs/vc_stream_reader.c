@@ -0,0 +1,435 @@
+#include "fatfs/vc_stream_reader.h"
+#include "voicecmd/vc_crc32.h"
+#include <stddef.h>
+#include <string.h>
+
+static uint16_t vc_rd_get16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | ((uint16_t)p[1] << 8));
+}
+
+static uint32_t vc_rd_get32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/* Jeden f_read wielu sektorów do obszaru za carry. Offset pliku jest zawsze
+ * wyrównany do sektora (start od wyrównanego adresu, odczyty po pełnych sektorach). */
+static vc_status_t vc_reader_read_sectors(vc_stream_reader_t *r, UINT *br)
+{
+    *br = 0;
+    return (f_read(&r->file, r->buf + VC_READER_CARRY_BYTES, VC_READER_READ_BYTES, br) == FR_OK)
+           ? VC_OK : VC_E_IO;
+}
+
+/* Skok do dowolnego offsetu: f_lseek do początku sektora i pełny odczyt. */
+static vc_status_t vc_reader_fill_at(vc_stream_reader_t *r, uint32_t file_off)
+{
+    uint32_t aligned = file_off & ~(VC_READER_SECTOR_BYTES - 1u);
+    UINT br;
+
+    if (f_lseek(&r->file, aligned) != FR_OK) return VC_E_IO;
+    if (vc_reader_read_sectors(r, &br) != VC_OK) return VC_E_IO;
+
+    r->win_file_pos = aligned;
+    r->win_start    = VC_READER_CARRY_BYTES;
+    r->win_end      = (uint16_t)(VC_READER_CARRY_BYTES + br);
+    r->pos          = (uint16_t)(VC_READER_CARRY_BYTES + (file_off - aligned));
+    return (r->pos <= r->win_end) ? VC_OK : VC_E_EMPTY;
+}
+
+static vc_status_t vc_reader_seek(vc_stream_reader_t *r, uint32_t file_off)
+{
+    uint32_t win_end_pos = r->win_file_pos + (uint32_t)(r->win_end - r->win_start);
+    if (file_off >= r->win_file_pos && file_off <= win_end_pos) {
+        r->pos = (uint16_t)(r->win_start + (file_off - r->win_file_pos));
+        return VC_OK;
+    }
+    return vc_reader_fill_at(r, file_off);
+}
+
+/* Zapewnia need ciągłych bajtów od r->pos. Niedobór: ogon okna przenoszony
+ * do carry (tuż przed sektorami), dalsze sektory czytane sekwencyjnie. */
+static vc_status_t vc_reader_ensure(vc_stream_reader_t *r, uint16_t need)
+{
+    if ((uint32_t)(r->win_end - r->pos) >= need) return VC_OK;
+
+    uint16_t tail = (uint16_t)(r->win_end - r->pos);
+    if (tail > VC_READER_CARRY_BYTES || need > VC_READER_CARRY_BYTES) return VC_E_PARAM;
+
+    uint32_t next_file_pos = r->win_file_pos + (uint32_t)(r->win_end - r->win_start);
+    memmove(r->buf + VC_READER_CARRY_BYTES - tail, r->buf + r->pos, tail);
+
+    UINT br;
+    if (vc_reader_read_sectors(r, &br) != VC_OK) return VC_E_IO;
+
+    r->win_start    = (uint16_t)(VC_READER_CARRY_BYTES - tail);
+    r->win_file_pos = next_file_pos - tail;
+    r->win_end      = (uint16_t)(VC_READER_CARRY_BYTES + br);
+    r->pos          = r->win_start;
+
+    return ((uint32_t)(r->win_end - r->pos) >= need) ? VC_OK : VC_E_EMPTY;
+}
+
+/* G.722 w WAV nie zapisuje samples_per_block - wynika z block_align:
+ * ramka = block_align / channels bajtów, bajt (bez pakowania) = 1 słowo = 2 próbki. */
+static uint16_t vc_reader_g722_spb(const vc_stream_meta_t *m)
+{
+    uint32_t bits = m->codec_opts & VC_G722_OPT_BITS_MASK;
+    if (bits == 0 || !(m->codec_opts & VC_G722_OPT_PACKED)) bits = 8u;
+    uint32_t ch = m->channels ? m->channels : 1u;
+    return (uint16_t)(((uint32_t)m->block_align * 16u) / (bits * ch));
+}
+
+static vc_status_t vc_reader_parse_wav(vc_stream_reader_t *r, uint32_t file_size)
+{
+    const uint8_t *p = r->buf + r->pos;
+    if (memcmp(p, "RIFF", 4) != 0 || memcmp(p + 8, "WAVE", 4) != 0) return VC_E_PARAM;
+
+    uint32_t off = 12;
+    uint8_t have_fmt = 0;
+    vc_stream_meta_t *m = &r->meta;
+
+    for (;;) {
+        if (vc_reader_seek(r, off) != VC_OK || vc_reader_ensure(r, 8) != VC_OK) return VC_E_PARAM;
+        p = r->buf + r->pos;
+        uint32_t size = vc_rd_get32(p + 4);
+
+        if (memcmp(p, "fmt ", 4) == 0) {
+            if (size < 16u || size > 40u || vc_reader_ensure(r, (uint16_t)(8u + size)) != VC_OK) return VC_E_PARAM;
+            p = r->buf + r->pos + 8;
+            m->codec_id          = (vc_codec_id_t)vc_rd_get16(p + 0);
+            m->channels          = vc_rd_get16(p + 2);
+            m->sample_rate_hz    = vc_rd_get32(p + 4);
+            m->avg_bytes_per_sec = vc_rd_get32(p + 8);
+            m->block_align       = vc_rd_get16(p + 12);
+            m->bits_per_sample   = vc_rd_get16(p + 14);
+            uint16_t ext = (size >= 20u && vc_rd_get16(p + 16) >= 2u) ? vc_rd_get16(p + 18) : 0u;
+            if (m->codec_id == VC_CODEC_IMA_ADPCM) m->samples_per_block = ext;
+            if (m->codec_id == VC_CODEC_G722) {
+                m->codec_opts        = ext;
+                m->samples_per_block = vc_reader_g722_spb(m);
+            }
+            have_fmt = 1;
+        } else if (memcmp(p, "data", 4) == 0) {
+            if (!have_fmt) return VC_E_PARAM;
+            r->data_start = off + 8u;
+            /* Nagranie przerwane przed poprawką nagłówka: rozmiar 0 lub poza plikiem -> do końca pliku. */
+            uint32_t avail = (file_size > r->data_start) ? file_size - r->data_start : 0u;
+            r->data_bytes = (size == 0u || size > avail) ? avail : size;
+            return VC_OK;
+        }
+        off += 8u + size + (size & 1u);
+        if (off >= file_size) return VC_E_PARAM;
+    }
+}
+
+static vc_status_t vc_reader_parse_vcmd(vc_stream_reader_t *r, uint32_t file_size)
+{
+    vc_vcmd_header_t *h = &r->hdr;
+    if (vc_reader_ensure(r, VC_VCMD_HEADER_V1_BYTES) != VC_OK) return VC_E_PARAM;
+    uint16_t header_bytes = vc_rd_get16(r->buf + r->pos + 6);
+    if (header_bytes < VC_VCMD_HEADER_V1_BYTES || header_bytes > file_size) return VC_E_PARAM;
+
+    /* v1: tylko pola do flags; brakujące pola v2 zostają zerami. */
+    uint16_t n = (header_bytes < sizeof(*h)) ? header_bytes : (uint16_t)sizeof(*h);
+    if (vc_reader_ensure(r, n) != VC_OK) return VC_E_PARAM;
+    memset(h, 0, sizeof(*h));
+    memcpy(h, r->buf + r->pos, n);
+    if (h->magic != VC_VCMD_MAGIC) return VC_E_PARAM;
+
+    r->meta.sample_rate_hz = h->sample_rate_hz;
+    r->data_start = h->header_bytes;
+    uint32_t avail = file_size - h->header_bytes;
+    r->data_bytes = (h->data_bytes != 0u && h->data_bytes <= avail) ? h->data_bytes : avail;
+
+    /* Tablica przełączeń kodeka (tryb adaptacyjny) - na stałe w RAM czytnika. */
+    if ((h->flags & VC_VCMD_FLAG_HAS_SWITCHES) && h->switch_count) {
+        uint32_t cnt = (h->switch_count < VC_VCMD_MAX_SWITCHES) ? h->switch_count : VC_VCMD_MAX_SWITCHES;
+        uint32_t bytes = cnt * sizeof(vc_vcmd_switch_t);
+        if (h->switch_offset + bytes > file_size) return VC_E_PARAM;
+        if (vc_reader_fill_at(r, h->switch_offset) != VC_OK || vc_reader_ensure(r, (uint16_t)bytes) != VC_OK) {
+            return VC_E_PARAM;
+        }
+        memcpy(r->switches, r->buf + r->pos, bytes);
+        r->switch_count = (uint16_t)cnt;
+    }
+    return VC_OK;
+}
+
+/* (Re)otwiera dekoder i wylicza rozmiar bloku. */
+static vc_status_t vc_reader_open_codec(vc_stream_reader_t *r, const vc_enc_cfg_t *cfg)
+{
+    vc_codec_close(&r->dec);
+    vc_status_t st = vc_codec_open(&r->dec, cfg, VC_CODEC_DIR_DEC);
+    if (st != VC_OK) return st;
+
+    r->block_bytes  = vc_codec_max_bytes_per_frame(&r->dec);
+    r->len_prefixed = (r->kind == VC_READER_VCMD) && (r->dec.ops->flags & VC_CODEC_F_VARIABLE);
+    if (r->kind == VC_READER_WAV && (r->dec.ops->flags & VC_CODEC_F_VARIABLE)) return VC_E_PARAM;
+    if (r->block_bytes == 0 || r->block_bytes + VC_VCMD_LEN_PREFIX_BYTES > VC_READER_CARRY_BYTES) return VC_E_PARAM;
+    return VC_OK;
+}
+
+/* Dekoder VCMD dla kodeka z nagłówka albo z wpisu tablicy przełączeń. */
+static vc_status_t vc_reader_open_vcmd_codec(vc_stream_reader_t *r, uint16_t codec_id, uint16_t codec_opts)
+{
+    vc_stream_meta_t m;
+    vc_enc_cfg_t cfg;
+
+    memset(&m, 0, sizeof(m));
+    m.codec_id          = (vc_codec_id_t)codec_id;
+    m.channels          = r->hdr.channels;
+    m.samples_per_block = r->hdr.frame_samples;
+    m.codec_opts        = codec_opts;
+
+    vc_status_t st = vc_codec_cfg_from_meta(&m, &cfg);
+    return (st == VC_OK) ? vc_reader_open_codec(r, &cfg) : st;
+}
+
+/* Dekoder obowiązujący od początku nagrania. */
+static vc_status_t vc_reader_open_initial_codec(vc_stream_reader_t *r)
+{
+    if (r->kind == VC_READER_VCMD) {
+        return vc_reader_open_vcmd_codec(r, (uint16_t)r->hdr.codec_id, r->hdr.codec_opts);
+    }
+    vc_enc_cfg_t cfg;
+    vc_status_t st = vc_codec_cfg_from_meta(&r->meta, &cfg);
+    return (st == VC_OK) ? vc_reader_open_codec(r, &cfg) : st;
+}
+
+/* Mapa klastrów (jeden przebieg łańcucha FAT przy otwarciu). FR_NOT_ENOUGH_CORE:
+ * więcej fragmentów niż tablica - bez fast seek. */
+static void vc_reader_build_clmt(vc_stream_reader_t *r)
+{
+#if _USE_FASTSEEK
+    r->clmt[0]      = VC_READER_CLMT_WORDS;
+    r->file.cltbl   = r->clmt;
+    r->fast_seek    = (f_lseek(&r->file, CREATE_LINKMAP) == FR_OK);
+    if (!r->fast_seek) r->file.cltbl = NULL;
+#endif
+}
+
+vc_status_t vc_reader_open(vc_stream_reader_t *r, const char *path)
+{
+    if (!r || !path) return VC_E_PARAM;
+
+    memset(r, 0, offsetof(vc_stream_reader_t, buf));
+    if (f_open(&r->file, path, FA_READ | FA_OPEN_EXISTING) != FR_OK) return VC_E_IO;
+    r->is_open = 1;
+    vc_reader_build_clmt(r);
+
+    uint32_t file_size = (uint32_t)f_size(&r->file);
+    vc_status_t st = vc_reader_fill_at(r, 0);
+    if (st == VC_OK) st = vc_reader_ensure(r, 12);
+
+    if (st == VC_OK) {
+        if (vc_rd_get32(r->buf + r->pos) == VC_VCMD_MAGIC) {
+            r->kind = VC_READER_VCMD;
+            st = vc_reader_parse_vcmd(r, file_size);
+        } else {
+            r->kind = VC_READER_WAV;
+            st = vc_reader_parse_wav(r, file_size);
+        }
+    }
+    if (st == VC_OK) st = vc_reader_open_initial_codec(r);
+    if (st == VC_OK && r->kind == VC_READER_VCMD) {
+        uint32_t fs = r->meta.sample_rate_hz;
+        vc_codec_meta(&r->dec, &r->meta);
+        if (fs) r->meta.sample_rate_hz = fs;
+    }
+    if (st == VC_OK) st = vc_reader_seek(r, r->data_start);
+    if (st != VC_OK) {
+        vc_reader_close(r);
+        return (st == VC_E_IO) ? VC_E_IO : VC_E_PARAM;
+    }
+    return VC_OK;
+}
+
+vc_status_t vc_reader_next_block(vc_stream_reader_t *r, const uint8_t **block, uint16_t *len)
+{
+    if (!r || !r->is_open || !block || !len) return VC_E_PARAM;
+
+    uint32_t remaining = r->data_bytes - r->data_pos;
+    if (remaining == 0) return VC_E_EMPTY;
+
+    /* Tryb adaptacyjny: od tej ramki obowiązuje inny kodek. */
+    while (r->next_switch < r->switch_count && r->switches[r->next_switch].frame_idx <= r->frame_idx) {
+        const vc_vcmd_switch_t *sw = &r->switches[r->next_switch++];
+        vc_status_t st = vc_reader_open_vcmd_codec(r, sw->codec_id, sw->codec_opts);
+        if (st != VC_OK) return st;
+    }
+
+    uint16_t n;
+    if (r->len_prefixed) {
+        if (remaining < VC_VCMD_LEN_PREFIX_BYTES || vc_reader_ensure(r, VC_VCMD_LEN_PREFIX_BYTES) != VC_OK) {
+            return VC_E_EMPTY;
+        }
+        n = vc_rd_get16(r->buf + r->pos);
+        if (n == 0 || n > r->block_bytes || n > remaining - VC_VCMD_LEN_PREFIX_BYTES) return VC_E_CODEC;
+        if (vc_reader_ensure(r, (uint16_t)(VC_VCMD_LEN_PREFIX_BYTES + n)) != VC_OK) return VC_E_EMPTY;
+        r->pos       = (uint16_t)(r->pos + VC_VCMD_LEN_PREFIX_BYTES);
+        r->data_pos += VC_VCMD_LEN_PREFIX_BYTES;
+    } else {
+        n = (remaining < r->block_bytes) ? (uint16_t)remaining : r->block_bytes;
+        if (vc_reader_ensure(r, n) != VC_OK) return VC_E_EMPTY;
+    }
+
+    *block = r->buf + r->pos;
+    *len   = n;
+    r->pos       = (uint16_t)(r->pos + n);
+    r->data_pos += n;
+    r->frame_idx++;
+    return VC_OK;
+}
+
+/* Offset bloku z wpisu indeksu: z RAM albo jednym odczytem z pliku. */
+static vc_status_t vc_reader_index_entry(vc_stream_reader_t *r, uint32_t e, uint32_t *off)
+{
+    if (r->index) {
+        *off = r->index[e];
+        return VC_OK;
+    }
+    vc_status_t st = vc_reader_fill_at(r, r->hdr.index_offset + e * sizeof(uint32_t));
+    if (st == VC_OK) st = vc_reader_ensure(r, sizeof(uint32_t));
+    if (st == VC_OK) *off = vc_rd_get32(r->buf + r->pos);
+    return st;
+}
+
+vc_status_t vc_reader_seek_frame(vc_stream_reader_t *r, uint32_t frame_idx)
+{
+    if (!r || !r->is_open) return VC_E_PARAM;
+
+    /* Segment kodeka, w którym leży ramka. */
+    uint16_t k = 0;
+    while (k < r->switch_count && r->switches[k].frame_idx <= frame_idx) k++;
+
+    uint32_t base_off = 0, base_frame = 0;
+    vc_status_t st;
+    if (k > 0) {
+        const vc_vcmd_switch_t *sw = &r->switches[k - 1u];
+        base_off   = sw->byte_offset;
+        base_frame = sw->frame_idx;
+        st = vc_reader_open_vcmd_codec(r, sw->codec_id, sw->codec_opts);
+    } else {
+        st = vc_reader_open_initial_codec(r);
+    }
+    if (st != VC_OK) return st;
+    r->next_switch = k;
+
+    uint32_t off, skip = 0;
+    if (!r->len_prefixed) {
+        off = base_off + (frame_idx - base_frame) * r->block_bytes;
+    } else if ((r->hdr.flags & VC_VCMD_FLAG_HAS_INDEX) && r->hdr.index_entries && r->hdr.index_interval) {
+        uint32_t e = frame_idx / r->hdr.index_interval;
+        if (e >= r->hdr.index_entries) e = r->hdr.index_entries - 1u;
+        st = vc_reader_index_entry(r, e, &off);
+        if (st != VC_OK) return st;
+        skip = frame_idx - e * r->hdr.index_interval;
+    } else {
+        off  = 0;                 /* bez indeksu: przejście od początku */
+        skip = frame_idx;
+    }
+    if (off > r->data_bytes) return VC_E_PARAM;
+
+    st = vc_reader_seek(r, r->data_start + off);
+    if (st != VC_OK) return st;
+    r->data_pos  = off;
+    r->frame_idx = frame_idx - skip;
+
+    const uint8_t *blk;
+    uint16_t len;
+    while (skip--) {
+        st = vc_reader_next_block(r, &blk, &len);
+        if (st != VC_OK) return st;
+    }
+    return VC_OK;
+}
+
+vc_status_t vc_reader_load_index(vc_stream_reader_t *r, uint32_t *buf, uint32_t cap)
+{
+    if (!r || !r->is_open || !buf) return VC_E_PARAM;
+    if (r->kind != VC_READER_VCMD || !(r->hdr.flags & VC_VCMD_FLAG_HAS_INDEX)) return VC_E_STATE;
+    if (r->hdr.index_entries > cap) return VC_E_FULL;
+
+    /* Bieżąca pozycja odtwarzania - okno bufora jest po odczycie wczytywane na nowo. */
+    uint32_t cur = r->data_start + r->data_pos;
+    UINT bytes = r->hdr.index_entries * sizeof(uint32_t), br = 0;
+    if (f_lseek(&r->file, r->hdr.index_offset) != FR_OK
+        || f_read(&r->file, buf, bytes, &br) != FR_OK || br != bytes) {
+        return VC_E_IO;
+    }
+    r->index = buf;
+    return vc_reader_fill_at(r, cur);
+}
+
+vc_status_t vc_reader_verify_crc(vc_stream_reader_t *r)
+{
+    if (!r || !r->is_open) return VC_E_PARAM;
+    if (r->kind != VC_READER_VCMD || r->hdr.crc32 == 0u) return VC_E_STATE;
+
+    const uint32_t half = VC_READER_READ_BYTES / 2u;
+    uint8_t *bufs[2] = { r->buf + VC_READER_CARRY_BYTES, r->buf + VC_READER_CARRY_BYTES + half };
+    uint32_t cur  = r->data_start + r->data_pos;
+    uint32_t end  = r->data_start + r->data_bytes;
+    uint32_t fpos = r->data_start & ~(VC_READER_SECTOR_BYTES - 1u);
+    vc_crc32_t crc;
+    vc_status_t st = VC_OK;
+
+    vc_crc32_init(&crc);
+    if (f_lseek(&r->file, fpos) != FR_OK) st = VC_E_IO;
+
+    /* Połowa k: odczyt, potem CRC w tle (async) podczas odczytu połowy k^1. */
+    for (uint32_t k = 0; st == VC_OK && fpos < end; k ^= 1u) {
+        UINT br = 0;
+        if (f_read(&r->file, bufs[k], half, &br) != FR_OK) { st = VC_E_IO; break; }
+        if (br == 0) break;
+
+        uint32_t from = (fpos < r->data_start) ? r->data_start - fpos : 0u;
+        uint32_t to   = (fpos + br > end) ? end - fpos : br;
+        vc_crc32_update_async(&crc, bufs[k] + from, to - from);
+        fpos += br;
+    }
+    uint32_t value = vc_crc32_final(&crc);
+
+    /* Okno bufora zostało nadpisane - odtworzenie bieżącej pozycji. */
+    vc_status_t sst = vc_reader_fill_at(r, cur);
+    if (st != VC_OK) return st;
+    if (sst != VC_OK) return sst;
+    return (value == r->hdr.crc32) ? VC_OK : VC_E_CRC;
+}
+
+vc_status_t vc_reader_read_frame(vc_stream_reader_t *r, int16_t *pcm, uint16_t *n_samples)
+{
+    if (!pcm || !n_samples) return VC_E_PARAM;
+
+    const uint8_t *blk;
+    uint16_t len;
+    vc_status_t st = vc_reader_next_block(r, &blk, &len);
+    if (st != VC_OK) return st;
+
+    uint16_t n = r->dec.frame_samples;
+    if (!r->len_prefixed && len < r->block_bytes) {
+        /* Ostatni, niepełny blok: dopełnienie zerami, próbki proporcjonalnie do bajtów. */
+        static uint8_t last[VC_READER_CARRY_BYTES];
+        memset(last, 0, r->block_bytes);
+        memcpy(last, blk, len);
+        blk = last;
+        n   = (uint16_t)(((uint32_t)n * len) / r->block_bytes);
+        len = r->block_bytes;
+    }
+
+    uint32_t offsets[2] = { 0, len };
+    st = vc_codec_decode_frames(&r->dec, blk, offsets, 1, pcm);
+    if (st != VC_OK) return st;
+    *n_samples = n;
+    return VC_OK;
+}
+
+void vc_reader_close(vc_stream_reader_t *r)
+{
+    if (!r || !r->is_open) return;
+    vc_codec_close(&r->dec);
+    f_close(&r->file);
+    r->is_open = 0;
+}
@@ -0,0 +1,159 @@
+#include "fatfs/vc_vcmd_writer.h"
+#include <string.h>
+
+vc_status_t vc_vcmd_writer_open_sink(vc_vcmd_writer_t *w, vc_stream_sink_t *sink, const vc_codec_t *codec)
+{
+    if (!w || !sink || !codec || !codec->ops) return VC_E_PARAM;
+
+    vc_stream_meta_t m;
+    vc_codec_meta(codec, &m);
+
+    memset(&w->hdr, 0, sizeof(w->hdr));
+    w->hdr.magic          = VC_VCMD_MAGIC;
+    w->hdr.version        = VC_VCMD_VERSION;
+    w->hdr.header_bytes   = sizeof(vc_vcmd_header_t);
+    w->hdr.codec_id       = codec->cfg.codec;
+    w->hdr.sample_rate_hz = m.sample_rate_hz;
+    w->hdr.channels       = codec->channels;
+    w->hdr.frame_samples  = codec->frame_samples;
+    w->hdr.codec_opts     = m.codec_opts;
+
+    w->len_prefixed   = (codec->ops->flags & VC_CODEC_F_VARIABLE) ? 1u : 0u;
+    w->block_max      = (uint16_t)(vc_codec_max_bytes_per_frame(codec)
+                                   + (w->len_prefixed ? VC_VCMD_LEN_PREFIX_BYTES : 0u));
+    w->index_interval = VC_VCMD_INDEX_INTERVAL;
+    w->index_count    = 0;
+    w->switches       = NULL;
+    w->switch_count   = 0;
+    w->ckpt_every     = 0;
+    w->ckpt_next      = 0;
+    vc_crc32_init(&w->crc);
+
+    /* Zaślepka nagłówka - poprawiana w close. */
+    w->sink = sink;
+    return vc_sink_write(sink, &w->hdr, sizeof(w->hdr));
+}
+
+vc_status_t vc_vcmd_writer_open(vc_vcmd_writer_t *w, const char *path, const vc_codec_t *codec)
+{
+    if (!w || !path || !codec || !codec->ops) return VC_E_PARAM;
+
+    vc_status_t st = vc_sector_writer_open(&w->out, path);
+    if (st == VC_OK) st = vc_vcmd_writer_open_sink(w, &w->out.sink, codec);
+    return st;
+}
+
+vc_status_t vc_vcmd_writer_reserve_ms(vc_vcmd_writer_t *w, uint32_t duration_ms)
+{
+    if (!w || !w->sink || !w->hdr.frame_samples || !w->hdr.sample_rate_hz) return VC_E_PARAM;
+
+    uint64_t frames = ((uint64_t)duration_ms * w->hdr.sample_rate_hz / 1000u + w->hdr.frame_samples - 1u)
+                      / w->hdr.frame_samples;
+    uint64_t bytes  = w->hdr.header_bytes + frames * w->block_max
+                    + VC_VCMD_INDEX_MAX * sizeof(uint32_t) + VC_VCMD_MAX_SWITCHES * sizeof(vc_vcmd_switch_t);
+    if (bytes > 0xFFFFFFFFu) return VC_E_PARAM;
+    return vc_sink_reserve(w->sink, (uint32_t)bytes);
+}
+
+/* Pełny indeks: zostaje co drugi wpis, interwał x2. */
+static void vc_vcmd_index_compact(vc_vcmd_writer_t *w)
+{
+    for (uint32_t i = 0; i < w->index_count / 2u; i++) {
+        w->index[i] = w->index[2u * i];
+    }
+    w->index_count /= 2u;
+    w->index_interval *= 2u;
+}
+
+vc_status_t vc_vcmd_writer_write_block(vc_vcmd_writer_t *w, const uint8_t *block, uint16_t len)
+{
+    if (!w || !w->sink || !block || len == 0) return VC_E_PARAM;
+
+    /* Blok z prefiksem idzie w całości albo wcale - indeks i CRC dopiero po miejscu. */
+    uint32_t need = len + (w->len_prefixed ? VC_VCMD_LEN_PREFIX_BYTES : 0u);
+    if (vc_sink_space(w->sink) < need) return VC_E_FULL;
+
+    if (w->hdr.total_blocks % w->index_interval == 0u) {
+        if (w->index_count == VC_VCMD_INDEX_MAX) vc_vcmd_index_compact(w);
+        w->index[w->index_count++] = w->hdr.data_bytes;
+    }
+
+    vc_status_t st = VC_OK;
+    if (w->len_prefixed) {
+        uint8_t prefix[VC_VCMD_LEN_PREFIX_BYTES] = { (uint8_t)len, (uint8_t)(len >> 8) };
+        st = vc_sink_write(w->sink, prefix, sizeof(prefix));
+        w->hdr.data_bytes += sizeof(prefix);
+        vc_crc32_update(&w->crc, prefix, sizeof(prefix));
+    }
+    if (st == VC_OK) st = vc_sink_write(w->sink, block, len);
+    if (st != VC_OK) return st;
+    vc_crc32_update(&w->crc, block, len);
+
+    w->hdr.data_bytes    += len;
+    w->hdr.total_blocks  += 1u;
+    w->hdr.total_samples += w->hdr.frame_samples;
+
+    if (w->ckpt_every && (int32_t)(w->hdr.total_samples - w->ckpt_next) >= 0) {
+        st = vc_vcmd_writer_checkpoint(w);
+        if (st == VC_E_AGAIN) return VC_OK;   /* ponowienie przy kolejnym bloku */
+        w->ckpt_next = w->hdr.total_samples + w->ckpt_every;
+    }
+    return st;
+}
+
+void vc_vcmd_writer_set_checkpoint(vc_vcmd_writer_t *w, uint32_t interval_ms)
+{
+    if (!w) return;
+    uint64_t samples = (uint64_t)w->hdr.sample_rate_hz * interval_ms / 1000u;
+    w->ckpt_every = (samples > 0xFFFFFFFFu) ? 0xFFFFFFFFu : (uint32_t)samples;
+    if (interval_ms && !w->ckpt_every) w->ckpt_every = 1;
+    w->ckpt_next  = w->hdr.total_samples + w->ckpt_every;
+}
+
+vc_status_t vc_vcmd_writer_checkpoint(vc_vcmd_writer_t *w)
+{
+    if (!w || !w->sink) return VC_E_PARAM;
+
+    /* Tylko payload: indeks/przełączenia/CRC są dopisywane przy zamknięciu. */
+    vc_vcmd_header_t h = w->hdr;
+    h.flags &= ~(uint32_t)(VC_VCMD_FLAG_HAS_INDEX | VC_VCMD_FLAG_HAS_SWITCHES);
+    h.crc32 = 0;
+    h.index_offset = h.index_interval = h.index_entries = 0;
+    h.switch_offset = h.switch_count = 0;
+    return vc_sink_checkpoint(w->sink, &h, sizeof(h));
+}
+
+void vc_vcmd_writer_set_switches(vc_vcmd_writer_t *w, const vc_vcmd_switch_t *log, uint16_t count)
+{
+    if (!w) return;
+    if (count > VC_VCMD_MAX_SWITCHES) count = VC_VCMD_MAX_SWITCHES;
+    w->switches     = log;
+    w->switch_count = log ? count : 0u;
+}
+
+vc_status_t vc_vcmd_writer_close(vc_vcmd_writer_t *w)
+{
+    if (!w || !w->sink) return VC_E_PARAM;
+
+    vc_status_t st = VC_OK;
+
+    w->hdr.crc32 = vc_crc32_final(&w->crc);
+    w->hdr.index_offset   = w->hdr.header_bytes + w->hdr.data_bytes;
+    w->hdr.index_interval = w->index_interval;
+    w->hdr.index_entries  = w->index_count;
+    if (w->index_count) {
+        w->hdr.flags |= VC_VCMD_FLAG_HAS_INDEX;
+        st = vc_sink_write(w->sink, w->index, w->index_count * sizeof(uint32_t));
+    }
+
+    w->hdr.switch_offset = w->hdr.index_offset + w->index_count * sizeof(uint32_t);
+    w->hdr.switch_count  = w->switch_count;
+    if (st == VC_OK && w->switch_count) {
+        w->hdr.flags |= VC_VCMD_FLAG_HAS_SWITCHES;
+        st = vc_sink_write(w->sink, w->switches, w->switch_count * sizeof(vc_vcmd_switch_t));
+    }
+
+    vc_status_t cst = vc_sink_close(w->sink, &w->hdr, sizeof(w->hdr));
+    w->sink = NULL;
+    return (st != VC_OK) ? st : cst;
+}
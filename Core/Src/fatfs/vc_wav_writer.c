@@ -0,0 +1,161 @@
+#include "fatfs/vc_wav_writer.h"
+#include <string.h>
+
+static uint8_t *vc_wav_put16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    return p + 2;
+}
+
+static uint8_t *vc_wav_put32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+    return p + 4;
+}
+
+static uint8_t *vc_wav_put_tag(uint8_t *p, const char *tag)
+{
+    memcpy(p, tag, 4);
+    return p + 4;
+}
+
+uint16_t vc_wav_build_header(const vc_stream_meta_t *m, uint32_t data_size, uint8_t *out)
+{
+    if (!m || !out) return 0;
+
+    uint16_t cb_size;
+    uint16_t cb_ext = 0;
+    switch (m->codec_id) {
+    case VC_CODEC_PCM16:     cb_size = 0; break;
+    case VC_CODEC_G711A:
+    case VC_CODEC_G711U:     cb_size = 0; break;
+    case VC_CODEC_IMA_ADPCM: cb_size = 2; cb_ext = m->samples_per_block; break;
+    case VC_CODEC_G722:      cb_size = 2; cb_ext = m->codec_opts; break;
+    default:                 return 0;   /* LPC: tylko kontener VCMD */
+    }
+
+    const uint8_t is_pcm = (m->codec_id == VC_CODEC_PCM16);
+    const uint32_t fmt_size = is_pcm ? 16u : (18u + cb_size);
+    const uint32_t header_bytes = 12u + (8u + fmt_size) + (is_pcm ? 0u : 12u) + 8u;
+    const uint32_t pad = data_size & 1u;   /* chunk 'data' wyrównany do 2 B */
+
+    uint8_t *p = out;
+    p = vc_wav_put_tag(p, "RIFF");
+    p = vc_wav_put32(p, header_bytes - 8u + data_size + pad);
+    p = vc_wav_put_tag(p, "WAVE");
+
+    p = vc_wav_put_tag(p, "fmt ");
+    p = vc_wav_put32(p, fmt_size);
+    p = vc_wav_put16(p, (uint16_t)m->codec_id);
+    p = vc_wav_put16(p, m->channels);
+    p = vc_wav_put32(p, m->sample_rate_hz);
+    p = vc_wav_put32(p, m->avg_bytes_per_sec);
+    p = vc_wav_put16(p, m->block_align);
+    p = vc_wav_put16(p, m->bits_per_sample);
+
+    if (!is_pcm) {
+        p = vc_wav_put16(p, cb_size);
+        if (cb_size == 2) p = vc_wav_put16(p, cb_ext);
+
+        /* 'fact': liczba próbek (na kanał) po dekodowaniu */
+        uint32_t spb = m->samples_per_block ? m->samples_per_block : 1u;
+        uint32_t num_samples = (m->block_align > 0) ? (data_size / m->block_align) * spb : 0;
+        p = vc_wav_put_tag(p, "fact");
+        p = vc_wav_put32(p, 4u);
+        p = vc_wav_put32(p, num_samples);
+    }
+
+    p = vc_wav_put_tag(p, "data");
+    p = vc_wav_put32(p, data_size);
+
+    return (uint16_t)(p - out);
+}
+
+vc_status_t vc_wav_writer_open_sink(vc_wav_writer_t *w, vc_stream_sink_t *sink, const vc_stream_meta_t *m)
+{
+    if (!w || !sink || !m) return VC_E_PARAM;
+
+    uint8_t header[VC_WAV_HEADER_MAX_BYTES];
+    w->sink         = sink;
+    w->meta         = *m;
+    w->data_bytes   = 0;
+    w->ckpt_every   = 0;
+    w->ckpt_next    = 0;
+    w->header_bytes = vc_wav_build_header(m, 0, header);
+    if (w->header_bytes == 0) return VC_E_PARAM;
+
+    /* Nagłówek z zerowymi rozmiarami rezerwuje miejsce na początku pierwszego bufora. */
+    return vc_sink_write(sink, header, w->header_bytes);
+}
+
+vc_status_t vc_wav_writer_open(vc_wav_writer_t *w, const char *path, const vc_stream_meta_t *m)
+{
+    uint8_t header[VC_WAV_HEADER_MAX_BYTES];
+    if (!w || !path || !m) return VC_E_PARAM;
+    if (vc_wav_build_header(m, 0, header) == 0) return VC_E_PARAM;   /* bez pliku dla LPC */
+
+    vc_status_t st = vc_sector_writer_open(&w->out, path);
+    if (st == VC_OK) st = vc_wav_writer_open_sink(w, &w->out.sink, m);
+    return st;
+}
+
+vc_status_t vc_wav_writer_reserve_ms(vc_wav_writer_t *w, uint32_t duration_ms)
+{
+    if (!w) return VC_E_PARAM;
+    uint64_t bytes = (uint64_t)w->meta.avg_bytes_per_sec * duration_ms / 1000u + w->header_bytes + 1u;
+    if (bytes > 0xFFFFFFFFu) return VC_E_PARAM;
+    return vc_sink_reserve(w->sink, (uint32_t)bytes);
+}
+
+void vc_wav_writer_set_checkpoint(vc_wav_writer_t *w, uint32_t interval_ms)
+{
+    if (!w) return;
+    uint64_t bytes = (uint64_t)w->meta.avg_bytes_per_sec * interval_ms / 1000u;
+    w->ckpt_every = (bytes > 0xFFFFFFFFu) ? 0xFFFFFFFFu : (uint32_t)bytes;
+    if (interval_ms && !w->ckpt_every) w->ckpt_every = 1;
+    w->ckpt_next  = w->data_bytes + w->ckpt_every;
+}
+
+vc_status_t vc_wav_writer_checkpoint(vc_wav_writer_t *w)
+{
+    if (!w || !w->sink) return VC_E_PARAM;
+    uint8_t header[VC_WAV_HEADER_MAX_BYTES];
+    uint16_t hb = vc_wav_build_header(&w->meta, w->data_bytes, header);
+    return vc_sink_checkpoint(w->sink, header, hb);
+}
+
+vc_status_t vc_wav_writer_write(vc_wav_writer_t *w, const void *data, uint32_t len)
+{
+    if (!w || !w->sink) return VC_E_PARAM;
+    vc_status_t st = vc_sink_write(w->sink, data, len);
+    if (st != VC_OK) return st;
+    w->data_bytes += len;
+
+    /* VC_E_AGAIN (poprzedni punkt czeka): ponowienie przy kolejnej ramce. */
+    if (w->ckpt_every && (int32_t)(w->data_bytes - w->ckpt_next) >= 0) {
+        st = vc_wav_writer_checkpoint(w);
+        if (st == VC_E_AGAIN) return VC_OK;
+        w->ckpt_next = w->data_bytes + w->ckpt_every;
+    }
+    return st;
+}
+
+vc_status_t vc_wav_writer_close(vc_wav_writer_t *w)
+{
+    if (!w || !w->sink) return VC_E_PARAM;
+
+    /* Bajt wyrównania chunku 'data' (np. nieparzysta liczba bajtów G.711). */
+    static const uint8_t pad = 0;
+    vc_status_t st = VC_OK;
+    if (w->data_bytes & 1u) st = vc_sink_write(w->sink, &pad, 1);
+
+    uint8_t header[VC_WAV_HEADER_MAX_BYTES];
+    uint16_t hb = vc_wav_build_header(&w->meta, w->data_bytes, header);
+    vc_status_t cst = vc_sink_close(w->sink, header, hb);
+    w->sink = NULL;
+    return (st != VC_OK) ? st : cst;
+}
@@ -0,0 +1,359 @@
+#include "fatfs/vc_write_behind.h"
+#include <stddef.h>
+#include <string.h>
+
+#ifdef VC_HOST_BUILD
+#define VC_WB_BARRIER()  __sync_synchronize()
+#else
+#include "stm32f4xx.h"
+#define VC_WB_BARRIER()  __DMB()
+#endif
+
+#define VC_WB_RING_MASK  (VC_WB_RING_BYTES - 1u)
+
+static vc_wb_t *s_wb_open[VC_WB_MAX_OPEN];
+
+static vc_status_t vc_wb_sink_write(vc_stream_sink_t *s, const void *data, uint32_t len)
+{
+    return vc_wb_push((vc_wb_t *)s, data, len);
+}
+
+static uint32_t vc_wb_sink_space(const vc_stream_sink_t *s)
+{
+    return vc_wb_space((const vc_wb_t *)s);
+}
+
+static vc_status_t vc_wb_sink_reserve(vc_stream_sink_t *s, uint32_t bytes)
+{
+    vc_wb_t *q = (vc_wb_t *)s;
+    if (q->rd_pos != q->file_base || q->reserved_bytes != 0) return VC_E_STATE;
+
+    bytes = (bytes + VC_WB_BUF_BYTES - 1u) & ~(VC_WB_BUF_BYTES - 1u);
+    FRESULT fr = f_expand(&q->file, bytes, 1);
+    if (fr == FR_DENIED) return VC_E_FULL;
+    if (fr != FR_OK) return VC_E_IO;
+    q->reserved_bytes = bytes;
+    return VC_OK;
+}
+
+static vc_status_t vc_wb_sink_checkpoint(vc_stream_sink_t *s, const void *header, uint16_t header_len)
+{
+    return vc_wb_checkpoint((vc_wb_t *)s, header, header_len);
+}
+
+static vc_status_t vc_wb_sink_close(vc_stream_sink_t *s, const void *header, uint16_t header_len)
+{
+    return vc_wb_close((vc_wb_t *)s, header, header_len);
+}
+
+static const vc_stream_sink_ops_t vc_wb_sink_ops = {
+    .write      = vc_wb_sink_write,
+    .space      = vc_wb_sink_space,
+    .reserve    = vc_wb_sink_reserve,
+    .checkpoint = vc_wb_sink_checkpoint,
+    .close      = vc_wb_sink_close,
+};
+
+vc_status_t vc_wb_open(vc_wb_t *q, const char *path)
+{
+    if (!q || !path) return VC_E_PARAM;
+
+    uint32_t slot = 0;
+    while (slot < VC_WB_MAX_OPEN && s_wb_open[slot]) slot++;
+    if (slot == VC_WB_MAX_OPEN) return VC_E_FULL;
+
+    memset(q, 0, offsetof(vc_wb_t, ring));
+    q->sink.ops = &vc_wb_sink_ops;
+    if (f_open(&q->file, path, FA_WRITE | FA_CREATE_ALWAYS) != FR_OK) return VC_E_IO;
+    q->is_open = 1;
+    s_wb_open[slot] = q;
+    return VC_OK;
+}
+
+uint32_t vc_wb_space(const vc_wb_t *q)
+{
+    return VC_WB_RING_BYTES - (q->wr_pos - q->rd_pos);
+}
+
+/* Kopia do pierścienia od pozycji wr (z zawinięciem) i publikacja po barierze. */
+static void vc_wb_put(vc_wb_t *q, uint32_t wr, const uint8_t *src, uint32_t n)
+{
+    uint32_t off   = wr & VC_WB_RING_MASK;
+    uint32_t first = VC_WB_RING_BYTES - off;
+    if (first > n) first = n;
+    memcpy(q->ring + off, src, first);
+    memcpy(q->ring, src + first, n - first);
+
+    VC_WB_BARRIER();              /* dane widoczne przed nowym wr_pos */
+    q->wr_pos = wr + n;
+
+    uint32_t used = q->wr_pos - q->rd_pos;
+    if (used > q->stats.high_water_bytes) q->stats.high_water_bytes = used;
+}
+
+vc_status_t vc_wb_push(vc_wb_t *q, const void *data, uint32_t len)
+{
+    if (!q || !q->is_open || (!data && len)) return VC_E_PARAM;
+
+    const uint8_t *src = (const uint8_t *)data;
+    uint32_t wr = q->wr_pos;
+
+    if (!q->finishing) {
+        if (len > VC_WB_RING_BYTES - (wr - q->rd_pos)) {
+            q->stats.dropped_frames++;
+            q->stats.dropped_bytes += len;
+            return VC_E_FULL;
+        }
+        vc_wb_put(q, wr, src, len);
+        return VC_OK;
+    }
+
+    /* Zamykanie: producent to zadanie zapisu - brak miejsca = zapis pełnych buforów. */
+    while (len) {
+        uint32_t n = VC_WB_RING_BYTES - (wr - q->rd_pos);
+        if (n == 0) {
+            if (vc_wb_service(q) == 0) return VC_E_IO;
+            continue;
+        }
+        if (n > len) n = len;
+        vc_wb_put(q, wr, src, n);
+        wr  += n;
+        src += n;
+        len -= n;
+    }
+    return VC_OK;
+}
+
+vc_status_t vc_wb_checkpoint(vc_wb_t *q, const void *header, uint16_t header_len)
+{
+    if (!q || !q->is_open || !header || header_len > VC_WB_CKPT_HEADER_MAX) return VC_E_PARAM;
+    if (q->ckpt_pending) {
+        q->stats.checkpoints_skipped++;
+        return VC_E_AGAIN;
+    }
+    memcpy(q->ckpt_header, header, header_len);
+    q->ckpt_len = header_len;
+    q->ckpt_pos = q->wr_pos;
+    VC_WB_BARRIER();              /* kopia nagłówka przed flagą */
+    q->ckpt_pending = 1;
+    return VC_OK;
+}
+
+/* Zapis [rd, rd + bytes) - ciągłe odcinki pierścienia, każdy jednym f_write.
+ * Błąd: wskaźnik pliku wraca na rd, ponowienie przy kolejnym wywołaniu. */
+static uint32_t vc_wb_drain(vc_wb_t *q, uint32_t bytes)
+{
+    uint32_t rd = q->rd_pos, done = 0;
+
+    while (bytes) {
+        uint32_t off = rd & VC_WB_RING_MASK;
+        uint32_t n   = VC_WB_RING_BYTES - off;
+        if (n > bytes) n = bytes;
+
+        UINT bw = 0;
+        q->stats.writes++;
+        if (f_write(&q->file, q->ring + off, n, &bw) != FR_OK || bw != n) {
+            q->stats.io_errors++;
+            f_lseek(&q->file, rd - q->file_base);
+            break;
+        }
+        VC_WB_BARRIER();          /* odczyt z pierścienia zakończony przed zwolnieniem miejsca */
+        rd += n;
+        q->rd_pos = rd;
+        q->stats.written_bytes += n;
+        bytes -= n;
+        done  += n;
+    }
+    return done;
+}
+
+/* Punkt kontrolny do ckpt_pos: pełne bufory już zapisane przez service, reszta (< 1 bufor,
+ * bez zawinięcia - rd wyrównany do bufora) zapisywana bez zwalniania; kolejny drain zapisze
+ * ją ponownie od wyrównanego rd. Potem nagłówek i f_sync (rozmiar pliku, FAT, cache diskio). */
+static void vc_wb_do_checkpoint(vc_wb_t *q)
+{
+    VC_WB_BARRIER();              /* flaga przed kopią nagłówka */
+    /* Pełne bufory mogły już wyprzedzić ckpt_pos - wtedy nic do dopisania. */
+    uint32_t rest = ((int32_t)(q->ckpt_pos - q->rd_pos) > 0) ? q->ckpt_pos - q->rd_pos : 0u;
+    if (rest >= VC_WB_BUF_BYTES) {
+        uint32_t full = rest & ~(VC_WB_BUF_BYTES - 1u);
+        if (vc_wb_drain(q, full) != full) return;   /* ponowienie przy kolejnym service */
+        rest -= full;
+    }
+
+    const uint32_t rd = q->rd_pos;
+    const uint32_t pos = rd - q->file_base;
+    UINT bw = 0;
+    FRESULT fr = FR_OK;
+    if (rest) {
+        fr = f_write(&q->file, q->ring + (rd & VC_WB_RING_MASK), rest, &bw);
+        if (fr == FR_OK && bw != rest) fr = FR_DISK_ERR;
+        q->stats.writes++;
+    }
+    if (fr == FR_OK) fr = f_lseek(&q->file, 0);
+    if (fr == FR_OK) fr = f_write(&q->file, q->ckpt_header, q->ckpt_len, &bw);
+    if (fr == FR_OK && bw != q->ckpt_len) fr = FR_DISK_ERR;
+    if (f_lseek(&q->file, pos) != FR_OK && fr == FR_OK) fr = FR_DISK_ERR;
+    if (fr == FR_OK) fr = f_sync(&q->file);
+    if (fr != FR_OK) {
+        q->stats.io_errors++;
+        return;
+    }
+
+    q->stats.checkpoints++;
+    VC_WB_BARRIER();
+    q->ckpt_pending = 0;
+}
+
+vc_status_t vc_wb_rotate(vc_wb_t *q, const void *header, uint16_t header_len,
+                         const char *next_path, uint32_t reserve_bytes)
+{
+    if (!q || !q->is_open || !next_path || header_len > VC_WB_CKPT_HEADER_MAX) return VC_E_PARAM;
+    if (strlen(next_path) >= VC_WB_PATH_MAX) return VC_E_PARAM;
+    if (q->rot_pending) return VC_E_AGAIN;
+
+    uint32_t wr   = q->wr_pos;
+    uint32_t next = (wr + VC_WB_BUF_BYTES - 1u) & ~(VC_WB_BUF_BYTES - 1u);
+    if (next - wr > VC_WB_RING_BYTES - (wr - q->rd_pos)) return VC_E_FULL;
+
+    if (header) memcpy(q->rot_header, header, header_len);
+    q->rot_len     = header ? header_len : 0u;
+    q->rot_reserve = (reserve_bytes + VC_WB_BUF_BYTES - 1u) & ~(VC_WB_BUF_BYTES - 1u);
+    q->rot_pos     = wr;
+    q->rot_next    = next;
+    strcpy(q->rot_path, next_path);
+
+    VC_WB_BARRIER();              /* zlecenie przed flagą */
+    q->rot_pending = 1;
+    VC_WB_BARRIER();              /* flaga przed przeskokiem wr_pos (konsument: wr_pos, potem flaga) */
+    q->wr_pos = next;
+    return VC_OK;
+}
+
+void vc_wb_set_rotate_hook(vc_wb_t *q, vc_wb_rotate_hook_t hook, void *ctx)
+{
+    if (!q) return;
+    q->rot_hook     = hook;
+    q->rot_hook_ctx = ctx;
+}
+
+/* Domknięcie pliku: rezerwacja przycięta do end (offset pliku), nagłówek, f_close. */
+static vc_status_t vc_wb_close_file(vc_wb_t *q, uint32_t end, const void *header, uint16_t header_len)
+{
+    vc_status_t st = VC_OK;
+    if (q->reserved_bytes > end && f_truncate(&q->file) != FR_OK) st = VC_E_IO;
+
+    if (st == VC_OK && header && header_len) {
+        UINT bw = 0;
+        if (f_lseek(&q->file, 0) != FR_OK
+            || f_write(&q->file, header, header_len, &bw) != FR_OK || bw != header_len) {
+            st = VC_E_IO;
+        }
+    }
+    if (f_close(&q->file) != FR_OK && st == VC_OK) st = VC_E_IO;
+    return st;
+}
+
+/* Rotacja: reszta starego pliku (także niepełny bufor), zamknięcie, otwarcie nowego,
+ * przeskok rd_pos na rot_next. Błąd zapisu: ponowienie przy kolejnym service; błąd
+ * otwarcia nowego pliku: ponowienie samego otwarcia. */
+static void vc_wb_do_rotate(vc_wb_t *q)
+{
+    VC_WB_BARRIER();              /* flaga przed zleceniem */
+    if (!q->rot_closed) {
+        uint32_t rest = q->rot_pos - q->rd_pos;
+        if (vc_wb_drain(q, rest) != rest) return;
+
+        /* Punkt kontrolny starego pliku jest już zbędny. */
+        if (q->ckpt_pending && (int32_t)(q->ckpt_pos - q->rot_pos) <= 0) q->ckpt_pending = 0;
+
+        vc_status_t st = vc_wb_close_file(q, q->rot_pos - q->file_base, q->rot_header, q->rot_len);
+        if (st != VC_OK) q->stats.io_errors++;
+        q->stats.rotations++;
+        q->rot_closed = 1;
+        if (q->rot_hook) q->rot_hook(q->rot_hook_ctx, st);
+    }
+
+    if (f_open(&q->file, q->rot_path, FA_WRITE | FA_CREATE_ALWAYS) != FR_OK) {
+        q->stats.io_errors++;
+        return;
+    }
+    q->reserved_bytes = 0;
+    if (q->rot_reserve && f_expand(&q->file, q->rot_reserve, 1) == FR_OK) q->reserved_bytes = q->rot_reserve;
+
+    q->file_base  = q->rot_next;
+    q->rot_closed = 0;
+    VC_WB_BARRIER();
+    q->rd_pos      = q->rot_next;  /* zwalnia też przeskok wyrównania */
+    q->rot_pending = 0;
+}
+
+uint32_t vc_wb_service(vc_wb_t *q)
+{
+    if (!q || !q->is_open) return 0;
+
+    uint32_t wr = q->wr_pos;
+    VC_WB_BARRIER();              /* wr_pos przed danymi i przed flagą rotacji */
+    uint8_t rot = q->rot_pending;
+    uint32_t avail = (rot ? q->rot_pos : wr) - q->rd_pos;
+
+    /* Tylko pełne bufory - offset pliku zostaje wyrównany do sektora. */
+    uint32_t full = (rot && q->rot_closed) ? 0u : (avail & ~(VC_WB_BUF_BYTES - 1u));
+    uint32_t done = vc_wb_drain(q, full);
+    if (done != full) return done;
+
+    /* Rotacja dopiero, gdy widać przeskok wr_pos producenta (flaga jest ustawiana przed nim). */
+    if (rot && (int32_t)(wr - q->rot_next) >= 0) vc_wb_do_rotate(q);
+    if (q->ckpt_pending && !q->rot_pending) vc_wb_do_checkpoint(q);
+    return done;
+}
+
+void vc_wb_finish(vc_wb_t *q)
+{
+    if (q) q->finishing = 1;
+}
+
+vc_status_t vc_wb_close(vc_wb_t *q, const void *header, uint16_t header_len)
+{
+    if (!q || !q->is_open) return VC_E_PARAM;
+
+    q->finishing = 1;
+    vc_status_t st = VC_OK;
+    if (q->rot_pending) {
+        vc_wb_do_rotate(q);       /* rotacja zlecona tuż przed zamknięciem */
+        if (q->rot_pending) st = VC_E_IO;
+    }
+
+    uint32_t rest = q->wr_pos - q->rd_pos;
+    if (st == VC_OK && vc_wb_drain(q, rest) != rest) st = VC_E_IO;
+
+    /* Rezerwacja: przycięcie do zapisanych danych (wskaźnik na ich końcu). */
+    if (st == VC_OK) {
+        st = vc_wb_close_file(q, q->rd_pos - q->file_base, header, header_len);
+    } else if (!q->rot_closed) {
+        f_close(&q->file);
+    }
+    q->is_open = 0;
+
+    for (uint32_t i = 0; i < VC_WB_MAX_OPEN; i++) {
+        if (s_wb_open[i] == q) s_wb_open[i] = NULL;
+    }
+    return st;
+}
+
+void vc_wb_abort(vc_wb_t *q)
+{
+    if (!q) return;
+    q->is_open = 0;
+    for (uint32_t i = 0; i < VC_WB_MAX_OPEN; i++) {
+        if (s_wb_open[i] == q) s_wb_open[i] = NULL;
+    }
+}
+
+void vc_storage_task(void)
+{
+    for (uint32_t i = 0; i < VC_WB_MAX_OPEN; i++) {
+        vc_wb_t *q = s_wb_open[i];
+        if (q) vc_wb_service(q);
+    }
+}
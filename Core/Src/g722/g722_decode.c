@@ -31,16 +31,15 @@
 #include <memory.h>
 #include <stdlib.h>
 
+#include "arm_math.h"         /* __QADD16, read_q15x2 (FILTEZ in g722_common.h) */
 #include "g722_private.h"
 #include "g722_common.h"
 #include "g722.h"
 #include "g722_decoder.h"
 
-G722_DEC_CTX *g722_decoder_new(int rate, int options)
+G722_DEC_CTX *g722_decoder_init(G722_DEC_CTX *s, int rate, int options)
 {
-    G722_DEC_CTX *s;
-
-    if ((s = (G722_DEC_CTX *) malloc(sizeof(*s))) == NULL)
+    if (s == NULL)
         return NULL;
     memset(s, 0, sizeof(*s));
     if (rate == 48000)
@@ -61,6 +60,16 @@ G722_DEC_CTX *g722_decoder_new(int rate, int options)
 }
 /*- End of function --------------------------------------------------------*/
 
+G722_DEC_CTX *g722_decoder_new(int rate, int options)
+{
+    G722_DEC_CTX *s;
+
+    if ((s = (G722_DEC_CTX *) malloc(sizeof(*s))) == NULL)
+        return NULL;
+    return g722_decoder_init(s, rate, options);
+}
+/*- End of function --------------------------------------------------------*/
+
 int g722_decoder_destroy(G722_DEC_CTX *s)
 {
     free(s);
@@ -142,7 +151,9 @@ int g722_decode(G722_DEC_CTX *s, const uint8_t g722_data[], int len, int16_t amp
 
     outlen = 0;
     rhigh = 0;
-    for (j = 0;  j < len;  )
+    /* W trybie upakowanym dekoduj też słowa, które zostały w in_buffer po
+       ostatnim bajcie - inaczej koniec ramki przechodzi do następnego wywołania. */
+    for (j = 0;  j < len  ||  (s->packed  &&  s->in_bits >= s->bits_per_sample);  )
     {
         if (s->packed)
         {
@@ -32,16 +32,14 @@
 #include <memory.h>
 #include <stdlib.h>
 
+#include "arm_math.h"         /* __QADD16, read_q15x2 (FILTEZ in g722_common.h) */
 #include "g722_private.h"
 #include "g722_common.h"
 #include "g722_encoder.h"
 
-G722_ENC_CTX *
-g722_encoder_new(int rate, int options)
+G722_ENC_CTX *g722_encoder_init(G722_ENC_CTX *s, int rate, int options)
 {
-    G722_ENC_CTX *s;
-
-    if ((s = (G722_ENC_CTX *) malloc(sizeof(*s))) == NULL)
+    if (s == NULL)
         return NULL;
     memset(s, 0, sizeof(*s));
     if (rate == 48000)
@@ -62,6 +60,16 @@ g722_encoder_new(int rate, int options)
 }
 /*- End of function --------------------------------------------------------*/
 
+G722_ENC_CTX *g722_encoder_new(int rate, int options)
+{
+    G722_ENC_CTX *s;
+
+    if ((s = (G722_ENC_CTX *) malloc(sizeof(*s))) == NULL)
+        return NULL;
+    return g722_encoder_init(s, rate, options);
+}
+/*- End of function --------------------------------------------------------*/
+
 int g722_encoder_destroy(G722_ENC_CTX *s)
 {
     free(s);
@@ -28,6 +28,8 @@
 //#include "vc_filters.h"
 //#include "vc_data_if.h"
  #include "app/app_main.h"
+ #include "fatfs/vc_write_behind.h"
+ #include "app/cli.h"
 //#include <stdio.h>
 /* USER CODE END Includes */
 
@@ -47,6 +49,8 @@
 /* USER CODE END PM */
 
 /* Private variables ---------------------------------------------------------*/
+CRC_HandleTypeDef hcrc;
+
 I2C_HandleTypeDef hi2c1;
 
 I2S_HandleTypeDef hi2s3;
@@ -66,6 +70,7 @@ static void MX_I2C1_Init(void);
 static void MX_I2S3_Init(void);
 static void MX_SPI1_Init(void);
 static void MX_USART2_UART_Init(void);
+static void MX_CRC_Init(void);
 void MX_USB_HOST_Process(void);
 
 /* USER CODE BEGIN PFP */
@@ -131,8 +136,9 @@ int main(void)
   MX_USART2_UART_Init();
   MX_FATFS_Init();
   MX_USB_HOST_Init();
+  MX_CRC_Init();
   /* USER CODE BEGIN 2 */
-
+  CLI_Init(&huart2);
   /* USER CODE END 2 */
 
   /* Infinite loop */
@@ -144,6 +150,10 @@ int main(void)
     MX_USB_HOST_Process();
 
     /* USER CODE BEGIN 3 */
+    // Zapis write-behind: pełne bufory sektorowe na pendrive, gdy USB jest gotowe
+    vc_storage_task();
+    // Polecenia UART (ls / play po nazwie z indeksu nagrań)
+    CLI_Process();
   }
   /* USER CODE END 3 */
 }
@@ -332,6 +342,32 @@ static void MX_USART2_UART_Init(void)
 
 }
 
+/**
+  * @brief CRC Initialization Function
+  * @param None
+  * @retval None
+  */
+static void MX_CRC_Init(void)
+{
+
+  /* USER CODE BEGIN CRC_Init 0 */
+
+  /* USER CODE END CRC_Init 0 */
+
+  /* USER CODE BEGIN CRC_Init 1 */
+
+  /* USER CODE END CRC_Init 1 */
+  hcrc.Instance = CRC;
+  if (HAL_CRC_Init(&hcrc) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  /* USER CODE BEGIN CRC_Init 2 */
+
+  /* USER CODE END CRC_Init 2 */
+
+}
+
 /**
   * @brief GPIO Initialization Function
   * @param None
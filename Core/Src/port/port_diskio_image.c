@@ -0,0 +1,203 @@
+#include "port/port_diskio_image.h"
+
+#ifdef VC_HOST_BUILD
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static FILE             *s_img;
+static uint32_t          s_sectors;
+static uint32_t          s_data_start;
+static port_img_faults_t s_faults;
+static port_img_stats_t  s_stats;
+static uint32_t          s_nreads, s_nwrites;      /* operacje od port_img_set_faults */
+static uint8_t           s_failed;
+static DWORD             s_next_read, s_next_write;
+
+static void port_img_delay(uint32_t us)
+{
+    if (!us) return;
+    struct timespec ts = { (time_t)(us / 1000000u), (long)(us % 1000000u) * 1000L };
+    nanosleep(&ts, NULL);
+    s_stats.delay_us += us;
+}
+
+static unsigned port_img_bucket(UINT count)
+{
+    if (count <= 1u)   return 0u;
+    if (count < 8u)    return 1u;
+    if (count < 16u)   return 2u;
+    if (count < 64u)   return 3u;
+    if (count < 128u)  return 4u;
+    return 5u;
+}
+
+/* Wstrzyknięty błąd N-tej operacji (albo każdej po pierwszym, fail_sticky). */
+static uint8_t port_img_fail(uint32_t n, uint32_t at)
+{
+    if (s_failed && s_faults.fail_sticky) return 1u;
+    if (at == 0u || n != at) return 0u;
+    s_failed = 1u;
+    return 1u;
+}
+
+vc_status_t port_img_open(const char *path, uint32_t sectors)
+{
+    if (!path) return VC_E_PARAM;
+    port_img_close();
+
+    s_img = fopen(path, sectors ? "w+b" : "r+b");
+    if (!s_img) return VC_E_IO;
+    if (sectors) {
+        /* rzadki plik: nieużywane sektory nie zajmują miejsca na dysku hosta */
+        if (ftruncate(fileno(s_img), (off_t)sectors * PORT_IMG_SECTOR_BYTES) != 0) {
+            port_img_close();
+            return VC_E_IO;
+        }
+        s_sectors = sectors;
+    } else {
+        fseek(s_img, 0, SEEK_END);
+        s_sectors = (uint32_t)(ftell(s_img) / PORT_IMG_SECTOR_BYTES);
+    }
+    s_data_start = 0;
+    port_img_set_faults(NULL);
+    port_img_reset_stats();
+    return VC_OK;
+}
+
+void port_img_close(void)
+{
+    if (s_img) fclose(s_img);
+    s_img = NULL;
+    s_sectors = 0;
+}
+
+void port_img_set_faults(const port_img_faults_t *f)
+{
+    if (f) s_faults = *f;
+    else   memset(&s_faults, 0, sizeof(s_faults));
+    s_nreads = s_nwrites = 0;
+    s_failed = 0;
+}
+
+void port_img_set_data_start(uint32_t sector)
+{
+    s_data_start = sector;
+}
+
+void port_img_get_stats(port_img_stats_t *s)
+{
+    if (s) *s = s_stats;
+}
+
+void port_img_reset_stats(void)
+{
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_next_read = s_next_write = (DWORD)-1;
+}
+
+static DSTATUS IMG_initialize(BYTE lun)
+{
+    (void)lun;
+    return s_img ? 0 : STA_NOINIT;
+}
+
+static DSTATUS IMG_status(BYTE lun)
+{
+    (void)lun;
+    return s_img ? 0 : STA_NOINIT;
+}
+
+static DRESULT IMG_read(BYTE lun, BYTE *buff, DWORD sector, UINT count)
+{
+    (void)lun;
+    if (!s_img) return RES_NOTRDY;
+    if ((uint64_t)sector + count > s_sectors) return RES_PARERR;
+
+    s_stats.reads++;
+    s_stats.read_sectors += count;
+    s_stats.read_sizes[port_img_bucket(count)]++;
+    if (sector == s_next_read) s_stats.seq_reads++;
+    s_next_read = sector + count;
+
+    port_img_delay(s_faults.read_us + s_faults.sector_us * count);
+    if (port_img_fail(++s_nreads, s_faults.fail_read_at)) {
+        s_stats.errors++;
+        return RES_ERROR;
+    }
+
+    if (fseek(s_img, (long)sector * PORT_IMG_SECTOR_BYTES, SEEK_SET) != 0
+        || fread(buff, PORT_IMG_SECTOR_BYTES, count, s_img) != count) return RES_ERROR;
+    return RES_OK;
+}
+
+#if _USE_WRITE == 1
+static DRESULT IMG_write(BYTE lun, const BYTE *buff, DWORD sector, UINT count)
+{
+    (void)lun;
+    if (!s_img) return RES_NOTRDY;
+    if ((uint64_t)sector + count > s_sectors) return RES_PARERR;
+
+    s_stats.writes++;
+    s_stats.write_sectors += count;
+    s_stats.write_sizes[port_img_bucket(count)]++;
+    if (sector == s_next_write) s_stats.seq_writes++;
+    if (sector < s_data_start) s_stats.fat_writes++;
+    s_next_write = sector + count;
+
+    uint32_t us = s_faults.write_us + s_faults.sector_us * count;
+    if (s_faults.stall_every && (s_nwrites + 1u) % s_faults.stall_every == 0u) us += s_faults.stall_us;
+    port_img_delay(us);
+    if (port_img_fail(++s_nwrites, s_faults.fail_write_at)) {
+        s_stats.errors++;
+        return RES_ERROR;
+    }
+
+    if (fseek(s_img, (long)sector * PORT_IMG_SECTOR_BYTES, SEEK_SET) != 0
+        || fwrite(buff, PORT_IMG_SECTOR_BYTES, count, s_img) != count) return RES_ERROR;
+    return RES_OK;
+}
+#endif /* _USE_WRITE == 1 */
+
+#if _USE_IOCTL == 1
+static DRESULT IMG_ioctl(BYTE lun, BYTE cmd, void *buff)
+{
+    (void)lun;
+    if (!s_img) return RES_NOTRDY;
+
+    switch (cmd) {
+    case CTRL_SYNC:
+        s_stats.syncs++;
+        port_img_delay(s_faults.sync_us);
+        return (fflush(s_img) == 0) ? RES_OK : RES_ERROR;
+    case GET_SECTOR_COUNT:
+        *(DWORD *)buff = s_sectors;
+        return RES_OK;
+    case GET_SECTOR_SIZE:
+        *(WORD *)buff = PORT_IMG_SECTOR_BYTES;
+        return RES_OK;
+    case GET_BLOCK_SIZE:
+        *(DWORD *)buff = 1;   /* nieznany rozmiar bloku kasowania */
+        return RES_OK;
+    default:
+        return RES_PARERR;
+    }
+}
+#endif /* _USE_IOCTL == 1 */
+
+const Diskio_drvTypeDef IMG_Driver =
+{
+  IMG_initialize,
+  IMG_status,
+  IMG_read,
+#if  _USE_WRITE == 1
+  IMG_write,
+#endif /* _USE_WRITE == 1 */
+#if  _USE_IOCTL == 1
+  IMG_ioctl,
+#endif /* _USE_IOCTL == 1 */
+};
+
+#endif /* VC_HOST_BUILD */
@@ -0,0 +1,82 @@
+#include "port/port_flash_sim.h"
+#include <string.h>
+
+static vc_status_t port_flash_sim_program(port_flash_dev_t *d, uint32_t offset, const void *data, uint32_t len)
+{
+    port_flash_sim_t *sim = (port_flash_sim_t *)d;
+    const uint8_t *src = (const uint8_t *)data;
+
+    if (sim->dead) return VC_E_IO;
+    if ((offset | len) & 3u || offset + len > (uint32_t)d->sectors * d->sector_bytes || sim->erasing >= 0) {
+        sim->violations++;
+        return VC_E_IO;
+    }
+    for (uint32_t i = 0; i < len; i++) {
+        if (sim->cut_after && sim->programmed >= sim->cut_after) {
+            sim->dead = 1;
+            return VC_E_IO;
+        }
+        if (src[i] & (uint8_t)~sim->mem[offset + i]) {   /* 0 -> 1 bez kasowania */
+            sim->violations++;
+            return VC_E_IO;
+        }
+        sim->mem[offset + i] = src[i];
+        sim->programmed++;
+    }
+    return VC_OK;
+}
+
+static vc_status_t port_flash_sim_erase_start(port_flash_dev_t *d, uint16_t sector)
+{
+    port_flash_sim_t *sim = (port_flash_sim_t *)d;
+    if (sim->dead) return VC_E_IO;
+    if (sector >= d->sectors || sim->erasing >= 0) {
+        sim->violations++;
+        return VC_E_IO;
+    }
+    sim->erasing = (int16_t)sector;
+    sim->busy = sim->erase_polls;
+    return VC_OK;
+}
+
+static vc_status_t port_flash_sim_erase_poll(port_flash_dev_t *d)
+{
+    port_flash_sim_t *sim = (port_flash_sim_t *)d;
+    if (sim->dead) return VC_E_IO;
+    if (sim->erasing < 0) return VC_OK;
+    if (sim->busy) {
+        sim->busy--;
+        return VC_E_AGAIN;
+    }
+    memset(sim->mem + (uint32_t)sim->erasing * d->sector_bytes, 0xFF, d->sector_bytes);
+    sim->erase_count[sim->erasing]++;
+    sim->erasing = -1;
+    return VC_OK;
+}
+
+void port_flash_sim_init(port_flash_sim_t *sim, uint8_t *mem, uint32_t sector_bytes, uint16_t sectors)
+{
+    memset(sim, 0, sizeof(*sim));
+    sim->dev.base         = mem;
+    sim->dev.sector_bytes = sector_bytes;
+    sim->dev.sectors      = sectors;
+    sim->dev.program      = port_flash_sim_program;
+    sim->dev.erase_start  = port_flash_sim_erase_start;
+    sim->dev.erase_poll   = port_flash_sim_erase_poll;
+    sim->mem              = mem;
+    sim->erasing          = -1;
+    sim->erase_polls      = 3;
+    memset(mem, 0xFF, (uint32_t)sector_bytes * sectors);
+}
+
+void port_flash_sim_power_cycle(port_flash_sim_t *sim)
+{
+    /* Kasowanie przerwane w połowie: stan sektora nieokreślony. */
+    if (sim->erasing >= 0) {
+        memset(sim->mem + (uint32_t)sim->erasing * sim->dev.sector_bytes, 0xFF, sim->dev.sector_bytes / 2u);
+        sim->erasing = -1;
+    }
+    sim->dead = 0;
+    sim->cut_after = 0;
+    sim->busy = 0;
+}
@@ -0,0 +1,839 @@
+#include "port/port_storage_flash.h"
+#include "voicecmd/vc_crc32.h"
+#include <stddef.h>
+#include <string.h>
+
+/* Nagłówek sektora (16 B): magic i licznik kasowań programowane po kasowaniu,
+ * seq przy przydziale do logu (do tego czasu 0xFFFFFFFF). */
+#define PF_SECTOR_HDR_BYTES  16u
+#define PF_OFF_MAGIC         0u
+#define PF_OFF_ERASES        4u
+#define PF_OFF_SEQ           8u
+#define PF_ERASED_WORD       0xFFFFFFFFu
+
+/* Nagłówek rekordu (16 B), programowany po payloadzie - zatwierdza rekord. */
+typedef struct {
+    uint16_t type;
+    uint16_t len;
+    uint16_t id;
+    uint16_t reserved;
+    uint32_t offset;        /* DATA: offset payloadu w pliku (kopie z GC są równoważne) */
+    uint32_t crc;           /* CRC-32 pól powyżej i payloadu */
+} pf_rec_t;
+
+enum {
+    PF_REC_OPEN   = 1,      /* payload: nazwa (PORT_FLASH_NAME_MAX) */
+    PF_REC_DATA   = 2,
+    PF_REC_HEADER = 3,
+    PF_REC_CLOSE  = 4,
+    PF_REC_DELETE = 5,
+};
+
+#define PF_REC_BYTES         ((uint32_t)sizeof(pf_rec_t))
+#define PF_ALIGN4(n)         (((n) + 3u) & ~3u)
+#define PF_SLOT_BYTES        (PF_REC_BYTES + PORT_FLASH_CHUNK_BYTES)
+#define PF_WRITER_SLOTS_KEEP 2u     /* zamknięcie (HEADER + CLOSE) i zapas na DELETE */
+#define PF_WEAR_DELTA        8u     /* różnica liczników kasowań uruchamiająca przeniesienie */
+
+static uint32_t pf_word(const port_flash_t *fs, uint32_t off)
+{
+    uint32_t w;
+    memcpy(&w, fs->dev->base + off, sizeof(w));
+    return w;
+}
+
+static uint32_t pf_sector_base(const port_flash_t *fs, uint16_t s)
+{
+    return (uint32_t)s * fs->dev->sector_bytes;
+}
+
+static uint8_t pf_blank(const port_flash_t *fs, uint32_t off, uint32_t len)
+{
+    const uint8_t *p = fs->dev->base + off;
+    for (uint32_t i = 0; i < len; i++) if (p[i] != 0xFFu) return 0;
+    return 1;
+}
+
+static uint32_t pf_rec_crc(const pf_rec_t *h, const void *payload)
+{
+    vc_crc32_t c;
+    vc_crc32_init(&c);
+    vc_crc32_update(&c, h, offsetof(pf_rec_t, crc));
+    vc_crc32_update(&c, payload, h->len);
+    return vc_crc32_final(&c);
+}
+
+static port_flash_file_t *pf_file_by_id(port_flash_t *fs, uint16_t id)
+{
+    for (uint32_t i = 0; i < PORT_FLASH_MAX_FILES; i++)
+        if (id && fs->file[i].id == id) return &fs->file[i];
+    return NULL;
+}
+
+static port_flash_file_t *pf_file_by_name(port_flash_t *fs, const char *name)
+{
+    for (uint32_t i = 0; i < PORT_FLASH_MAX_FILES; i++)
+        if (fs->file[i].id && strncmp(fs->file[i].name, name, PORT_FLASH_NAME_MAX) == 0) return &fs->file[i];
+    return NULL;
+}
+
+/* Wpis nagrania id; brak - nowy (przy montowaniu rekordy mogą wyprzedzać OPEN przeniesione
+ * przez GC, nazwa uzupełniana z OPEN). NULL: brak wolnego wpisu. */
+static port_flash_file_t *pf_file_get(port_flash_t *fs, uint16_t id)
+{
+    port_flash_file_t *f = pf_file_by_id(fs, id);
+    if (f || !id || fs->file_count >= PORT_FLASH_MAX_FILES) return f;
+    for (uint32_t i = 0; !f && i < PORT_FLASH_MAX_FILES; i++) if (!fs->file[i].id) f = &fs->file[i];
+    memset(f, 0, sizeof(*f));
+    f->id = id;
+    fs->file_count++;
+    return f;
+}
+
+/* Nagranie znika z mapy; reclaim: sektory bez żywych nagrań (poza aktywnym) -> do
+ * skasowania (przy montowaniu dopiero po odtworzeniu całego logu). */
+static void pf_file_drop(port_flash_t *fs, port_flash_file_t *f, uint8_t reclaim)
+{
+    for (uint16_t s = 0; s < fs->dev->sectors; s++) {
+        if (!(f->sector_mask & (1u << s))) continue;
+        port_flash_sector_t *sec = &fs->sector[s];
+        if (sec->files) sec->files--;
+        if (reclaim && sec->files == 0 && (int16_t)s != fs->active) sec->state = PORT_FLASH_S_DIRTY;
+    }
+    memset(f, 0, sizeof(*f));
+    fs->file_count--;
+}
+
+static void pf_file_touch(port_flash_t *fs, port_flash_file_t *f, uint16_t s)
+{
+    if (f->sector_mask & (1u << s)) return;
+    f->sector_mask |= (uint8_t)(1u << s);
+    fs->sector[s].files++;
+}
+
+/* Skasowany sektor o najmniejszym liczniku kasowań (-1: brak). */
+static int16_t pf_pick_erased(const port_flash_t *fs)
+{
+    int16_t best = -1;
+    for (uint16_t s = 0; s < fs->dev->sectors; s++) {
+        if (fs->sector[s].state != PORT_FLASH_S_ERASED) continue;
+        if (best < 0 || fs->sector[s].erase_count < fs->sector[best].erase_count) best = (int16_t)s;
+    }
+    return best;
+}
+
+/* Pełne sloty rekordu DATA (nagłówek + PORT_FLASH_CHUNK_BYTES) w wolnym miejscu.
+ * reserve: bez jednego skasowanego sektora - zapas na przenoszenie nagrań (GC). */
+static uint32_t pf_free_slots(const port_flash_t *fs, uint8_t reserve)
+{
+    const uint32_t sb = fs->dev->sector_bytes;
+    const uint32_t per_sector = (sb - PF_SECTOR_HDR_BYTES) / PF_SLOT_BYTES;
+    uint32_t slots = 0;
+    uint8_t  erased = 0;
+    if (fs->active >= 0) slots += (sb - fs->sector[fs->active].used) / PF_SLOT_BYTES;
+    for (uint16_t s = 0; s < fs->dev->sectors; s++) {
+        if (fs->sector[s].state != PORT_FLASH_S_ERASED) continue;
+        slots += per_sector;
+        erased = 1;
+    }
+    return (reserve && erased) ? slots - per_sector : slots;
+}
+
+/* Przydział skasowanego sektora do logu: nagłówek (jeśli pusty po fabryce) + seq. */
+static vc_status_t pf_open_sector(port_flash_t *fs)
+{
+    int16_t s = pf_pick_erased(fs);
+    if (s < 0) return VC_E_FULL;
+
+    uint32_t base = pf_sector_base(fs, (uint16_t)s);
+    uint32_t hdr[3] = { PORT_FLASH_SECTOR_MAGIC, fs->sector[s].erase_count, fs->next_seq };
+    vc_status_t st = (pf_word(fs, base + PF_OFF_MAGIC) == PF_ERASED_WORD)
+                   ? fs->dev->program(fs->dev, base, hdr, sizeof(hdr))
+                   : fs->dev->program(fs->dev, base + PF_OFF_SEQ, &hdr[2], sizeof(hdr[2]));
+    if (st != VC_OK) {
+        fs->sector[s].state = PORT_FLASH_S_DIRTY;
+        fs->sector[s].seq   = 0;
+        return st;
+    }
+    fs->sector[s].state = PORT_FLASH_S_LOG;
+    fs->sector[s].seq   = fs->next_seq++;
+    fs->sector[s].used  = PF_SECTOR_HDR_BYTES;
+    fs->sector[s].files = 0;
+    fs->active = s;
+    return VC_OK;
+}
+
+/* Dopisuje rekord: payload, potem nagłówek. *payload_at = offset payloadu w urządzeniu. */
+static vc_status_t pf_append(port_flash_t *fs, uint16_t type, uint16_t id, uint32_t offset,
+                             const void *payload, uint16_t len, uint32_t *payload_at)
+{
+    const uint32_t size = PF_REC_BYTES + PF_ALIGN4((uint32_t)len);
+    vc_status_t st;
+
+    if (fs->active < 0 || fs->sector[fs->active].used + size > fs->dev->sector_bytes) {
+        int16_t old = fs->active;
+        if ((st = pf_open_sector(fs)) != VC_OK) return st;
+        if (old >= 0 && fs->sector[old].files == 0) fs->sector[old].state = PORT_FLASH_S_DIRTY;
+    }
+
+    port_flash_sector_t *sec = &fs->sector[fs->active];
+    uint32_t at = pf_sector_base(fs, (uint16_t)fs->active) + sec->used;
+    pf_rec_t h = { type, len, id, 0u, offset, 0u };
+    h.crc = pf_rec_crc(&h, payload);
+
+    /* Zajęte także przy błędzie - miejsce może być częściowo zaprogramowane. */
+    sec->used += size;
+    st = VC_OK;
+    if (len >= 4u) st = fs->dev->program(fs->dev, at + PF_REC_BYTES, payload, len & ~3u);
+    if (st == VC_OK && (len & 3u)) {
+        uint32_t tail = PF_ERASED_WORD;
+        memcpy(&tail, (const uint8_t *)payload + (len & ~3u), len & 3u);
+        st = fs->dev->program(fs->dev, at + PF_REC_BYTES + (len & ~3u), &tail, sizeof(tail));
+    }
+    if (st == VC_OK) st = fs->dev->program(fs->dev, at, &h, sizeof(h));
+    if (st != VC_OK) return VC_E_IO;
+
+    port_flash_file_t *f = pf_file_by_id(fs, id);
+    if (f) pf_file_touch(fs, f, (uint16_t)fs->active);
+    if (payload_at) *payload_at = at + PF_REC_BYTES;
+    return VC_OK;
+}
+
+/* Kolejny sektor logu po seq (-1: koniec). */
+static int16_t pf_next_log_sector(const port_flash_t *fs, int16_t cur)
+{
+    int16_t best = -1;
+    for (uint16_t s = 0; s < fs->dev->sectors; s++) {
+        const port_flash_sector_t *sec = &fs->sector[s];
+        if (sec->state != PORT_FLASH_S_LOG) continue;
+        if (cur >= 0 && sec->seq <= fs->sector[cur].seq) continue;
+        if (best < 0 || sec->seq < fs->sector[best].seq) best = (int16_t)s;
+    }
+    return best;
+}
+
+/* Następny rekord sektora s od *at do końca logu; słowa 0 (zamazany przerwany zapis)
+ * pomijane, *at = offset rekordu. crc = 0: tylko nagłówek (przeglądanie). 0: koniec. */
+static uint8_t pf_next_rec(const port_flash_t *fs, uint16_t s, uint32_t *at, pf_rec_t *h, uint8_t crc)
+{
+    const uint32_t base = pf_sector_base(fs, s);
+    const uint32_t end  = fs->sector[s].used;
+
+    while (*at + 4u <= end && pf_word(fs, base + *at) == 0u) *at += 4u;
+    if (*at + PF_REC_BYTES > end) return 0;
+    memcpy(h, fs->dev->base + base + *at, sizeof(*h));
+    if (h->type < PF_REC_OPEN || h->type > PF_REC_DELETE || h->len > PORT_FLASH_CHUNK_BYTES) return 0;
+    if (*at + PF_REC_BYTES + PF_ALIGN4((uint32_t)h->len) > end) return 0;
+    return !crc || pf_rec_crc(h, fs->dev->base + base + *at + PF_REC_BYTES) == h->crc;
+}
+
+/* Odtwarza nagrania z rekordów sektora s. */
+static void pf_replay_sector(port_flash_t *fs, uint16_t s)
+{
+    const uint32_t sb = fs->dev->sector_bytes;
+    const uint32_t base = pf_sector_base(fs, s);
+    uint32_t at = PF_SECTOR_HDR_BYTES;
+    pf_rec_t h;
+
+    fs->sector[s].used = sb;
+    while (pf_next_rec(fs, s, &at, &h, 1)) {
+        port_flash_file_t *f = (h.type == PF_REC_DELETE) ? pf_file_by_id(fs, h.id) : pf_file_get(fs, h.id);
+        const uint8_t *payload = fs->dev->base + base + at + PF_REC_BYTES;
+
+        switch (h.type) {
+        case PF_REC_OPEN:
+            if (f) {
+                memcpy(f->name, payload, PORT_FLASH_NAME_MAX);
+                f->name[PORT_FLASH_NAME_MAX - 1u] = '\0';
+            }
+            break;
+        case PF_REC_DATA:
+            if (f && h.offset + h.len > f->bytes) f->bytes = h.offset + h.len;
+            break;
+        case PF_REC_HEADER:
+            if (f && h.len <= PORT_FLASH_HEADER_MAX) {
+                f->header_at  = base + at + PF_REC_BYTES;
+                f->header_len = h.len;
+            }
+            break;
+        case PF_REC_CLOSE:
+            if (f) f->closed = 1;
+            break;
+        case PF_REC_DELETE:
+            if (f) pf_file_drop(fs, f, 0);
+            f = NULL;
+            break;
+        default:
+            break;
+        }
+        if (f) pf_file_touch(fs, f, s);
+        if (h.id >= fs->next_id) fs->next_id = (uint16_t)(h.id + 1u);
+        at += PF_REC_BYTES + PF_ALIGN4((uint32_t)h.len);
+    }
+
+    /* Za końcem logu coś jest - przerwany zapis: zamazany zerami (pomijane przy odczycie),
+     * dopisywanie za nim. Gdy zamazanie się nie uda, sektor zamknięty. */
+    if (at < sb && !pf_blank(fs, base + at, sb - at)) {
+        static const uint32_t zero[16];
+        uint32_t end = sb;
+        while (pf_word(fs, base + end - 4u) == PF_ERASED_WORD) end -= 4u;
+        for (uint32_t n; at < end; at += n) {
+            n = (end - at < sizeof(zero)) ? end - at : sizeof(zero);
+            if (fs->dev->program(fs->dev, base + at, zero, n) != VC_OK) {
+                at = sb;
+                break;
+            }
+        }
+    }
+    fs->sector[s].used = at;
+}
+
+/* Rekord h sektora s już skopiowany przez przerwany GC: identyczny nagłówek (z CRC
+ * payloadu, programowany po nim) w innym sektorze nagrania. */
+static uint8_t pf_gc_copied(port_flash_t *fs, const port_flash_file_t *f, uint16_t s, const pf_rec_t *h)
+{
+    pf_rec_t c;
+    for (uint16_t t = 0; t < fs->dev->sectors; t++) {
+        if (t == s || !(f->sector_mask & (1u << t))) continue;
+        for (uint32_t at = PF_SECTOR_HDR_BYTES; pf_next_rec(fs, t, &at, &c, 0);
+             at += PF_REC_BYTES + PF_ALIGN4((uint32_t)c.len))
+            if (memcmp(&c, h, sizeof(c)) == 0) return 1;
+    }
+    return 0;
+}
+
+/* Rekord sektora s potrzebny po jego skasowaniu: żywego nagrania, nie nieaktualny HEADER
+ * i bez kopii. */
+static uint8_t pf_gc_needed(port_flash_t *fs, uint16_t s, uint32_t payload_at, const pf_rec_t *h)
+{
+    const port_flash_file_t *f = pf_file_by_id(fs, h->id);
+    if (!f || h->type == PF_REC_DELETE) return 0;
+    if (h->type == PF_REC_HEADER && f->header_at != payload_at) return 0;
+    return !pf_gc_copied(fs, f, s, h);
+}
+
+/* Koniec zajętej części sektora s; *need = bajty żywych rekordów do przeniesienia. */
+static uint32_t pf_gc_live(port_flash_t *fs, uint16_t s, uint32_t *need)
+{
+    const uint32_t base = pf_sector_base(fs, s);
+    uint32_t at = PF_SECTOR_HDR_BYTES;
+    pf_rec_t h;
+
+    *need = 0;
+    while (pf_next_rec(fs, s, &at, &h, 1)) {
+        uint32_t size = PF_REC_BYTES + PF_ALIGN4((uint32_t)h.len);
+        if (pf_gc_needed(fs, s, base + at + PF_REC_BYTES, &h)) *need += size;
+        at += size;
+    }
+    return PF_SECTOR_HDR_BYTES + *need;
+}
+
+/* Przenosi żywe rekordy sektora s na koniec logu (ten sam id i offset - przy zaniku
+ * zasilania w trakcie kopie są równoważne) i oddaje sektor do skasowania. */
+static vc_status_t pf_gc_sector(port_flash_t *fs, uint16_t s)
+{
+    static uint8_t buf[PORT_FLASH_CHUNK_BYTES] __attribute__((aligned(4)));
+    const uint32_t base = pf_sector_base(fs, s);
+    uint32_t at = PF_SECTOR_HDR_BYTES;
+    pf_rec_t h;
+
+    while (pf_next_rec(fs, s, &at, &h, 1)) {
+        uint32_t payload_at = base + at + PF_REC_BYTES, new_at;
+        at += PF_REC_BYTES + PF_ALIGN4((uint32_t)h.len);
+        if (!pf_gc_needed(fs, s, payload_at, &h)) continue;
+
+        memcpy(buf, fs->dev->base + payload_at, h.len);   /* źródło we flash - kopia w RAM */
+        vc_status_t st = pf_append(fs, h.type, h.id, h.offset, buf, h.len, &new_at);
+        if (st != VC_OK) return st;
+        if (h.type == PF_REC_HEADER) pf_file_by_id(fs, h.id)->header_at = new_at;
+        fs->relocated += h.len;
+    }
+
+    for (uint32_t i = 0; i < PORT_FLASH_MAX_FILES; i++) fs->file[i].sector_mask &= (uint8_t)~(1u << s);
+    fs->sector[s].files = 0;
+    fs->sector[s].state = PORT_FLASH_S_DIRTY;
+    return VC_OK;
+}
+
+vc_status_t port_flash_mount(port_flash_t *fs, port_flash_dev_t *dev)
+{
+    if (!fs || !dev || !dev->sectors || dev->sectors > PORT_FLASH_MAX_SECTORS) return VC_E_PARAM;
+
+    memset(fs, 0, sizeof(*fs));
+    fs->dev     = dev;
+    fs->active  = -1;
+    fs->erasing = -1;
+    fs->next_id = 1;
+
+    uint32_t max_erases = 0;
+    for (uint16_t s = 0; s < dev->sectors; s++) {
+        port_flash_sector_t *sec = &fs->sector[s];
+        uint32_t base = pf_sector_base(fs, s);
+        uint32_t magic = pf_word(fs, base + PF_OFF_MAGIC);
+
+        if (magic == PORT_FLASH_SECTOR_MAGIC) {
+            sec->erase_count = pf_word(fs, base + PF_OFF_ERASES);
+            sec->seq = pf_word(fs, base + PF_OFF_SEQ);
+            if (sec->seq != PF_ERASED_WORD) sec->state = PORT_FLASH_S_LOG;
+            else if (pf_blank(fs, base + PF_SECTOR_HDR_BYTES, dev->sector_bytes - PF_SECTOR_HDR_BYTES))
+                sec->state = PORT_FLASH_S_ERASED;
+            else
+                sec->state = PORT_FLASH_S_DIRTY;
+            if (sec->erase_count > max_erases) max_erases = sec->erase_count;
+        } else {
+            /* Pusty po fabryce: gotowy (nagłówek przy przydziale); inaczej np. przerwane kasowanie. */
+            sec->state = pf_blank(fs, base, dev->sector_bytes) ? PORT_FLASH_S_ERASED : PORT_FLASH_S_DIRTY;
+            sec->erase_count = PF_ERASED_WORD;   /* nieznany - niżej */
+        }
+    }
+    /* Utracony licznik: zachowawczo jak najbardziej zużyty sektor. Poza logiem seq bez
+     * znaczenia - 0, żeby śmieci mogły być kasowane od razu. */
+    for (uint16_t s = 0; s < dev->sectors; s++) {
+        if (fs->sector[s].erase_count == PF_ERASED_WORD) fs->sector[s].erase_count = max_erases;
+        if (fs->sector[s].state != PORT_FLASH_S_LOG) fs->sector[s].seq = 0;
+    }
+
+    for (int16_t s = pf_next_log_sector(fs, -1); s >= 0; s = pf_next_log_sector(fs, s)) {
+        pf_replay_sector(fs, (uint16_t)s);
+        fs->active = s;
+        fs->next_seq = fs->sector[s].seq + 1u;
+    }
+
+    /* Nagranie bez OPEN (nie powinno wystąpić - OPEN przenoszony razem z resztą). */
+    for (uint32_t i = 0; i < PORT_FLASH_MAX_FILES; i++)
+        if (fs->file[i].id && !fs->file[i].name[0]) pf_file_drop(fs, &fs->file[i], 0);
+
+    /* Dopisywanie do ostatniego sektora, o ile ma miejsce; sektory bez nagrań do skasowania. */
+    if (fs->active >= 0 && fs->sector[fs->active].used + PF_REC_BYTES > dev->sector_bytes) fs->active = -1;
+    for (uint16_t s = 0; s < dev->sectors; s++) {
+        port_flash_sector_t *sec = &fs->sector[s];
+        if (sec->state == PORT_FLASH_S_LOG && sec->files == 0 && (int16_t)s != fs->active)
+            sec->state = PORT_FLASH_S_DIRTY;
+    }
+    return VC_OK;
+}
+
+vc_status_t port_flash_service(port_flash_t *fs)
+{
+    if (!fs || !fs->dev) return VC_E_PARAM;
+    port_flash_dev_t *dev = fs->dev;
+
+    if (fs->erasing >= 0) {       /* rozpoczęte przed otwarciem czytnika - sektor DIRTY, poza nim */
+        vc_status_t st = dev->erase_poll(dev);
+        if (st == VC_E_AGAIN) return VC_E_AGAIN;
+
+        port_flash_sector_t *sec = &fs->sector[fs->erasing];
+        uint32_t hdr[2] = { PORT_FLASH_SECTOR_MAGIC, sec->erase_count + 1u };
+        if (st == VC_OK) st = dev->program(dev, pf_sector_base(fs, (uint16_t)fs->erasing), hdr, sizeof(hdr));
+        if (st == VC_OK) {
+            sec->erase_count++;
+            sec->state = PORT_FLASH_S_ERASED;
+            sec->seq   = 0;
+            sec->used  = PF_SECTOR_HDR_BYTES;
+            sec->files = 0;
+            fs->erases++;
+        }
+        fs->erasing = -1;
+        if (st != VC_OK) return VC_E_IO;
+    }
+
+    /* Kasowanie tylko od najstarszego sektora logu: rekord DELETE nie może zniknąć
+     * wcześniej niż dane, które usuwa (inaczej po zaniku zasilania nagranie by wróciło). */
+    int16_t tail = pf_next_log_sector(fs, -1);
+    int16_t pick = -1;
+    uint8_t waiting = 0;
+    for (uint16_t s = 0; s < dev->sectors; s++) {
+        if (fs->sector[s].state != PORT_FLASH_S_DIRTY) continue;
+        if (tail >= 0 && fs->sector[s].seq > fs->sector[tail].seq) {
+            waiting = 1;
+            continue;
+        }
+        if (pick < 0 || fs->sector[s].seq < fs->sector[pick].seq) pick = (int16_t)s;
+    }
+    if (pick < 0) {
+        /* Brak gotowego: przeniesienie żywych rekordów z najstarszego sektora (GC), gdy
+         * kończy się skasowane miejsce, albo gdy zalega w nim statyczne nagranie (zużycie). */
+        if (tail < 0 || tail == fs->active) return VC_OK;
+        uint32_t need, max_erases = 0, stamp = fs->next_seq + fs->file_count;
+        uint16_t erased = 0;
+        for (uint16_t s = 0; s < dev->sectors; s++) {
+            if (fs->sector[s].state == PORT_FLASH_S_ERASED) erased++;
+            if (fs->sector[s].erase_count > max_erases) max_erases = fs->sector[s].erase_count;
+            stamp += fs->sector[s].used;
+        }
+        uint8_t wear = fs->sector[tail].erase_count + PF_WEAR_DELTA < max_erases;
+        if (erased > 1u && !wear) return VC_OK;
+        if (fs->writers || fs->readers || fs->suspends) return VC_E_AGAIN;
+        if (stamp == fs->gc_idle) return VC_OK;     /* log bez zmian od ostatniej oceny */
+
+        uint32_t live = pf_gc_live(fs, (uint16_t)tail, &need);
+        uint8_t low = erased <= 1u && (waiting || live < fs->sector[tail].used);
+        uint8_t fits = erased || (fs->active >= 0 && fs->sector[fs->active].used + need <= dev->sector_bytes);
+        if ((!low && !wear) || !fits) {
+            fs->gc_idle = stamp;
+            return VC_OK;
+        }
+        return (pf_gc_sector(fs, (uint16_t)tail) == VC_OK) ? VC_E_AGAIN : VC_E_IO;
+    }
+    if (fs->writers || fs->readers || fs->suspends) return VC_E_AGAIN;
+
+    if (dev->erase_start(dev, (uint16_t)pick) != VC_OK) return VC_E_IO;
+    fs->erasing = pick;
+    return VC_E_AGAIN;
+}
+
+vc_status_t port_flash_suspend(port_flash_t *fs)
+{
+    if (!fs || !fs->dev) return VC_E_PARAM;
+    fs->suspends++;
+    /* Kasowania nie da się przerwać - kończymy je przed startem DMA audio. */
+    vc_status_t st = VC_OK;
+    while (fs->erasing >= 0) st = port_flash_service(fs);
+    return (st == VC_E_IO) ? VC_E_IO : VC_OK;
+}
+
+void port_flash_resume(port_flash_t *fs)
+{
+    if (fs && fs->suspends) fs->suspends--;
+}
+
+vc_status_t port_flash_delete(port_flash_t *fs, const char *name)
+{
+    if (!fs || !name) return VC_E_PARAM;
+    port_flash_file_t *f = pf_file_by_name(fs, name);
+    if (!f) return VC_E_EMPTY;
+
+    vc_status_t st = pf_append(fs, PF_REC_DELETE, f->id, 0, NULL, 0, NULL);
+    if (st == VC_OK) pf_file_drop(fs, f, 1);
+    return st;
+}
+
+vc_status_t port_flash_format(port_flash_t *fs)
+{
+    if (!fs || !fs->dev) return VC_E_PARAM;
+    if (fs->writers || fs->readers) return VC_E_STATE;
+
+    /* DELETE zapisane, żeby nagrania nie wróciły przy zaniku zasilania w trakcie kasowania. */
+    for (uint32_t i = 0; i < PORT_FLASH_MAX_FILES; i++)
+        if (fs->file[i].id) port_flash_delete(fs, fs->file[i].name);
+    for (uint16_t s = 0; s < fs->dev->sectors; s++)
+        if (fs->sector[s].state == PORT_FLASH_S_LOG) fs->sector[s].state = PORT_FLASH_S_DIRTY;
+    memset(fs->file, 0, sizeof(fs->file));
+    fs->file_count = 0;
+    fs->active = -1;
+    return VC_OK;
+}
+
+/* --- writer (vc_stream_sink_t) --- */
+
+static vc_status_t pf_writer_flush(port_flash_writer_t *w)
+{
+    if (w->fill == 0) return VC_OK;
+    vc_status_t st = pf_append(w->fs, PF_REC_DATA, w->fs->file[w->file].id, w->fs->file[w->file].bytes,
+                               w->buf, w->fill, NULL);
+    if (st != VC_OK) return st;
+    w->fs->file[w->file].bytes += w->fill;
+    w->fill = 0;
+    return VC_OK;
+}
+
+static vc_status_t pf_writer_header(port_flash_writer_t *w, const void *header, uint16_t len)
+{
+    if (len > PORT_FLASH_HEADER_MAX) return VC_E_PARAM;
+    port_flash_file_t *f = &w->fs->file[w->file];
+    uint32_t at;
+    vc_status_t st = pf_append(w->fs, PF_REC_HEADER, f->id, 0, header, len, &at);
+    if (st == VC_OK) {
+        f->header_at  = at;
+        f->header_len = len;
+    }
+    return st;
+}
+
+static uint32_t pf_sink_space(const vc_stream_sink_t *s)
+{
+    const port_flash_writer_t *w = (const port_flash_writer_t *)s;
+    uint32_t slots = pf_free_slots(w->fs, 1);
+    if (slots < PF_WRITER_SLOTS_KEEP) return 0;
+    return (slots - PF_WRITER_SLOTS_KEEP + 1u) * PORT_FLASH_CHUNK_BYTES - 1u - w->fill;
+}
+
+static vc_status_t pf_sink_write(vc_stream_sink_t *s, const void *data, uint32_t len)
+{
+    port_flash_writer_t *w = (port_flash_writer_t *)s;
+    if (!w->is_open || (!data && len)) return VC_E_PARAM;
+    /* Całość albo nic: tylko skasowane miejsce, bez kasowania w torze audio. */
+    if (len > pf_sink_space(s)) return VC_E_FULL;
+
+    const uint8_t *src = (const uint8_t *)data;
+    while (len) {
+        uint32_t n = PORT_FLASH_CHUNK_BYTES - w->fill;
+        if (n > len) n = len;
+        memcpy(&w->buf[w->fill], src, n);
+        w->fill = (uint16_t)(w->fill + n);
+        src += n;
+        len -= n;
+        if (w->fill == PORT_FLASH_CHUNK_BYTES) {
+            vc_status_t st = pf_writer_flush(w);
+            if (st != VC_OK) return st;
+        }
+    }
+    return VC_OK;
+}
+
+static vc_status_t pf_sink_reserve(vc_stream_sink_t *s, uint32_t bytes)
+{
+    const port_flash_writer_t *w = (const port_flash_writer_t *)s;
+    uint32_t need = bytes / PORT_FLASH_CHUNK_BYTES + PF_WRITER_SLOTS_KEEP;
+    return (pf_free_slots(w->fs, 1) >= need) ? VC_OK : VC_E_FULL;
+}
+
+static vc_status_t pf_sink_checkpoint(vc_stream_sink_t *s, const void *header, uint16_t header_len)
+{
+    port_flash_writer_t *w = (port_flash_writer_t *)s;
+    if (!w->is_open) return VC_E_STATE;
+    vc_status_t st = pf_writer_flush(w);
+    if (st == VC_OK && header) st = pf_writer_header(w, header, header_len);
+    return st;
+}
+
+static vc_status_t pf_sink_close(vc_stream_sink_t *s, const void *header, uint16_t header_len)
+{
+    port_flash_writer_t *w = (port_flash_writer_t *)s;
+    if (!w->is_open) return VC_E_STATE;
+
+    port_flash_file_t *f = &w->fs->file[w->file];
+    vc_status_t st = pf_writer_flush(w);
+    if (st == VC_OK && header) st = pf_writer_header(w, header, header_len);
+    if (st == VC_OK) st = pf_append(w->fs, PF_REC_CLOSE, f->id, 0, NULL, 0, NULL);
+    if (st == VC_OK) f->closed = 1;
+    w->is_open = 0;
+    w->fs->writers--;
+    return st;
+}
+
+static const vc_stream_sink_ops_t pf_sink_ops = {
+    .write      = pf_sink_write,
+    .space      = pf_sink_space,
+    .reserve    = pf_sink_reserve,
+    .checkpoint = pf_sink_checkpoint,
+    .close      = pf_sink_close,
+};
+
+vc_status_t port_flash_writer_open(port_flash_t *fs, port_flash_writer_t *w, const char *name)
+{
+    if (!fs || !fs->dev || !w || !name || !name[0]) return VC_E_PARAM;
+    if (fs->erasing >= 0) return VC_E_STATE;   /* najpierw dokończyć kasowanie (service) */
+
+    memset(w, 0, offsetof(port_flash_writer_t, buf));
+    w->sink.ops = &pf_sink_ops;
+    w->fs = fs;
+
+    vc_status_t st = VC_OK;
+    if (pf_file_by_name(fs, name)) st = port_flash_delete(fs, name);
+    if (st != VC_OK) return st;
+    if (fs->file_count >= PORT_FLASH_MAX_FILES || pf_free_slots(fs, 1) < PF_WRITER_SLOTS_KEEP + 1u) return VC_E_FULL;
+
+    uint32_t i = 0;
+    while (fs->file[i].id) i++;
+    port_flash_file_t *f = &fs->file[i];
+    memset(f, 0, sizeof(*f));
+    strncpy(f->name, name, PORT_FLASH_NAME_MAX - 1u);
+    f->id = fs->next_id++;
+    fs->file_count++;
+
+    char rec_name[PORT_FLASH_NAME_MAX];
+    memcpy(rec_name, f->name, sizeof(rec_name));
+    st = pf_append(fs, PF_REC_OPEN, f->id, 0, rec_name, sizeof(rec_name), NULL);
+    if (st != VC_OK) {
+        memset(f, 0, sizeof(*f));
+        fs->file_count--;
+        return st;
+    }
+    w->file = (uint16_t)i;
+    w->is_open = 1;
+    fs->writers++;
+    return VC_OK;
+}
+
+/* --- odczyt --- */
+
+vc_status_t port_flash_reader_open(port_flash_t *fs, port_flash_reader_t *r, const char *name)
+{
+    if (!fs || !fs->dev || !r || !name) return VC_E_PARAM;
+    const port_flash_file_t *f = pf_file_by_name(fs, name);
+    if (!f) return VC_E_EMPTY;
+
+    memset(r, 0, sizeof(*r));
+    r->fs         = fs;
+    r->id         = f->id;
+    r->bytes      = f->bytes;
+    r->header_at  = f->header_at;
+    r->header_len = f->header_len;
+    r->sector     = pf_next_log_sector(fs, -1);
+    r->at         = PF_SECTOR_HDR_BYTES;
+    fs->readers++;
+    return VC_OK;
+}
+
+void port_flash_reader_close(port_flash_reader_t *r)
+{
+    if (!r || !r->fs) return;
+    r->fs->readers--;
+    r->fs = NULL;
+}
+
+/* Rekord DATA nagrania zaczynający się na r->pos: dalej w logu, po końcu od najstarszego
+ * sektora (rekordy przeniesione przez GC leżą za późniejszymi). 0: brak. */
+static uint8_t pf_reader_next(port_flash_reader_t *r)
+{
+    port_flash_t *fs = r->fs;
+    const port_flash_file_t *f = pf_file_by_id(fs, r->id);
+    pf_rec_t h;
+
+    if (!f) return 0;
+    for (uint8_t pass = 0; pass < 2u; pass++) {
+        while (r->sector >= 0) {
+            if (!(f->sector_mask & (1u << r->sector))) {
+                r->at = fs->sector[r->sector].used;          /* sektor bez rekordów nagrania */
+            }
+            while (pf_next_rec(fs, (uint16_t)r->sector, &r->at, &h, 1)) {
+                uint32_t at = r->at;
+                r->at += PF_REC_BYTES + PF_ALIGN4((uint32_t)h.len);
+                if (h.type == PF_REC_DATA && h.id == r->id && h.offset == r->pos && h.len) {
+                    r->rec_at  = pf_sector_base(fs, (uint16_t)r->sector) + at + PF_REC_BYTES;
+                    r->rec_len = h.len;
+                    r->rec_pos = 0;
+                    return 1;
+                }
+            }
+            r->sector = pf_next_log_sector(fs, r->sector);
+            r->at = PF_SECTOR_HDR_BYTES;
+        }
+        r->sector = pf_next_log_sector(fs, -1);
+    }
+    return 0;
+}
+
+vc_status_t port_flash_read(port_flash_reader_t *r, void *buf, uint32_t len, uint32_t *got)
+{
+    if (!r || !r->fs || (!buf && len)) return VC_E_PARAM;
+    const uint8_t *base = r->fs->dev->base;
+    uint8_t *dst = (uint8_t *)buf;
+    uint32_t done = 0;
+
+    if (len > r->bytes - r->pos) len = r->bytes - r->pos;
+    while (done < len) {
+        if (r->rec_pos == r->rec_len && !pf_reader_next(r)) break;
+        uint32_t n = r->rec_len - r->rec_pos;
+        if (n > len - done) n = len - done;
+        memcpy(dst + done, base + r->rec_at + r->rec_pos, n);
+
+        /* Bajty objęte ostatnim nagłówkiem (HEADER) zamiast pierwotnych. */
+        if (r->header_len && r->pos < r->header_len) {
+            uint32_t h = r->header_len - r->pos;
+            if (h > n) h = n;
+            memcpy(dst + done, base + r->header_at + r->pos, h);
+        }
+        r->rec_pos = (uint16_t)(r->rec_pos + n);
+        r->pos  += n;
+        done    += n;
+    }
+    if (got) *got = done;
+    return (done == len) ? VC_OK : VC_E_IO;
+}
+
+void port_flash_get_stats(const port_flash_t *fs, port_flash_stats_t *st)
+{
+    if (!fs || !fs->dev || !st) return;
+    memset(st, 0, sizeof(*st));
+    st->free_bytes = pf_free_slots(fs, 1) * PORT_FLASH_CHUNK_BYTES;
+    st->files = fs->file_count;
+    st->erase_min = PF_ERASED_WORD;
+    for (uint16_t s = 0; s < fs->dev->sectors; s++) {
+        const port_flash_sector_t *sec = &fs->sector[s];
+        if (sec->state == PORT_FLASH_S_ERASED) st->erased_sectors++;
+        if (sec->state == PORT_FLASH_S_DIRTY)  st->dirty_sectors++;
+        if (sec->erase_count < st->erase_min) st->erase_min = sec->erase_count;
+        if (sec->erase_count > st->erase_max) st->erase_max = sec->erase_count;
+    }
+}
+
+/* --- STM32F407: sektory 8-11 --- */
+#ifndef VC_HOST_BUILD
+#include "stm32f4xx_hal.h"
+
+#define PF_STM32_BASE          0x08080000u
+#define PF_STM32_FIRST_SECTOR  FLASH_SECTOR_8
+#define PF_STM32_SECTOR_BYTES  (128u * 1024u)
+#define PF_STM32_SECTORS       4u
+#define PF_STM32_ERRORS        (FLASH_FLAG_OPERR | FLASH_FLAG_WRPERR | FLASH_FLAG_PGAERR | \
+                                FLASH_FLAG_PGPERR | FLASH_FLAG_PGSERR)
+
+/* 16 us na słowo (x32, 2,7-3,6 V); w tym czasie odczyt flash czeka. */
+static vc_status_t pf_stm32_program(port_flash_dev_t *d, uint32_t offset, const void *data, uint32_t len)
+{
+    const uint8_t *src = (const uint8_t *)data;
+    vc_status_t st = VC_OK;
+    (void)d;
+
+    HAL_FLASH_Unlock();
+    __HAL_FLASH_CLEAR_FLAG(PF_STM32_ERRORS);
+    for (uint32_t i = 0; i < len && st == VC_OK; i += 4u) {
+        uint32_t word;
+        memcpy(&word, src + i, sizeof(word));
+        if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, PF_STM32_BASE + offset + i, word) != HAL_OK) st = VC_E_IO;
+    }
+    HAL_FLASH_Lock();
+    return st;
+}
+
+/* Start kasowania bez czekania (HAL_FLASHEx_Erase czekałby do końca). */
+static vc_status_t pf_stm32_erase_start(port_flash_dev_t *d, uint16_t sector)
+{
+    (void)d;
+    HAL_FLASH_Unlock();
+    __HAL_FLASH_CLEAR_FLAG(PF_STM32_ERRORS);
+    FLASH_Erase_Sector(PF_STM32_FIRST_SECTOR + sector, FLASH_VOLTAGE_RANGE_3);
+    return VC_OK;
+}
+
+static vc_status_t pf_stm32_erase_poll(port_flash_dev_t *d)
+{
+    (void)d;
+    if (__HAL_FLASH_GET_FLAG(FLASH_FLAG_BSY)) return VC_E_AGAIN;
+
+    CLEAR_BIT(FLASH->CR, (FLASH_CR_SER | FLASH_CR_SNB));
+    uint32_t err = FLASH->SR & PF_STM32_ERRORS;
+    __HAL_FLASH_CLEAR_FLAG(PF_STM32_ERRORS);
+    HAL_FLASH_Lock();
+
+    /* Odczyt przez ART: stare linie cache danych po kasowaniu. */
+    if (READ_BIT(FLASH->ACR, FLASH_ACR_DCEN)) {
+        __HAL_FLASH_DATA_CACHE_DISABLE();
+        __HAL_FLASH_DATA_CACHE_RESET();
+        __HAL_FLASH_DATA_CACHE_ENABLE();
+    }
+    return err ? VC_E_IO : VC_OK;
+}
+
+static port_flash_dev_t s_pf_stm32 = {
+    .base         = (const uint8_t *)PF_STM32_BASE,
+    .sector_bytes = PF_STM32_SECTOR_BYTES,
+    .sectors      = PF_STM32_SECTORS,
+    .program      = pf_stm32_program,
+    .erase_start  = pf_stm32_erase_start,
+    .erase_poll   = pf_stm32_erase_poll,
+};
+
+/* Symbole skryptu linkera (STM32F407VGTX_FLASH.ld). */
+extern uint32_t _sidata, _sdata, _edata;
+
+port_flash_dev_t *port_flash_stm32(void)
+{
+    /* Koniec obrazu we flash: wartości początkowe .data leżą za kodem i stałymi. */
+    uint32_t image_end = (uint32_t)&_sidata + ((uint32_t)&_edata - (uint32_t)&_sdata);
+    if (image_end > PF_STM32_BASE) return NULL;   /* kasowanie zniszczyłoby program */
+    return &s_pf_stm32;
+}
+#endif /* VC_HOST_BUILD */
@@ -13,7 +13,12 @@
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
+#include "g722_private.h"          /* pełne struktury stanu G.722 - przed g722_encoder.h */
 #include <tests/test_encoders.h>
+#include "main.h"
+#include "g722_encoder.h"
+#include "g722_decoder.h"
+#include "voicecmd/vc_crc32.h"
 
 // --------------------------------------------------
 // Funkcje pomocnicze
@@ -70,7 +75,11 @@ void test_pcm16_compression(void)
     float32_t rms_input = test_compute_rms_f32(test_signal, TEST_FRAME_SAMPLES);
     
     // Test kompresji PCM16
-    compress_data(&pcm_meta, test_signal, &cfg);
+    vc_codec_t codec;
+    uint8_t encoded[VC_PCM16_BYTES_PER_FRAME];
+    vc_codec_open(&codec, &cfg, VC_CODEC_DIR_ENC);
+    uint16_t encoded_bytes = compress_data(&codec, &pcm_meta, test_signal, encoded);
+    vc_codec_close(&codec);
     
     // Informacje o PCM16
     vc_stream_meta_t pcm_meta_info;
@@ -113,7 +122,11 @@ void test_ima_adpcm_compression(void)
     float32_t rms_input = test_compute_rms_f32(test_signal, TEST_FRAME_SAMPLES);
     
     // Test kompresji IMA-ADPCM
-    compress_data(&pcm_meta, test_signal, &cfg);
+    vc_codec_t codec;
+    uint8_t encoded[VC_PCM16_BYTES_PER_FRAME];
+    vc_codec_open(&codec, &cfg, VC_CODEC_DIR_ENC);
+    uint16_t encoded_bytes = compress_data(&codec, &pcm_meta, test_signal, encoded);
+    vc_codec_close(&codec);
     
     // Informacje o IMA-ADPCM
     vc_stream_meta_t adpcm_meta_info;
@@ -160,7 +173,11 @@ void test_g722_compression(void){
     float32_t rms_input = test_compute_rms_f32(test_signal, TEST_FRAME_SAMPLES);
     
     // Test kompresji IMA-ADPCM
-    compress_data(&pcm_meta, test_signal, &cfg);
+    vc_codec_t codec;
+    uint8_t encoded[VC_PCM16_BYTES_PER_FRAME];
+    vc_codec_open(&codec, &cfg, VC_CODEC_DIR_ENC);
+    uint16_t encoded_bytes = compress_data(&codec, &pcm_meta, test_signal, encoded);
+    vc_codec_close(&codec);
     
     // Informacje o IMA-ADPCM
     vc_stream_meta_t adpcm_meta_info;
@@ -174,6 +191,548 @@ void test_g722_compression(void){
     g722_deinit_dec();
 }
 
+void test_g711_compression(void)
+{
+    // Przygotowanie metadanych PCM
+    vc_pcm_meta_t pcm_meta = {
+        .frame_idx = 3,
+        .sample_rate_hz = TEST_FS_HZ,
+        .channels = 1,
+        .len_samples = TEST_FRAME_SAMPLES
+    };
+
+    // Konfiguracja kodera G.711 µ-law
+    vc_enc_cfg_t cfg = {
+        .codec = VC_CODEC_G711U,
+        .samples_per_block = 0  // nie dotyczy G.711
+    };
+
+    // Generowanie sygnału testowego (1 kHz sinus)
+    float32_t test_signal[TEST_FRAME_SAMPLES];
+    test_generate_sine_f32(test_signal, TEST_FRAME_SAMPLES, 8000.0f, 1000.0f);
+
+    // Test kompresji G.711
+    vc_codec_t codec;
+    uint8_t encoded[VC_PCM16_BYTES_PER_FRAME];
+    vc_codec_open(&codec, &cfg, VC_CODEC_DIR_ENC);
+    uint16_t encoded_bytes = compress_data(&codec, &pcm_meta, test_signal, encoded);
+    vc_codec_close(&codec);
+
+    // Rekonstrukcja µ-law / A-law i błąd względem wejścia
+    int16_t pcm[TEST_FRAME_SAMPLES];
+    int16_t pcm_out[TEST_FRAME_SAMPLES];
+    uint8_t g711[VC_G711_BYTES_PER_FRAME];
+    vc_convert_float32_to_int16(test_signal, pcm, TEST_FRAME_SAMPLES);
+
+    vc_g711u_encode(pcm, TEST_FRAME_SAMPLES, g711);
+    vc_g711u_decode(g711, TEST_FRAME_SAMPLES, pcm_out);
+    int32_t max_err_u = 0;
+    for (int i = 0; i < TEST_FRAME_SAMPLES; i++) {
+        int32_t e = abs(pcm[i] - pcm_out[i]);
+        if (e > max_err_u) max_err_u = e;
+    }
+
+    vc_g711a_encode(pcm, TEST_FRAME_SAMPLES, g711);
+    vc_g711a_decode(g711, TEST_FRAME_SAMPLES, pcm_out);
+    int32_t max_err_a = 0;
+    for (int i = 0; i < TEST_FRAME_SAMPLES; i++) {
+        int32_t e = abs(pcm[i] - pcm_out[i]);
+        if (e > max_err_a) max_err_a = e;
+    }
+
+    vc_stream_meta_t g711_meta_info;
+    vc_meta_g711_make(&g711_meta_info, VC_CODEC_G711U);
+
+    uint32_t pcm_frame_size = TEST_FRAME_SAMPLES * 2;                          // PCM16: 640 bajtów
+    uint32_t g711_frame_size = TEST_FRAME_SAMPLES * g711_meta_info.block_align; // G.711: 320 bajtów
+    float compression_ratio = (float)pcm_frame_size / (float)g711_frame_size;
+}
+
+void test_g722_cycles(void)
+{
+    // Licznik cykli DWT (Cortex-M4)
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    float32_t test_signal[TEST_FRAME_SAMPLES];
+    int16_t pcm[TEST_FRAME_SAMPLES];
+    int16_t pcm_out[TEST_FRAME_SAMPLES];
+    uint8_t payload[VC_G722_BYTES_PER_FRAME];
+
+    test_generate_white_noise_f32(test_signal, TEST_FRAME_SAMPLES, 8000.0f);
+    vc_convert_float32_to_int16(test_signal, pcm, TEST_FRAME_SAMPLES);
+
+    g722_init_64k_enc();
+    g722_init_64k_dec();
+
+    uint32_t enc_cycles = 0;
+    uint32_t dec_cycles = 0;
+    for (int f = 0; f < 50; f++) {          // 1 s audio
+        uint32_t t0 = DWT->CYCCNT;
+        g722_encode_20ms_64k(pcm, payload);
+        uint32_t t1 = DWT->CYCCNT;
+        g722_decode_20ms_64k(payload, pcm_out);
+        uint32_t t2 = DWT->CYCCNT;
+        enc_cycles += t1 - t0;
+        dec_cycles += t2 - t1;
+    }
+
+    printf("G.722 64k: enc %lu cyc/ramka, dec %lu cyc/ramka\r\n",
+           (unsigned long)(enc_cycles / 50u), (unsigned long)(dec_cycles / 50u));
+
+    g722_deinit_enc();
+    g722_deinit_dec();
+}
+
+#define TEST_LPC_FRAMES 150   // 3 s: mowa dźwięczna, prawie cisza, szum pełnej skali
+
+/* LPC + Rice: bezstratność ramka po ramce, rozmiar względem PCM16 w każdym odcinku
+ * i najgorszy czas kodowania / dekodowania ramki względem 20 ms (168 MHz). */
+void test_lpc_roundtrip(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    static const char *const parts[] = { "mowa", "cisza", "szum" };
+    float32_t noise[TEST_FRAME_SAMPLES];
+    int16_t pcm[TEST_FRAME_SAMPLES];
+    int16_t pcm_out[TEST_FRAME_SAMPLES];
+    static uint8_t payload[VC_LPC_MAX_BYTES_PER_FRAME];
+    uint32_t bytes[3] = { 0 }, bad = 0, enc_max = 0, dec_max = 0;
+    float32_t phase = 0.0f;
+
+    for (uint32_t f = 0; f < TEST_LPC_FRAMES; f++) {
+        uint32_t part = f / (TEST_LPC_FRAMES / 3u);
+        test_generate_white_noise_f32(noise, TEST_FRAME_SAMPLES, (part == 2u) ? 32767.0f : 20.0f);
+        for (uint32_t i = 0; i < TEST_FRAME_SAMPLES; i++) {
+            float32_t v = noise[i];
+            if (part == 0u) {
+                // Ton krtaniowy 120 Hz z harmonicznymi malejącymi, obwiednia sylab 1,5 Hz
+                float32_t t = (float32_t)(f * TEST_FRAME_SAMPLES + i) / TEST_FS_HZ;
+                phase += 2.0f * TEST_PI_F * 120.0f / TEST_FS_HZ;
+                float32_t voiced = 0.0f;
+                for (uint32_t h = 1; h < 12u; h++) voiced += sinf(h * phase) / (float32_t)h;
+                v += 6000.0f * (0.5f + 0.5f * sinf(2.0f * TEST_PI_F * 1.5f * t)) * voiced;
+            }
+            if (v > 32767.0f) v = 32767.0f;
+            if (v < -32768.0f) v = -32768.0f;
+            pcm[i] = (int16_t)v;
+        }
+
+        uint32_t t0 = DWT->CYCCNT;
+        uint16_t len = vc_lpc_encode_frame(pcm, TEST_FRAME_SAMPLES, payload);
+        uint32_t t1 = DWT->CYCCNT;
+        uint16_t n = vc_lpc_decode_frame(payload, len, TEST_FRAME_SAMPLES, pcm_out);
+        uint32_t t2 = DWT->CYCCNT;
+
+        if (t1 - t0 > enc_max) enc_max = t1 - t0;
+        if (t2 - t1 > dec_max) dec_max = t2 - t1;
+        if (len == 0 || n != TEST_FRAME_SAMPLES || memcmp(pcm, pcm_out, sizeof(pcm)) != 0) bad++;
+        bytes[part] += len;
+    }
+
+    const uint32_t pcm_bytes = (TEST_LPC_FRAMES / 3u) * TEST_FRAME_SAMPLES * 2u;
+    for (uint32_t k = 0; k < 3u; k++) {
+        printf("LPC %s: %.1f%% PCM16\r\n", parts[k], 100.0f * (float32_t)bytes[k] / (float32_t)pcm_bytes);
+    }
+    const uint32_t budget = SystemCoreClock / 50u;   // 20 ms
+    printf("LPC: %u ramek, niezgodne %lu, max enc %lu cyc (%.1f%% ramki), max dec %lu cyc (%.1f%%)\r\n",
+           TEST_LPC_FRAMES, (unsigned long)bad, (unsigned long)enc_max, 100.0f * (float32_t)enc_max / (float32_t)budget,
+           (unsigned long)dec_max, 100.0f * (float32_t)dec_max / (float32_t)budget);
+}
+
+/* G.722 64/56/48 kb/s, bez i z pakowaniem: rozmiar ramki, metadane i dekoder
+ * skonfigurowany wyłącznie z metadanych (vc_codec_cfg_from_meta). */
+void test_g722_modes(void)
+{
+    static const uint32_t rates[] = { 64000u, 56000u, 48000u };
+    float32_t test_signal[TEST_FRAME_SAMPLES];
+    int16_t pcm_out[TEST_FRAME_SAMPLES];
+    uint8_t payload[VC_G722_BYTES_PER_FRAME];
+    vc_pcm_meta_t pcm_meta = { .sample_rate_hz = TEST_FS_HZ, .channels = 1, .len_samples = TEST_FRAME_SAMPLES };
+
+    test_generate_sine_f32(test_signal, TEST_FRAME_SAMPLES, 3000.0f, 440.0f);
+
+    for (uint32_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+        for (uint8_t packed = 0; packed < 2; packed++) {
+            vc_enc_cfg_t cfg = { .codec = VC_CODEC_G722, .samples_per_block = TEST_FRAME_SAMPLES,
+                                 .bitrate_bps = rates[r], .packed = packed };
+            vc_codec_t enc_codec, dec_codec;
+            vc_stream_meta_t meta;
+            vc_enc_cfg_t dec_cfg;
+
+            vc_codec_open(&enc_codec, &cfg, VC_CODEC_DIR_ENC);
+            vc_codec_meta(&enc_codec, &meta);
+            uint16_t bytes = compress_data(&enc_codec, &pcm_meta, test_signal, payload);
+            vc_codec_close(&enc_codec);
+
+            vc_codec_cfg_from_meta(&meta, &dec_cfg);
+            vc_codec_open(&dec_codec, &dec_cfg, VC_CODEC_DIR_DEC);
+            uint16_t samples = decompress_data(&dec_codec, &pcm_meta, payload, bytes, pcm_out);
+            vc_codec_close(&dec_codec);
+
+            printf("G.722 %lu%s: %u B/ramka, avg %lu B/s, dekoder %u probek\r\n",
+                   (unsigned long)rates[r], packed ? " packed" : "", bytes,
+                   (unsigned long)meta.avg_bytes_per_sec, samples);
+        }
+    }
+}
+
+#define TEST_G722_REF_FRAMES 150   // 3 s: piła + szum, prostokąt w nasyceniu, prawie cisza
+
+/* Sygnał całkowitoliczbowy - ten sam na hoście i na targecie (bez sinf / rand). */
+static int16_t test_g722_ref_sample(uint32_t n, uint32_t *seed)
+{
+    *seed = *seed * 1664525u + 1013904223u;
+    int32_t noise = (int32_t)(*seed >> 20) - 2048;
+    int32_t x;
+    if (n < (uint32_t)TEST_FS_HZ)        x = ((int32_t)(n % 160u) - 80) * 100 + noise / 2;
+    else if (n < 2u * (uint32_t)TEST_FS_HZ) x = ((n / 8u) & 1u ? 30000 : -30000) + noise * 4;
+    else                                 x = noise / 64;
+    return (x > INT16_MAX) ? INT16_MAX : (x < INT16_MIN) ? INT16_MIN : (int16_t)x;
+}
+
+/* CRC-32 (vc_crc32) strumienia G.722 i zdekodowanego PCM z implementacji referencyjnej
+ * SpanDSP (stan pasma w int, przesuwana linia opóźniająca - przed zawężeniem do int16).
+ * [64/56/48 kb/s][bez / z pakowaniem][strumień, PCM] */
+static const uint32_t test_g722_ref_crc[3][2][2] = {
+    { { 0x0DFD1BC1u, 0x38882B40u }, { 0x0DFD1BC1u, 0x38882B40u } },
+    { { 0x270EEDC5u, 0xABFDF096u }, { 0x3C387FDEu, 0xABFDF096u } },
+    { { 0x1780D0A9u, 0x59AB30C3u }, { 0x8A9CB59Du, 0x59AB30C3u } },
+};
+
+/* Zgodność bit w bit z implementacją referencyjną: 3 s sygnału ramkami 20 ms przez
+ * g722_encode / g722_decode, CRC strumienia i PCM porównane z tabelą. */
+void test_g722_bitexact(void)
+{
+    static const int rates[] = { 64000, 56000, 48000 };
+    static struct g722_encode_state enc;
+    static struct g722_decode_state dec;
+    int16_t pcm[TEST_FRAME_SAMPLES];
+    uint8_t payload[VC_G722_BYTES_PER_FRAME];
+    uint32_t fails = 0;
+
+    for (uint32_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+        for (uint32_t packed = 0; packed < 2u; packed++) {
+            int options = packed ? G722_PACKED : G722_DEFAULT;
+            vc_crc32_t crc_bits, crc_pcm;
+            uint32_t seed = 1u, n = 0;
+
+            g722_encoder_init(&enc, rates[r], options);
+            g722_decoder_init(&dec, rates[r], options);
+            vc_crc32_init(&crc_bits);
+            vc_crc32_init(&crc_pcm);
+            for (uint32_t f = 0; f < TEST_G722_REF_FRAMES; f++) {
+                for (uint32_t i = 0; i < TEST_FRAME_SAMPLES; i++) pcm[i] = test_g722_ref_sample(n++, &seed);
+                int bytes = g722_encode(&enc, pcm, TEST_FRAME_SAMPLES, payload);
+                vc_crc32_update(&crc_bits, payload, (uint32_t)bytes);
+                int samples = g722_decode(&dec, payload, bytes, pcm);
+                vc_crc32_update(&crc_pcm, pcm, (uint32_t)samples * sizeof(int16_t));
+            }
+
+            uint32_t cb = vc_crc32_final(&crc_bits), cp = vc_crc32_final(&crc_pcm);
+            uint8_t ok = (cb == test_g722_ref_crc[r][packed][0] && cp == test_g722_ref_crc[r][packed][1]);
+            if (!ok) fails++;
+            printf("G.722 %d%s bit-exact: strumien %08lx, PCM %08lx - %s\r\n", rates[r], packed ? " packed" : "",
+                   (unsigned long)cb, (unsigned long)cp, ok ? "OK" : "ROZNE");
+        }
+    }
+    printf("G.722 bit-exact: %lu/6 trybow niezgodnych\r\n", (unsigned long)fails);
+}
+
+#define TEST_PLC_FRAMES 12
+
+/* Ukrywanie strat: ramki 4-5 z "błędnym CRC", ramka 8 obcięta. Dekoder nie może
+ * się zatrzymać; drukuje SNR ramek ukrytych względem dekodowania bez strat. */
+void test_plc_concealment(void)
+{
+    static float32_t test_signal[TEST_PLC_FRAMES * TEST_FRAME_SAMPLES];
+    static float32_t temp_signal[TEST_PLC_FRAMES * TEST_FRAME_SAMPLES];
+    static int16_t pcm_ref[TEST_PLC_FRAMES * TEST_FRAME_SAMPLES];
+    static int16_t pcm_plc[TEST_PLC_FRAMES * TEST_FRAME_SAMPLES];
+    static uint8_t payload[TEST_PLC_FRAMES * VC_G722_BYTES_PER_FRAME];
+    static vc_plc_t plc;
+    uint32_t offsets[TEST_PLC_FRAMES + 1];
+    uint32_t total = 0;
+
+    // "samogłoska" 200 Hz + harmoniczne
+    test_generate_sine_f32(test_signal, TEST_PLC_FRAMES * TEST_FRAME_SAMPLES, 6000.0f, 200.0f);
+    test_generate_sine_f32(temp_signal, TEST_PLC_FRAMES * TEST_FRAME_SAMPLES, 2500.0f, 400.0f);
+    arm_add_f32(test_signal, temp_signal, test_signal, TEST_PLC_FRAMES * TEST_FRAME_SAMPLES);
+
+    const vc_codec_id_t ids[] = { VC_CODEC_IMA_ADPCM, VC_CODEC_G722 };
+    for (uint32_t k = 0; k < sizeof(ids) / sizeof(ids[0]); k++) {
+        vc_enc_cfg_t cfg = { .codec = ids[k], .samples_per_block = TEST_FRAME_SAMPLES };
+        vc_pcm_meta_t pcm_meta = { .sample_rate_hz = TEST_FS_HZ, .channels = 1, .len_samples = TEST_FRAME_SAMPLES };
+        vc_codec_t enc_codec, dec_ref, dec_plc;
+
+        vc_codec_open(&enc_codec, &cfg, VC_CODEC_DIR_ENC);
+        total = compress_frames(&enc_codec, &pcm_meta, test_signal, TEST_PLC_FRAMES,
+                                payload, sizeof(payload), offsets);
+        vc_codec_close(&enc_codec);
+        if (total == 0) continue;
+
+        vc_codec_open(&dec_ref, &cfg, VC_CODEC_DIR_DEC);
+        decompress_frames(&dec_ref, &pcm_meta, payload, offsets, TEST_PLC_FRAMES, pcm_ref);
+        vc_codec_close(&dec_ref);
+
+        vc_codec_open(&dec_plc, &cfg, VC_CODEC_DIR_DEC);
+        vc_plc_init(&plc);
+        uint32_t produced = 0;
+        for (int f = 0; f < TEST_PLC_FRAMES; f++) {
+            uint16_t len = (uint16_t)(offsets[f + 1] - offsets[f]);
+            if (f == 8) len /= 2;                                   // obcięty blok
+            bool crc_ok = !(f == 4 || f == 5);
+            produced += decompress_data_plc(&dec_plc, &plc, &pcm_meta, payload + offsets[f], len,
+                                            crc_ok, &pcm_plc[f * TEST_FRAME_SAMPLES]);
+        }
+        vc_codec_close(&dec_plc);
+
+        float32_t sig = 0.0f, err = 0.0f;
+        for (int f = 4; f <= 8; f++) {
+            if (f == 6 || f == 7) continue;
+            for (int i = 0; i < TEST_FRAME_SAMPLES; i++) {
+                float32_t r = pcm_ref[f * TEST_FRAME_SAMPLES + i];
+                float32_t e = r - pcm_plc[f * TEST_FRAME_SAMPLES + i];
+                sig += r * r;
+                err += e * e;
+            }
+        }
+        printf("PLC %s: %lu/%u probek, ukryte ramki %lu, SNR ukrytych %.1f dB\r\n",
+               vc_codec_find(ids[k])->name, (unsigned long)produced, TEST_PLC_FRAMES * TEST_FRAME_SAMPLES,
+               (unsigned long)plc.concealed_frames,
+               (err > 0.0f) ? 10.0f * log10f(sig / err) : 99.0f);
+    }
+}
+
+/* IMA: koder zachłanny vs przeszukiwanie w przód (różne głębokości/budżety).
+ * Strumień dekoduje niezmieniony vc_ima_decode_block_mono; drukuje SNR i cykle na blok. */
+void test_ima_lookahead(void)
+{
+    static const vc_ima_search_t searches[] = {
+        { 1, 1, 0 },        // odpowiednik vc_ima_encode_block_mono
+        { 2, 3, 0 },
+        { 3, 3, 4000 },     // budżet na targecie
+        { 3, 3, 0 },
+    };
+    float32_t test_signal[TEST_FRAME_SAMPLES];
+    int16_t pcm[TEST_FRAME_SAMPLES];
+    int16_t pcm_out[TEST_FRAME_SAMPLES];
+    uint8_t block[VC_IMA_MONO_BYTES_PER_FRAME];
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    test_generate_sine_f32(test_signal, TEST_FRAME_SAMPLES, 5000.0f, 180.0f);
+    vc_convert_float32_to_int16(test_signal, pcm, TEST_FRAME_SAMPLES);
+
+    for (uint32_t k = 0; k < sizeof(searches) / sizeof(searches[0]); k++) {
+        vc_ima_state_t st = { 0 };
+        uint32_t t0 = DWT->CYCCNT;
+        vc_ima_encode_block_mono_search(pcm, TEST_FRAME_SAMPLES, block, &st, &searches[k]);
+        uint32_t t1 = DWT->CYCCNT;
+        vc_ima_decode_block_mono(block, TEST_FRAME_SAMPLES, pcm_out);
+
+        float32_t sig = 0.0f, err = 0.0f;
+        for (int i = 0; i < TEST_FRAME_SAMPLES; i++) {
+            float32_t e = (float32_t)pcm[i] - (float32_t)pcm_out[i];
+            sig += (float32_t)pcm[i] * (float32_t)pcm[i];
+            err += e * e;
+        }
+        printf("IMA depth %u branch %u budget %lu: SNR %.2f dB, %lu cyc/blok\r\n",
+               searches[k].depth, searches[k].branch, (unsigned long)searches[k].node_budget,
+               (err > 0.0f) ? 10.0f * log10f(sig / err) : 99.0f, (unsigned long)(t1 - t0));
+    }
+}
+
+static uint32_t test_dwt_cycles(void)
+{
+    return DWT->CYCCNT;
+}
+
+/* Tryb adaptacyjny: 4 s sygnału (2 s głośno, 2 s cicho), próba co 0.5 s.
+ * Drukuje przełączenia (log do kontenera) i łączny rozmiar vs PCM16. */
+void test_codec_select(void)
+{
+    static vc_codec_select_t sel;
+    static float32_t frame_f32[TEST_FRAME_SAMPLES];
+    int16_t frame_pcm[TEST_FRAME_SAMPLES];
+    uint8_t payload[VC_PCM16_BYTES_PER_FRAME];
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    vc_select_cfg_t cfg;
+    vc_select_default_cfg(&cfg);
+    cfg.target_snr_db     = 25.0f;
+    cfg.eval_every_frames = 25;
+    cfg.cycles            = test_dwt_cycles;
+    vc_select_init(&sel, &cfg);
+
+    uint32_t total = 0;
+    for (int f = 0; f < 200; f++) {
+        test_generate_white_noise_f32(frame_f32, TEST_FRAME_SAMPLES, (f < 100) ? 4000.0f : 500.0f);
+        vc_convert_float32_to_int16(frame_f32, frame_pcm, TEST_FRAME_SAMPLES);
+
+        uint16_t len = 0;
+        bool switched = false;
+        if (vc_select_encode(&sel, frame_pcm, payload, &len, &switched) != VC_OK) break;
+        total += len;
+        if (switched) {
+            const vc_vcmd_switch_t *e = &sel.log[sel.n_switches - 1u];
+            printf("ramka %lu: kodek 0x%02X opts 0x%02X (offset %lu)\r\n", (unsigned long)e->frame_idx,
+                   e->codec_id, e->codec_opts, (unsigned long)e->byte_offset);
+        }
+    }
+    printf("adaptacyjnie: %lu B vs PCM16 %lu B\r\n", (unsigned long)total,
+           (unsigned long)(200u * VC_PCM16_BYTES_PER_FRAME));
+    for (uint32_t i = 0; i < VC_SELECT_N_CANDIDATES; i++) {
+        printf("  kandydat %lu: SNR %.1f dB, %lu cyc/ramka\r\n", (unsigned long)i,
+               sel.last_snr_db[i], (unsigned long)sel.cand[i].enc_cycles);
+    }
+}
+
+#define TEST_BATCH_FRAMES 8
+
+/* Porównuje kodowanie ramka-po-ramce z wersją wsadową (compress_frames):
+ * bajty i offsety muszą być identyczne, różnica to tylko narzut wywołań. */
+void test_batch_compression(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    static float32_t test_signal[TEST_BATCH_FRAMES * TEST_FRAME_SAMPLES];
+    static uint8_t out_single[TEST_BATCH_FRAMES * VC_PCM16_BYTES_PER_FRAME];
+    static uint8_t out_batch[TEST_BATCH_FRAMES * VC_PCM16_BYTES_PER_FRAME];
+    uint32_t off_single[TEST_BATCH_FRAMES + 1];
+    uint32_t off_batch[TEST_BATCH_FRAMES + 1];
+
+    test_generate_white_noise_f32(test_signal, TEST_BATCH_FRAMES * TEST_FRAME_SAMPLES, 8000.0f);
+
+    const vc_codec_id_t ids[] = { VC_CODEC_PCM16, VC_CODEC_IMA_ADPCM, VC_CODEC_G722 };
+    for (uint32_t k = 0; k < sizeof(ids) / sizeof(ids[0]); k++) {
+        vc_enc_cfg_t cfg = { .codec = ids[k], .samples_per_block = TEST_FRAME_SAMPLES };
+        vc_pcm_meta_t pcm_meta = { .len_samples = TEST_FRAME_SAMPLES };
+        vc_codec_t single, batch;
+        vc_codec_open(&single, &cfg, VC_CODEC_DIR_ENC);
+        vc_codec_open(&batch, &cfg, VC_CODEC_DIR_ENC);
+
+        uint32_t t0 = DWT->CYCCNT;
+        uint32_t pos = 0;
+        for (int f = 0; f < TEST_BATCH_FRAMES; f++) {
+            off_single[f] = pos;
+            pos += compress_data(&single, &pcm_meta, &test_signal[f * TEST_FRAME_SAMPLES], out_single + pos);
+        }
+        off_single[TEST_BATCH_FRAMES] = pos;
+        uint32_t t1 = DWT->CYCCNT;
+        uint32_t total = compress_frames(&batch, &pcm_meta, test_signal, TEST_BATCH_FRAMES,
+                                         out_batch, sizeof(out_batch), off_batch);
+        uint32_t t2 = DWT->CYCCNT;
+
+        int same = (total == pos) && memcmp(out_single, out_batch, pos) == 0
+                && memcmp(off_single, off_batch, sizeof(off_single)) == 0;
+
+        printf("%s x%d: single %lu cyc, batch %lu cyc, %s\r\n", single.ops->name, TEST_BATCH_FRAMES,
+               (unsigned long)(t1 - t0), (unsigned long)(t2 - t1), same ? "OK" : "ROZNICA!");
+
+        vc_codec_close(&single);
+        vc_codec_close(&batch);
+    }
+
+    /* Ramki krótsze niż 20 ms: dekodowanie wsadowe bez offsetów idzie krokiem
+     * max_bytes_per_frame, więc musi się zgadzać z długością z encode_frames. */
+    static int16_t pcm_in[TEST_BATCH_FRAMES * TEST_FRAME_SAMPLES];
+    static int16_t pcm_out[TEST_BATCH_FRAMES * TEST_FRAME_SAMPLES];
+    static int16_t pcm_ref[TEST_FRAME_SAMPLES];
+    const uint16_t short_n = TEST_FRAME_SAMPLES / 2u;
+    for (uint32_t i = 0; i < TEST_BATCH_FRAMES * short_n; i++) pcm_in[i] = (int16_t)test_signal[i];
+
+    const vc_codec_id_t short_ids[] = { VC_CODEC_PCM16, VC_CODEC_G711U, VC_CODEC_G711A };
+    for (uint32_t k = 0; k < sizeof(short_ids) / sizeof(short_ids[0]); k++) {
+        vc_enc_cfg_t cfg = { .codec = short_ids[k], .samples_per_block = short_n };
+        vc_codec_t enc, dec, ref;
+        uint32_t len = 0, diff = 0;
+        vc_codec_open(&enc, &cfg, VC_CODEC_DIR_ENC);
+        vc_codec_open(&dec, &cfg, VC_CODEC_DIR_DEC);
+        vc_codec_open(&ref, &cfg, VC_CODEC_DIR_DEC);
+
+        vc_codec_encode_frames(&enc, pcm_in, TEST_BATCH_FRAMES, out_batch, sizeof(out_batch), off_batch, &len);
+        vc_status_t st = vc_codec_decode_frames(&dec, out_batch, NULL, TEST_BATCH_FRAMES, pcm_out);
+        for (uint32_t f = 0; f < TEST_BATCH_FRAMES; f++) {
+            uint32_t flen = off_batch[f + 1] - off_batch[f];
+            vc_codec_decode_frames(&ref, out_batch + off_batch[f], NULL, 1, pcm_ref);
+            if (flen != vc_codec_max_bytes_per_frame(&dec)
+                || memcmp(pcm_ref, pcm_out + f * short_n, short_n * sizeof(int16_t)) != 0) diff++;
+        }
+        printf("%s x%d po %u probek: %lu B, dekodowanie bez offsetow %d, zle ramki %lu\r\n", enc.ops->name,
+               TEST_BATCH_FRAMES, short_n, (unsigned long)len, st, (unsigned long)diff);
+
+        vc_codec_close(&enc);
+        vc_codec_close(&dec);
+        vc_codec_close(&ref);
+    }
+}
+
+/* Stereo: L = sinus 300 Hz, R = szum. Kodowanie 2-kanałowe (IMA: bloki MS-IMA, G.722:
+ * ramka na kanał), dekodowanie z metadanych i SNR osobno dla każdego kanału. */
+void test_stereo_compression(void)
+{
+    static float32_t left[TEST_FRAME_SAMPLES], right[TEST_FRAME_SAMPLES];
+    static float32_t stereo_f32[2 * TEST_FRAME_SAMPLES];
+    static int16_t stereo_pcm[2 * TEST_FRAME_SAMPLES];
+    static int16_t stereo_out[2 * TEST_FRAME_SAMPLES];
+    static uint8_t payload[2 * VC_PCM16_BYTES_PER_FRAME];
+
+    test_generate_sine_f32(left, TEST_FRAME_SAMPLES, 6000.0f, 300.0f);
+    test_generate_white_noise_f32(right, TEST_FRAME_SAMPLES, 3000.0f);
+    for (int i = 0; i < TEST_FRAME_SAMPLES; i++) {
+        stereo_f32[2 * i]     = left[i];
+        stereo_f32[2 * i + 1] = right[i];
+    }
+    vc_convert_float32_to_int16(stereo_f32, stereo_pcm, 2 * TEST_FRAME_SAMPLES);
+
+    const vc_codec_id_t ids[] = { VC_CODEC_PCM16, VC_CODEC_IMA_ADPCM, VC_CODEC_G722 };
+    for (uint32_t k = 0; k < sizeof(ids) / sizeof(ids[0]); k++) {
+        vc_enc_cfg_t cfg = { .codec = ids[k], .samples_per_block = TEST_FRAME_SAMPLES, .channels = 2 };
+        vc_pcm_meta_t pcm_meta = { .channels = 2, .len_samples = TEST_FRAME_SAMPLES };
+        vc_codec_t enc, dec;
+        vc_stream_meta_t meta;
+        vc_enc_cfg_t dec_cfg;
+
+        if (vc_codec_open(&enc, &cfg, VC_CODEC_DIR_ENC) != VC_OK) continue;
+        vc_codec_meta(&enc, &meta);
+        uint16_t len = compress_data(&enc, &pcm_meta, stereo_f32, payload);
+
+        vc_codec_cfg_from_meta(&meta, &dec_cfg);
+        vc_codec_open(&dec, &dec_cfg, VC_CODEC_DIR_DEC);
+        decompress_data(&dec, &pcm_meta, payload, len, stereo_out);
+
+        /* G.722: pomiń opóźnienie QMF */
+        uint16_t d = enc.ops->delay_samples;
+        float32_t snr[2];
+        for (int ch = 0; ch < 2; ch++) {
+            float32_t sig = 0.0f, err = 0.0f;
+            for (int i = 0; i + d < TEST_FRAME_SAMPLES; i++) {
+                float32_t x = (float32_t)stereo_pcm[2 * i + ch];
+                float32_t e = x - (float32_t)stereo_out[2 * (i + d) + ch];
+                sig += x * x;
+                err += e * e;
+            }
+            snr[ch] = (err > 0.0f) ? 10.0f * log10f(sig / err) : 99.0f;
+        }
+        printf("%s stereo: %u B/ramka, block_align %u, SNR L %.1f dB, R %.1f dB\r\n",
+               enc.ops->name, len, meta.block_align, snr[0], snr[1]);
+
+        vc_codec_close(&enc);
+        vc_codec_close(&dec);
+    }
+}
+
 void run_encoders_test(void)
 {
     // Inicjalizacja generatora liczb losowych
@@ -181,6 +740,16 @@ void run_encoders_test(void)
     
     // Uruchom wszystkie testy
     test_g722_compression();
+    test_g722_cycles();
     // test_pcm16_compression();
     // test_ima_adpcm_compression();
+    // test_g711_compression();
+    // test_batch_compression();
+    // test_g722_modes();
+    // test_g722_bitexact();
+    // test_plc_concealment();
+    // test_codec_select();
+    // test_ima_lookahead();
+    // test_stereo_compression();
+    // test_lpc_roundtrip();
 }
@@ -1,9 +1,549 @@
 #include "tests/test_fatfs.h"
 #include "fatfs/app_fatfs.h"
+#include "fatfs/vc_wav_writer.h"
+#include "fatfs/vc_stream_reader.h"
+#include "fatfs/vc_vcmd_writer.h"
+#include "fatfs/vc_write_behind.h"
+#include "fatfs/vc_recover.h"
+#include "fatfs/vc_segment_writer.h"
+#include "fatfs/vc_rec_index.h"
+#include "voicecmd/vc_codec.h"
+#include "voicecmd/vc_crc32.h"
+#include "voicecmd/vc_encoders.h"
+#include "main.h"
+#include "fatfs.h"   // ff_gen_drv.h + usbh_diskio.h (liczniki cache diskio)
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <stdlib.h>
 
+#define TEST_RT_FRAMES 250   // 5 s
+
+// Zapis 5 s IMA-ADPCM (sinus 440 Hz) writerem i odczyt readerem:
+// liczba próbek, zgodność z dekodowaniem z pamięci i czas odczytu.
+void test_wav_roundtrip(void)
+{
+    static vc_wav_writer_t writer;
+    static vc_stream_reader_t reader;
+    static int16_t pcm[VC_FRAME_SAMPLES];
+    static int16_t ref[VC_FRAME_SAMPLES];
+    static int16_t out[VC_FRAME_SAMPLES];
+    uint8_t block[VC_IMA_MONO_BYTES_PER_FRAME];
+    FATFS fs;
+
+    if (f_mount(&fs, "", 1) != FR_OK) return;
+
+    vc_enc_cfg_t cfg = { .codec = VC_CODEC_IMA_ADPCM, .samples_per_block = VC_FRAME_SAMPLES };
+    vc_codec_t enc;
+    vc_stream_meta_t meta;
+    vc_codec_open(&enc, &cfg, VC_CODEC_DIR_ENC);
+    vc_codec_meta(&enc, &meta);
+
+    uint32_t t0 = HAL_GetTick();
+    vc_wav_writer_open(&writer, "rt.wav", &meta);
+    for (uint32_t f = 0; f < TEST_RT_FRAMES; f++) {
+        for (uint32_t i = 0; i < VC_FRAME_SAMPLES; i++) {
+            pcm[i] = (int16_t)(8000.0f * sinf(2.0f * PI * 440.0f * (float32_t)(f * VC_FRAME_SAMPLES + i) / VC_FS_HZ));
+        }
+        uint32_t len = 0;
+        vc_codec_encode_frames(&enc, pcm, 1, block, sizeof(block), NULL, &len);
+        vc_wav_writer_write(&writer, block, len);
+    }
+    vc_status_t wst = vc_wav_writer_close(&writer);
+    uint32_t t1 = HAL_GetTick();
+
+    // Odczyt: drugi dekoder na blokach z pliku vs dekoder readera
+    vc_codec_t dec;
+    vc_codec_open(&dec, &cfg, VC_CODEC_DIR_DEC);
+    uint32_t samples = 0, mismatch = 0;
+    uint16_t n = 0;
+    const uint8_t *blk;
+    uint16_t blk_len;
+    vc_status_t rst = vc_reader_open(&reader, "rt.wav");
+    uint32_t t2 = HAL_GetTick();
+    while (rst == VC_OK && vc_reader_next_block(&reader, &blk, &blk_len) == VC_OK) {
+        uint32_t offsets[2] = { 0, blk_len };
+        vc_codec_decode_frames(&reader.dec, blk, offsets, 1, out);
+        vc_codec_decode_frames(&dec, blk, offsets, 1, ref);
+        n = reader.dec.frame_samples;
+        mismatch += (memcmp(out, ref, sizeof(out)) != 0);
+        samples += n;
+    }
+    uint32_t t3 = HAL_GetTick();
+    vc_reader_close(&reader);
+
+    printf("WAV IMA: zapis %d (%lu ms), odczyt %d: %lu probek, %lu ms, rozne ramki %lu\r\n",
+           wst, (unsigned long)(t1 - t0), rst, (unsigned long)samples,
+           (unsigned long)(t3 - t2), (unsigned long)mismatch);
+
+    vc_codec_close(&enc);
+    vc_codec_close(&dec);
+    f_mount(NULL, "", 1);
+}
+
+#define TEST_VCMD_FRAMES 3000   // 60 s
+
+// VCMD z LPC (ramki zmiennej długości): zapis z indeksem, potem skoki w losowe
+// miejsca - czas seek_frame + read_frame vs dekodowanie sekwencyjne od początku.
+void test_vcmd_seek(void)
+{
+    static vc_vcmd_writer_t writer;
+    static vc_stream_reader_t reader;
+    static uint32_t index[VC_VCMD_INDEX_MAX];
+    static int16_t pcm[VC_FRAME_SAMPLES];
+    static uint8_t block[VC_LPC_MAX_BYTES_PER_FRAME];
+    FATFS fs;
+
+    if (f_mount(&fs, "", 1) != FR_OK) return;
+
+    vc_enc_cfg_t cfg = { .codec = VC_CODEC_LPC_RICE };
+    vc_codec_t enc;
+    vc_codec_open(&enc, &cfg, VC_CODEC_DIR_ENC);
+    vc_vcmd_writer_open(&writer, "seek.vcm", &enc);
+    for (uint32_t f = 0; f < TEST_VCMD_FRAMES; f++) {
+        for (uint32_t i = 0; i < VC_FRAME_SAMPLES; i++) {
+            pcm[i] = (int16_t)(6000.0f * sinf(2.0f * PI * 300.0f * (float32_t)(f * VC_FRAME_SAMPLES + i) / VC_FS_HZ)
+                               + (float32_t)(rand() % 512 - 256));
+        }
+        uint32_t len = 0;
+        vc_codec_encode_frames(&enc, pcm, 1, block, sizeof(block), NULL, &len);
+        vc_vcmd_writer_write_block(&writer, block, (uint16_t)len);
+    }
+    vc_status_t wst = vc_vcmd_writer_close(&writer);
+    vc_codec_close(&enc);
+
+    vc_status_t rst = vc_reader_open(&reader, "seek.vcm");
+    if (rst == VC_OK) rst = vc_reader_load_index(&reader, index, VC_VCMD_INDEX_MAX);
+
+    // Te same skoki z mapą klastrów (fast seek) i po jej wyłączeniu (łańcuch FAT).
+    uint8_t fast = reader.fast_seek;
+    for (int mode = 0; mode < 2 && rst == VC_OK; mode++) {
+        if (mode) reader.file.cltbl = NULL;
+        srand(1);
+        uint32_t t0 = HAL_GetTick(), worst = 0;
+        for (int k = 0; k < 20 && rst == VC_OK; k++) {
+            uint32_t ts = HAL_GetTick();
+            uint16_t n;
+            rst = vc_reader_seek_frame(&reader, (uint32_t)rand() % TEST_VCMD_FRAMES);
+            if (rst == VC_OK) rst = vc_reader_read_frame(&reader, pcm, &n);
+            if (HAL_GetTick() - ts > worst) worst = HAL_GetTick() - ts;
+        }
+        uint32_t t1 = HAL_GetTick();
+        printf("VCMD LPC: zapis %d, indeks %lu x %lu ramek, %s: 20 skokow %lu ms (max %lu ms), status %d\r\n",
+               wst, (unsigned long)reader.hdr.index_entries, (unsigned long)reader.hdr.index_interval,
+               (mode == 0 && fast) ? "fast seek" : "lancuch FAT",
+               (unsigned long)(t1 - t0), (unsigned long)worst, rst);
+    }
+    vc_reader_close(&reader);
+    f_mount(NULL, "", 1);
+}
+
+#define TEST_CRC_WORDS 1024   // 4 KiB
+
+void test_crc32_speed(void)
+{
+    static uint32_t data[TEST_CRC_WORDS];
+    static vc_stream_reader_t reader;
+    FATFS fs;
+
+    for (uint32_t i = 0; i < TEST_CRC_WORDS; i++) data[i] = (uint32_t)rand();
+
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    uint32_t t0 = DWT->CYCCNT;
+    uint32_t sw = vc_crc32_words_sw(VC_CRC32_INIT, data, TEST_CRC_WORDS);
+    uint32_t t1 = DWT->CYCCNT;
+    uint32_t hw = vc_crc32(data, sizeof(data));
+    uint32_t t2 = DWT->CYCCNT;
+
+    // Async: CPU wolny w trakcie transferu DMA
+    vc_crc32_t c;
+    vc_crc32_init(&c);
+    vc_crc32_update_async(&c, data, sizeof(data));
+    uint32_t t3 = DWT->CYCCNT;
+    uint32_t hw_async = vc_crc32_final(&c);
+    uint32_t t4 = DWT->CYCCNT;
+
+    printf("CRC32 4 KiB: sw %08lx %lu cyk, hw %08lx %lu cyk, async %08lx start %lu cyk + wait %lu cyk\r\n",
+           (unsigned long)sw, (unsigned long)(t1 - t0), (unsigned long)hw, (unsigned long)(t2 - t1),
+           (unsigned long)hw_async, (unsigned long)(t3 - t2), (unsigned long)(t4 - t3));
+
+    if (f_mount(&fs, "", 1) != FR_OK) return;
+    if (vc_reader_open(&reader, "seek.vcm") == VC_OK) {
+        uint32_t ts = HAL_GetTick();
+        vc_status_t st = vc_reader_verify_crc(&reader);
+        printf("VCMD CRC %08lx: status %d, %lu ms\r\n", (unsigned long)reader.hdr.crc32, st,
+               (unsigned long)(HAL_GetTick() - ts));
+        vc_reader_close(&reader);
+    }
+    f_mount(NULL, "", 1);
+}
+
+#define TEST_PREALLOC_FRAMES 1500   // 30 s
+
+// Czas vc_wav_writer_write ramki PCM16 (co 4 KiB f_write): najgorszy przypadek
+// i liczba ramek > 20 ms, bez rezerwacji (przydział klastrów w trakcie) i z f_expand.
+void test_prealloc_latency(void)
+{
+    static vc_wav_writer_t writer;
+    static int16_t pcm[VC_FRAME_SAMPLES];
+    vc_stream_meta_t meta;
+    FATFS fs;
+
+    if (f_mount(&fs, "", 1) != FR_OK) return;
+    vc_meta_pcm16_make(&meta);
+
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    const uint32_t cyc_per_us = SystemCoreClock / 1000000u;
+
+    for (int mode = 0; mode < 2; mode++) {
+        vc_status_t rst = VC_OK;
+        vc_wav_writer_open(&writer, mode ? "pre.wav" : "nopre.wav", &meta);
+        uint32_t tr = HAL_GetTick();
+        if (mode) rst = vc_wav_writer_reserve_ms(&writer, TEST_PREALLOC_FRAMES * 20u);
+        tr = HAL_GetTick() - tr;
+
+        uint32_t worst = 0, over = 0;
+        for (uint32_t f = 0; f < TEST_PREALLOC_FRAMES; f++) {
+            for (uint32_t i = 0; i < VC_FRAME_SAMPLES; i++) pcm[i] = (int16_t)(f + i);
+            uint32_t t0 = DWT->CYCCNT;
+            vc_wav_writer_write(&writer, pcm, sizeof(pcm));
+            uint32_t us = (DWT->CYCCNT - t0) / cyc_per_us;
+            if (us > worst) worst = us;
+            if (us > 20000u) over++;
+        }
+        vc_status_t cst = vc_wav_writer_close(&writer);
+        printf("%s: rezerwacja %d (%lu ms), max zapis ramki %lu us, > 20 ms: %lu, zamkniecie %d\r\n",
+               mode ? "f_expand" : "bez rezerwacji", rst, (unsigned long)tr,
+               (unsigned long)worst, (unsigned long)over, cst);
+    }
+    f_mount(NULL, "", 1);
+}
+
+#define TEST_WB_FRAMES 500   // 10 s
+
+// Producent co 20 ms (jak tor I2S) dopisuje ramkę do kolejki; zadanie zapisu
+// obsługiwane w pętli, ale co 2 s wstrzymane na 200 ms (symulacja przestoju USB).
+void test_write_behind_stall(void)
+{
+    static vc_wb_t wb;
+    static vc_wav_writer_t writer;
+    static int16_t pcm[VC_FRAME_SAMPLES];
+    vc_stream_meta_t meta;
+    FATFS fs;
+
+    if (f_mount(&fs, "", 1) != FR_OK) return;
+    vc_meta_pcm16_make(&meta);
+
+    if (vc_wb_open(&wb, "wb.wav") != VC_OK) { f_mount(NULL, "", 1); return; }
+    vc_wav_writer_open_sink(&writer, &wb.sink, &meta);
+    vc_wav_writer_reserve_ms(&writer, TEST_WB_FRAMES * 20u);
+
+    uint32_t lost = 0, next = HAL_GetTick();
+    for (uint32_t f = 0; f < TEST_WB_FRAMES; ) {
+        uint32_t now = HAL_GetTick();
+        if ((int32_t)(now - next) >= 0) {
+            for (uint32_t i = 0; i < VC_FRAME_SAMPLES; i++) pcm[i] = (int16_t)(f + i);
+            if (vc_wav_writer_write(&writer, pcm, sizeof(pcm)) != VC_OK) lost++;
+            next += 20u;
+            f++;
+        }
+        if ((f % 100u) >= 10u) vc_storage_task();   // ramki 0-9 co 2 s: przestój 200 ms
+    }
+    vc_wb_finish(&wb);
+    vc_status_t cst = vc_wav_writer_close(&writer);
+
+    printf("write-behind: zgubione %lu/%u, high-water %lu B z %u, f_write %lu, bledy %lu, zamkniecie %d\r\n",
+           (unsigned long)lost, TEST_WB_FRAMES, (unsigned long)wb.stats.high_water_bytes, VC_WB_RING_BYTES,
+           (unsigned long)wb.stats.writes, (unsigned long)wb.stats.io_errors, cst);
+    f_mount(NULL, "", 1);
+}
+
+#define TEST_CACHE_BYTES (1024u * 1024u)
+
+// Najgorszy przypadek dla BOT: f_write/f_read po jednym sektorze (FatFs przez okno FIL,
+// disk_write/disk_read pojedynczych sektorów) - cache diskio skleja je w transfery 8 KiB.
+void test_diskio_cache(void)
+{
+    static uint8_t sector[512];
+    USBH_DiskCacheStatsTypeDef st;
+    FIL file;
+    FATFS fs;
+    UINT n;
+
+    if (f_mount(&fs, "", 1) != FR_OK) return;
+    for (uint32_t i = 0; i < sizeof(sector); i++) sector[i] = (uint8_t)i;
+
+    USBH_DiskCache_ResetStats();
+    uint32_t t0 = HAL_GetTick();
+    if (f_open(&file, "cache.bin", FA_WRITE | FA_CREATE_ALWAYS) == FR_OK) {
+        for (uint32_t b = 0; b < TEST_CACHE_BYTES; b += sizeof(sector)) f_write(&file, sector, sizeof(sector), &n);
+        f_close(&file);
+    }
+    uint32_t t1 = HAL_GetTick();
+    USBH_DiskCache_GetStats(&st);
+    printf("diskio zapis: %lu zadan / %lu transferow MSC, %lu ms (%lu kB/s)\r\n",
+           (unsigned long)st.write_requests, (unsigned long)st.dev_writes, (unsigned long)(t1 - t0),
+           (unsigned long)(TEST_CACHE_BYTES / ((t1 - t0) ? (t1 - t0) : 1u)));
+
+    USBH_DiskCache_ResetStats();
+    t0 = HAL_GetTick();
+    if (f_open(&file, "cache.bin", FA_READ | FA_OPEN_EXISTING) == FR_OK) {
+        for (uint32_t b = 0; b < TEST_CACHE_BYTES; b += sizeof(sector)) f_read(&file, sector, sizeof(sector), &n);
+        f_close(&file);
+    }
+    t1 = HAL_GetTick();
+    USBH_DiskCache_GetStats(&st);
+    printf("diskio odczyt: %lu zadan / %lu transferow MSC, trafienia %lu sekt., %lu ms (%lu kB/s)\r\n",
+           (unsigned long)st.read_requests, (unsigned long)st.dev_reads, (unsigned long)st.read_hit_sectors,
+           (unsigned long)(t1 - t0), (unsigned long)(TEST_CACHE_BYTES / ((t1 - t0) ? (t1 - t0) : 1u)));
+    f_mount(NULL, "", 1);
+}
+
+#define TEST_CKPT_FRAMES 375   // 7,5 s
+#define TEST_CKPT_MS     1000u
+
+// "Zanik zasilania": nagranie porzucone bez close, odmontowanie i ponowne montowanie.
+// Odzyskane powinno być 7 s (ostatni punkt kontrolny), reszta rezerwacji przycięta.
+void test_checkpoint_recovery(void)
+{
+    static vc_wav_writer_t writer;
+    static vc_stream_reader_t reader;
+    static int16_t pcm[VC_FRAME_SAMPLES];
+    vc_stream_meta_t meta;
+    FATFS fs;
+
+    if (f_mount(&fs, "", 1) != FR_OK) return;
+    vc_meta_pcm16_make(&meta);
+
+    if (vc_wav_writer_open(&writer, "ckpt.wav", &meta) != VC_OK) { f_mount(NULL, "", 1); return; }
+    vc_wav_writer_reserve_ms(&writer, 10000);
+    vc_wav_writer_set_checkpoint(&writer, TEST_CKPT_MS);
+
+    uint32_t worst = 0, worst_ckpt = 0;
+    for (uint32_t f = 0; f < TEST_CKPT_FRAMES; f++) {
+        for (uint32_t i = 0; i < VC_FRAME_SAMPLES; i++) pcm[i] = (int16_t)(f + i);
+        uint32_t before = writer.ckpt_next;
+        uint32_t t0 = HAL_GetTick();
+        vc_wav_writer_write(&writer, pcm, sizeof(pcm));
+        uint32_t dt = HAL_GetTick() - t0;
+        if (writer.ckpt_next != before) { if (dt > worst_ckpt) worst_ckpt = dt; }
+        else if (dt > worst) worst = dt;
+    }
+    f_mount(NULL, "", 1);   // bez vc_wav_writer_close
+
+    if (f_mount(&fs, "", 1) != FR_OK) return;
+    uint8_t repaired = 0;
+    vc_status_t rst = vc_recover_file("ckpt.wav", &repaired);
+
+    uint32_t samples = 0, bad = 0;
+    uint16_t n;
+    if (vc_reader_open(&reader, "ckpt.wav") == VC_OK) {
+        while (vc_reader_read_frame(&reader, pcm, &n) == VC_OK) {
+            uint32_t f = samples / VC_FRAME_SAMPLES;
+            if (n == VC_FRAME_SAMPLES && pcm[0] != (int16_t)f) bad++;
+            samples += n;
+        }
+        vc_reader_close(&reader);
+    }
+    printf("checkpoint: naprawa %d (zmieniony %u), odzyskane %lu ms z %u ms, zle ramki %lu, "
+           "max ramka %lu ms, max z punktem %lu ms\r\n",
+           rst, repaired, (unsigned long)(samples / (meta.sample_rate_hz / 1000u)), TEST_CKPT_FRAMES * 20u,
+           (unsigned long)bad, (unsigned long)worst, (unsigned long)worst_ckpt);
+
+    // Kolejne montowanie: naprawiony plik rozpoznany po sektorze nagłówka, bez czytnika.
+    uint32_t t0 = HAL_GetTick();
+    rst = vc_recover_file("ckpt.wav", &repaired);
+    printf("checkpoint: ponowne sprawdzenie %d (zmieniony %u), %lu ms\r\n", rst, repaired,
+           (unsigned long)(HAL_GetTick() - t0));
+    f_mount(NULL, "", 1);
+}
+
+#define TEST_SEG_FRAMES     350   // 7 s
+#define TEST_SEG_CUT_FRAMES 260   // 5,2 s: zanik w trzecim segmencie
+#define TEST_SEG_MS         2000u
+
+static vc_wb_t seg_wb;
+static vc_seg_writer_t seg;
+static vc_stream_reader_t seg_reader;
+static int16_t seg_pcm[VC_FRAME_SAMPLES];
+
+// Ramki co 20 ms, pierwsza próbka = numer ramki w nagraniu; vc_storage_task w pętli.
+static void test_seg_record(uint32_t frames, uint32_t *lost, uint32_t *worst_task)
+{
+    uint32_t next = HAL_GetTick();
+    *lost = 0;
+    *worst_task = 0;
+    for (uint32_t fr = 0; fr < frames; ) {
+        if ((int32_t)(HAL_GetTick() - next) >= 0) {
+            for (uint32_t i = 0; i < VC_FRAME_SAMPLES; i++) seg_pcm[i] = (int16_t)(fr + i);
+            if (vc_seg_write_frame(&seg, (const uint8_t *)seg_pcm, sizeof(seg_pcm)) != VC_OK) (*lost)++;
+            next += 20u;
+            fr++;
+        }
+        uint32_t t0 = HAL_GetTick();
+        vc_storage_task();
+        uint32_t dt = HAL_GetTick() - t0;
+        if (dt > *worst_task) *worst_task = dt;
+    }
+}
+
+// Manifest -> segmenty: ramki odczytane, złe próbki, wpisy niezgodne z plikami (liczba
+// ramek, ciągłość first_frame); *last_flags = flagi ostatniego wpisu.
+static void test_seg_check(const char *dir, vc_manifest_header_t *mh, uint32_t *frames, uint32_t *bad,
+                           uint32_t *mismatch, uint16_t *last_flags)
+{
+    char path[VC_WB_PATH_MAX];
+    vc_manifest_entry_t e;
+    FIL f;
+    UINT br;
+
+    memset(mh, 0, sizeof(*mh));
+    *frames = *bad = *mismatch = 0;
+    *last_flags = 0;
+    snprintf(path, sizeof(path), "%s/" VC_SEG_MANIFEST_NAME, dir);
+    if (f_open(&f, path, FA_READ | FA_OPEN_EXISTING) != FR_OK) return;
+    f_read(&f, mh, sizeof(*mh), &br);
+    for (uint32_t k = 0; k < mh->entry_count; k++) {
+        f_read(&f, &e, sizeof(e), &br);
+        snprintf(path, sizeof(path), "%s/S%03u.WAV", dir, e.segment);
+
+        uint32_t n_read = 0;
+        uint16_t n;
+        if (vc_reader_open(&seg_reader, path) == VC_OK) {
+            while (vc_reader_read_frame(&seg_reader, seg_pcm, &n) == VC_OK) {
+                if (seg_pcm[0] != (int16_t)(e.first_frame + n_read)) (*bad)++;
+                n_read++;
+            }
+            vc_reader_close(&seg_reader);
+        }
+        if (n_read != e.frames || e.first_frame != *frames) (*mismatch)++;
+        *frames += n_read;
+        *last_flags = e.flags;
+    }
+    f_close(&f);
+}
+
+// Segmenty 2 s: każdy plik czytany osobno, pierwsza próbka ramki = jej numer w całym nagraniu.
+// Potem zanik zasilania w trzecim segmencie (punkty kontrolne co 250 ms): vc_seg_recover
+// naprawia segment i dopisuje jego wpis do manifestu.
+void test_segment_rotation(void)
+{
+    vc_enc_cfg_t cfg = { .codec = VC_CODEC_PCM16 };
+    vc_codec_t enc;
+    vc_manifest_header_t mh;
+    vc_recover_stats_t rs;
+    uint32_t lost, worst_task, frames, bad, mismatch;
+    uint16_t last_flags;
+    FATFS fs;
+
+    if (f_mount(&fs, "", 1) != FR_OK) return;
+    vc_codec_open(&enc, &cfg, VC_CODEC_DIR_ENC);
+    if (vc_seg_open(&seg, &seg_wb, "SEGTEST", VC_SEG_WAV, &enc, TEST_SEG_MS) != VC_OK) { f_mount(NULL, "", 1); return; }
+    test_seg_record(TEST_SEG_FRAMES, &lost, &worst_task);
+    vc_status_t cst = vc_seg_close(&seg);
+
+    test_seg_check("SEGTEST", &mh, &frames, &bad, &mismatch, &last_flags);
+    printf("segmenty: %lu plikow, ramki %lu/%u, zgubione %lu, wydluzone %lu, zle %lu, niezgodne wpisy %lu, "
+           "max vc_storage_task %lu ms, zamkniecie %d\r\n",
+           (unsigned long)mh.entry_count, (unsigned long)frames, TEST_SEG_FRAMES, (unsigned long)lost,
+           (unsigned long)seg.deferred, (unsigned long)bad, (unsigned long)mismatch, (unsigned long)worst_task, cst);
+
+    if (vc_seg_open(&seg, &seg_wb, "SEGCUT", VC_SEG_WAV, &enc, TEST_SEG_MS) != VC_OK) { f_mount(NULL, "", 1); return; }
+    vc_seg_set_checkpoint(&seg, 250);
+    test_seg_record(TEST_SEG_CUT_FRAMES, &lost, &worst_task);
+    vc_wb_abort(&seg_wb);   // bez vc_seg_close
+    f_mount(NULL, "", 1);
+
+    if (f_mount(&fs, "", 1) != FR_OK) return;
+    vc_status_t rst = vc_seg_recover("SEGCUT", &rs);
+    test_seg_check("SEGCUT", &mh, &frames, &bad, &mismatch, &last_flags);
+    printf("segmenty po zaniku: naprawa %d (pliki %lu, naprawione %lu), wpisy %lu, ramki %lu/%u, zle %lu, "
+           "niezgodne wpisy %lu, ostatni wpis %s\r\n",
+           rst, (unsigned long)rs.scanned, (unsigned long)rs.repaired, (unsigned long)mh.entry_count,
+           (unsigned long)frames, TEST_SEG_CUT_FRAMES, (unsigned long)bad, (unsigned long)mismatch,
+           (last_flags == (VC_MANIFEST_F_LAST | VC_MANIFEST_F_RECOVERED)) ? "odtworzony (LAST)" : "ZLY");
+    f_mount(NULL, "", 1);
+}
+
+static void test_rec_index_count(void *ctx, const vc_index_entry_t *e)
+{
+    (void)e;
+    (*(uint32_t *)ctx)++;
+}
+
+#define TEST_IX_FILES 300
+#define TEST_IX_DIR   "IXTEST"
+
+// Katalog z TEST_IX_FILES pustymi nagraniami w indeksie: wyszukanie ostatniego
+// przez vc_index_find vs liniowy f_readdir, lista indeksu. Wpisy usuwane na końcu.
+void test_rec_index(void)
+{
+    static vc_index_entry_t e;
+    char name[VC_MAX_PATH];
+    uint32_t put_fail = 0, miss = 0, listed = 0;
+    FATFS fs;
+    FIL file;
+    DIR dir;
+    FILINFO fi;
+
+    if (f_mount(&fs, "", 1) != FR_OK) return;
+    f_mkdir(TEST_IX_DIR);
+
+    uint32_t t0 = HAL_GetTick();
+    for (uint32_t i = 0; i < TEST_IX_FILES; i++) {
+        snprintf(name, sizeof(name), TEST_IX_DIR "/R%04lu.WAV", (unsigned long)i);
+        if (f_open(&file, name, FA_WRITE | FA_CREATE_ALWAYS) == FR_OK) f_close(&file);
+        memset(&e, 0, sizeof(e));
+        strncpy(e.name, name, sizeof(e.name) - 1u);
+        e.duration_ms = i * 1000u;
+        e.codec_id    = VC_CODEC_PCM16;
+        if (vc_index_put(&e) != VC_OK) put_fail++;
+    }
+    uint32_t t_put = HAL_GetTick() - t0;
+
+    snprintf(name, sizeof(name), "R%04lu.WAV", (unsigned long)(TEST_IX_FILES - 1));
+    t0 = HAL_GetTick();
+    uint8_t found = 0;
+    if (f_opendir(&dir, TEST_IX_DIR) == FR_OK) {
+        while (!found && f_readdir(&dir, &fi) == FR_OK && fi.fname[0]) found = (strcmp(fi.fname, name) == 0);
+        f_closedir(&dir);
+    }
+    uint32_t t_scan = HAL_GetTick() - t0;
+
+    t0 = HAL_GetTick();
+    for (uint32_t i = 0; i < TEST_IX_FILES; i += 10) {
+        snprintf(name, sizeof(name), TEST_IX_DIR "/R%04lu.WAV", (unsigned long)i);
+        if (vc_index_find(name, &e) != VC_OK || e.duration_ms != i * 1000u) miss++;
+    }
+    uint32_t t_find = HAL_GetTick() - t0;
+
+    vc_index_foreach(test_rec_index_count, &listed);
+    for (uint32_t i = 0; i < TEST_IX_FILES; i++) {
+        snprintf(name, sizeof(name), TEST_IX_DIR "/R%04lu.WAV", (unsigned long)i);
+        vc_index_remove(name);
+        f_unlink(name);
+    }
+
+    printf("indeks: put %lu ms (bledy %lu), f_readdir do ostatniego %lu ms (%s), find x%u %lu ms (braki %lu), lista %lu\r\n",
+           (unsigned long)t_put, (unsigned long)put_fail, (unsigned long)t_scan, found ? "ok" : "brak",
+           (unsigned)(TEST_IX_FILES / 10), (unsigned long)t_find, (unsigned long)miss, (unsigned long)listed);
+    f_mount(NULL, "", 1);
+}
 
 void run_fatfs_test(){
 
 	int result = fatfs_init();
 
+	// test_wav_roundtrip();
+	// test_vcmd_seek();
+	// test_crc32_speed();
+	// test_prealloc_latency();
+	// test_write_behind_stall();
+	// test_diskio_cache();
+	// test_checkpoint_recovery();
+	// test_segment_rotation();
+	// test_rec_index();
 }
@@ -0,0 +1,244 @@
+#include "tests/test_img_bench.h"
+#include "tests/test_storage_bench.h"
+
+#ifdef VC_HOST_BUILD
+
+#include "port/port_diskio_image.h"
+#include "fatfs/vc_wav_writer.h"
+#include "fatfs/vc_vcmd_writer.h"
+#include "fatfs/vc_stream_reader.h"
+#include "fatfs/vc_recover.h"
+#include "voicecmd/vc_codec.h"
+#include "voicecmd/vc_encoders.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+// Host: gcc -DVC_HOST_BUILD -DVC_IMG_BENCH_MAIN ... test_img_bench.c port_diskio_image.c
+//       Core/Src/fatfs/*.c Core/Src/voicecmd/*.c + ff.c, ff_gen_drv.c, diskio.c (Middlewares FatFs)
+// Uwaga: źródeł FatFs (Middlewares) nie ma w repozytorium - ten program nie był jeszcze
+// zbudowany ani uruchomiony; wyniki z pierwszego przebiegu trzeba zweryfikować.
+
+#define BENCH_IMG_SECTORS   (512u * 2048u)   // 512 MiB (plik rzadki)
+#define BENCH_CLUSTER_BYTES 32768u           // jak na typowym pendrive FAT32
+#define BENCH_FRAMES        3000u            // 60 s
+#define BENCH_LPC_BLOCKS    50u              // kodowane raz, zapisywane cyklicznie
+#define BENCH_FAIL_WRITE    40u              // numer żądania disk_write z błędem
+
+typedef enum {
+    BENCH_RAW = 0,          // f_write po ramce 640 B, bez bufora sektorowego
+    BENCH_WAV,
+    BENCH_WAV_RESERVE,      // + f_expand na całe nagranie
+    BENCH_VCMD,
+} bench_case_t;
+
+static const char *const bench_names[] = { "f_write 640 B", "WAV PCM16", "WAV PCM16 + f_expand", "VCMD LPC" };
+static const char *const bench_files[] = { "RAW.PCM", "BENCH.WAV", "BENCHRES.WAV", "BENCH.VCM" };
+
+static FATFS bench_fs;
+static char bench_drive[4];
+static vc_wav_writer_t bench_wav;
+static vc_vcmd_writer_t bench_vcmd;
+static vc_stream_reader_t bench_reader;
+static vc_codec_t bench_enc;
+static int16_t bench_pcm[VC_FRAME_SAMPLES];
+static uint8_t bench_lpc[BENCH_LPC_BLOCKS][VC_LPC_MAX_BYTES_PER_FRAME];
+static uint16_t bench_lpc_len[BENCH_LPC_BLOCKS];
+
+static double bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void bench_print(const char *name, const char *dir, uint32_t bytes, double sec,
+                        uint32_t fcalls, const port_img_stats_t *st)
+{
+    uint8_t wr = (dir[0] == 'z');
+    uint32_t req = wr ? st->writes : st->reads;
+    uint32_t sect = wr ? st->write_sectors : st->read_sectors;
+    uint32_t seq = wr ? st->seq_writes : st->seq_reads;
+    const uint32_t *sz = wr ? st->write_sizes : st->read_sizes;
+
+    printf("%-22s %-6s %7.2f MB/s  f_%s %5lu  diskio %5lu zadan / %6lu sekt.  sekw. %3lu%%  FAT %4lu"
+           "  rozm. 1:%lu 2-7:%lu 8-15:%lu 16-63:%lu 64-127:%lu 128+:%lu  sync %lu\r\n",
+           name, dir, sec > 0.0 ? (double)bytes / sec / 1e6 : 0.0, wr ? "write" : "read", (unsigned long)fcalls,
+           (unsigned long)req, (unsigned long)sect, (unsigned long)(req ? 100u * seq / req : 0u),
+           (unsigned long)(wr ? st->fat_writes : 0u),
+           (unsigned long)sz[0], (unsigned long)sz[1], (unsigned long)sz[2], (unsigned long)sz[3],
+           (unsigned long)sz[4], (unsigned long)sz[5], (unsigned long)st->syncs);
+}
+
+static void bench_fill_pcm(uint32_t f)
+{
+    for (uint32_t i = 0; i < VC_FRAME_SAMPLES; i++) {
+        bench_pcm[i] = (int16_t)(6000.0f * sinf(2.0f * (float)M_PI * 300.0f * (float)(f * VC_FRAME_SAMPLES + i) / VC_FS_HZ)
+                                 + (float)(rand() % 512 - 256));
+    }
+}
+
+// Zapis BENCH_FRAMES ramek; *fcalls = wywołania f_write, *bytes = rozmiar pliku.
+static vc_status_t bench_write(bench_case_t c, uint32_t *fcalls, uint32_t *bytes)
+{
+    vc_stream_meta_t m;
+    vc_status_t st = VC_OK, cst;
+    FIL file;
+    UINT bw;
+
+    vc_meta_pcm16_make(&m);
+    *fcalls = 0;
+    *bytes = 0;
+
+    switch (c) {
+    case BENCH_RAW:
+        if (f_open(&file, bench_files[c], FA_WRITE | FA_CREATE_ALWAYS) != FR_OK) return VC_E_IO;
+        for (uint32_t f = 0; f < BENCH_FRAMES && st == VC_OK; f++) {
+            if (f_write(&file, bench_pcm, sizeof(bench_pcm), &bw) != FR_OK || bw != sizeof(bench_pcm)) st = VC_E_IO;
+            (*fcalls)++;
+        }
+        *bytes = (uint32_t)f_size(&file);
+        if (f_close(&file) != FR_OK && st == VC_OK) st = VC_E_IO;
+        return st;
+
+    case BENCH_WAV:
+    case BENCH_WAV_RESERVE:
+        st = vc_wav_writer_open(&bench_wav, bench_files[c], &m);
+        if (st == VC_OK && c == BENCH_WAV_RESERVE) st = vc_wav_writer_reserve_ms(&bench_wav, BENCH_FRAMES * VC_FRAME_MS);
+        for (uint32_t f = 0; f < BENCH_FRAMES && st == VC_OK; f++)
+            st = vc_wav_writer_write(&bench_wav, bench_pcm, sizeof(bench_pcm));
+        cst = vc_wav_writer_close(&bench_wav);
+        *fcalls = bench_wav.out.writes;
+        *bytes = bench_wav.out.flushed_bytes;
+        return (st != VC_OK) ? st : cst;
+
+    case BENCH_VCMD:
+        st = vc_vcmd_writer_open(&bench_vcmd, bench_files[c], &bench_enc);
+        for (uint32_t f = 0; f < BENCH_FRAMES && st == VC_OK; f++)
+            st = vc_vcmd_writer_write_block(&bench_vcmd, bench_lpc[f % BENCH_LPC_BLOCKS], bench_lpc_len[f % BENCH_LPC_BLOCKS]);
+        cst = vc_vcmd_writer_close(&bench_vcmd);
+        *fcalls = bench_vcmd.out.writes;
+        *bytes = bench_vcmd.out.flushed_bytes;
+        return (st != VC_OK) ? st : cst;
+    }
+    return VC_E_PARAM;
+}
+
+// Odczyt całego payloadu czytnikiem (bloki bez dekodowania); *fcalls = bloki.
+static vc_status_t bench_read(const char *path, uint32_t *fcalls, uint32_t *bytes)
+{
+    const uint8_t *block;
+    uint16_t len;
+    vc_status_t st = vc_reader_open(&bench_reader, path);
+
+    *fcalls = 0;
+    *bytes = 0;
+    while (st == VC_OK && (st = vc_reader_next_block(&bench_reader, &block, &len)) == VC_OK) {
+        *bytes += len;
+        (*fcalls)++;
+    }
+    vc_reader_close(&bench_reader);
+    return (st == VC_E_EMPTY) ? VC_OK : st;
+}
+
+static vc_status_t bench_run(bench_case_t c, const char *tag)
+{
+    port_img_stats_t st;
+    uint32_t calls, bytes;
+    char name[40];
+
+    snprintf(name, sizeof(name), "%s%s", bench_names[c], tag);
+    port_img_reset_stats();
+    double t0 = bench_now();
+    vc_status_t ws = bench_write(c, &calls, &bytes);
+    double t1 = bench_now();
+    port_img_get_stats(&st);
+    bench_print(name, "zapis", bytes, t1 - t0, calls, &st);
+    if (ws != VC_OK || c == BENCH_RAW) return ws;
+
+    port_img_reset_stats();
+    t0 = bench_now();
+    vc_status_t rs = bench_read(bench_files[c], &calls, &bytes);
+    t1 = bench_now();
+    port_img_get_stats(&st);
+    bench_print(name, "odczyt", bytes, t1 - t0, calls, &st);
+    return rs;
+}
+
+void run_img_bench(const char *image)
+{
+    static BYTE work[_MAX_SS];
+    vc_enc_cfg_t cfg = { .codec = VC_CODEC_LPC_RICE };
+
+    if (port_img_open(image, BENCH_IMG_SECTORS) != VC_OK) {
+        printf("bench: brak obrazu %s\r\n", image);
+        return;
+    }
+    if (FATFS_LinkDriver(&IMG_Driver, bench_drive) != 0
+        || f_mkfs(bench_drive, FM_FAT32, BENCH_CLUSTER_BYTES, work, sizeof(work)) != FR_OK
+        || f_mount(&bench_fs, bench_drive, 1) != FR_OK) {
+        printf("bench: f_mkfs/f_mount nieudane\r\n");
+        port_img_close();
+        return;
+    }
+    port_img_set_data_start(bench_fs.database);
+
+    srand(1);
+    vc_codec_open(&bench_enc, &cfg, VC_CODEC_DIR_ENC);
+    for (uint32_t b = 0; b < BENCH_LPC_BLOCKS; b++) {
+        uint32_t len = 0;
+        bench_fill_pcm(b);
+        vc_codec_encode_frames(&bench_enc, bench_pcm, 1, bench_lpc[b], sizeof(bench_lpc[b]), NULL, &len);
+        bench_lpc_len[b] = (uint16_t)len;
+    }
+    bench_fill_pcm(0);
+
+    printf("bench: obraz %s, %lu MiB, klaster %lu B, %lu ramek (%lu s)\r\n", image,
+           (unsigned long)(BENCH_IMG_SECTORS / 2048u), (unsigned long)BENCH_CLUSTER_BYTES,
+           (unsigned long)BENCH_FRAMES, (unsigned long)(BENCH_FRAMES * VC_FRAME_MS / 1000u));
+    for (int c = BENCH_RAW; c <= BENCH_VCMD; c++) bench_run((bench_case_t)c, "");
+    test_storage_bench(bench_drive);
+
+    // Pendrive USB FS: ~1 MB/s, narzut na komendę MSC, okresowe porządkowanie bloków.
+    port_img_faults_t stick = { .read_us = 300, .write_us = 500, .sector_us = 450,
+                                .sync_us = 2000, .stall_every = 64, .stall_us = 100000 };
+    port_img_set_faults(&stick);
+    bench_run(BENCH_RAW, " (pendrive)");
+    bench_run(BENCH_WAV, " (pendrive)");
+    bench_run(BENCH_WAV_RESERVE, " (pendrive)");
+    test_storage_bench(bench_drive);
+
+    // Błąd zapisu w trakcie nagrania: status writera, potem naprawa jak po ponownym montowaniu.
+    port_img_faults_t fail = { .fail_write_at = BENCH_FAIL_WRITE };
+    port_img_set_faults(&fail);
+    vc_status_t ws = bench_run(BENCH_WAV, " (blad zapisu)");
+    port_img_set_faults(NULL);
+    uint8_t repaired = 0;
+    vc_status_t rs = vc_recover_file(bench_files[BENCH_WAV], &repaired);
+    uint32_t blocks = 0, bytes = 0;
+    vc_status_t ds = bench_read(bench_files[BENCH_WAV], &blocks, &bytes);
+    printf("bench: blad zapisu nr %u -> status %d, naprawa %d (zmiany %u), odczyt %d: %lu ramek\r\n",
+           BENCH_FAIL_WRITE, ws, rs, repaired, ds, (unsigned long)blocks);
+
+    vc_codec_close(&bench_enc);
+    f_mount(NULL, bench_drive, 1);
+    FATFS_UnLinkDriver(bench_drive);
+    port_img_close();
+}
+
+#ifdef VC_IMG_BENCH_MAIN
+DWORD get_fattime(void)
+{
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    run_img_bench(argc > 1 ? argv[1] : "vc_bench.img");
+    return 0;
+}
+#endif /* VC_IMG_BENCH_MAIN */
+
+#endif /* VC_HOST_BUILD */
@@ -0,0 +1,167 @@
+#include "tests/test_ringbuf.h"
+#include "voicecmd/vc_ringbuf.h"
+#include <stdio.h>
+#include <stdint.h>
+
+#ifdef VC_HOST_BUILD
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#else
+#include "main.h"
+#endif
+
+#define TEST_SPSC_CAP      8u
+#define TEST_SPSC_ITERS    1000u
+
+#define TEST_STRESS_CAP    64u
+#define TEST_STRESS_ITEMS  2000000u
+#define TEST_STRESS_DATA   (2u * TEST_STRESS_CAP)   // producent nie wyprzedza o więcej niż CAP
+
+static void *spsc_slots[TEST_SPSC_CAP];
+
+void test_spsc_basic(void)
+{
+    static uint32_t items[3u * TEST_SPSC_CAP];
+    vc_spsc_fifo_t q;
+    void *in[TEST_SPSC_CAP + 2u], *out[TEST_SPSC_CAP + 2u], **span;
+    uint32_t errors = 0, next_out = 0;
+
+    if (vc_spsc_init(&q, spsc_slots, 6u) != VC_E_PARAM) errors++;
+    vc_spsc_init(&q, spsc_slots, TEST_SPSC_CAP);
+    for (uint32_t i = 0; i < 3u * TEST_SPSC_CAP; i++) items[i] = i;
+
+    // Wsady przez koniec tablicy: 5 na wejście, 3 zdjęte, z 10 mieści się 6 (sloty 5-7, 0-2).
+    for (uint32_t i = 0; i < TEST_SPSC_CAP + 2u; i++) in[i] = &items[i];
+    if (vc_spsc_push_n(&q, in, 5u) != 5u) errors++;
+    if (vc_spsc_pop_n(&q, out, 3u) != 3u) errors++;
+    for (uint32_t i = 0; i < 3u; i++) if (*(uint32_t *)out[i] != next_out++) errors++;
+    for (uint32_t i = 0; i < TEST_SPSC_CAP + 2u; i++) in[i] = &items[5u + i];
+    if (vc_spsc_push_n(&q, in, TEST_SPSC_CAP + 2u) != 6u || vc_spsc_space(&q) != 0) errors++;
+    if (vc_spsc_push(&q, &items[0]) != VC_E_FULL) errors++;
+
+    uint32_t popped = vc_spsc_pop_n(&q, out, TEST_SPSC_CAP + 2u);
+    for (uint32_t i = 0; i < popped; i++) if (*(uint32_t *)out[i] != next_out++) errors++;
+    if (popped != TEST_SPSC_CAP || vc_spsc_pop(&q, &out[0]) != VC_E_EMPTY) errors++;
+
+    // Span kończy się na końcu tablicy: od indeksu 6 zostały 2 sloty, reszta w drugim spanie.
+    vc_spsc_reset(&q);
+    for (uint32_t i = 0; i < 6u; i++) vc_spsc_push(&q, &items[i]);
+    vc_spsc_pop_n(&q, out, 6u);
+    uint32_t n = vc_spsc_write_span(&q, &span);
+    if (n != 2u || span != &spsc_slots[6]) errors++;
+    span[0] = &items[6];
+    span[1] = &items[7];
+    vc_spsc_write_commit(&q, 2u);
+    n = vc_spsc_write_span(&q, &span);
+    if (n != 6u || span != &spsc_slots[0]) errors++;
+    span[0] = &items[8];
+    vc_spsc_write_commit(&q, 1u);
+
+    n = vc_spsc_read_span(&q, &span);                   // podgląd bez zdejmowania
+    if (n != 2u || *(uint32_t *)span[0] != 6u || vc_spsc_count(&q) != 3u) errors++;
+    vc_spsc_read_release(&q, 1u);
+    n = vc_spsc_read_span(&q, &span);
+    if (n != 1u || *(uint32_t *)span[0] != 7u) errors++;
+    vc_spsc_read_release(&q, 1u);
+    if (vc_spsc_pop(&q, &out[0]) != VC_OK || *(uint32_t *)out[0] != 8u || vc_spsc_count(&q) != 0) errors++;
+
+    // Koszt pary push + pop (z barierami).
+#ifndef VC_HOST_BUILD
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    uint32_t t0 = DWT->CYCCNT;
+#endif
+    for (uint32_t i = 0; i < TEST_SPSC_ITERS; i++) {
+        vc_spsc_push(&q, &items[i % TEST_SPSC_CAP]);
+        vc_spsc_pop(&q, &out[0]);
+    }
+#ifndef VC_HOST_BUILD
+    printf("spsc: push+pop %lu cyk\r\n", (unsigned long)((DWT->CYCCNT - t0) / TEST_SPSC_ITERS));
+#endif
+    printf("spsc podstawowy: bledy %lu\r\n", (unsigned long)errors);
+}
+
+#ifdef VC_HOST_BUILD
+static vc_spsc_fifo_t stress_q;
+static void *stress_slots[TEST_STRESS_CAP];
+static volatile uint32_t stress_data[TEST_STRESS_DATA];
+
+static void *test_spsc_producer(void *arg)
+{
+    uint32_t seq = 0, seed = 1;
+    void *batch[TEST_STRESS_CAP], **span;
+    (void)arg;
+
+    while (seq < TEST_STRESS_ITEMS) {
+        seed = seed * 1103515245u + 12345u;
+        uint32_t want = 1u + (seed >> 16) % TEST_STRESS_CAP;
+        if (want > TEST_STRESS_ITEMS - seq) want = TEST_STRESS_ITEMS - seq;
+
+        if (seed & 0x100u) {
+            uint32_t n = vc_spsc_write_span(&stress_q, &span);
+            if (n > want) n = want;
+            for (uint32_t i = 0; i < n; i++, seq++) {
+                stress_data[seq % TEST_STRESS_DATA] = seq;   // dane przed publikacją wskaźnika
+                span[i] = (void *)&stress_data[seq % TEST_STRESS_DATA];
+            }
+            vc_spsc_write_commit(&stress_q, n);
+            if (!n) sched_yield();                           // jeden rdzeń: oddaj czas konsumentowi
+        } else {
+            uint32_t room = vc_spsc_space(&stress_q);
+            if (want > room) want = room;
+            for (uint32_t i = 0; i < want; i++) {
+                stress_data[(seq + i) % TEST_STRESS_DATA] = seq + i;
+                batch[i] = (void *)&stress_data[(seq + i) % TEST_STRESS_DATA];
+            }
+            seq += vc_spsc_push_n(&stress_q, batch, want);
+            if (!want) sched_yield();
+        }
+    }
+    return NULL;
+}
+
+void test_spsc_stress(void)
+{
+    pthread_t producer;
+    void *batch[TEST_STRESS_CAP], **span;
+    uint32_t expect = 0, errors = 0, empty = 0, seed = 7;
+
+    vc_spsc_init(&stress_q, stress_slots, TEST_STRESS_CAP);
+    pthread_create(&producer, NULL, test_spsc_producer, NULL);
+
+    while (expect < TEST_STRESS_ITEMS) {
+        seed = seed * 1103515245u + 12345u;
+        uint32_t want = 1u + (seed >> 16) % TEST_STRESS_CAP;
+        uint32_t n;
+
+        if (seed & 0x100u) {
+            n = vc_spsc_read_span(&stress_q, &span);
+            if (n > want) n = want;
+            for (uint32_t i = 0; i < n; i++, expect++)
+                if (*(volatile uint32_t *)span[i] != expect) errors++;
+            vc_spsc_read_release(&stress_q, n);
+        } else {
+            n = vc_spsc_pop_n(&stress_q, batch, want);
+            for (uint32_t i = 0; i < n; i++, expect++)
+                if (*(volatile uint32_t *)batch[i] != expect) errors++;
+        }
+        if (!n) {
+            empty++;
+            sched_yield();
+        }
+    }
+    pthread_join(producer, NULL);
+
+    printf("spsc 2 watki: %u elementow, bledy kolejnosci/danych %lu, puste odczyty %lu, w kolejce %lu\r\n",
+           TEST_STRESS_ITEMS, (unsigned long)errors, (unsigned long)empty, (unsigned long)vc_spsc_count(&stress_q));
+}
+#endif /* VC_HOST_BUILD */
+
+void run_ringbuf_test(void)
+{
+    test_spsc_basic();
+#ifdef VC_HOST_BUILD
+    test_spsc_stress();
+#endif
+}
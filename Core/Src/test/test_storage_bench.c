@@ -0,0 +1,271 @@
+#include "tests/test_storage_bench.h"
+#include "ff.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#ifdef VC_HOST_BUILD
+#include <time.h>
+#else
+#include "main.h"
+#endif
+
+#define SB_FILE_BYTES   (2u * 1024u * 1024u)
+#define SB_CHUNK_MIN    512u
+#define SB_CHUNK_MAX    (32u * 1024u)
+#define SB_SYNC_BYTES   (256u * 1024u)   // f_sync jak punkt kontrolny nagrania
+#define SB_SEEKS        256u
+#define SB_CLMT_WORDS   64u
+#define SB_BUCKETS      128u             // 0-15 us co 1 us, dalej 4 przedziały na oktawę
+
+typedef struct {
+    uint32_t count;
+    uint32_t errors;
+    uint32_t max_us;
+    uint64_t sum_us;
+    uint32_t bucket[SB_BUCKETS];
+} sb_hist_t;
+
+typedef enum { SB_WRITE = 0, SB_SYNC, SB_READ, SB_SEEK, SB_SEEK_FAST, SB_CALLS } sb_call_t;
+
+static const char *const sb_names[SB_CALLS] = { "f_write", "f_sync", "f_read", "f_lseek", "f_lseek+clmt" };
+
+static uint8_t sb_buf[SB_CHUNK_MAX] __attribute__((aligned(4)));
+static sb_hist_t sb_hist[SB_CALLS];
+static FIL sb_file;
+static DWORD sb_clmt[SB_CLMT_WORDS];
+
+// Najgorszy przestój całego przebiegu.
+static uint32_t sb_worst_us;
+static sb_call_t sb_worst_call;
+static uint32_t sb_worst_chunk;
+
+#ifdef VC_HOST_BUILD
+static uint32_t sb_ticks(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u);
+}
+#define SB_TICKS_PER_US 1u
+#else
+static uint32_t sb_ticks(void)
+{
+    return DWT->CYCCNT;   // 168 MHz: przepełnienie po ~25 s, różnice poprawne
+}
+#define SB_TICKS_PER_US (SystemCoreClock / 1000000u)
+#endif
+
+static uint32_t sb_bucket(uint32_t us)
+{
+    if (us < 16u) return us;
+    uint32_t e = 31u - (uint32_t)__builtin_clz(us);
+    return 16u + (e - 4u) * 4u + ((us >> (e - 2u)) & 3u);
+}
+
+// Górna granica przedziału - percentyl zawyżony najwyżej o ~25%.
+static uint32_t sb_bucket_top(uint32_t b)
+{
+    if (b < 16u) return b;
+    uint32_t e = (b - 16u) / 4u + 4u;
+    uint32_t low = (4u + (b - 16u) % 4u) << (e - 2u);
+    return low + (1u << (e - 2u)) - 1u;
+}
+
+static void sb_record(sb_call_t call, uint32_t chunk, uint32_t t0, uint8_t ok)
+{
+    uint32_t us = (sb_ticks() - t0) / SB_TICKS_PER_US;
+    sb_hist_t *h = &sb_hist[call];
+
+    h->count++;
+    h->sum_us += us;
+    h->bucket[sb_bucket(us)]++;
+    if (!ok) h->errors++;
+    if (us > h->max_us) h->max_us = us;
+    if (us > sb_worst_us) {
+        sb_worst_us = us;
+        sb_worst_call = call;
+        sb_worst_chunk = chunk;
+    }
+}
+
+// p w promilach (500 = p50, 999 = p99.9).
+static uint32_t sb_percentile(const sb_hist_t *h, uint32_t p)
+{
+    uint64_t need = ((uint64_t)h->count * p + 999u) / 1000u, seen = 0;
+    for (uint32_t b = 0; b < SB_BUCKETS; b++) {
+        seen += h->bucket[b];
+        if (seen >= need && h->bucket[b]) return (sb_bucket_top(b) < h->max_us) ? sb_bucket_top(b) : h->max_us;
+    }
+    return h->max_us;
+}
+
+static void sb_print(sb_call_t call)
+{
+    const sb_hist_t *h = &sb_hist[call];
+    if (!h->count) return;
+    printf("  %-12s n %5lu  sr %6lu  p50 %6lu  p90 %6lu  p99 %7lu  p99.9 %7lu  max %7lu us  bledy %lu\r\n",
+           sb_names[call], (unsigned long)h->count, (unsigned long)(h->sum_us / h->count),
+           (unsigned long)sb_percentile(h, 500u), (unsigned long)sb_percentile(h, 900u),
+           (unsigned long)sb_percentile(h, 990u), (unsigned long)sb_percentile(h, 999u),
+           (unsigned long)h->max_us, (unsigned long)h->errors);
+}
+
+// kB/s w liczbach całkowitych - newlib-nano bez -u _printf_float nie drukuje %f.
+static unsigned long sb_kbps(uint32_t bytes, uint32_t us)
+{
+    return us ? (unsigned long)((uint64_t)bytes * 1000u / us) : 0ul;
+}
+
+// Zapis SB_FILE_BYTES porcjami chunk z f_sync co SB_SYNC_BYTES; czas całości [us] w *us.
+// Zwraca wynik f_open.
+static FRESULT sb_write_file(const char *path, uint32_t chunk, uint32_t *us)
+{
+    UINT bw;
+    uint32_t start = sb_ticks();
+
+    FRESULT fo = f_open(&sb_file, path, FA_WRITE | FA_CREATE_ALWAYS);
+    if (fo != FR_OK) return fo;
+    for (uint32_t done = 0; done < SB_FILE_BYTES; ) {
+        uint32_t t0 = sb_ticks();
+        FRESULT fr = f_write(&sb_file, sb_buf, chunk, &bw);
+        sb_record(SB_WRITE, chunk, t0, fr == FR_OK && bw == chunk);
+        if (fr != FR_OK || bw != chunk) break;
+        done += chunk;
+
+        if (done % SB_SYNC_BYTES == 0u) {
+            t0 = sb_ticks();
+            fr = f_sync(&sb_file);
+            sb_record(SB_SYNC, chunk, t0, fr == FR_OK);
+        }
+    }
+    f_close(&sb_file);
+    *us = (sb_ticks() - start) / SB_TICKS_PER_US;
+    return FR_OK;
+}
+
+static FRESULT sb_read_file(const char *path, uint32_t chunk, uint32_t *us)
+{
+    UINT br;
+    uint32_t start = sb_ticks();
+
+    FRESULT fo = f_open(&sb_file, path, FA_READ | FA_OPEN_EXISTING);
+    if (fo != FR_OK) return fo;
+    for (uint32_t done = 0; done < SB_FILE_BYTES; done += chunk) {
+        uint32_t t0 = sb_ticks();
+        FRESULT fr = f_read(&sb_file, sb_buf, chunk, &br);
+        sb_record(SB_READ, chunk, t0, fr == FR_OK && br == chunk);
+        if (fr != FR_OK || br != chunk) break;
+    }
+    f_close(&sb_file);
+    *us = (sb_ticks() - start) / SB_TICKS_PER_US;
+    return FR_OK;
+}
+
+// Losowe f_lseek + f_read 512 B; fast: z mapą klastrów (jak vc_stream_reader).
+static void sb_seek_file(const char *path, uint8_t fast)
+{
+    sb_call_t call = fast ? SB_SEEK_FAST : SB_SEEK;
+    UINT br;
+
+    FRESULT fo = f_open(&sb_file, path, FA_READ | FA_OPEN_EXISTING);
+    if (fo != FR_OK) {
+        printf("  %s: f_open blad %d\r\n", sb_names[call], (int)fo);
+        return;
+    }
+#if _USE_FASTSEEK
+    if (fast) {
+        sb_clmt[0] = SB_CLMT_WORDS;
+        sb_file.cltbl = sb_clmt;
+        if (f_lseek(&sb_file, CREATE_LINKMAP) != FR_OK) {
+            printf("  f_lseek+clmt: mapa klastrow nie miesci sie w %u slowach\r\n", SB_CLMT_WORDS);
+            f_close(&sb_file);
+            return;
+        }
+    }
+#else
+    if (fast) {
+        f_close(&sb_file);
+        return;
+    }
+#endif
+    srand(1);
+    for (uint32_t i = 0; i < SB_SEEKS; i++) {
+        FSIZE_t at = ((FSIZE_t)rand() % (SB_FILE_BYTES / SB_CHUNK_MIN)) * SB_CHUNK_MIN;
+        uint32_t t0 = sb_ticks();
+        FRESULT fr = f_lseek(&sb_file, at);
+        sb_record(call, 0, t0, fr == FR_OK);   // porcja 0: nie dotyczy
+        if (fr == FR_OK) f_read(&sb_file, sb_buf, SB_CHUNK_MIN, &br);
+    }
+    f_close(&sb_file);
+}
+
+void test_storage_bench(const char *drive)
+{
+    char path[24];
+
+    snprintf(path, sizeof(path), "%sSBENCH.BIN", drive);
+    for (uint32_t i = 0; i < sizeof(sb_buf); i++) sb_buf[i] = (uint8_t)(i * 7u);
+    sb_worst_us = 0;
+    sb_worst_chunk = 0;
+
+#ifndef VC_HOST_BUILD
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+
+    printf("storage bench: plik %lu KiB, f_sync co %lu KiB\r\n", (unsigned long)(SB_FILE_BYTES / 1024u),
+           (unsigned long)(SB_SYNC_BYTES / 1024u));
+    for (uint32_t chunk = SB_CHUNK_MIN; chunk <= SB_CHUNK_MAX; chunk *= 2u) {
+        memset(sb_hist, 0, sizeof(sb_hist));
+        uint32_t wus = 0, rus = 0;
+        FRESULT fo = sb_write_file(path, chunk, &wus);
+        if (fo != FR_OK) {
+            printf("porcja %5lu B: f_open (zapis) blad %d\r\n", (unsigned long)chunk, (int)fo);
+            return;
+        }
+        fo = sb_read_file(path, chunk, &rus);
+        if (fo != FR_OK) {
+            printf("porcja %5lu B: zapis %lu kB/s, f_open (odczyt) blad %d\r\n", (unsigned long)chunk,
+                   sb_kbps(SB_FILE_BYTES, wus), (int)fo);
+        } else {
+            printf("porcja %5lu B: zapis %lu kB/s, odczyt %lu kB/s\r\n", (unsigned long)chunk,
+                   sb_kbps(SB_FILE_BYTES, wus), sb_kbps(SB_FILE_BYTES, rus));
+        }
+        sb_print(SB_WRITE);
+        sb_print(SB_SYNC);
+        sb_print(SB_READ);
+    }
+
+    // Plik z ostatniej porcji (32 KiB): f_lseek bez mapy idzie łańcuchem FAT od początku.
+    memset(sb_hist, 0, sizeof(sb_hist));
+    sb_seek_file(path, 0);
+    sb_seek_file(path, 1);
+    printf("losowe f_lseek (%u):\r\n", SB_SEEKS);
+    sb_print(SB_SEEK);
+    sb_print(SB_SEEK_FAST);
+
+    // Porcja tylko dla f_write/f_sync/f_read; f_lseek zapisuje 0.
+    if (sb_worst_chunk) {
+        printf("najgorszy przestoj: %s %lu us (porcja %lu B)\r\n", sb_names[sb_worst_call],
+               (unsigned long)sb_worst_us, (unsigned long)sb_worst_chunk);
+    } else {
+        printf("najgorszy przestoj: %s %lu us\r\n", sb_names[sb_worst_call], (unsigned long)sb_worst_us);
+    }
+    f_unlink(path);
+}
+
+#ifndef VC_HOST_BUILD
+void run_storage_bench(void)
+{
+    FATFS fs;
+
+    // Bez fatfs_init: ten zapisuje test.wav i przechodzi odzyskiwanie nagrań.
+    if (f_mount(&fs, "", 1) != FR_OK) {
+        printf("storage bench: brak nosnika\r\n");
+        return;
+    }
+    test_storage_bench("");
+    f_mount(NULL, "", 1);
+}
+#endif
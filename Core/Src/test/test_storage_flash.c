@@ -0,0 +1,264 @@
+#include "tests/test_storage_flash.h"
+#include "port/port_flash_sim.h"
+#include "fatfs/vc_wav_writer.h"
+#include "voicecmd/vc_encoders.h"
+#include "main.h"
+#include <stdio.h>
+#include <string.h>
+
+#define TEST_FLASH_SECTOR_BYTES (128u * 1024u)
+#define TEST_FLASH_SECTORS      4u
+
+static port_flash_t fl;
+static port_flash_writer_t fw;
+static port_flash_reader_t fr;
+static vc_wav_writer_t fwav;
+static int16_t fpcm[VC_FRAME_SAMPLES];
+static int16_t fref[VC_FRAME_SAMPLES];
+
+#ifdef VC_HOST_BUILD
+static uint8_t fmem[TEST_FLASH_SECTORS * TEST_FLASH_SECTOR_BYTES];
+static port_flash_sim_t fsim;
+#endif
+
+// Próbki zależne od nagrania i ramki - odczyt sprawdzany bez kopii w RAM.
+static void test_flash_frame(int16_t *pcm, uint32_t seed, uint32_t f)
+{
+    for (uint32_t i = 0; i < VC_FRAME_SAMPLES; i++) pcm[i] = (int16_t)(seed * 977u + f * 131u + i * 7u);
+}
+
+static void test_flash_service_all(port_flash_t *fs)
+{
+    while (port_flash_service(fs) == VC_E_AGAIN) { }
+}
+
+// Nagranie frames ramek przez writer WAV; *worst = najdłuższy zapis ramki [ms].
+static vc_status_t test_flash_record(const char *name, uint32_t seed, uint32_t frames, uint32_t ckpt_ms,
+                                     uint32_t *worst)
+{
+    vc_stream_meta_t m;
+    vc_meta_pcm16_make(&m);
+    vc_status_t st = port_flash_writer_open(&fl, &fw, name);
+    if (st == VC_OK) st = vc_wav_writer_open_sink(&fwav, &fw.sink, &m);
+    if (st != VC_OK) return st;
+    if (ckpt_ms) vc_wav_writer_set_checkpoint(&fwav, ckpt_ms);
+
+    for (uint32_t f = 0; f < frames && st == VC_OK; f++) {
+        test_flash_frame(fpcm, seed, f);
+        uint32_t t0 = HAL_GetTick();
+        st = vc_wav_writer_write(&fwav, fpcm, sizeof(fpcm));
+        if (worst && HAL_GetTick() - t0 > *worst) *worst = HAL_GetTick() - t0;
+    }
+    vc_status_t cst = vc_wav_writer_close(&fwav);
+    return (st != VC_OK) ? st : cst;
+}
+
+// Odczyt nagrania: *frames = pełne ramki zgodne z zapisem, 1 gdy rozmiar 'data' w nagłówku
+// zgadza się z liczbą ramek (*hdr_ok).
+static vc_status_t test_flash_verify(const char *name, uint32_t seed, uint32_t *frames, uint8_t *hdr_ok)
+{
+    uint8_t hdr[VC_WAV_HEADER_MAX_BYTES];
+    uint32_t got, data_size;
+    vc_stream_meta_t m;
+    vc_meta_pcm16_make(&m);
+    uint16_t hb = vc_wav_build_header(&m, 0, hdr);
+
+    *frames = 0;
+    *hdr_ok = 0;
+    vc_status_t st = port_flash_reader_open(&fl, &fr, name);
+    if (st != VC_OK) return st;
+    st = port_flash_read(&fr, hdr, hb, &got);
+    if (st != VC_OK) {
+        port_flash_reader_close(&fr);
+        return st;
+    }
+    memcpy(&data_size, &hdr[hb - 4u], sizeof(data_size));
+
+    while (port_flash_read(&fr, fpcm, sizeof(fpcm), &got) == VC_OK) {
+        test_flash_frame(fref, seed, *frames);
+        if (memcmp(fpcm, fref, sizeof(fpcm)) != 0) break;
+        (*frames)++;
+    }
+    port_flash_reader_close(&fr);
+    *hdr_ok = (data_size == *frames * sizeof(fpcm));
+    return VC_OK;
+}
+
+// Odczyt CMD1 przerywany wywołaniami service: GC sektora z CMD1 czeka na zamknięcie czytnika.
+static void test_flash_read_during_gc(void)
+{
+    uint8_t hdr[VC_WAV_HEADER_MAX_BYTES];
+    uint32_t got, frames = 0, moved = fl.relocated;
+    vc_status_t svc = VC_OK;
+    vc_stream_meta_t m;
+    vc_meta_pcm16_make(&m);
+
+    if (port_flash_reader_open(&fl, &fr, "CMD1") != VC_OK) return;
+    port_flash_read(&fr, hdr, vc_wav_build_header(&m, 0, hdr), &got);
+    while (port_flash_read(&fr, fpcm, sizeof(fpcm), &got) == VC_OK) {
+        test_flash_frame(fref, 0, frames);
+        if (memcmp(fpcm, fref, sizeof(fpcm)) != 0) break;
+        frames++;
+        if (frames % 50u == 0u) svc = port_flash_service(&fl);
+    }
+    port_flash_reader_close(&fr);
+    printf("flash odczyt w trakcie GC: CMD1 %lu/150 ramek, service %d, GC %s\r\n", (unsigned long)frames, svc,
+           (fl.relocated == moved) ? "wstrzymany" : "W TRAKCIE ODCZYTU");
+}
+
+// Tor audio aktywny (port_flash_suspend): service nie kasuje ani nie przenosi sektorów.
+static void test_flash_audio_hold(void)
+{
+    uint32_t erases = fl.erases, moved = fl.relocated;
+
+    port_flash_suspend(&fl);
+    vc_status_t svc = port_flash_service(&fl);
+    port_flash_resume(&fl);
+    printf("flash przy aktywnym audio: service %d, GC i kasowanie %s\r\n", svc,
+           (fl.erases == erases && fl.relocated == moved) ? "wstrzymane" : "W TRAKCIE AUDIO");
+}
+
+static void test_flash_print_stats(const char *tag)
+{
+    port_flash_stats_t s;
+    port_flash_get_stats(&fl, &s);
+    printf("flash %s: nagrania %u, wolne %lu B, skasowane %u, do skasowania %u, kasowania %lu-%lu, GC %lu B\r\n",
+           tag, s.files, (unsigned long)s.free_bytes, s.erased_sectors, s.dirty_sectors,
+           (unsigned long)s.erase_min, (unsigned long)s.erase_max, (unsigned long)fl.relocated);
+}
+
+// Zapowiedzi 3/4/4 s, odczyt, usunięcie środkowej i 4 s w miejscu odzyskanym przez GC.
+void test_flash_log(port_flash_dev_t *dev)
+{
+    static const char *const names[] = { "CMD1", "CMD2", "CMD3", "CMD4" };
+    static const uint32_t frames[] = { 150, 200, 200, 200 };
+    uint32_t worst = 0, ok_frames;
+    uint8_t hdr_ok;
+
+    if (port_flash_mount(&fl, dev) != VC_OK) return;
+    port_flash_format(&fl);
+    test_flash_service_all(&fl);
+
+    uint32_t t0 = HAL_GetTick();
+    for (uint32_t i = 0; i < 3; i++) {
+        vc_status_t st = test_flash_record(names[i], i, frames[i], 0, &worst);
+        printf("flash zapis %s: %lu ramek, status %d\r\n", names[i], (unsigned long)frames[i], st);
+    }
+    printf("flash: 11 s w %lu ms, najgorsza ramka %lu ms\r\n", (unsigned long)(HAL_GetTick() - t0), (unsigned long)worst);
+    test_flash_print_stats("po zapisie");
+
+    // 4 s nie mieści się, dopóki CMD2 nie zostanie usunięte, a sektory przez nie dzielone
+    // przeniesione (GC) i skasowane.
+    vc_status_t full = test_flash_record(names[3], 3, frames[3], 0, NULL);
+    port_flash_delete(&fl, names[3]);
+    port_flash_delete(&fl, names[1]);
+    test_flash_read_during_gc();
+    test_flash_audio_hold();
+    t0 = HAL_GetTick();
+    test_flash_service_all(&fl);
+    printf("flash: 4 s przed usunieciem status %d, GC (przeniesione %lu B) i kasowanie %lu ms\r\n", full,
+           (unsigned long)fl.relocated, (unsigned long)(HAL_GetTick() - t0));
+    vc_status_t st4 = test_flash_record(names[3], 3, frames[3], 0, NULL);
+    test_flash_print_stats("po GC");
+
+    // Ponowne montowanie: mapa odtworzona z nośnika.
+    port_flash_mount(&fl, dev);
+    for (uint32_t i = 0; i < 4; i++) {
+        vc_status_t st = test_flash_verify(names[i], i, &ok_frames, &hdr_ok);
+        printf("flash odczyt %s: status %d, ramki %lu/%lu, naglowek %s\r\n", names[i], st,
+               (unsigned long)ok_frames, (unsigned long)((i == 1) ? 0u : frames[i]), hdr_ok ? "ok" : "zly");
+    }
+    printf("flash: zapis 4 s po kasowaniu status %d\r\n", st4);
+    test_flash_print_stats("koniec");
+}
+
+#ifdef VC_HOST_BUILD
+// Zanik zasilania w połowie 3 s nagrania (punkty kontrolne co 250 ms) i w trakcie kasowania.
+void test_flash_power_cut(void)
+{
+    uint32_t ok_frames;
+    uint8_t hdr_ok;
+
+    port_flash_sim_init(&fsim, fmem, TEST_FLASH_SECTOR_BYTES, TEST_FLASH_SECTORS);
+    port_flash_mount(&fl, &fsim.dev);
+    test_flash_record("KEEP", 7, 200, 0, NULL);     // przez granicę sektorów
+
+    fsim.cut_after = fsim.programmed + 50u * sizeof(fpcm) + 333u;
+    vc_status_t st = test_flash_record("CUT", 8, 150, 250, NULL);
+    port_flash_sim_power_cycle(&fsim);
+    port_flash_mount(&fl, &fsim.dev);
+    test_flash_verify("CUT", 8, &ok_frames, &hdr_ok);
+    printf("flash zanik w nagraniu: status %d, odzyskane ramki %lu (punkt kontrolny co 12,5), naglowek %s\r\n",
+           st, (unsigned long)ok_frames, hdr_ok ? "ok" : "z punktu kontrolnego");
+    test_flash_verify("KEEP", 7, &ok_frames, &hdr_ok);
+    printf("flash zanik: KEEP %lu/200 ramek, naglowek %s\r\n", (unsigned long)ok_frames, hdr_ok ? "ok" : "zly");
+
+    // Usunięcie + zanik w trakcie kasowania: nagranie nie wraca, sektor kasowany ponownie.
+    port_flash_delete(&fl, "KEEP");
+    port_flash_delete(&fl, "CUT");
+    port_flash_service(&fl);
+    port_flash_sim_power_cycle(&fsim);
+    port_flash_mount(&fl, &fsim.dev);
+    vc_status_t gone = port_flash_reader_open(&fl, &fr, "KEEP");
+    test_flash_service_all(&fl);
+    printf("flash zanik w kasowaniu: KEEP %s, naruszenia NOR %lu\r\n", (gone == VC_E_EMPTY) ? "usuniete" : "WROCILO",
+           (unsigned long)fsim.violations);
+
+    // Zanik w trakcie GC: kopie rekordów równoważne, po montowaniu GC dokończony.
+    test_flash_service_all(&fl);
+    test_flash_record("A", 10, 200, 0, NULL);
+    test_flash_record("B", 11, 200, 0, NULL);
+    test_flash_record("C", 12, 100, 0, NULL);
+    port_flash_delete(&fl, "B");
+    fsim.cut_after = fsim.programmed + 40000u;
+    test_flash_service_all(&fl);
+    port_flash_sim_power_cycle(&fsim);
+    port_flash_mount(&fl, &fsim.dev);
+    test_flash_service_all(&fl);
+    uint32_t a_frames, c_frames;
+    uint8_t a_hdr, c_hdr;
+    test_flash_verify("A", 10, &a_frames, &a_hdr);
+    test_flash_verify("C", 12, &c_frames, &c_hdr);
+    printf("flash zanik w GC: A %lu/200 (%s), C %lu/100 (%s), B %s\r\n", (unsigned long)a_frames,
+           a_hdr ? "ok" : "zly", (unsigned long)c_frames, c_hdr ? "ok" : "zly",
+           (port_flash_reader_open(&fl, &fr, "B") == VC_E_EMPTY) ? "usuniete" : "WROCILO");
+    test_flash_print_stats("po zanikach");
+}
+
+// Cykle zapis/usunięcie - sektor o najmniejszym liczniku przydzielany jako następny.
+void test_flash_wear(void)
+{
+    char name[PORT_FLASH_NAME_MAX];
+    uint32_t fails = 0;
+
+    port_flash_sim_init(&fsim, fmem, TEST_FLASH_SECTOR_BYTES, TEST_FLASH_SECTORS);
+    port_flash_mount(&fl, &fsim.dev);
+    test_flash_record("STATIC", 1, 50, 0, NULL);      // zapowiedź, która zostaje
+    for (uint32_t c = 0; c < 300; c++) {
+        snprintf(name, sizeof(name), "W%lu", (unsigned long)(c % 3u));
+        port_flash_delete(&fl, name);
+        test_flash_service_all(&fl);
+        if (test_flash_record(name, c, 100, 0, NULL) != VC_OK) fails++;
+    }
+    uint32_t ok_frames;
+    uint8_t hdr_ok;
+    test_flash_verify("STATIC", 1, &ok_frames, &hdr_ok);
+    printf("flash wear: 300 cykli, bledy %lu, STATIC %lu/50, kasowania sektorow %lu %lu %lu %lu, naruszenia NOR %lu\r\n",
+           (unsigned long)fails, (unsigned long)ok_frames, (unsigned long)fsim.erase_count[0], (unsigned long)fsim.erase_count[1],
+           (unsigned long)fsim.erase_count[2], (unsigned long)fsim.erase_count[3], (unsigned long)fsim.violations);
+}
+#endif /* VC_HOST_BUILD */
+
+void run_storage_flash_test(void)
+{
+#ifdef VC_HOST_BUILD
+    port_flash_sim_init(&fsim, fmem, TEST_FLASH_SECTOR_BYTES, TEST_FLASH_SECTORS);
+    test_flash_log(&fsim.dev);
+    test_flash_power_cut();
+    test_flash_wear();
+#else
+    port_flash_dev_t *dev = port_flash_stm32();
+    if (dev) test_flash_log(dev);
+    else     printf("flash: program nachodzi na sektory 8-11 (STM32F407VGTX_FLASH.ld)\r\n");
+#endif
+}
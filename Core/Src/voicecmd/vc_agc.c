@@ -35,13 +35,15 @@ float32_t agc_f32_update_gain(agc_f32_t *agc, float32_t rms)
 
 /**
  * @brief  Przetwarza ramkę float32 na podstawie metadanych.
+ *         Stereo: wspólne wzmocnienie dla obu kanałów (RMS z całej przeplatanej ramki),
+ *         żeby nie przesuwać obrazu stereo.
  */
 void agc_f32_process(const vc_pcm_meta_t *meta, agc_f32_t *agc, float32_t *samples)
 {
-    if (!meta || !samples || meta->channels != 1)
+    if (!meta || !samples || meta->channels == 0 || meta->channels > VC_MAX_CHANNELS)
         return;
 
-    uint32_t N = meta->len_samples;
+    uint32_t N = (uint32_t)meta->len_samples * meta->channels;
 
     arm_scale_f32(samples, agc->last_measured_gain, samples, N);
 
@@ -0,0 +1,654 @@
+#include "g722_private.h"          /* pełne struktury stanu G.722 (stan w vc_codec_t) */
+#include "voicecmd/vc_codec.h"
+#include "voicecmd/vc_decoders.h"
+#include <string.h>
+
+/* Próbki na ramkę dla danej konfiguracji (samples_per_block albo VC_FRAME_SAMPLES). */
+static uint16_t vc_codec_frame_samples(const vc_enc_cfg_t *cfg)
+{
+    return (cfg->samples_per_block && cfg->samples_per_block <= VC_FRAME_SAMPLES)
+         ? cfg->samples_per_block : VC_FRAME_SAMPLES;
+}
+
+/* Liczba kanałów z konfiguracji (0 = mono). */
+static uint16_t vc_codec_cfg_channels(const vc_enc_cfg_t *cfg)
+{
+    return (cfg && cfg->channels) ? cfg->channels : 1u;
+}
+
+/* Offsety dla ramek stałej długości (offsets może być NULL). */
+static void vc_codec_fixed_offsets(uint32_t *offsets, uint16_t n_frames, uint32_t frame_bytes)
+{
+    if (!offsets) return;
+    for (uint16_t f = 0; f <= n_frames; f++) offsets[f] = (uint32_t)f * frame_bytes;
+}
+
+/* ======================================================================
+ * PCM16 (bez kompresji)
+ * ====================================================================== */
+static vc_status_t pcm16_open(void *st, const vc_enc_cfg_t *cfg, vc_codec_dir_t dir)
+{
+    (void)st; (void)cfg; (void)dir;
+    return VC_OK;
+}
+
+static vc_status_t pcm16_encode_frame(void *st, const int16_t *pcm, uint16_t n,
+                                      uint8_t *out, uint16_t *out_len)
+{
+    (void)st;
+    memcpy(out, pcm, (size_t)n * 2u);                /* little-endian jak w WAV */
+    *out_len = (uint16_t)(n * 2u);
+    return VC_OK;
+}
+
+static vc_status_t pcm16_decode_frame(void *st, const uint8_t *in, uint16_t in_len,
+                                      int16_t *pcm, uint16_t n)
+{
+    (void)st;
+    if (in_len < n * 2u) return VC_E_CODEC;
+    memcpy(pcm, in, (size_t)n * 2u);
+    return VC_OK;
+}
+
+static vc_status_t pcm16_encode_frames(void *st, const int16_t *pcm, uint16_t n, uint16_t n_frames,
+                                       uint8_t *out, uint32_t out_cap,
+                                       uint32_t *offsets, uint32_t *out_len)
+{
+    (void)st;
+    uint32_t total = (uint32_t)n_frames * n * 2u;
+    if (total > out_cap) return VC_E_FULL;
+    memcpy(out, pcm, total);
+    vc_codec_fixed_offsets(offsets, n_frames, (uint32_t)n * 2u);
+    if (out_len) *out_len = total;
+    return VC_OK;
+}
+
+static vc_status_t pcm16_decode_frames(void *st, const uint8_t *in, const uint32_t *offsets,
+                                       uint16_t n_frames, int16_t *pcm, uint16_t n)
+{
+    (void)st;
+    const uint32_t frame_bytes = (uint32_t)n * 2u;
+    if (!offsets) {
+        memcpy(pcm, in, (size_t)n_frames * frame_bytes);
+        return VC_OK;
+    }
+    for (uint16_t f = 0; f < n_frames; f++) {
+        if (offsets[f + 1] - offsets[f] < frame_bytes) return VC_E_CODEC;
+        memcpy(pcm + (uint32_t)f * n, in + offsets[f], frame_bytes);
+    }
+    return VC_OK;
+}
+
+static void pcm16_meta(const vc_enc_cfg_t *cfg, vc_stream_meta_t *m)
+{
+    (void)cfg;
+    vc_meta_pcm16_make(m);
+}
+
+static uint16_t pcm16_max_bytes(const vc_enc_cfg_t *cfg)
+{
+    return (uint16_t)(vc_codec_frame_samples(cfg) * 2u);
+}
+
+static const vc_codec_ops_t vc_codec_pcm16_ops = {
+    .id = VC_CODEC_PCM16, .name = "pcm16", .state_bytes = 0, .flags = VC_CODEC_F_INTERLEAVED,
+    .open = pcm16_open,
+    .encode_frame = pcm16_encode_frame, .decode_frame = pcm16_decode_frame,
+    .encode_frames = pcm16_encode_frames, .decode_frames = pcm16_decode_frames,
+    .meta = pcm16_meta, .max_bytes_per_frame = pcm16_max_bytes,
+};
+
+/* ======================================================================
+ * IMA-ADPCM (blok = ramka; stereo w układzie MS-IMA)
+ * ====================================================================== */
+typedef struct {
+    vc_ima_state_t  st[VC_MAX_CHANNELS];
+    vc_ima_search_t search;       /* depth > 1 -> koder z przeszukiwaniem w przód */
+    uint16_t        channels;
+} ima_codec_state_t;
+
+static vc_status_t ima_open(void *st, const vc_enc_cfg_t *cfg, vc_codec_dir_t dir)
+{
+    (void)dir;
+    ima_codec_state_t *s = (ima_codec_state_t *)st;
+    memset(s, 0, sizeof(*s));
+    s->search   = cfg->ima_search;
+    s->channels = vc_codec_cfg_channels(cfg);
+    return VC_OK;
+}
+
+static vc_status_t ima_encode_frame(void *st, const int16_t *pcm, uint16_t n,
+                                    uint8_t *out, uint16_t *out_len)
+{
+    ima_codec_state_t *s = (ima_codec_state_t *)st;
+    *out_len = vc_ima_encode_block(pcm, n, s->channels, out, s->st, &s->search);
+    return (*out_len != 0) ? VC_OK : VC_E_CODEC;
+}
+
+static vc_status_t ima_decode_frame(void *st, const uint8_t *in, uint16_t in_len,
+                                    int16_t *pcm, uint16_t n)
+{
+    ima_codec_state_t *s = (ima_codec_state_t *)st;
+    if (in_len < vc_ima_block_bytes(n, s->channels)) return VC_E_CODEC;
+    return (vc_ima_decode_block(in, n, s->channels, pcm) == n) ? VC_OK : VC_E_CODEC;
+}
+
+static vc_status_t ima_encode_frames(void *st, const int16_t *pcm, uint16_t n, uint16_t n_frames,
+                                     uint8_t *out, uint32_t out_cap,
+                                     uint32_t *offsets, uint32_t *out_len)
+{
+    ima_codec_state_t *s = (ima_codec_state_t *)st;
+    if ((uint32_t)vc_ima_block_bytes(n, s->channels) * n_frames > out_cap) return VC_E_FULL;
+
+    if (s->search.depth > 1u || s->channels > 1u) {
+        /* przeszukiwanie / przeplot kanałów dominuje koszt - pętla po blokach wystarczy */
+        uint32_t pos = 0;
+        for (uint16_t f = 0; f < n_frames; f++) {
+            if (offsets) offsets[f] = pos;
+            pos += vc_ima_encode_block(pcm + (uint32_t)f * n * s->channels, n, s->channels,
+                                       out + pos, s->st, &s->search);
+        }
+        if (offsets) offsets[n_frames] = pos;
+        if (out_len) *out_len = pos;
+        return VC_OK;
+    }
+
+    uint32_t total = vc_ima_encode_blocks_mono(pcm, n, n_frames, out, out_cap, offsets, &s->st[0]);
+    if (total == 0 && n_frames != 0) return VC_E_CODEC;
+    if (offsets && n_frames == 0) offsets[0] = 0;
+    if (out_len) *out_len = total;
+    return VC_OK;
+}
+
+static vc_status_t ima_decode_frames(void *st, const uint8_t *in, const uint32_t *offsets,
+                                     uint16_t n_frames, int16_t *pcm, uint16_t n)
+{
+    ima_codec_state_t *s = (ima_codec_state_t *)st;
+    if (n_frames == 0) return VC_OK;
+
+    if (s->channels > 1u) {
+        for (uint16_t f = 0; f < n_frames; f++) {
+            uint16_t len = offsets ? (uint16_t)(offsets[f + 1] - offsets[f]) : vc_ima_block_bytes(n, s->channels);
+            const uint8_t *blk = in + (offsets ? offsets[f] : (uint32_t)f * len);
+            vc_status_t r = ima_decode_frame(st, blk, len, pcm + (uint32_t)f * n * s->channels, n);
+            if (r != VC_OK) return r;
+        }
+        return VC_OK;
+    }
+    return (vc_ima_decode_blocks_mono(in, n, n_frames, offsets, pcm) == (uint32_t)n_frames * n)
+         ? VC_OK : VC_E_CODEC;
+}
+
+static void ima_meta(const vc_enc_cfg_t *cfg, vc_stream_meta_t *m)
+{
+    vc_meta_ima_adpcm_make(m);
+    if (!m || !cfg) return;
+    if (cfg->samples_per_block) m->samples_per_block = cfg->samples_per_block;
+    m->channels          = vc_codec_cfg_channels(cfg);
+    m->block_align       = vc_ima_block_bytes(m->samples_per_block, m->channels);
+    m->avg_bytes_per_sec = (uint32_t)(((uint64_t)m->sample_rate_hz * m->block_align) / m->samples_per_block);
+}
+
+static uint16_t ima_max_bytes(const vc_enc_cfg_t *cfg)
+{
+    uint16_t spb = (cfg && cfg->samples_per_block) ? cfg->samples_per_block : VC_FRAME_SAMPLES;
+    return vc_ima_block_bytes(spb, vc_codec_cfg_channels(cfg));
+}
+
+static const vc_codec_ops_t vc_codec_ima_ops = {
+    .id = VC_CODEC_IMA_ADPCM, .name = "ima-adpcm", .state_bytes = sizeof(ima_codec_state_t),
+    .flags = VC_CODEC_F_MULTICHANNEL,
+    .open = ima_open,
+    .encode_frame = ima_encode_frame, .decode_frame = ima_decode_frame,
+    .encode_frames = ima_encode_frames, .decode_frames = ima_decode_frames,
+    .meta = ima_meta, .max_bytes_per_frame = ima_max_bytes,
+};
+
+/* ======================================================================
+ * G.711 µ-law / A-law (bezstanowe)
+ * ====================================================================== */
+static vc_status_t g711_open(void *st, const vc_enc_cfg_t *cfg, vc_codec_dir_t dir)
+{
+    (void)st; (void)cfg; (void)dir;
+    return VC_OK;
+}
+
+static vc_status_t g711u_encode_frame(void *st, const int16_t *pcm, uint16_t n,
+                                      uint8_t *out, uint16_t *out_len)
+{
+    (void)st;
+    *out_len = vc_g711u_encode(pcm, n, out);
+    return VC_OK;
+}
+
+static vc_status_t g711u_decode_frame(void *st, const uint8_t *in, uint16_t in_len,
+                                      int16_t *pcm, uint16_t n)
+{
+    (void)st;
+    if (in_len < n) return VC_E_CODEC;
+    vc_g711u_decode(in, n, pcm);
+    return VC_OK;
+}
+
+static vc_status_t g711a_encode_frame(void *st, const int16_t *pcm, uint16_t n,
+                                      uint8_t *out, uint16_t *out_len)
+{
+    (void)st;
+    *out_len = vc_g711a_encode(pcm, n, out);
+    return VC_OK;
+}
+
+static vc_status_t g711a_decode_frame(void *st, const uint8_t *in, uint16_t in_len,
+                                      int16_t *pcm, uint16_t n)
+{
+    (void)st;
+    if (in_len < n) return VC_E_CODEC;
+    vc_g711a_decode(in, n, pcm);
+    return VC_OK;
+}
+
+static void g711u_meta(const vc_enc_cfg_t *cfg, vc_stream_meta_t *m) { (void)cfg; vc_meta_g711_make(m, VC_CODEC_G711U); }
+static void g711a_meta(const vc_enc_cfg_t *cfg, vc_stream_meta_t *m) { (void)cfg; vc_meta_g711_make(m, VC_CODEC_G711A); }
+
+static uint16_t g711_max_bytes(const vc_enc_cfg_t *cfg)
+{
+    return vc_codec_frame_samples(cfg);
+}
+
+static const vc_codec_ops_t vc_codec_g711u_ops = {
+    .id = VC_CODEC_G711U, .name = "g711u", .state_bytes = 0, .flags = VC_CODEC_F_INTERLEAVED,
+    .open = g711_open,
+    .encode_frame = g711u_encode_frame, .decode_frame = g711u_decode_frame,
+    .meta = g711u_meta, .max_bytes_per_frame = g711_max_bytes,
+};
+
+static const vc_codec_ops_t vc_codec_g711a_ops = {
+    .id = VC_CODEC_G711A, .name = "g711a", .state_bytes = 0, .flags = VC_CODEC_F_INTERLEAVED,
+    .open = g711_open,
+    .encode_frame = g711a_encode_frame, .decode_frame = g711a_decode_frame,
+    .meta = g711a_meta, .max_bytes_per_frame = g711_max_bytes,
+};
+
+/* ======================================================================
+ * G.722 64/56/48 kb/s, opcjonalnie upakowany (stan SpanDSP osadzony w vc_codec_t).
+ * Stereo: ramka = [ramka kanału 0][ramka kanału 1], osobny stan na kanał.
+ * ====================================================================== */
+typedef union {
+    struct g722_encode_state enc;
+    struct g722_decode_state dec;
+} g722_codec_state_t;
+
+typedef struct {
+    g722_codec_state_t ch[VC_MAX_CHANNELS];
+    uint16_t           channels;
+} g722_multi_state_t;
+
+/* Rozplot kanałów (stereo). Koder i dekoder osobno - odtwarzanie może przerywać
+ * nagrywanie (i odwrotnie); jeden tor nagrywania i jeden odtwarzania. */
+static int16_t g722_enc_pcm[VC_FRAME_SAMPLES];
+static int16_t g722_dec_pcm[VC_FRAME_SAMPLES];
+
+static uint32_t g722_cfg_rate(const vc_enc_cfg_t *cfg)
+{
+    return (cfg->bitrate_bps == 56000u || cfg->bitrate_bps == 48000u) ? cfg->bitrate_bps : 64000u;
+}
+
+static vc_status_t g722_open(void *st, const vc_enc_cfg_t *cfg, vc_codec_dir_t dir)
+{
+    g722_multi_state_t *s = (g722_multi_state_t *)st;
+    uint32_t rate = g722_cfg_rate(cfg);
+    int options = cfg->packed ? G722_PACKED : G722_DEFAULT;
+
+    /* Ramka upakowana musi kończyć się na granicy bajtu, inaczej bity
+     * przechodziłyby do następnej ramki i ramki nie byłyby samodzielne. */
+    uint16_t n = vc_codec_frame_samples(cfg);
+    if (cfg->packed && (((uint32_t)n / 2u) * vc_g722_bits_per_code(rate)) % 8u != 0u) return VC_E_PARAM;
+
+    s->channels = vc_codec_cfg_channels(cfg);
+    for (uint16_t c = 0; c < s->channels; c++) {
+        if (dir == VC_CODEC_DIR_ENC) g722_encoder_init(&s->ch[c].enc, (int)rate, options);
+        else                         g722_decoder_init(&s->ch[c].dec, (int)rate, options);
+    }
+    return VC_OK;
+}
+
+/* Bajty ramki jednego kanału. */
+static uint32_t g722_enc_frame_bytes(const g722_multi_state_t *s, uint16_t n)
+{
+    const struct g722_encode_state *e = &s->ch[0].enc;
+    return e->packed ? ((uint32_t)n / 2u) * (uint32_t)e->bits_per_sample / 8u : n / 2u;
+}
+
+static uint32_t g722_dec_frame_bytes(const g722_multi_state_t *s, uint16_t n)
+{
+    const struct g722_decode_state *d = &s->ch[0].dec;
+    return d->packed ? ((uint32_t)n / 2u) * (uint32_t)d->bits_per_sample / 8u : n / 2u;
+}
+
+static vc_status_t g722_encode_frame(void *st, const int16_t *pcm, uint16_t n,
+                                     uint8_t *out, uint16_t *out_len)
+{
+    g722_multi_state_t *s = (g722_multi_state_t *)st;
+    if (s->channels == 1u) {
+        *out_len = (uint16_t)g722_encode(&s->ch[0].enc, pcm, n, out);
+        return VC_OK;
+    }
+
+    const uint32_t frame_bytes = g722_enc_frame_bytes(s, n);
+    for (uint16_t c = 0; c < s->channels; c++) {
+        for (uint16_t i = 0; i < n; i++) g722_enc_pcm[i] = pcm[(uint32_t)i * s->channels + c];
+        g722_encode(&s->ch[c].enc, g722_enc_pcm, n, out + c * frame_bytes);
+    }
+    *out_len = (uint16_t)(frame_bytes * s->channels);
+    return VC_OK;
+}
+
+static vc_status_t g722_decode_frame(void *st, const uint8_t *in, uint16_t in_len,
+                                     int16_t *pcm, uint16_t n)
+{
+    g722_multi_state_t *s = (g722_multi_state_t *)st;
+    const uint32_t frame_bytes = g722_dec_frame_bytes(s, n);
+    if (in_len < frame_bytes * s->channels) return VC_E_CODEC;
+
+    if (s->channels == 1u) {
+        return (g722_decode(&s->ch[0].dec, in, (int)frame_bytes, pcm) == n) ? VC_OK : VC_E_CODEC;
+    }
+    for (uint16_t c = 0; c < s->channels; c++) {
+        if (g722_decode(&s->ch[c].dec, in + c * frame_bytes, (int)frame_bytes, g722_dec_pcm) != n) {
+            return VC_E_CODEC;
+        }
+        for (uint16_t i = 0; i < n; i++) pcm[(uint32_t)i * s->channels + c] = g722_dec_pcm[i];
+    }
+    return VC_OK;
+}
+
+/* Ramki G.722 mają stałą długość (n/2 bajtów, upakowane: n/2 * bits / 8), więc N ramek mono
+ * leżących jedna za drugą to jedno wywołanie g722_encode()/g722_decode(). */
+static vc_status_t g722_encode_frames(void *st, const int16_t *pcm, uint16_t n, uint16_t n_frames,
+                                      uint8_t *out, uint32_t out_cap,
+                                      uint32_t *offsets, uint32_t *out_len)
+{
+    g722_multi_state_t *s = (g722_multi_state_t *)st;
+    const uint32_t frame_bytes = g722_enc_frame_bytes(s, n) * s->channels;
+    if (frame_bytes * n_frames > out_cap) return VC_E_FULL;
+
+    if (s->channels > 1u) {
+        for (uint16_t f = 0; f < n_frames; f++) {
+            uint16_t len = 0;
+            g722_encode_frame(st, pcm + (uint32_t)f * n * s->channels, n, out + f * frame_bytes, &len);
+        }
+    } else {
+        int wrote = g722_encode(&s->ch[0].enc, pcm, (int)n_frames * n, out);
+        if ((uint32_t)wrote != frame_bytes * n_frames) return VC_E_CODEC;
+    }
+
+    vc_codec_fixed_offsets(offsets, n_frames, frame_bytes);
+    if (out_len) *out_len = frame_bytes * n_frames;
+    return VC_OK;
+}
+
+static vc_status_t g722_decode_frames(void *st, const uint8_t *in, const uint32_t *offsets,
+                                      uint16_t n_frames, int16_t *pcm, uint16_t n)
+{
+    g722_multi_state_t *s = (g722_multi_state_t *)st;
+    const uint32_t frame_bytes = g722_dec_frame_bytes(s, n) * s->channels;
+
+    /* Ramki ciągłe (offsets NULL albo równo co frame_bytes) -> jedno wywołanie. */
+    int contiguous = (s->channels == 1u);
+    if (contiguous && offsets) {
+        for (uint16_t f = 0; f <= n_frames; f++) {
+            if (offsets[f] != offsets[0] + (uint32_t)f * frame_bytes) { contiguous = 0; break; }
+        }
+    }
+    if (contiguous) {
+        const uint8_t *src = in + (offsets ? offsets[0] : 0u);
+        int got = g722_decode(&s->ch[0].dec, src, (int)(frame_bytes * n_frames), pcm);
+        return ((uint32_t)got == (uint32_t)n_frames * n) ? VC_OK : VC_E_CODEC;
+    }
+    for (uint16_t f = 0; f < n_frames; f++) {
+        uint32_t start = offsets ? offsets[f] : f * frame_bytes;
+        uint32_t len   = offsets ? offsets[f + 1] - offsets[f] : frame_bytes;
+        vc_status_t r = g722_decode_frame(st, in + start, (uint16_t)len,
+                                          pcm + (uint32_t)f * n * s->channels, n);
+        if (r != VC_OK) return r;
+    }
+    return VC_OK;
+}
+
+static void g722_meta(const vc_enc_cfg_t *cfg, vc_stream_meta_t *m)
+{
+    uint16_t n  = vc_codec_frame_samples(cfg);
+    uint16_t ch = vc_codec_cfg_channels(cfg);
+    vc_meta_g722_mode_make(m, g722_cfg_rate(cfg), cfg->packed, n);
+    if (ch > 1u) {
+        /* stereo: jednostką jest ramka z blokami kolejnych kanałów */
+        m->channels           = ch;
+        m->block_align        = (uint16_t)(vc_g722_frame_bytes(g722_cfg_rate(cfg), cfg->packed, n) * ch);
+        m->samples_per_block  = n;
+        m->avg_bytes_per_sec *= ch;
+    }
+}
+
+static uint16_t g722_max_bytes(const vc_enc_cfg_t *cfg)
+{
+    return (uint16_t)(vc_g722_frame_bytes(g722_cfg_rate(cfg), cfg->packed, vc_codec_frame_samples(cfg))
+                      * vc_codec_cfg_channels(cfg));
+}
+
+static const vc_codec_ops_t vc_codec_g722_ops = {
+    .id = VC_CODEC_G722, .name = "g722", .state_bytes = sizeof(g722_multi_state_t),
+    .flags = VC_CODEC_F_MULTICHANNEL,
+    .delay_samples = VC_G722_DELAY_SAMPLES,
+    .open = g722_open,
+    .encode_frame = g722_encode_frame, .decode_frame = g722_decode_frame,
+    .encode_frames = g722_encode_frames, .decode_frames = g722_decode_frames,
+    .meta = g722_meta, .max_bytes_per_frame = g722_max_bytes,
+};
+
+/* ======================================================================
+ * Bezstratny LPC + Rice
+ * ====================================================================== */
+static vc_status_t lpc_open(void *st, const vc_enc_cfg_t *cfg, vc_codec_dir_t dir)
+{
+    (void)st; (void)cfg; (void)dir;
+    return VC_OK;
+}
+
+static vc_status_t lpc_encode_frame(void *st, const int16_t *pcm, uint16_t n,
+                                    uint8_t *out, uint16_t *out_len)
+{
+    (void)st;
+    *out_len = vc_lpc_encode_frame(pcm, n, out);
+    return (*out_len != 0) ? VC_OK : VC_E_CODEC;
+}
+
+static vc_status_t lpc_decode_frame(void *st, const uint8_t *in, uint16_t in_len,
+                                    int16_t *pcm, uint16_t n)
+{
+    (void)st;
+    return (vc_lpc_decode_frame(in, in_len, n, pcm) == n) ? VC_OK : VC_E_CODEC;
+}
+
+static void lpc_meta(const vc_enc_cfg_t *cfg, vc_stream_meta_t *m)
+{
+    (void)cfg;
+    vc_meta_lpc_make(m);
+}
+
+static uint16_t lpc_max_bytes(const vc_enc_cfg_t *cfg)
+{
+    (void)cfg;
+    return VC_LPC_MAX_BYTES_PER_FRAME;
+}
+
+static const vc_codec_ops_t vc_codec_lpc_ops = {
+    .id = VC_CODEC_LPC_RICE, .name = "lpc-rice", .state_bytes = 0, .flags = VC_CODEC_F_VARIABLE,
+    .open = lpc_open,
+    .encode_frame = lpc_encode_frame, .decode_frame = lpc_decode_frame,
+    .meta = lpc_meta, .max_bytes_per_frame = lpc_max_bytes,
+};
+
+/* ======================================================================
+ * Rejestr
+ * ====================================================================== */
+static const vc_codec_ops_t *const vc_codec_registry[] = {
+    &vc_codec_pcm16_ops,
+    &vc_codec_ima_ops,
+    &vc_codec_g711u_ops,
+    &vc_codec_g711a_ops,
+    &vc_codec_g722_ops,
+    &vc_codec_lpc_ops,
+};
+
+const vc_codec_ops_t *vc_codec_find(vc_codec_id_t id)
+{
+    for (uint32_t i = 0; i < sizeof(vc_codec_registry) / sizeof(vc_codec_registry[0]); i++) {
+        if (vc_codec_registry[i]->id == id) return vc_codec_registry[i];
+    }
+    return NULL;
+}
+
+vc_status_t vc_codec_open(vc_codec_t *c, const vc_enc_cfg_t *cfg, vc_codec_dir_t dir)
+{
+    if (!c || !cfg) return VC_E_PARAM;
+
+    const vc_codec_ops_t *ops = vc_codec_find(cfg->codec);
+    if (!ops) return VC_E_CODEC;
+    if (ops->state_bytes > VC_CODEC_STATE_BYTES) return VC_E_PARAM;
+
+    uint16_t ch = vc_codec_cfg_channels(cfg);
+    if (ch > VC_MAX_CHANNELS) return VC_E_PARAM;
+    if (ch > 1u && !(ops->flags & (VC_CODEC_F_INTERLEAVED | VC_CODEC_F_MULTICHANNEL))) return VC_E_PARAM;
+
+    memset(c, 0, sizeof(*c));
+    c->cfg = *cfg;
+    c->dir = dir;
+    c->frame_samples = vc_codec_frame_samples(cfg);
+    c->channels = ch;
+
+    vc_status_t st = ops->open(c->state, &c->cfg, dir);
+    if (st == VC_OK) c->ops = ops;
+    return st;
+}
+
+vc_status_t vc_codec_cfg_from_meta(const vc_stream_meta_t *m, vc_enc_cfg_t *cfg)
+{
+    if (!m || !cfg) return VC_E_PARAM;
+    if (!vc_codec_find(m->codec_id)) return VC_E_CODEC;
+
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->codec    = m->codec_id;
+    cfg->channels = m->channels;
+
+    switch (m->codec_id) {
+    case VC_CODEC_IMA_ADPCM:
+        cfg->samples_per_block = m->samples_per_block;
+        break;
+    case VC_CODEC_G722: {
+        uint16_t bits = m->codec_opts & VC_G722_OPT_BITS_MASK;
+        cfg->bitrate_bps = (bits == 6u) ? 48000u : (bits == 7u) ? 56000u : 64000u;
+        cfg->packed      = (m->codec_opts & VC_G722_OPT_PACKED) ? 1u : 0u;
+        if (cfg->packed || m->channels > 1u) cfg->samples_per_block = m->samples_per_block;
+        break;
+    }
+    default:
+        break;
+    }
+    return VC_OK;
+}
+
+void vc_codec_close(vc_codec_t *c)
+{
+    if (!c || !c->ops) return;
+    if (c->ops->close) c->ops->close(c->state);
+    c->ops = NULL;
+}
+
+/* Kodeki próbkowe (F_INTERLEAVED) widzą stereo jako płaski strumień n * channels próbek. */
+static uint16_t vc_codec_op_samples(const vc_codec_t *c)
+{
+    return (c->ops->flags & VC_CODEC_F_INTERLEAVED) ? (uint16_t)(c->frame_samples * c->channels)
+                                                    : c->frame_samples;
+}
+
+vc_status_t vc_codec_encode_frames(vc_codec_t *c, const int16_t *pcm, uint16_t n_frames,
+                                   uint8_t *out, uint32_t out_cap,
+                                   uint32_t *offsets, uint32_t *out_len)
+{
+    if (!c || !c->ops || !pcm || !out) return VC_E_PARAM;
+    if (c->dir != VC_CODEC_DIR_ENC) return VC_E_STATE;
+
+    const uint16_t n      = vc_codec_op_samples(c);
+    const uint32_t stride = (uint32_t)c->frame_samples * c->channels;
+
+    if (c->ops->encode_frames) {
+        return c->ops->encode_frames(c->state, pcm, n, n_frames, out, out_cap, offsets, out_len);
+    }
+
+    uint16_t max_bytes = vc_codec_max_bytes_per_frame(c);
+    uint32_t pos = 0;
+    for (uint16_t f = 0; f < n_frames; f++) {
+        if (out_cap - pos < max_bytes) return VC_E_FULL;
+        if (offsets) offsets[f] = pos;
+
+        uint16_t len = 0;
+        vc_status_t st = c->ops->encode_frame(c->state, pcm + (uint32_t)f * stride, n, out + pos, &len);
+        if (st != VC_OK) return st;
+        pos += len;
+    }
+    if (offsets) offsets[n_frames] = pos;
+    if (out_len) *out_len = pos;
+    return VC_OK;
+}
+
+vc_status_t vc_codec_decode_frames(vc_codec_t *c, const uint8_t *in, const uint32_t *offsets,
+                                   uint16_t n_frames, int16_t *pcm)
+{
+    if (!c || !c->ops || !in || !pcm) return VC_E_PARAM;
+    if (c->dir != VC_CODEC_DIR_DEC) return VC_E_STATE;
+    if (!offsets && (c->ops->flags & VC_CODEC_F_VARIABLE)) return VC_E_PARAM;
+
+    const uint16_t n      = vc_codec_op_samples(c);
+    const uint32_t stride = (uint32_t)c->frame_samples * c->channels;
+
+    if (c->ops->decode_frames) {
+        return c->ops->decode_frames(c->state, in, offsets, n_frames, pcm, n);
+    }
+
+    uint16_t frame_bytes = vc_codec_max_bytes_per_frame(c);
+    for (uint16_t f = 0; f < n_frames; f++) {
+        uint32_t start = offsets ? offsets[f] : (uint32_t)f * frame_bytes;
+        uint32_t len   = offsets ? offsets[f + 1] - offsets[f] : frame_bytes;
+        if (len > 0xFFFFu) return VC_E_CODEC;
+
+        vc_status_t st = c->ops->decode_frame(c->state, in + start, (uint16_t)len,
+                                              pcm + (uint32_t)f * stride, n);
+        if (st != VC_OK) return st;
+    }
+    return VC_OK;
+}
+
+vc_status_t vc_codec_flush(vc_codec_t *c, uint8_t *out, uint16_t *out_len)
+{
+    if (!c || !c->ops || !out_len) return VC_E_PARAM;
+    *out_len = 0;
+    return c->ops->flush ? c->ops->flush(c->state, out, out_len) : VC_OK;
+}
+
+void vc_codec_meta(const vc_codec_t *c, vc_stream_meta_t *m)
+{
+    if (!c || !c->ops || !m) return;
+    c->ops->meta(&c->cfg, m);
+    if ((c->ops->flags & VC_CODEC_F_INTERLEAVED) && c->channels > 1u) {
+        m->channels           = c->channels;
+        m->block_align        = (uint16_t)(m->block_align * c->channels);
+        m->avg_bytes_per_sec *= c->channels;
+    }
+}
+
+uint16_t vc_codec_max_bytes_per_frame(const vc_codec_t *c)
+{
+    if (!c || !c->ops) return 0;
+    uint16_t bytes = c->ops->max_bytes_per_frame(&c->cfg);
+    return (c->ops->flags & VC_CODEC_F_INTERLEAVED) ? (uint16_t)(bytes * c->channels) : bytes;
+}
@@ -0,0 +1,176 @@
+#include "voicecmd/vc_codec_select.h"
+#include <string.h>
+
+/* Kandydaci od najtańszego w zapisie. Cykle to szacunek dla Cortex-M4 @168 MHz;
+ * z cfg.cycles != NULL są nadpisywane pomiarem z prób. */
+static const vc_select_candidate_t vc_select_candidates[VC_SELECT_N_CANDIDATES] = {
+    { { .codec = VC_CODEC_G722, .bitrate_bps = 48000u, .packed = 1 },                    6000u, 120000u },
+    { { .codec = VC_CODEC_G722, .bitrate_bps = 56000u, .packed = 1 },                    7000u, 120000u },
+    { { .codec = VC_CODEC_G722, .bitrate_bps = 64000u },                                 8000u, 120000u },
+    { { .codec = VC_CODEC_IMA_ADPCM, .samples_per_block = VC_FRAME_SAMPLES },            8200u,  25000u },
+    { { .codec = VC_CODEC_PCM16 },                                                      32000u,   2000u },
+};
+
+void vc_select_default_cfg(vc_select_cfg_t *cfg)
+{
+    if (!cfg) return;
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->target_snr_db     = 20.0f;
+    cfg->hysteresis_db     = 1.0f;
+    cfg->cpu_cap_cycles    = 0;
+    cfg->eval_every_frames = 50;
+    cfg->cycles            = NULL;
+}
+
+float32_t vc_segsnr_db(const int16_t *ref, const int16_t *test, uint16_t n, uint16_t *active)
+{
+    /* próg ciszy: średnia moc < 10^2 (~ -70 dBFS) */
+    const float32_t silence = 100.0f * VC_SEGSNR_SUBFRAME;
+    float32_t sum = 0.0f;
+    uint16_t  cnt = 0;
+
+    for (uint16_t off = 0; off + VC_SEGSNR_SUBFRAME <= n; off += VC_SEGSNR_SUBFRAME) {
+        float32_t sig = 0.0f, err = 0.0f;
+        for (uint16_t i = 0; i < VC_SEGSNR_SUBFRAME; i++) {
+            float32_t r = ref[off + i];
+            float32_t e = r - (float32_t)test[off + i];
+            sig += r * r;
+            err += e * e;
+        }
+        if (sig < silence) continue;
+
+        float32_t db = (err > 0.0f) ? 10.0f * log10f(sig / err) : VC_SEGSNR_MAX_DB;
+        if (db < VC_SEGSNR_MIN_DB) db = VC_SEGSNR_MIN_DB;
+        if (db > VC_SEGSNR_MAX_DB) db = VC_SEGSNR_MAX_DB;
+        sum += db;
+        cnt++;
+    }
+    if (active) *active = cnt;
+    return cnt ? sum / (float32_t)cnt : 0.0f;
+}
+
+static void vc_select_log(vc_codec_select_t *s)
+{
+    vc_stream_meta_t m;
+    vc_codec_meta(&s->active, &m);
+
+    vc_vcmd_switch_t *e = &s->log[s->n_switches++];
+    e->frame_idx   = s->frame_idx;
+    e->byte_offset = s->byte_pos;
+    e->codec_id    = (uint16_t)m.codec_id;
+    e->codec_opts  = m.codec_opts;
+}
+
+static vc_status_t vc_select_activate(vc_codec_select_t *s, uint8_t idx)
+{
+    vc_codec_close(&s->active);
+    vc_status_t st = vc_codec_open(&s->active, &s->cand[idx].cfg, VC_CODEC_DIR_ENC);
+    if (st != VC_OK) return st;
+    s->active_idx = idx;
+    vc_select_log(s);
+    return VC_OK;
+}
+
+vc_status_t vc_select_init(vc_codec_select_t *s, const vc_select_cfg_t *cfg)
+{
+    if (!s) return VC_E_PARAM;
+    memset(s, 0, sizeof(*s));
+    if (cfg) s->cfg = *cfg;
+    else     vc_select_default_cfg(&s->cfg);
+    if (s->cfg.eval_every_frames == 0) s->cfg.eval_every_frames = 50;
+    memcpy(s->cand, vc_select_candidates, sizeof(s->cand));
+
+    /* Start: najdroższy w zapisie kandydat mieszczący się w limicie CPU
+     * (bezpieczna jakość do pierwszej próby). */
+    uint8_t start = 0;
+    for (uint8_t i = 0; i < VC_SELECT_N_CANDIDATES; i++) {
+        if (s->cfg.cpu_cap_cycles == 0 || s->cand[i].enc_cycles <= s->cfg.cpu_cap_cycles) start = i;
+    }
+    return vc_select_activate(s, start);
+}
+
+/* Próba kandydata idx na s->src; zwraca segSNR bieżącej ramki (active = 0 -> cisza). */
+static float32_t vc_select_trial(vc_codec_select_t *s, uint8_t idx, uint16_t *active)
+{
+    const uint16_t n  = VC_FRAME_SAMPLES;
+    const uint16_t nf = s->have_prev ? 2u : 1u;
+    const int16_t *in = s->have_prev ? s->src : s->src + n;
+    uint32_t len = 0;
+
+    *active = 0;
+    if (vc_codec_open(&s->trial_enc, &s->cand[idx].cfg, VC_CODEC_DIR_ENC) != VC_OK) return VC_SEGSNR_MIN_DB;
+    if (vc_codec_open(&s->trial_dec, &s->cand[idx].cfg, VC_CODEC_DIR_DEC) != VC_OK) return VC_SEGSNR_MIN_DB;
+
+    uint32_t t0 = s->cfg.cycles ? s->cfg.cycles() : 0u;
+    vc_status_t st = vc_codec_encode_frames(&s->trial_enc, in, nf, s->trial_bytes,
+                                            sizeof(s->trial_bytes), NULL, &len);
+    if (s->cfg.cycles) {
+        /* średnia krocząca 1/4 z pomiaru na ramkę */
+        uint32_t per_frame = (s->cfg.cycles() - t0) / nf;
+        s->cand[idx].enc_cycles = (3u * s->cand[idx].enc_cycles + per_frame) / 4u;
+    }
+    if (st != VC_OK) return VC_SEGSNR_MIN_DB;
+
+    uint32_t offsets[3] = { 0, len / nf, len };   /* kandydaci mają ramki stałej długości */
+    st = vc_codec_decode_frames(&s->trial_dec, s->trial_bytes, offsets, nf, s->trial_pcm);
+    uint16_t delay = s->trial_dec.ops->delay_samples;
+    vc_codec_close(&s->trial_enc);
+    vc_codec_close(&s->trial_dec);
+    if (st != VC_OK) return VC_SEGSNR_MIN_DB;
+
+    /* Ostatnia ramka wyjścia, przesunięta o opóźnienie kodeka. */
+    return vc_segsnr_db(s->src + n, s->trial_pcm + (uint32_t)(nf - 1u) * n + delay,
+                        (uint16_t)(n - delay), active);
+}
+
+static void vc_select_evaluate(vc_codec_select_t *s)
+{
+    uint16_t active = 0;
+    for (uint8_t i = 0; i < VC_SELECT_N_CANDIDATES; i++) {
+        s->last_snr_db[i] = vc_select_trial(s, i, &active);
+    }
+    if (active == 0) return;                          /* cisza - bez decyzji */
+
+    int best_fit = -1, best_snr = -1, cheapest_cpu = 0;
+    for (uint8_t i = 0; i < VC_SELECT_N_CANDIDATES; i++) {
+        if (s->cand[i].enc_cycles < s->cand[cheapest_cpu].enc_cycles) cheapest_cpu = i;
+        if (s->cfg.cpu_cap_cycles && s->cand[i].enc_cycles > s->cfg.cpu_cap_cycles) continue;
+
+        /* Zejście na tańszy kodek wymaga zapasu (histereza), pozostanie - tylko celu. */
+        float32_t need = s->cfg.target_snr_db + ((i < s->active_idx) ? s->cfg.hysteresis_db : 0.0f);
+        if (best_fit < 0 && s->last_snr_db[i] >= need) best_fit = i;
+        if (best_snr < 0 || s->last_snr_db[i] > s->last_snr_db[best_snr]) best_snr = i;
+    }
+
+    int pick = (best_fit >= 0) ? best_fit : (best_snr >= 0) ? best_snr : cheapest_cpu;
+    if ((uint8_t)pick != s->active_idx && s->n_switches < VC_SELECT_MAX_SWITCHES) {
+        vc_select_activate(s, (uint8_t)pick);
+    }
+}
+
+vc_status_t vc_select_encode(vc_codec_select_t *s, const int16_t *pcm,
+                             uint8_t *out, uint16_t *out_len, bool *switched)
+{
+    if (!s || !s->active.ops || !pcm || !out || !out_len) return VC_E_PARAM;
+
+    const uint16_t n = VC_FRAME_SAMPLES;
+    uint16_t log_before = s->n_switches;
+
+    memcpy(s->src + n, pcm, (size_t)n * sizeof(int16_t));
+    if (s->frame_idx >= 1u && ((s->frame_idx - 1u) % s->cfg.eval_every_frames) == 0u) {
+        vc_select_evaluate(s);
+    }
+
+    uint32_t len = 0;
+    vc_status_t st = vc_codec_encode_frames(&s->active, pcm, 1, out, VC_PCM_FRAME_BYTES, NULL, &len);
+    if (st != VC_OK) return st;
+
+    *out_len = (uint16_t)len;
+    if (switched) *switched = (s->n_switches != log_before);
+
+    memcpy(s->src, s->src + n, (size_t)n * sizeof(int16_t));
+    s->have_prev = true;
+    s->frame_idx++;
+    s->byte_pos += len;
+    return VC_OK;
+}
@@ -0,0 +1,269 @@
+#include "voicecmd/vc_crc32.h"
+#include <string.h>
+
+#if VC_CRC32_USE_HW
+#include "main.h"
+extern CRC_HandleTypeDef hcrc;
+#endif
+
+/* Tablice slice-by-8 (8 KiB RAM), liczone przy pierwszym użyciu:
+ * T0[i] = CRC bajtu i (MSB-first), Tk[i] = T0 przesunięte o k bajtów zer. */
+static uint32_t s_tab[8][256];
+static uint8_t  s_tab_ready;
+
+static void vc_crc32_make_tables(void)
+{
+    for (uint32_t i = 0; i < 256u; i++) {
+        uint32_t c = i << 24;
+        for (int b = 0; b < 8; b++) {
+            c = (c & 0x80000000u) ? (c << 1) ^ VC_CRC32_POLY : (c << 1);
+        }
+        s_tab[0][i] = c;
+    }
+    for (uint32_t k = 1; k < 8u; k++) {
+        for (uint32_t i = 0; i < 256u; i++) {
+            uint32_t c = s_tab[k - 1u][i];
+            s_tab[k][i] = (c << 8) ^ s_tab[0][c >> 24];
+        }
+    }
+    s_tab_ready = 1;
+}
+
+uint32_t vc_crc32_words_sw(uint32_t crc, const uint32_t *words, uint32_t n_words)
+{
+    if (!s_tab_ready) vc_crc32_make_tables();
+
+    /* Po dwa słowa (8 bajtów) na krok - 8 niezależnych odczytów tablic. */
+    while (n_words >= 2u) {
+        uint32_t a = crc ^ words[0];
+        uint32_t b = words[1];
+        crc = s_tab[7][a >> 24] ^ s_tab[6][(a >> 16) & 0xFFu] ^ s_tab[5][(a >> 8) & 0xFFu] ^ s_tab[4][a & 0xFFu]
+            ^ s_tab[3][b >> 24] ^ s_tab[2][(b >> 16) & 0xFFu] ^ s_tab[1][(b >> 8) & 0xFFu] ^ s_tab[0][b & 0xFFu];
+        words   += 2;
+        n_words -= 2u;
+    }
+    if (n_words) {
+        uint32_t a = crc ^ words[0];
+        crc = s_tab[3][a >> 24] ^ s_tab[2][(a >> 16) & 0xFFu] ^ s_tab[1][(a >> 8) & 0xFFu] ^ s_tab[0][a & 0xFFu];
+    }
+    return crc;
+}
+
+#if VC_CRC32_USE_HW
+
+/* Mem->mem DMA2 (tylko DMA2 umie pamięć-pamięć): źródło z inkrementacją, cel stały CRC->DR. */
+#define VC_CRC32_DMA_MAX_WORDS  0xFFFFu
+
+static DMA_HandleTypeDef s_dma;
+static vc_crc32_t       *s_dma_owner;     /* kontekst z trwającym transferem */
+static volatile uint8_t  s_hw_busy;       /* jednostka zajęta (też przez s_dma_owner) */
+
+/* Jednostka CRC i DMA2 Stream0 są jedne na cały program, a DR trzyma stan tylko jednego
+ * kontekstu. Kto zastanie je zajęte (writer VCMD w przerwaniu audio w trakcie verify_crc
+ * w pętli głównej, inny kontekst z trwającym update_async), liczy programowo. */
+static uint8_t vc_crc32_hw_claim(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint8_t ok = !s_hw_busy;
+    if (ok) s_hw_busy = 1;
+    __set_PRIMASK(primask);
+    return ok;
+}
+
+static void vc_crc32_hw_release(void)
+{
+    s_hw_busy = 0;
+}
+
+static void vc_crc32_dma_setup(void)
+{
+    if (s_dma.Instance) return;
+    __HAL_RCC_DMA2_CLK_ENABLE();
+    s_dma.Instance                 = DMA2_Stream0;
+    s_dma.Init.Channel             = DMA_CHANNEL_0;
+    s_dma.Init.Direction           = DMA_MEMORY_TO_MEMORY;
+    s_dma.Init.PeriphInc           = DMA_PINC_ENABLE;
+    s_dma.Init.MemInc              = DMA_MINC_DISABLE;
+    s_dma.Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+    s_dma.Init.MemDataAlignment    = DMA_MDATAALIGN_WORD;
+    s_dma.Init.Mode                = DMA_NORMAL;
+    s_dma.Init.Priority            = DMA_PRIORITY_LOW;
+    s_dma.Init.FIFOMode            = DMA_FIFOMODE_ENABLE;   /* mem->mem wymaga FIFO */
+    s_dma.Init.FIFOThreshold       = DMA_FIFO_THRESHOLD_FULL;
+    s_dma.Init.MemBurst            = DMA_MBURST_SINGLE;
+    s_dma.Init.PeriphBurst         = DMA_PBURST_SINGLE;
+    if (HAL_DMA_Init(&s_dma) != HAL_OK) s_dma.Instance = NULL;
+}
+
+/* Odwrotność jednego kroku 32-bitowego jednostki (DR' = f(DR ^ w)) - pozwala wpisać
+ * do CRC->DR dowolny stan: po resecie DR = 0xFFFFFFFF, więc słowo unstep(crc) ^ 0xFFFFFFFF
+ * daje DR = crc. Dzięki temu kilka kontekstów dzieli jedną jednostkę. */
+static uint32_t vc_crc32_unstep32(uint32_t crc)
+{
+    for (int b = 0; b < 32; b++) {
+        crc = (crc & 1u) ? ((crc ^ VC_CRC32_POLY) >> 1) | 0x80000000u : (crc >> 1);
+    }
+    return crc;
+}
+
+/* Wołane z zajętą jednostką (vc_crc32_hw_claim). */
+static void vc_crc32_hw_load(uint32_t crc)
+{
+    __HAL_CRC_DR_RESET(&hcrc);
+    if (crc != VC_CRC32_INIT) hcrc.Instance->DR = vc_crc32_unstep32(crc) ^ VC_CRC32_INIT;
+}
+
+/* DMA tylko z SRAM1/2 (CCM nie jest podłączony do matrycy szyn DMA). */
+static uint8_t vc_crc32_dma_ok(const void *p, uint32_t n_words)
+{
+    uintptr_t a = (uintptr_t)p;
+    return (n_words * 4u >= VC_CRC32_DMA_MIN_BYTES) && !(a & 3u)
+        && (a < CCMDATARAM_BASE || a >= CCMDATARAM_BASE + 0x10000u);
+}
+
+static void vc_crc32_words(vc_crc32_t *c, const uint32_t *w, uint32_t n)
+{
+    if (!vc_crc32_hw_claim()) {
+        c->crc = vc_crc32_words_sw(c->crc, w, n);
+        return;
+    }
+    vc_crc32_hw_load(c->crc);
+    if (vc_crc32_dma_ok(w, n)) vc_crc32_dma_setup();
+
+    while (n) {
+        uint32_t chunk = (n > VC_CRC32_DMA_MAX_WORDS) ? VC_CRC32_DMA_MAX_WORDS : n;
+        if (s_dma.Instance && vc_crc32_dma_ok(w, chunk)
+            && HAL_DMA_Start(&s_dma, (uint32_t)w, (uint32_t)&hcrc.Instance->DR, chunk) == HAL_OK) {
+            HAL_DMA_PollForTransfer(&s_dma, HAL_DMA_FULL_TRANSFER, HAL_MAX_DELAY);
+        } else {
+            for (uint32_t i = 0; i < chunk; i++) hcrc.Instance->DR = w[i];
+        }
+        w += chunk;
+        n -= chunk;
+    }
+    c->crc = hcrc.Instance->DR;
+    vc_crc32_hw_release();
+}
+
+void vc_crc32_update_async(vc_crc32_t *c, const void *data, uint32_t len)
+{
+    if (!c || !data) return;
+    uint32_t n = len / 4u;
+    vc_crc32_wait(c);
+    if (c->n_pending || (len & 3u) || n > VC_CRC32_DMA_MAX_WORDS || !vc_crc32_dma_ok(data, n)
+        || !vc_crc32_hw_claim()) {
+        vc_crc32_update(c, data, len);
+        return;
+    }
+    vc_crc32_hw_load(c->crc);
+    vc_crc32_dma_setup();
+    if (!s_dma.Instance || HAL_DMA_Start(&s_dma, (uint32_t)data, (uint32_t)&hcrc.Instance->DR, n) != HAL_OK) {
+        vc_crc32_hw_release();
+        vc_crc32_update(c, data, len);
+        return;
+    }
+    s_dma_owner = c;   /* jednostka zajęta do vc_crc32_wait(c) */
+}
+
+void vc_crc32_wait(vc_crc32_t *c)
+{
+    if (!c || s_dma_owner != c) return;
+    HAL_DMA_PollForTransfer(&s_dma, HAL_DMA_FULL_TRANSFER, HAL_MAX_DELAY);
+    c->crc = hcrc.Instance->DR;
+    s_dma_owner = NULL;
+    vc_crc32_hw_release();
+}
+
+#else
+
+static void vc_crc32_words(vc_crc32_t *c, const uint32_t *w, uint32_t n)
+{
+    c->crc = vc_crc32_words_sw(c->crc, w, n);
+}
+
+void vc_crc32_update_async(vc_crc32_t *c, const void *data, uint32_t len)
+{
+    vc_crc32_update(c, data, len);
+}
+
+void vc_crc32_wait(vc_crc32_t *c)
+{
+    (void)c;
+}
+
+#endif /* VC_CRC32_USE_HW */
+
+void vc_crc32_init(vc_crc32_t *c)
+{
+    if (!c) return;
+    c->crc       = VC_CRC32_INIT;
+    c->pending   = 0;
+    c->n_pending = 0;
+}
+
+void vc_crc32_update(vc_crc32_t *c, const void *data, uint32_t len)
+{
+    if (!c || (!data && len)) return;
+    vc_crc32_wait(c);
+
+    const uint8_t *p = (const uint8_t *)data;
+
+    /* Dopełnienie zaległego słowa (ramki o nieparzystej długości, prefiksy uint16). */
+    while (c->n_pending && len) {
+        c->pending |= (uint32_t)*p++ << (8u * c->n_pending);
+        len--;
+        if (++c->n_pending == 4u) {
+            vc_crc32_words(c, &c->pending, 1);
+            c->pending   = 0;
+            c->n_pending = 0;
+        }
+    }
+
+    uint32_t n_words = len / 4u;
+    if (n_words) {
+        if (((uintptr_t)p & 3u) == 0u) {
+            vc_crc32_words(c, (const uint32_t *)(const void *)p, n_words);
+        } else {
+            uint32_t tmp[16];
+            for (uint32_t done = 0; done < n_words; ) {
+                uint32_t k = n_words - done;
+                if (k > 16u) k = 16u;
+                memcpy(tmp, p + done * 4u, k * 4u);
+                vc_crc32_words(c, tmp, k);
+                done += k;
+            }
+        }
+        p   += n_words * 4u;
+        len -= n_words * 4u;
+    }
+
+    if (len) {
+        /* Tu n_pending == 0 (zaległe słowo domknięte albo zabrakło danych - wtedy len == 0). */
+        for (uint32_t i = 0; i < len; i++) {
+            c->pending |= (uint32_t)p[i] << (8u * i);
+        }
+        c->n_pending = (uint8_t)len;
+    }
+}
+
+uint32_t vc_crc32_final(vc_crc32_t *c)
+{
+    if (!c) return 0;
+    vc_crc32_wait(c);
+    if (c->n_pending) {
+        /* Niepełne słowo dopełnione zerami (starsze bajty pending są zerowe). */
+        vc_crc32_words(c, &c->pending, 1);
+        c->pending   = 0;
+        c->n_pending = 0;
+    }
+    return c->crc;
+}
+
+uint32_t vc_crc32(const void *data, uint32_t len)
+{
+    vc_crc32_t c;
+    vc_crc32_init(&c);
+    vc_crc32_update(&c, data, len);
+    return vc_crc32_final(&c);
+}
@@ -1,33 +1,60 @@
 #include "voicecmd/vc_decoders.h"
+#include "voicecmd/vc_codec.h"
+#include <string.h>
 
-void decompress_data(vc_pcm_meta_t *frm, int16_t *samples, vc_enc_cfg_t *cfg)
+/* Dekoduje jedną ramkę (in_len bajtów) otwartym kodekiem (vc_codec_open(..., VC_CODEC_DIR_DEC)).
+ * Zwraca liczbę próbek (frm->len_samples) lub 0 przy błędzie. */
+uint16_t decompress_data(struct vc_codec *codec, vc_pcm_meta_t *frm, const uint8_t *in, uint16_t in_len,
+                         int16_t *samples)
 {
-vc_stream_meta_t *m;
-if (!frm || !cfg) return;
-
-
-    switch (cfg->codec) {
-    case VC_CODEC_PCM16:
-        // TODO: load file encoded in PCM16 and fill samples array
-        break;
-
-    case VC_CODEC_IMA_ADPCM:
-        uint8_t  adpcm[VC_IMA_MONO_BYTES_PER_FRAME];
-        // TODO: load file encoded in IMA-ADPCM and fill adpcm array
-        uint16_t result = vc_ima_decode_block_mono(adpcm, VC_MAX_FRAME_SAMPLES, samples);
-        break;
-
-    case VC_CODEC_G722:
-        // -------------------------ALLLLERTT 
-        // BEFORE USING 'g722_decode_20ms_64k' USE somewhere 'g722_init_64k_dec();' and after coding 'g722_deinit_dec();'
-        //---------------------------------
-        g722_init_64k_dec(); // maybe somewhere else
-        int16_t g722_data[VC_G722_BYTES_PER_FRAME];
-        // TODO dla wojtka: load file encoded in G722 and fill adpcm array
-        int wrote_g722 = g722_decode_20ms_64k(g722_data, samples);
-        if (wrote_g722 != 320) break; 
-        g722_deinit_dec(); // maybe somewhere else
-    }  
+    if (!codec || !frm || !in || !samples) return 0;
+    if (frm->len_samples != codec->frame_samples) return 0;
+    if (vc_frame_channels(frm) != codec->channels) return 0;
+
+    uint32_t offsets[2] = { 0, in_len };
+    if (vc_codec_decode_frames(codec, in, offsets, 1, samples) != VC_OK) return 0;
+    return frm->len_samples;
+}
+
+uint16_t decompress_data_plc(struct vc_codec *codec, vc_plc_t *plc, vc_pcm_meta_t *frm,
+                             const uint8_t *in, uint16_t in_len, bool frame_ok, int16_t *samples)
+{
+    if (!codec || !codec->ops || !plc || !frm || !samples) return 0;
+    if (frm->len_samples != codec->frame_samples) return 0;
+    if (codec->channels != 1u || vc_frame_channels(frm) != 1u) return 0;   /* PLC tylko mono */
+
+    /* Kontrola rozmiaru: ramki stałej długości muszą mieć dokładnie max_bytes_per_frame,
+     * zmiennej - nie więcej. */
+    uint16_t max_bytes = vc_codec_max_bytes_per_frame(codec);
+    if (in == NULL || in_len == 0 || in_len > max_bytes) frame_ok = false;
+    if (!(codec->ops->flags & VC_CODEC_F_VARIABLE) && in_len != max_bytes) frame_ok = false;
+
+    if (frame_ok) {
+        /* Resynchronizacja: IMA startuje z predyktora/indeksu z nagłówka bloku.
+         * G.722 dekoduje dalej ze stanu sprzed dziury - adaptacja dogania koder
+         * szybciej niż po zimnym starcie (zerowe predyktory, minimalny krok). */
+        uint32_t offsets[2] = { 0, in_len };
+        if (vc_codec_decode_frames(codec, in, offsets, 1, samples) == VC_OK) {
+            vc_plc_good(plc, samples, frm->len_samples);
+            return frm->len_samples;
+        }
+    }
+
+    vc_plc_conceal(plc, samples, frm->len_samples);
+    return frm->len_samples;
+}
+
+/* Dekoduje n_frames ramek; offsets [n_frames + 1] albo NULL dla ramek stałej długości.
+ * Zwraca łączną liczbę próbek na kanał (n_frames * frm->len_samples) lub 0 przy błędzie. */
+uint32_t decompress_frames(struct vc_codec *codec, vc_pcm_meta_t *frm, const uint8_t *in,
+                           const uint32_t *offsets, uint16_t n_frames, int16_t *samples)
+{
+    if (!codec || !frm || !in || !samples) return 0;
+    if (frm->len_samples != codec->frame_samples) return 0;
+    if (vc_frame_channels(frm) != codec->channels) return 0;
+
+    if (vc_codec_decode_frames(codec, in, offsets, n_frames, samples) != VC_OK) return 0;
+    return (uint32_t)n_frames * frm->len_samples;
 }
 
 uint16_t vc_ima_decode_block_mono(const uint8_t *block,
@@ -75,6 +102,53 @@ uint16_t vc_ima_decode_block_mono(const uint8_t *block,
     return spb;
 }
 
+/* Blok wielokanałowy MS-IMA (układ jak vc_ima_encode_block) -> out_pcm przeplatane.
+ * Zwraca liczbę próbek na kanał (spb) lub 0. */
+uint16_t vc_ima_decode_block(const uint8_t *block,
+                             uint16_t spb,
+                             uint16_t channels,
+                             int16_t *out_pcm)
+{
+    static uint8_t ch_block[4u + VC_MAX_FRAME_SAMPLES / 2u + 4u];
+    static int16_t ch_pcm[VC_MAX_FRAME_SAMPLES];
+
+    if (!block || !out_pcm || spb == 0) return 0;
+    if (channels <= 1u) return vc_ima_decode_block_mono(block, spb, out_pcm);
+    if (channels > VC_MAX_CHANNELS || spb > VC_MAX_FRAME_SAMPLES) return 0;
+
+    const uint32_t words = ((uint32_t)spb - 1u + 7u) / 8u;
+    for (uint16_t c = 0; c < channels; c++) {
+        memcpy(ch_block, block + 4u * c, 4u);
+        for (uint32_t w = 0; w < words; w++) {
+            memcpy(ch_block + 4u + 4u * w, block + 4u * channels + 4u * (w * channels + c), 4u);
+        }
+        vc_ima_decode_block_mono(ch_block, spb, ch_pcm);
+        for (uint16_t i = 0; i < spb; i++) out_pcm[(uint32_t)i * channels + c] = ch_pcm[i];
+    }
+    return spb;
+}
+
+/* Dekoduje n_blocks bloków IMA; offsets [n_blocks + 1] albo NULL, gdy bloki leżą
+ * jeden za drugim co vc_ima_block_bytes_mono(spb). Blok krótszy niż wymagany -> 0.
+ * Zwraca łączną liczbę próbek (n_blocks * spb) lub 0 przy błędzie. */
+uint32_t vc_ima_decode_blocks_mono(const uint8_t *in,
+                                   uint16_t spb,
+                                   uint16_t n_blocks,
+                                   const uint32_t *offsets,
+                                   int16_t *out_pcm)
+{
+    if (!in || !out_pcm || spb == 0) return 0;
+
+    const uint16_t block_bytes = vc_ima_block_bytes_mono(spb);
+    for (uint16_t b = 0; b < n_blocks; b++) {
+        const uint8_t *block = in + (offsets ? offsets[b] : (uint32_t)b * block_bytes);
+        if (offsets && offsets[b + 1] - offsets[b] < block_bytes) return 0;
+        vc_ima_decode_block_mono(block, spb, out_pcm);
+        out_pcm += spb;
+    }
+    return (uint32_t)n_blocks * spb;
+}
+
 void g722_init_64k_dec(void) {
     // 64 kb/s, wejście 16 kHz -> options = 0
     dec = g722_decoder_new(64000, 0);
@@ -88,3 +162,9 @@ int g722_decode_20ms_64k(const uint8_t *in160, int16_t *pcm320_out) {
     // zwraca liczbę próbek; oczekuj 320
     return g722_decode(dec, in160, 160, pcm320_out);
 }
+
+/* n_frames ramek po 160 B leżących jedna za drugą -> n_frames * 320 próbek. */
+int g722_decode_frames_64k(const uint8_t *in, uint16_t n_frames, int16_t *pcm_out) {
+    if (!dec || !in || !pcm_out) return 0;
+    return g722_decode(dec, in, (int)n_frames * VC_G722_BYTES_PER_FRAME, pcm_out);
+}
@@ -32,22 +32,29 @@ static const float32_t biquad_coeffs[5 * NUM_STAGES] = {
     VC_HPF_B0, VC_HPF_B1, VC_HPF_B2, VC_HPF_A1, VC_HPF_A2
 };
 
-// Stan filtru (4*N)
-static float32_t biquad_state[4 * NUM_STAGES];
+// Stan filtru (4*N) - osobny dla każdego kanału
+static float32_t biquad_state[VC_MAX_CHANNELS][4 * NUM_STAGES];
 
-// Instancja CMSIS-DSP
-static arm_biquad_casd_df1_inst_f32 S_hpf;
+// Instancje CMSIS-DSP (po jednej na kanał, wspólne współczynniki)
+static arm_biquad_casd_df1_inst_f32 S_hpf[VC_MAX_CHANNELS];
 
 // Inicjalizacja
 void vc_hpf_init_f32(void)
 {
-    arm_biquad_cascade_df1_init_f32(&S_hpf, NUM_STAGES, biquad_coeffs, biquad_state);
+    for (uint32_t ch = 0; ch < VC_MAX_CHANNELS; ch++) {
+        arm_biquad_cascade_df1_init_f32(&S_hpf[ch], NUM_STAGES, biquad_coeffs, biquad_state[ch]);
+    }
 }
 
-// Przetwarzanie ramki HPF z metadanymi i oddzielnymi tablicami
+// Przetwarzanie ramki HPF z metadanymi i oddzielnymi tablicami.
+// Stereo: próbki przeplatane (L R L R ...) na wejściu i wyjściu.
 void vc_hpf_process_frame_f32(const vc_pcm_meta_t *pcm_meta, int16_t *input_data, float32_t *output_data)
 {
-    if (!pcm_meta || !input_data || !output_data || pcm_meta->channels != 1)
+    if (!pcm_meta || !input_data || !output_data)
+        return;
+
+    uint32_t channels = pcm_meta->channels;
+    if (channels == 0 || channels > VC_MAX_CHANNELS)
         return;
 
     uint32_t N = pcm_meta->len_samples;
@@ -55,11 +62,25 @@ void vc_hpf_process_frame_f32(const vc_pcm_meta_t *pcm_meta, int16_t *input_data
     
     float32_t temp_input_f32[VC_FRAME_SAMPLES];
 
-    // Konwersja próbek z int16_t do float32_t
-    vc_convert_int16_to_float32(input_data, temp_input_f32, N);
+    if (channels == 1) {
+        // Konwersja próbek z int16_t do float32_t
+        vc_convert_int16_to_float32(input_data, temp_input_f32, N);
 
-    // Przetwarzanie filtrem HPF: temp_input_f32 -> output_data
-    arm_biquad_cascade_df1_f32(&S_hpf, temp_input_f32, output_data, N);
+        // Przetwarzanie filtrem HPF: temp_input_f32 -> output_data
+        arm_biquad_cascade_df1_f32(&S_hpf[0], temp_input_f32, output_data, N);
+        return;
+    }
+
+    // Wielokanałowo: rozplot kanału -> HPF (in-place) -> przeplot do output_data
+    for (uint32_t ch = 0; ch < channels; ch++) {
+        for (uint32_t i = 0; i < N; i++) {
+            temp_input_f32[i] = (float32_t)input_data[i * channels + ch];
+        }
+        arm_biquad_cascade_df1_f32(&S_hpf[ch], temp_input_f32, temp_input_f32, N);
+        for (uint32_t i = 0; i < N; i++) {
+            output_data[i * channels + ch] = temp_input_f32[i];
+        }
+    }
 }
 
 
@@ -0,0 +1,409 @@
+#include "voicecmd/vc_lpc.h"
+#include "arm_math.h"
+#include <string.h>
+
+enum {
+    VC_LPC_T_VERBATIM = 0,
+    VC_LPC_T_FIXED    = 1,
+    VC_LPC_T_LPC      = 2,
+};
+
+#define VC_LPC_RICE_ESCAPE 31u
+#define VC_LPC_MAX_SHIFT   14
+
+/* Rzędy LPC sprawdzane przy każdej ramce (koszt: rząd * N MAC na rząd) */
+static const uint8_t VC_LPC_ORDERS[] = { 4, 8, VC_LPC_MAX_ORDER };
+
+/* Bufory robocze kodera - moduł nie jest reentrantny (jeden tor nagrywania) */
+static float32_t lpc_win[VC_FRAME_SAMPLES];
+static uint16_t  lpc_win_len = 0;
+static float32_t lpc_xw[VC_FRAME_SAMPLES];
+static int32_t   lpc_res[2][VC_FRAME_SAMPLES];
+
+/* Bufor dekodera osobno - odtwarzanie może przerywać nagrywanie (i odwrotnie) */
+static int32_t   lpc_dec_x[VC_FRAME_SAMPLES];
+
+/* ========== Zapis / odczyt bitów (MSB-first) ========== */
+typedef struct {
+    uint8_t  *buf;
+    uint32_t  pos;
+    uint32_t  acc;
+    uint32_t  nacc;
+} vc_bitw_t;
+
+static inline void bitw_put(vc_bitw_t *w, uint32_t v, uint32_t nbits)   /* nbits <= 24 */
+{
+    w->acc = (w->acc << nbits) | (v & ((1u << nbits) - 1u));
+    w->nacc += nbits;
+    while (w->nacc >= 8u) {
+        w->nacc -= 8u;
+        w->buf[w->pos++] = (uint8_t)(w->acc >> w->nacc);
+    }
+}
+
+static inline void bitw_put_unary(vc_bitw_t *w, uint32_t q)
+{
+    while (q >= 24u) { bitw_put(w, 0, 24); q -= 24u; }
+    bitw_put(w, 1, q + 1u);
+}
+
+static inline uint32_t bitw_flush(vc_bitw_t *w)
+{
+    if (w->nacc) bitw_put(w, 0, 8u - w->nacc);
+    return w->pos;
+}
+
+typedef struct {
+    const uint8_t *buf;
+    uint32_t  len;
+    uint32_t  pos;
+    uint32_t  acc;
+    uint32_t  nacc;
+    int       err;
+} vc_bitr_t;
+
+static inline uint32_t bitr_get(vc_bitr_t *r, uint32_t nbits)           /* nbits <= 24 */
+{
+    while (r->nacc < nbits) {
+        if (r->pos >= r->len) { r->err = 1; return 0; }
+        r->acc = (r->acc << 8) | r->buf[r->pos++];
+        r->nacc += 8u;
+    }
+    r->nacc -= nbits;
+    return (r->acc >> r->nacc) & ((1u << nbits) - 1u);
+}
+
+static inline uint32_t bitr_get_unary(vc_bitr_t *r)
+{
+    uint32_t q = 0;
+    while (!r->err && bitr_get(r, 1) == 0) {
+        if (++q > (1u << 20)) { r->err = 1; break; }  /* śmieci zamiast Rice'a */
+    }
+    return q;
+}
+
+/* ========== Pomocnicze ========== */
+static inline uint32_t zigzag(int32_t v)   { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+static inline int32_t  unzigzag(uint32_t u) { return (int32_t)(u >> 1) ^ -(int32_t)(u & 1u); }
+static inline uint32_t bitlen(uint32_t v)  { return v ? 32u - __CLZ(v) : 0u; }
+
+static inline uint16_t lpc_partitions(uint16_t n, uint8_t order)
+{
+    return (n % VC_LPC_PARTITIONS == 0 && n / VC_LPC_PARTITIONS > order) ? VC_LPC_PARTITIONS : 1;
+}
+
+/* Najlepszy parametr Rice'a dla partycji; zwraca koszt w bitach (z nagłówkiem partycji). */
+static uint32_t rice_best(const int32_t *res, uint16_t cnt, uint32_t *k_out)
+{
+    uint32_t sum = 0, umax = 0;
+    for (uint16_t i = 0; i < cnt; i++) {
+        uint32_t u = zigzag(res[i]);
+        sum += u;
+        if (u > umax) umax = u;
+    }
+
+    /* escape: surowe w-bitowe wartości */
+    uint32_t w = bitlen(umax);
+    if (w == 0) w = 1;
+    uint32_t best_bits = 10u + (uint32_t)cnt * w;
+    uint32_t best_k = VC_LPC_RICE_ESCAPE;
+
+    uint32_t mean = cnt ? sum / cnt : 0;
+    int32_t k0 = (int32_t)bitlen(mean) - 1;
+    for (int32_t k = k0 - 1; k <= k0 + 1; k++) {
+        if (k < 0 || k >= (int32_t)VC_LPC_RICE_ESCAPE || k > 24) continue;
+        uint32_t bits = 5u + (uint32_t)cnt * (uint32_t)(k + 1);
+        for (uint16_t i = 0; i < cnt; i++) bits += zigzag(res[i]) >> k;
+        if (bits < best_bits) { best_bits = bits; best_k = (uint32_t)k; }
+    }
+    if (k_out) *k_out = best_k;
+    return best_bits;
+}
+
+static uint32_t residual_bits(const int32_t *res, uint16_t n, uint8_t order)
+{
+    uint16_t parts = lpc_partitions(n, order);
+    uint16_t psize = n / parts;
+    uint32_t bits = 0;
+    for (uint16_t p = 0; p < parts; p++) {
+        uint16_t start = (p == 0) ? order : (uint16_t)(p * psize);
+        uint16_t end   = (p == parts - 1) ? n : (uint16_t)((p + 1) * psize);
+        bits += rice_best(&res[start], (uint16_t)(end - start), NULL);
+    }
+    return bits;
+}
+
+static void residual_write(vc_bitw_t *w, const int32_t *res, uint16_t n, uint8_t order)
+{
+    uint16_t parts = lpc_partitions(n, order);
+    uint16_t psize = n / parts;
+    for (uint16_t p = 0; p < parts; p++) {
+        uint16_t start = (p == 0) ? order : (uint16_t)(p * psize);
+        uint16_t end   = (p == parts - 1) ? n : (uint16_t)((p + 1) * psize);
+        uint32_t k;
+        rice_best(&res[start], (uint16_t)(end - start), &k);
+        bitw_put(w, k, 5);
+        if (k == VC_LPC_RICE_ESCAPE) {
+            uint32_t umax = 0;
+            for (uint16_t i = start; i < end; i++) {
+                uint32_t u = zigzag(res[i]);
+                if (u > umax) umax = u;
+            }
+            uint32_t width = bitlen(umax);
+            if (width == 0) width = 1;
+            bitw_put(w, width, 5);
+            for (uint16_t i = start; i < end; i++) bitw_put(w, zigzag(res[i]), width);
+        } else {
+            for (uint16_t i = start; i < end; i++) {
+                uint32_t u = zigzag(res[i]);
+                bitw_put_unary(w, u >> k);
+                if (k) bitw_put(w, u, k);
+            }
+        }
+    }
+}
+
+static int residual_read(vc_bitr_t *r, int32_t *res, uint16_t n, uint8_t order)
+{
+    uint16_t parts = lpc_partitions(n, order);
+    uint16_t psize = n / parts;
+    for (uint16_t p = 0; p < parts; p++) {
+        uint16_t start = (p == 0) ? order : (uint16_t)(p * psize);
+        uint16_t end   = (p == parts - 1) ? n : (uint16_t)((p + 1) * psize);
+        uint32_t k = bitr_get(r, 5);
+        if (k == VC_LPC_RICE_ESCAPE) {
+            uint32_t width = bitr_get(r, 5);
+            if (width == 0 || width > 24) return -1;
+            for (uint16_t i = start; i < end; i++) res[i] = unzigzag(bitr_get(r, width));
+        } else {
+            if (k > 24) return -1;
+            for (uint16_t i = start; i < end; i++) {
+                uint32_t q = bitr_get_unary(r);
+                uint32_t u = (q << k) | (k ? bitr_get(r, k) : 0u);
+                res[i] = unzigzag(u);
+            }
+        }
+        if (r->err) return -1;
+    }
+    return 0;
+}
+
+/* ========== Predyktory ========== */
+static void fixed_residual(const int16_t *x, uint16_t n, uint8_t order, int32_t *res)
+{
+    for (uint16_t i = order; i < n; i++) {
+        int32_t e;
+        switch (order) {
+        case 0:  e = x[i]; break;
+        case 1:  e = x[i] - x[i-1]; break;
+        case 2:  e = x[i] - 2*x[i-1] + x[i-2]; break;
+        default: e = x[i] - 3*x[i-1] + 3*x[i-2] - x[i-3]; break;
+        }
+        res[i] = e;
+    }
+}
+
+static inline int64_t lpc_predict(const int16_t *qc, uint8_t order, const int32_t *hist)
+{
+    /* hist wskazuje na x[i-1], historia rośnie w dół */
+    int64_t acc = 0;
+    for (uint8_t j = 0; j < order; j++) acc += (int64_t)qc[j] * hist[-(int32_t)j];
+    return acc;
+}
+
+/* Zwraca -1, gdy residuum nie mieści się w 20 bitach (niestabilny predyktor). */
+static int lpc_residual(const int16_t *x, uint16_t n, const int16_t *qc, uint8_t order,
+                        uint8_t shift, int32_t *res)
+{
+    for (uint16_t i = order; i < n; i++) {
+        int64_t acc = 0;
+        for (uint8_t j = 0; j < order; j++) acc += (int64_t)qc[j] * x[i - 1 - j];
+        int64_t e = (int64_t)x[i] - (acc >> shift);
+        if (e > (1 << 20) || e < -(1 << 20)) return -1;
+        res[i] = (int32_t)e;
+    }
+    return 0;
+}
+
+/* Okno Welcha dla autokorelacji - liczone raz dla danej długości ramki */
+static void lpc_window_init(uint16_t n)
+{
+    if (lpc_win_len == n) return;
+    float32_t half = 0.5f * (float32_t)(n - 1);
+    float32_t den  = 0.5f * (float32_t)(n + 1);
+    for (uint16_t i = 0; i < n; i++) {
+        float32_t t = ((float32_t)i - half) / den;
+        lpc_win[i] = 1.0f - t * t;
+    }
+    lpc_win_len = n;
+}
+
+/* Kwantyzacja współczynników do int16; zwraca shift lub -1 gdy się nie da. */
+static int lpc_quantize(const float32_t *a, uint8_t order, int16_t *qc)
+{
+    float32_t amax = 0.0f;
+    for (uint8_t j = 0; j < order; j++) {
+        float32_t v = fabsf(a[j]);
+        if (v != v) return -1;                                /* NaN */
+        if (v > amax) amax = v;
+    }
+    int shift = VC_LPC_MAX_SHIFT;
+    while (shift > 0 && amax * (float32_t)(1 << shift) >= 32767.0f) shift--;
+    if (amax * (float32_t)(1 << shift) >= 32767.0f) return -1;
+
+    for (uint8_t j = 0; j < order; j++) {
+        qc[j] = (int16_t)lrintf(a[j] * (float32_t)(1 << shift));
+    }
+    return shift;
+}
+
+/* ========== Koder ========== */
+uint16_t vc_lpc_encode_frame(const int16_t *pcm, uint16_t n, uint8_t *out)
+{
+    if (!pcm || !out || n == 0 || n > VC_FRAME_SAMPLES) return 0;
+
+    int32_t *best_res = lpc_res[0];
+    int32_t *try_res  = lpc_res[1];
+
+    /* --- predyktory stałe 0..3 --- */
+    uint8_t  best_type  = VC_LPC_T_FIXED;
+    uint8_t  best_order = 0;
+    uint8_t  best_shift = 0;
+    int16_t  best_qc[VC_LPC_MAX_ORDER];
+    uint32_t best_bits  = 0xFFFFFFFFu;
+
+    for (uint8_t order = 0; order <= 3 && order < n; order++) {
+        fixed_residual(pcm, n, order, try_res);
+        uint32_t bits = 8u + 16u * order + residual_bits(try_res, n, order);
+        if (bits < best_bits) {
+            best_bits = bits; best_order = order;
+            int32_t *t = best_res; best_res = try_res; try_res = t;
+        }
+    }
+
+    /* --- LPC: autokorelacja okienkowanego sygnału + Levinson-Durbin --- */
+    lpc_window_init(n);
+    for (uint16_t i = 0; i < n; i++) lpc_xw[i] = (float32_t)pcm[i] * lpc_win[i];
+
+    float32_t phi[VC_LPC_MAX_ORDER + 1];
+    for (uint8_t lag = 0; lag <= VC_LPC_MAX_ORDER; lag++) {
+        if (lag < n) arm_dot_prod_f32(lpc_xw, &lpc_xw[lag], (uint32_t)(n - lag), &phi[lag]);
+        else         phi[lag] = 0.0f;
+    }
+
+    if (phi[0] > 0.0f) {
+        phi[0] *= 1.0f + 1e-5f;                                /* stabilizacja (biały szum -100 dB) */
+        for (uint8_t oi = 0; oi < sizeof(VC_LPC_ORDERS); oi++) {
+            uint8_t order = VC_LPC_ORDERS[oi];
+            if (order >= n) break;
+
+            float32_t a[VC_LPC_MAX_ORDER];
+            float32_t err;
+            int16_t   qc[VC_LPC_MAX_ORDER];
+            arm_levinson_durbin_f32(phi, a, &err, order);
+            int shift = lpc_quantize(a, order, qc);
+            if (shift < 0) continue;
+
+            if (lpc_residual(pcm, n, qc, order, (uint8_t)shift, try_res) != 0) continue;
+            uint32_t bits = 16u + 32u * order + residual_bits(try_res, n, order);
+            if (bits < best_bits) {
+                best_bits = bits; best_order = order; best_type = VC_LPC_T_LPC;
+                best_shift = (uint8_t)shift;
+                memcpy(best_qc, qc, sizeof(int16_t) * order);
+                int32_t *t = best_res; best_res = try_res; try_res = t;
+            }
+        }
+    }
+
+    /* --- verbatim, jeśli kompresja nic nie daje --- */
+    if (best_bits + 7u >= 8u + 16u * (uint32_t)n) {
+        out[0] = (uint8_t)(VC_LPC_T_VERBATIM << 6);
+        for (uint16_t i = 0; i < n; i++) {
+            out[1 + 2*i]     = (uint8_t)((uint16_t)pcm[i] & 0xFF);
+            out[1 + 2*i + 1] = (uint8_t)((uint16_t)pcm[i] >> 8);
+        }
+        return (uint16_t)(1u + 2u * n);
+    }
+
+    vc_bitw_t w = { out, 0, 0, 0 };
+    bitw_put(&w, ((uint32_t)best_type << 6) | best_order, 8);
+    if (best_type == VC_LPC_T_LPC) {
+        bitw_put(&w, (uint32_t)best_shift << 4, 8);
+        for (uint8_t j = 0; j < best_order; j++) bitw_put(&w, (uint16_t)best_qc[j], 16);
+    }
+    for (uint8_t j = 0; j < best_order; j++) bitw_put(&w, (uint16_t)pcm[j], 16);
+    residual_write(&w, best_res, n, best_order);
+
+    return (uint16_t)bitw_flush(&w);
+}
+
+/* ========== Dekoder ========== */
+uint16_t vc_lpc_decode_frame(const uint8_t *in, uint16_t in_len, uint16_t n, int16_t *pcm)
+{
+    if (!in || !pcm || in_len == 0 || n == 0 || n > VC_FRAME_SAMPLES) return 0;
+
+    uint8_t type  = in[0] >> 6;
+    uint8_t order = in[0] & 0x3F;
+
+    if (type == VC_LPC_T_VERBATIM) {
+        if (in_len < 1u + 2u * n) return 0;
+        for (uint16_t i = 0; i < n; i++) {
+            pcm[i] = (int16_t)((uint16_t)in[1 + 2*i] | ((uint16_t)in[1 + 2*i + 1] << 8));
+        }
+        return n;
+    }
+    if (order >= n
+        || (type == VC_LPC_T_FIXED && order > 3)
+        || (type == VC_LPC_T_LPC && (order == 0 || order > VC_LPC_MAX_ORDER))
+        || type > VC_LPC_T_LPC) {
+        return 0;
+    }
+
+    vc_bitr_t r = { in, in_len, 1, 0, 0, 0 };
+    uint8_t shift = 0;
+    int16_t qc[VC_LPC_MAX_ORDER];
+    if (type == VC_LPC_T_LPC) {
+        shift = (uint8_t)(bitr_get(&r, 8) >> 4);
+        if (shift > VC_LPC_MAX_SHIFT) return 0;
+        for (uint8_t j = 0; j < order; j++) qc[j] = (int16_t)bitr_get(&r, 16);
+    }
+
+    int32_t *x = lpc_dec_x;   /* rekonstrukcja w int32 (kontrola zakresu) */
+    for (uint8_t j = 0; j < order; j++) x[j] = (int16_t)bitr_get(&r, 16);
+    if (r.err) return 0;
+
+    if (residual_read(&r, x, n, order) != 0) return 0;
+
+    /* x[i] zawiera residuum -> rekonstrukcja w miejscu */
+    for (uint16_t i = order; i < n; i++) {
+        int32_t v;
+        if (type == VC_LPC_T_LPC) {
+            v = x[i] + (int32_t)(lpc_predict(qc, order, &x[i - 1]) >> shift);
+        } else {
+            switch (order) {
+            case 0:  v = x[i]; break;
+            case 1:  v = x[i] + x[i-1]; break;
+            case 2:  v = x[i] + 2*x[i-1] - x[i-2]; break;
+            default: v = x[i] + 3*x[i-1] - 3*x[i-2] + x[i-3]; break;
+            }
+        }
+        if (v > 32767 || v < -32768) return 0;                /* uszkodzona ramka */
+        x[i] = v;
+    }
+    for (uint16_t i = 0; i < n; i++) pcm[i] = (int16_t)x[i];
+    return n;
+}
+
+/* ========== Metadane ========== */
+void vc_meta_lpc_make(vc_stream_meta_t *m)
+{
+   if (!m) return;
+   m->codec_id          = VC_CODEC_LPC_RICE;
+   m->sample_rate_hz    = VC_FS_HZ;
+   m->channels          = 1;
+   m->bits_per_sample   = 16;                            /* bezstratnie: PCM16 po dekodowaniu */
+   m->samples_per_block = VC_FRAME_SAMPLES;
+   m->block_align       = 0;                             /* bloki o zmiennej długości */
+   m->avg_bytes_per_sec = 0;                             /* zależy od sygnału */
+   m->codec_opts        = 0;
+}
@@ -0,0 +1,129 @@
+#include "voicecmd/vc_plc.h"
+#include "arm_math.h"
+#include <string.h>
+
+void vc_plc_init(vc_plc_t *p)
+{
+    if (!p) return;
+    memset(p, 0, sizeof(*p));
+    p->pitch = VC_PLC_PITCH_MAX;
+}
+
+/* Znormalizowana autokorelacja końcówki historii (okno VC_PLC_CORR_WINDOW)
+ * z jej przesuniętą kopią. Najpierw co druga zwłoka, potem doprecyzowanie ±1. */
+static float32_t vc_plc_corr_score(const int16_t *hist, uint16_t lag)
+{
+    const int16_t *x = hist + VC_PLC_HIST_SAMPLES - VC_PLC_CORR_WINDOW;
+    const int16_t *y = x - lag;
+    q63_t corr, energy;
+
+    arm_dot_prod_q15((q15_t *)x, (q15_t *)y, VC_PLC_CORR_WINDOW, &corr);
+    if (corr <= 0) return 0.0f;
+    arm_dot_prod_q15((q15_t *)y, (q15_t *)y, VC_PLC_CORR_WINDOW, &energy);
+    if (energy <= 0) return 0.0f;
+
+    float32_t c = (float32_t)corr;
+    return c * c / (float32_t)energy;
+}
+
+uint16_t vc_plc_estimate_pitch(const int16_t *hist)
+{
+    uint16_t best_lag = VC_PLC_PITCH_MAX;
+    float32_t best = 0.0f;
+
+    for (uint16_t lag = VC_PLC_PITCH_MIN; lag <= VC_PLC_PITCH_MAX; lag += 2u) {
+        float32_t s = vc_plc_corr_score(hist, lag);
+        if (s > best) { best = s; best_lag = lag; }
+    }
+    if (best <= 0.0f) return VC_PLC_PITCH_MAX;   /* bez korelacji (szum/cisza): najdłuższy okres */
+
+    uint16_t coarse = best_lag;
+    for (int16_t d = -1; d <= 1; d += 2) {
+        uint16_t lag = (uint16_t)(coarse + d);
+        if (lag < VC_PLC_PITCH_MIN || lag > VC_PLC_PITCH_MAX) continue;
+        float32_t s = vc_plc_corr_score(hist, lag);
+        if (s > best) { best = s; best_lag = lag; }
+    }
+    return best_lag;
+}
+
+/* Okres = ostatnie `pitch` próbek historii. Jego końcówkę (1/4 okresu) przenikamy
+ * w próbki poprzedzające okres, żeby zawinięcie period[P-1] -> period[0] było ciągłe. */
+static void vc_plc_build_period(vc_plc_t *p)
+{
+    const uint16_t P = p->pitch;
+    const int16_t *src = p->hist + VC_PLC_HIST_SAMPLES - P;
+    uint16_t L = P / 4u;
+    if (L > VC_PLC_OLA_MAX) L = VC_PLC_OLA_MAX;
+
+    memcpy(p->period, src, (size_t)P * sizeof(int16_t));
+    for (uint16_t j = 0; j < L; j++) {
+        int32_t w   = (int32_t)(((j + 1u) << 15) / (L + 1u));    /* Q15, 0 -> 1 */
+        int32_t cur = src[P - L + j];
+        int32_t pre = src[(int32_t)j - (int32_t)L];             /* próbki przed okresem */
+        p->period[P - L + j] = (int16_t)(cur + (((pre - cur) * w) >> 15));
+    }
+    p->phase = 0;
+}
+
+/* Wzmocnienie Q15 dla k-tej ukrytej próbki serii. */
+static inline int32_t vc_plc_gain_q15(uint32_t k)
+{
+    if (k < VC_PLC_HOLD_SAMPLES) return 32768;
+    k -= VC_PLC_HOLD_SAMPLES;
+    if (k >= VC_PLC_FADE_SAMPLES) return 0;
+    return (int32_t)(((VC_PLC_FADE_SAMPLES - k) << 15) / VC_PLC_FADE_SAMPLES);
+}
+
+/* Następne n próbek sygnału zastępczego (powtarzany okres * wygaszanie). */
+static void vc_plc_synth(vc_plc_t *p, int16_t *out, uint16_t n)
+{
+    for (uint16_t i = 0; i < n; i++) {
+        int32_t g = vc_plc_gain_q15(p->lost_samples++);
+        out[i] = (int16_t)(((int32_t)p->period[p->phase] * g) >> 15);
+        if (++p->phase >= p->pitch) p->phase = 0;
+    }
+}
+
+static void vc_plc_push_hist(vc_plc_t *p, const int16_t *pcm, uint16_t n)
+{
+    if (n >= VC_PLC_HIST_SAMPLES) {
+        memcpy(p->hist, pcm + n - VC_PLC_HIST_SAMPLES, sizeof(p->hist));
+        return;
+    }
+    memmove(p->hist, p->hist + n, (VC_PLC_HIST_SAMPLES - n) * sizeof(int16_t));
+    memcpy(p->hist + VC_PLC_HIST_SAMPLES - n, pcm, (size_t)n * sizeof(int16_t));
+}
+
+void vc_plc_conceal(vc_plc_t *p, int16_t *pcm, uint16_t n)
+{
+    if (!p || !pcm) return;
+
+    if (p->lost_samples == 0u) {
+        p->pitch = vc_plc_estimate_pitch(p->hist);
+        vc_plc_build_period(p);
+    }
+    vc_plc_synth(p, pcm, n);
+    p->concealed_frames++;
+
+    /* Historia dostaje sygnał zastępczy - przy kolejnej serii estymacja startuje z niego. */
+    vc_plc_push_hist(p, pcm, n);
+}
+
+void vc_plc_good(vc_plc_t *p, int16_t *pcm, uint16_t n)
+{
+    if (!p || !pcm) return;
+
+    if (p->lost_samples != 0u) {
+        int16_t synth[VC_PLC_RECOVER_SAMPLES];
+        uint16_t r = (n < VC_PLC_RECOVER_SAMPLES) ? n : VC_PLC_RECOVER_SAMPLES;
+        vc_plc_synth(p, synth, r);
+        for (uint16_t i = 0; i < r; i++) {
+            int32_t w = (int32_t)(((i + 1u) << 15) / (r + 1u));  /* Q15, udział ramki dobrej */
+            int32_t s = synth[i];
+            pcm[i] = (int16_t)(s + ((((int32_t)pcm[i] - s) * w) >> 15));
+        }
+        p->lost_samples = 0;
+    }
+    vc_plc_push_hist(p, pcm, n);
+}
@@ -0,0 +1,112 @@
+#include "voicecmd/vc_ringbuf.h"
+#include <stddef.h>
+
+#ifdef VC_HOST_BUILD
+#define VC_SPSC_BARRIER()  __sync_synchronize()
+#else
+#include "stm32f4xx.h"
+#define VC_SPSC_BARRIER()  __DMB()
+#endif
+
+#define VC_SPSC_MASK(q)    ((q)->capacity - 1u)
+
+vc_status_t vc_spsc_init(vc_spsc_fifo_t *q, void **slots, uint32_t capacity)
+{
+    if (!q || !slots || capacity < 2u || (capacity & (capacity - 1u))) return VC_E_PARAM;
+    q->slots     = slots;
+    q->capacity  = capacity;
+    q->write_idx = 0;
+    q->read_idx  = 0;
+    return VC_OK;
+}
+
+void vc_spsc_reset(vc_spsc_fifo_t *q)
+{
+    q->write_idx = 0;
+    q->read_idx  = 0;
+    VC_SPSC_BARRIER();
+}
+
+uint32_t vc_spsc_count(const vc_spsc_fifo_t *q)
+{
+    return q->write_idx - q->read_idx;
+}
+
+uint32_t vc_spsc_space(const vc_spsc_fifo_t *q)
+{
+    return q->capacity - (q->write_idx - q->read_idx);
+}
+
+/* --- producent --- */
+
+uint32_t vc_spsc_write_span(vc_spsc_fifo_t *q, void ***span)
+{
+    uint32_t w = q->write_idx;
+    uint32_t room = q->capacity - (w - q->read_idx);
+    VC_SPSC_BARRIER();            /* read_idx przed zapisem slotów: konsument skończył je czytać */
+
+    uint32_t at = w & VC_SPSC_MASK(q);
+    uint32_t run = q->capacity - at;
+    *span = &q->slots[at];
+    return (room < run) ? room : run;
+}
+
+void vc_spsc_write_commit(vc_spsc_fifo_t *q, uint32_t n)
+{
+    VC_SPSC_BARRIER();            /* sloty widoczne przed nowym write_idx */
+    q->write_idx = q->write_idx + n;
+}
+
+vc_status_t vc_spsc_push(vc_spsc_fifo_t *q, void *item)
+{
+    return vc_spsc_push_n(q, &item, 1u) ? VC_OK : VC_E_FULL;
+}
+
+uint32_t vc_spsc_push_n(vc_spsc_fifo_t *q, void *const *items, uint32_t n)
+{
+    uint32_t w = q->write_idx;
+    uint32_t room = q->capacity - (w - q->read_idx);
+    VC_SPSC_BARRIER();
+
+    if (n > room) n = room;
+    for (uint32_t i = 0; i < n; i++) q->slots[(w + i) & VC_SPSC_MASK(q)] = items[i];
+    if (n) vc_spsc_write_commit(q, n);
+    return n;
+}
+
+/* --- konsument --- */
+
+uint32_t vc_spsc_read_span(vc_spsc_fifo_t *q, void ***span)
+{
+    uint32_t r = q->read_idx;
+    uint32_t used = q->write_idx - r;
+    VC_SPSC_BARRIER();            /* write_idx przed odczytem slotów */
+
+    uint32_t at = r & VC_SPSC_MASK(q);
+    uint32_t run = q->capacity - at;
+    *span = &q->slots[at];
+    return (used < run) ? used : run;
+}
+
+void vc_spsc_read_release(vc_spsc_fifo_t *q, uint32_t n)
+{
+    VC_SPSC_BARRIER();            /* odczyt slotów zakończony przed zwolnieniem */
+    q->read_idx = q->read_idx + n;
+}
+
+vc_status_t vc_spsc_pop(vc_spsc_fifo_t *q, void **item)
+{
+    return vc_spsc_pop_n(q, item, 1u) ? VC_OK : VC_E_EMPTY;
+}
+
+uint32_t vc_spsc_pop_n(vc_spsc_fifo_t *q, void **items, uint32_t n)
+{
+    uint32_t r = q->read_idx;
+    uint32_t used = q->write_idx - r;
+    VC_SPSC_BARRIER();
+
+    if (n > used) n = used;
+    for (uint32_t i = 0; i < n; i++) items[i] = q->slots[(r + i) & VC_SPSC_MASK(q)];
+    if (n) vc_spsc_read_release(q, n);
+    return n;
+}
@@ -1,6 +1,8 @@
 #include "voicecmd/vc_encoders.h"
 #include "voicecmd/vc_decoders.h"
 #include "voicecmd/vc_filters.h"
+#include "voicecmd/vc_codec.h"
+#include <string.h>
 
 uint16_t vc_ima_block_bytes_mono(uint16_t spb)
 {
@@ -9,54 +11,76 @@ uint16_t vc_ima_block_bytes_mono(uint16_t spb)
     return (uint16_t)(4u + bytes_nibbles);
 }
 
-
-void compress_data(vc_pcm_meta_t *frm, float32_t *samples, vc_enc_cfg_t *cfg)
+/* Mono: jak vc_ima_block_bytes_mono. Wielokanałowo (MS-IMA): 4B nagłówka na kanał
+ * + ceil((spb-1)/8) słów 4-bajtowych na kanał. */
+uint16_t vc_ima_block_bytes(uint16_t spb, uint16_t channels)
 {
-vc_stream_meta_t *m;
-int16_t  to_file_raw[VC_MAX_FRAME_SAMPLES];
-vc_convert_float32_to_int16(samples, to_file_raw, frm->len_samples);
-if (!frm || !cfg) return;
-
-
-    switch (cfg->codec) {
-    case VC_CODEC_PCM16:
-        vc_meta_pcm16_make(m);
-        // TODO: save to file (data 'to_file_raw' with block size 640B, Metadata 'm')
-        break;
-
-    case VC_CODEC_IMA_ADPCM:
-        vc_ima_state_t  ima_state = {0};
-        uint8_t  adpcm[VC_IMA_MONO_BYTES_PER_FRAME];
-        uint16_t wrote = vc_ima_encode_block_mono(to_file_raw, frm->len_samples, adpcm, &ima_state);
-        vc_meta_ima_adpcm_make(m);
-        /* got == 320; pcm_out to zdekodowany PCM16 (rekonstrukcja ADPCM) */
-
-        // TODO: save to file dla wojtka
-        
-        // TODO: Moje pierdoly
-        // int16_t pcm_out[320];
-        // uint16_t got = vc_ima_decode_block_mono(adpcm, 320, pcm_out);
-        break;
-
-    case VC_CODEC_G722:
-        // -------------------------ALLLLERTT 
-        // BEFORE USING 'g722_encode_20ms_64k' USE somewhere 'g722_init_64k_enc();' and after coding 'g722_deinit_enc();'
-        //---------------------------------
-        g722_init_64k_enc(); // maybe somewhere else
-        uint8_t payload[VC_G722_BYTES_PER_FRAME];                // 64 kb/s → 160 B / 20 ms
-        int wrote_g722 = g722_encode_20ms_64k(to_file_raw, payload); // wrote_g722 == 0 SUCCESS?
-        g722_deinit_enc(); // maybe somewhere else
+    if (channels <= 1u) return vc_ima_block_bytes_mono(spb);
+    uint32_t nibbles = (spb > 0) ? (uint32_t)(spb - 1u) : 0u;
+    uint32_t words = (nibbles + 7u) / 8u;
+    return (uint16_t)(channels * (4u + 4u * words));
+}
 
-        // TODO: save to file dla wojtka
 
+/* Koduje jedną ramkę float32 (po HPF/AGC) otwartym kodekiem (vc_codec_open(..., VC_CODEC_DIR_ENC)).
+ * out musi mieć >= vc_codec_max_bytes_per_frame(codec) bajtów.
+ * Zwraca liczbę bajtów ramki (0 przy błędzie). Metadane strumienia: vc_codec_meta(). */
+uint16_t compress_data(struct vc_codec *codec, vc_pcm_meta_t *frm, float32_t *samples, uint8_t *out)
+{
+    if (!codec || !frm || !samples || !out) return 0;
+    if (frm->len_samples != codec->frame_samples) return 0;
+    if (vc_frame_channels(frm) != codec->channels) return 0;
+
+    static int16_t to_file_raw[VC_MAX_FRAME_SAMPLES * VC_MAX_CHANNELS];
+    vc_convert_float32_to_int16(samples, to_file_raw, (uint32_t)frm->len_samples * codec->channels);
+
+    uint32_t wrote = 0;
+    if (vc_codec_encode_frames(codec, to_file_raw, 1, out, vc_codec_max_bytes_per_frame(codec),
+                               NULL, &wrote) != VC_OK) {
+        return 0;
+    }
+    return (uint16_t)wrote;
+}
 
-        // TODO: Moje pierdoly
-        // int16_t pcm_out_g722[320];
-        // int kox = g722_decode_20ms_64k(payload, pcm_out_g722);
-        // kox = 5;
-        // if (wrote_g722 != VC_G722_BYTES_PER_FRAME) break; 
-        break;
-    }  
+/* Koduje n_frames kolejnych ramek float32 (frm->len_samples próbek na kanał, przeplatane) - np. transkodowanie
+ * offline albo nadrabianie zaległości po przestoju USB. Konwersja float->int16 idzie porcjami
+ * po VC_BATCH_MAX_FRAMES ramek, każda porcja jednym vc_codec_encode_frames().
+ * offsets (opcjonalnie) dostaje n_frames + 1 pozycji. Zwraca łączną liczbę bajtów (0 przy błędzie). */
+uint32_t compress_frames(struct vc_codec *codec, vc_pcm_meta_t *frm, const float32_t *samples, uint16_t n_frames,
+                         uint8_t *out, uint32_t out_cap, uint32_t *offsets)
+{
+    static int16_t batch_raw[VC_BATCH_MAX_FRAMES * VC_MAX_FRAME_SAMPLES];
+
+    if (!codec || !frm || !samples || !out) return 0;
+    if (frm->len_samples != codec->frame_samples) return 0;
+    if (vc_frame_channels(frm) != codec->channels) return 0;
+
+    /* stereo: ramka zajmuje 2x tyle próbek - porcja mieści o połowę mniej ramek */
+    const uint32_t stride = (uint32_t)frm->len_samples * codec->channels;
+    const uint16_t max_chunk = (uint16_t)(VC_BATCH_MAX_FRAMES / codec->channels);
+
+    uint32_t pos = 0;
+    for (uint16_t f = 0; f < n_frames; ) {
+        uint16_t chunk = (uint16_t)(n_frames - f);
+        if (chunk > max_chunk) chunk = max_chunk;
+
+        vc_convert_float32_to_int16(samples + (uint32_t)f * stride, batch_raw, (uint32_t)chunk * stride);
+
+        uint32_t wrote = 0;
+        uint32_t *chunk_offsets = offsets ? offsets + f : NULL;
+        if (vc_codec_encode_frames(codec, batch_raw, chunk, out + pos, out_cap - pos,
+                                   chunk_offsets, &wrote) != VC_OK) {
+            return 0;
+        }
+        /* offsety porcji są względne - przesuń o to, co już zapisane */
+        if (chunk_offsets) {
+            for (uint16_t i = 0; i <= chunk; i++) chunk_offsets[i] += pos;
+        }
+        pos += wrote;
+        f = (uint16_t)(f + chunk);
+    }
+    if (offsets && n_frames == 0) offsets[0] = 0;
+    return pos;
 }
 
 /* Metadane dla PCM16 (np. 16 kHz, mono). */
@@ -70,22 +94,58 @@ void vc_meta_pcm16_make(vc_stream_meta_t *m)
    m->block_align       = (uint16_t)(m->channels * 2u);         /* 2 dla mono 16-bit */
    m->avg_bytes_per_sec = m->sample_rate_hz * m->block_align;   /* np. 32000 */
    m->samples_per_block = 0;                                 /* nie dotyczy */
-   m->reserved          = 0;
+   m->codec_opts        = 0;
+}
+
+
+/* Bity na słowo kodowe G.722 (jedno słowo = 2 próbki 16 kHz). */
+uint8_t vc_g722_bits_per_code(uint32_t bitrate_bps)
+{
+   if (bitrate_bps == 48000u) return 6;
+   if (bitrate_bps == 56000u) return 7;
+   return 8;
 }
 
+/* Bajty jednej ramki frame_samples próbek. Bez pakowania: bajt na słowo (także 56/48k,
+ * wtedy górne bity są puste). Z pakowaniem: (frame_samples/2) * bits / 8, zaokrąglone w górę. */
+uint16_t vc_g722_frame_bytes(uint32_t bitrate_bps, uint8_t packed, uint16_t frame_samples)
+{
+   uint32_t codes = frame_samples / 2u;
+   uint8_t  bits  = vc_g722_bits_per_code(bitrate_bps);
+   if (!packed || bits == 8) return (uint16_t)codes;
+   return (uint16_t)((codes * bits + 7u) / 8u);
+}
 
-// void vc_meta_g722_make(vc_stream_meta_t *m)
-// {
-//    if (!m) return;
-//    m->codec_id          = VC_CODEC_G722;
-//    m->sample_rate_hz    = VC_FS_HZ;
-//    m->channels          = 1;
-//    m->bits_per_sample   = 16;                                /* PCM16 */
-//    m->block_align       = (uint16_t)(m->channels * 2u);         /* 2 dla mono 16-bit */
-//    m->avg_bytes_per_sec = m->sample_rate_hz * m->block_align;   /* np. 32000 */
-//    m->samples_per_block = 0;                                 /* nie dotyczy */
-//    m->reserved          = 0;
-// }
+/* Metadane dla G.722 (WAV fmt=0x65). Tryb kodeka (bity/słowo, pakowanie) w codec_opts;
+ * ramka upakowana jest najmniejszą samodzielną jednostką -> block_align = bajty ramki. */
+void vc_meta_g722_mode_make(vc_stream_meta_t *m, uint32_t bitrate_bps, uint8_t packed, uint16_t frame_samples)
+{
+   if (!m) return;
+   uint8_t bits = vc_g722_bits_per_code(bitrate_bps);
+   if (bits == 8) packed = 0;                                /* 64 kb/s nie ma czego pakować */
+   if (frame_samples == 0) frame_samples = VC_FRAME_SAMPLES;
+
+   m->codec_id          = VC_CODEC_G722;
+   m->sample_rate_hz    = VC_FS_HZ;
+   m->channels          = 1;
+   m->bits_per_sample   = 4;                                 /* słowo kodowe na 2 próbki (nominalnie) */
+   if (packed) {
+       m->block_align       = vc_g722_frame_bytes(bitrate_bps, 1, frame_samples);
+       m->samples_per_block = frame_samples;
+       m->avg_bytes_per_sec = (uint32_t)bits * VC_FS_HZ / 16u; /* 7000 / 6000 */
+   } else {
+       m->block_align       = 1;                             /* 1 bajt = 2 próbki */
+       m->samples_per_block = 2;
+       m->avg_bytes_per_sec = VC_FS_HZ / 2u;                 /* 8000 niezależnie od trybu */
+   }
+   m->codec_opts        = (uint16_t)(bits | (packed ? VC_G722_OPT_PACKED : 0u));
+}
+
+/* Metadane dla G.722 64 kb/s (2 próbki na bajt, WAV fmt=0x65). */
+void vc_meta_g722_make(vc_stream_meta_t *m)
+{
+   vc_meta_g722_mode_make(m, 64000u, 0, VC_FRAME_SAMPLES);
+}
 
 
 /* ========== Metadane dla IMA-ADPCM (mono) ========== */
@@ -101,7 +161,7 @@ void vc_meta_ima_adpcm_make(vc_stream_meta_t *m)
    m->avg_bytes_per_sec = (m->samples_per_block > 0)
        ? (uint32_t)(((uint64_t)m->sample_rate_hz * m->block_align) / m->samples_per_block)
        : 0;
-   m->reserved          = 0;
+   m->codec_opts        = 0;
 }
 
 
@@ -110,20 +170,16 @@ void vc_meta_ima_adpcm_make(vc_stream_meta_t *m)
 
 
 /* ========== Enkodowanie jednego bloku IMA-ADPCM (mono) ========== */
-/* out_block musi mieć co najmniej vc_ima_block_bytes_mono(spb) bajtów.
-* Zwraca liczbę zapisanych bajtów (= rozmiar bloku). */
-uint16_t vc_ima_encode_block_mono(int16_t *pcm,
-                                               uint16_t spb,
-                                               uint8_t *out_block,
-                                               vc_ima_state_t *st /* może być NULL – wtedy lokalny reset */)
+/* Rdzeń kodera bloku. io to lokalna kopia stanu wywołującego (inline ->
+ * w pętli wieloblokowej predictor/index zostają w rejestrach). */
+static inline uint16_t vc_ima_encode_block_core(const int16_t *pcm, uint16_t spb,
+                                                uint8_t *out_block, vc_ima_state_t *io)
 {
-   if (!pcm || !out_block || spb == 0) return 0;
-
    /* Inicjalizacja stanu na początek bloku:
       - predictor = pierwszy sample bloku
-      - index: bierzemy z *st (ciągłość między blokami) lub 0 przy NULL */
+      - index: z poprzedniego bloku (ciągłość) */
    int16_t predictor = pcm[0];
-   uint8_t index     = (st ? st->index : 0);
+   uint8_t index     = io->index;
    if (index > 88) index = 88;
 
    /* Nagłówek bloku: predictor(int16 LE), index(uint8), reserved(uint8)=0 */
@@ -183,18 +239,253 @@ uint16_t vc_ima_encode_block_mono(int16_t *pcm,
        *dst++ = packed;
    }
 
-   /* Zapisz stan dla kolejnego bloku (ciągłość), jeśli przekazano st */
-   if (st) {
-       st->predictor = predictor; /* nie jest używany jako nagłówek kolejnego bloku,
-                                     bo kolejny blok i tak bierze predictor = pierwszy sample tamtego bloku,
-                                     ale możesz go trzymać diagnostycznie */
-       st->index = index;
+   io->predictor = predictor;
+   io->index     = index;
+   return (uint16_t)(dst - out_block);
+}
+
+/* out_block musi mieć co najmniej vc_ima_block_bytes_mono(spb) bajtów.
+* Zwraca liczbę zapisanych bajtów (= rozmiar bloku). */
+uint16_t vc_ima_encode_block_mono(int16_t *pcm,
+                                               uint16_t spb,
+                                               uint8_t *out_block,
+                                               vc_ima_state_t *st /* może być NULL – wtedy lokalny reset */)
+{
+   if (!pcm || !out_block || spb == 0) return 0;
+
+   vc_ima_state_t s = { 0, (uint8_t)(st ? st->index : 0) };
+   uint16_t len = vc_ima_encode_block_core(pcm, spb, out_block, &s);
+
+   /* Zapisz stan dla kolejnego bloku (ciągłość), jeśli przekazano st.
+      predictor jest tylko diagnostyczny - kolejny blok startuje z własnego pierwszego sampla. */
+   if (st) *st = s;
+   return len;
+}
+
+/* ========== Enkodowanie n_blocks kolejnych bloków IMA-ADPCM (mono) ========== */
+/* pcm      -> n_blocks * spb próbek
+ * out      -> out_cap bajtów (potrzeba n_blocks * vc_ima_block_bytes_mono(spb))
+ * offsets  -> (opcjonalnie) n_blocks + 1 pozycji: początek każdego bloku, ostatni = suma
+ * Zwraca łączną liczbę bajtów albo 0 przy błędzie / za małym out. */
+uint32_t vc_ima_encode_blocks_mono(const int16_t *pcm,
+                                   uint16_t spb,
+                                   uint16_t n_blocks,
+                                   uint8_t *out,
+                                   uint32_t out_cap,
+                                   uint32_t *offsets,
+                                   vc_ima_state_t *st)
+{
+   if (!pcm || !out || spb == 0) return 0;
+
+   const uint16_t block_bytes = vc_ima_block_bytes_mono(spb);
+   if ((uint32_t)block_bytes * n_blocks > out_cap) return 0;
+
+   vc_ima_state_t s = { 0, (uint8_t)(st ? st->index : 0) };
+   uint32_t pos = 0;
+   for (uint16_t b = 0; b < n_blocks; b++) {
+       if (offsets) offsets[b] = pos;
+       pos += vc_ima_encode_block_core(pcm, spb, out + pos, &s);
+       pcm += spb;
    }
+   if (offsets) offsets[n_blocks] = pos;
+
+   if (st && n_blocks) *st = s;
+   return pos;
+}
+
+
+/* ========== IMA-ADPCM z przeszukiwaniem w przód (look-ahead) ========== */
+/* Rekonstrukcja dekodera dla kodu code przy danym kroku (identycznie jak vc_ima_decode_block_mono). */
+static inline int32_t vc_ima_recon(int32_t predictor, int32_t step, uint8_t code)
+{
+   int32_t delta = step >> 3;
+   if (code & 1) delta += step >> 2;
+   if (code & 2) delta += step >> 1;
+   if (code & 4) delta += step;
+   if (code & 8) delta = -delta;
+
+   int32_t pred = predictor + delta;
+   if (pred >  32767) pred =  32767;
+   if (pred < -32768) pred = -32768;
+   return pred;
+}
 
+static inline int32_t vc_ima_next_index(int32_t index, uint8_t code)
+{
+   index += VC_IMA_INDEX_TABLE[code & 7];
+   if (index < 0) index = 0;
+   if (index > 88) index = 88;
+   return index;
+}
+
+/* branch kodów o najmniejszym błędzie rekonstrukcji próbki x (kolejność rosnąca). */
+static uint8_t vc_ima_candidates(int32_t x, int32_t predictor, int32_t index, uint8_t branch, uint8_t *codes)
+{
+   uint32_t err[16];
+   int32_t step = VC_IMA_STEP_TABLE[index];
+   for (uint8_t c = 0; c < 16; c++) {
+       int32_t e = vc_ima_recon(predictor, step, c) - x;
+       err[c] = (uint32_t)(e < 0 ? -e : e);
+   }
+   uint16_t used = 0;
+   for (uint8_t k = 0; k < branch; k++) {
+       uint8_t best = 0xFF;
+       for (uint8_t c = 0; c < 16; c++) {
+           if (used & (1u << c)) continue;
+           if (best == 0xFF || err[c] < err[best]) best = c;
+       }
+       used |= (uint16_t)(1u << best);
+       codes[k] = best;
+   }
+   return branch;
+}
+
+/* Minimalny łączny błąd kwadratowy na depth kolejnych próbkach x[0..]. */
+static uint64_t vc_ima_search_cost(const int16_t *x, uint16_t remaining, int32_t predictor, int32_t index,
+                                   uint8_t depth, uint8_t branch, uint32_t *nodes)
+{
+   uint8_t codes[16];
+   uint8_t n = vc_ima_candidates(x[0], predictor, index, branch, codes);
+   int32_t step = VC_IMA_STEP_TABLE[index];
+   uint64_t best = UINT64_MAX;
+
+   for (uint8_t k = 0; k < n; k++) {
+       int32_t pred = vc_ima_recon(predictor, step, codes[k]);
+       int32_t e = pred - x[0];
+       uint64_t cost = (uint64_t)((int64_t)e * e);
+       (*nodes)++;
+       if (depth > 1 && remaining > 1 && cost < best) {
+           cost += vc_ima_search_cost(x + 1, (uint16_t)(remaining - 1u), pred,
+                                      vc_ima_next_index(index, codes[k]), (uint8_t)(depth - 1u), branch, nodes);
+       }
+       if (cost < best) best = cost;
+   }
+   return best;
+}
+
+/* Blok IMA zgodny z vc_ima_decode_block_mono, ale każdy nibble wybierany tak, by
+ * zminimalizować błąd na search->depth próbkach w przód (search->branch najbliższych
+ * kodów na poziom). Po przekroczeniu search->node_budget reszta bloku jest kodowana
+ * zachłannie (najbliższy kod) - ogranicza czas na targecie. */
+uint16_t vc_ima_encode_block_mono_search(const int16_t *pcm,
+                                         uint16_t spb,
+                                         uint8_t *out_block,
+                                         vc_ima_state_t *st,
+                                         const vc_ima_search_t *search)
+{
+   if (!pcm || !out_block || spb == 0 || !search) return 0;
+
+   uint8_t depth  = search->depth  ? search->depth  : 1u;
+   uint8_t branch = search->branch ? search->branch : 1u;
+   if (depth > VC_IMA_SEARCH_MAX_DEPTH) depth = VC_IMA_SEARCH_MAX_DEPTH;
+   if (branch > 16u) branch = 16u;
+
+   int32_t predictor = pcm[0];
+   int32_t index     = (st ? st->index : 0);
+   if (index > 88) index = 88;
+
+   out_block[0] = (uint8_t)(predictor & 0xFF);
+   out_block[1] = (uint8_t)((uint16_t)predictor >> 8);
+   out_block[2] = (uint8_t)index;
+   out_block[3] = 0;
+
+   uint8_t *dst = out_block + 4;
+   uint8_t packed = 0;
+   int low_nibble = 1;
+   uint32_t nodes = 0;
+
+   for (uint16_t i = 1; i < spb; i++) {
+       int32_t step = VC_IMA_STEP_TABLE[index];
+       uint8_t codes[16];
+       uint8_t code;
+
+       if (depth == 1 || (search->node_budget && nodes >= search->node_budget)) {
+           vc_ima_candidates(pcm[i], predictor, index, 1, codes);
+           code = codes[0];
+       } else {
+           uint16_t remaining = (uint16_t)(spb - i);
+           uint8_t n = vc_ima_candidates(pcm[i], predictor, index, branch, codes);
+           uint64_t best = UINT64_MAX;
+           code = codes[0];
+           for (uint8_t k = 0; k < n; k++) {
+               int32_t pred = vc_ima_recon(predictor, step, codes[k]);
+               int32_t e = pred - pcm[i];
+               uint64_t cost = (uint64_t)((int64_t)e * e);
+               nodes++;
+               if (remaining > 1 && cost < best) {
+                   cost += vc_ima_search_cost(&pcm[i + 1], (uint16_t)(remaining - 1u), pred,
+                                              vc_ima_next_index(index, codes[k]), (uint8_t)(depth - 1u),
+                                              branch, &nodes);
+               }
+               if (cost < best) { best = cost; code = codes[k]; }
+           }
+       }
+
+       predictor = vc_ima_recon(predictor, step, code);
+       index     = vc_ima_next_index(index, code);
+
+       if (low_nibble) {
+           packed = code;
+           low_nibble = 0;
+       } else {
+           *dst++ = (uint8_t)(packed | (code << 4));
+           low_nibble = 1;
+       }
+   }
+   if (!low_nibble) {
+       *dst++ = packed;
+   }
+
+   if (st) {
+       st->predictor = (int16_t)predictor;
+       st->index     = (uint8_t)index;
+   }
    return (uint16_t)(dst - out_block);
 }
 
 
+/* ========== Blok IMA-ADPCM wielokanałowy (MS-IMA) ========== */
+/* pcm: spb próbek na kanał, przeplatane (L R L R ...).
+ * Układ bloku: nagłówki 4B kolejnych kanałów, potem na przemian słowa 4-bajtowe
+ * (8 nibbli, low-nibble-first) kanału 0, 1, ... Ostatnie słowo dopełnione zerami.
+ * Każdy kanał ma własny predyktor/indeks (st[channels]). search == NULL -> koder zachłanny.
+ * Zwraca liczbę bajtów bloku (vc_ima_block_bytes(spb, channels)) albo 0. */
+uint16_t vc_ima_encode_block(const int16_t *pcm,
+                             uint16_t spb,
+                             uint16_t channels,
+                             uint8_t *out_block,
+                             vc_ima_state_t *st,
+                             const vc_ima_search_t *search)
+{
+   static int16_t ch_pcm[VC_MAX_FRAME_SAMPLES];
+   static uint8_t ch_block[4u + VC_MAX_FRAME_SAMPLES / 2u + 4u];
+
+   if (!pcm || !out_block || !st || spb == 0) return 0;
+   if (channels <= 1u) {
+       return (search && search->depth > 1u)
+            ? vc_ima_encode_block_mono_search(pcm, spb, out_block, st, search)
+            : vc_ima_encode_block_mono((int16_t *)pcm, spb, out_block, st);
+   }
+   if (channels > VC_MAX_CHANNELS || spb > VC_MAX_FRAME_SAMPLES) return 0;
+
+   const uint32_t words = ((uint32_t)spb - 1u + 7u) / 8u;
+   for (uint16_t c = 0; c < channels; c++) {
+       for (uint16_t i = 0; i < spb; i++) ch_pcm[i] = pcm[(uint32_t)i * channels + c];
+
+       uint16_t len = (search && search->depth > 1u)
+                    ? vc_ima_encode_block_mono_search(ch_pcm, spb, ch_block, &st[c], search)
+                    : vc_ima_encode_block_mono(ch_pcm, spb, ch_block, &st[c]);
+       memset(ch_block + len, 0, sizeof(ch_block) - len);
+
+       memcpy(out_block + 4u * c, ch_block, 4u);
+       for (uint32_t w = 0; w < words; w++) {
+           memcpy(out_block + 4u * channels + 4u * (w * channels + c), ch_block + 4u + 4u * w, 4u);
+       }
+   }
+   return vc_ima_block_bytes(spb, channels);
+}
+
+
 void g722_init_64k_enc(void) {
     // 64 kb/s, wejście 16 kHz -> options = 0
     enc = g722_encoder_new(64000, 0);
@@ -210,3 +501,15 @@ int g722_encode_20ms_64k(const int16_t *pcm320, uint8_t *out160) {
     // zwraca liczbę bajtów; oczekuj 160
     return g722_encode(enc, pcm320, 320, out160);
 }
+
+
+/* n_frames ramek 20 ms jednym wywołaniem g722_encode (stan pasm nie wraca do
+ * pamięci między ramkami). out >= n_frames * 160 B, offsets opcjonalnie [n_frames + 1].
+ * Zwraca łączną liczbę bajtów. */
+int g722_encode_frames_64k(const int16_t *pcm, uint16_t n_frames, uint8_t *out, uint32_t *offsets) {
+    if (!enc || !pcm || !out) return 0;
+    if (offsets) {
+        for (uint16_t f = 0; f <= n_frames; f++) offsets[f] = (uint32_t)f * VC_G722_BYTES_PER_FRAME;
+    }
+    return g722_encode(enc, pcm, (int)n_frames * VC_MAX_FRAME_SAMPLES, out);
+}
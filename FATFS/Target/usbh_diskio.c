@@ -18,6 +18,14 @@
 /* USER CODE END Header */
 /* USER CODE BEGIN firstSection */
 /* can be used to modify / undefine following code or add new definitions */
+/* Pamięć podręczna sektorów (lastSection): wygenerowane niżej funkcje stają się surowym
+ * dostępem do MSC (*_raw), a USBH_Driver z lastSection wskazuje wersje z cache. */
+#define USBH_initialize  USBH_initialize_raw
+#define USBH_status      USBH_status_raw
+#define USBH_read        USBH_read_raw
+#define USBH_write       USBH_write_raw
+#define USBH_ioctl       USBH_ioctl_raw
+#define USBH_Driver      USBH_Driver_raw
 /* USER CODE END firstSection */
 
 /* Includes ------------------------------------------------------------------*/
@@ -60,6 +68,7 @@ const Diskio_drvTypeDef  USBH_Driver =
 
 /* USER CODE BEGIN beforeFunctionSection */
 /* can be used to modify / undefine following code or add new code */
+#include <string.h>
 /* USER CODE END beforeFunctionSection */
 
 /* Private functions ---------------------------------------------------------*/
@@ -264,4 +273,289 @@ DRESULT USBH_ioctl(BYTE lun, BYTE cmd, void *buff)
 
 /* USER CODE BEGIN lastSection */
 /* can be used to modify / undefine previous code or add new code */
+#undef USBH_initialize
+#undef USBH_status
+#undef USBH_read
+#undef USBH_write
+#undef USBH_ioctl
+#undef USBH_Driver
+
+DSTATUS USBH_initialize (BYTE);
+DSTATUS USBH_status (BYTE);
+DRESULT USBH_read (BYTE, BYTE*, DWORD, UINT);
+#if _USE_WRITE == 1
+  DRESULT USBH_write (BYTE, const BYTE*, DWORD, UINT);
+#endif /* _USE_WRITE == 1 */
+#if _USE_IOCTL == 1
+  DRESULT USBH_ioctl (BYTE, BYTE, void*);
+#endif /* _USE_IOCTL == 1 */
+
+const Diskio_drvTypeDef  USBH_Driver =
+{
+  USBH_initialize,
+  USBH_status,
+  USBH_read,
+#if  _USE_WRITE == 1
+  USBH_write,
+#endif /* _USE_WRITE == 1 */
+#if  _USE_IOCTL == 1
+  USBH_ioctl,
+#endif /* _USE_IOCTL == 1 */
+};
+
+static USBH_DiskCacheStatsTypeDef cache_stats;
+
+void USBH_DiskCache_GetStats(USBH_DiskCacheStatsTypeDef *stats)
+{
+  *stats = cache_stats;
+}
+
+void USBH_DiskCache_ResetStats(void)
+{
+  memset(&cache_stats, 0, sizeof(cache_stats));
+}
+
+/* Transfery na urządzenie z licznikami i czasem. */
+static DRESULT cache_dev_read(BYTE lun, BYTE *buff, DWORD sector, UINT count)
+{
+  uint32_t t0 = HAL_GetTick();
+  DRESULT res = USBH_read_raw(lun, buff, sector, count);
+  cache_stats.dev_read_ms += HAL_GetTick() - t0;
+  cache_stats.dev_reads++;
+  cache_stats.dev_read_sectors += count;
+  return res;
+}
+
+#if _USE_WRITE == 1
+static DRESULT cache_dev_write(BYTE lun, const BYTE *buff, DWORD sector, UINT count)
+{
+  uint32_t t0 = HAL_GetTick();
+  DRESULT res = USBH_write_raw(lun, buff, sector, count);
+  cache_stats.dev_write_ms += HAL_GetTick() - t0;
+  cache_stats.dev_writes++;
+  cache_stats.dev_write_sectors += count;
+  return res;
+}
+#endif /* _USE_WRITE == 1 */
+
+#if USBH_CACHE_SECTORS > 0
+
+#define CACHE_BYTES  (USBH_CACHE_SECTORS * USB_DEFAULT_BLOCK_SIZE)
+
+/* Bufor zapisu: ciągły zakres [wr_start, wr_start + wr_count) jeszcze nie wysłany. */
+static BYTE  wr_buf[CACHE_BYTES] __attribute__((aligned(4)));
+static DWORD wr_start;
+static UINT  wr_count;
+static BYTE  wr_lun;
+
+/* Bufor read-ahead: [ra_start, ra_start + ra_count) zgodny z urządzeniem. */
+static BYTE  ra_buf[CACHE_BYTES] __attribute__((aligned(4)));
+static DWORD ra_start;
+static UINT  ra_count;
+static BYTE  ra_lun;
+static DWORD rd_next = 0xFFFFFFFFU;   /* sektor za ostatnim odczytem */
+
+static int cache_overlaps(DWORD a, UINT na, DWORD b, UINT nb)
+{
+  return (na != 0U) && (nb != 0U) && (a < b + nb) && (b < a + na);
+}
+
+static DRESULT cache_flush(void)
+{
+#if _USE_WRITE == 1
+  if (wr_count == 0U)
+  {
+    return RES_OK;
+  }
+  DRESULT res = cache_dev_write(wr_lun, wr_buf, wr_start, wr_count);
+  cache_stats.flushes++;
+  if (res == RES_OK)
+  {
+    wr_count = 0U;    /* po błędzie dane zostają - ponowienie przy kolejnym flush */
+  }
+  return res;
+#else
+  return RES_OK;
+#endif /* _USE_WRITE == 1 */
+}
+
+DRESULT USBH_read(BYTE lun, BYTE *buff, DWORD sector, UINT count)
+{
+  DRESULT res;
+  MSC_LUNTypeDef info;
+
+  cache_stats.read_requests++;
+  cache_stats.read_sectors += count;
+
+  /* Odczyt sektorów, które czekają w buforze zapisu: najpierw zapis. */
+  if (wr_lun == lun && cache_overlaps(wr_start, wr_count, sector, count))
+  {
+    res = cache_flush();
+    if (res != RES_OK)
+    {
+      return res;
+    }
+  }
+
+  int sequential = (sector == rd_next) || (ra_count != 0U && ra_lun == lun && sector == ra_start + ra_count);
+  rd_next = sector + count;
+
+  if (ra_count != 0U && ra_lun == lun && sector >= ra_start && sector + count <= ra_start + ra_count)
+  {
+    memcpy(buff, ra_buf + (sector - ra_start) * USB_DEFAULT_BLOCK_SIZE, count * USB_DEFAULT_BLOCK_SIZE);
+    cache_stats.read_hit_sectors += count;
+    return RES_OK;
+  }
+
+  if (!sequential || count >= USBH_CACHE_SECTORS)
+  {
+    return cache_dev_read(lun, buff, sector, count);
+  }
+
+  /* Odczyt sekwencyjny: pełny bufor z wyprzedzeniem (nie za koniec nośnika). */
+  UINT n = USBH_CACHE_SECTORS;
+  if (USBH_MSC_GetLUNInfo(&hUSB_Host, lun, &info) == USBH_OK && info.capacity.block_nbr > sector
+      && info.capacity.block_nbr - sector < n)
+  {
+    n = info.capacity.block_nbr - sector;
+  }
+  if (n < count)
+  {
+    return cache_dev_read(lun, buff, sector, count);
+  }
+
+  if (wr_lun == lun && cache_overlaps(wr_start, wr_count, sector, n))
+  {
+    res = cache_flush();
+    if (res != RES_OK)
+    {
+      return res;
+    }
+  }
+  ra_count = 0U;
+  res = cache_dev_read(lun, ra_buf, sector, n);
+  if (res != RES_OK)
+  {
+    return res;
+  }
+  ra_start = sector;
+  ra_count = n;
+  ra_lun   = lun;
+  memcpy(buff, ra_buf, count * USB_DEFAULT_BLOCK_SIZE);
+  return RES_OK;
+}
+
+#if _USE_WRITE == 1
+DRESULT USBH_write(BYTE lun, const BYTE *buff, DWORD sector, UINT count)
+{
+  DRESULT res;
+
+  cache_stats.write_requests++;
+  cache_stats.write_sectors += count;
+
+  /* Zapis unieważnia nakładający się read-ahead. */
+  if (ra_lun == lun && cache_overlaps(ra_start, ra_count, sector, count))
+  {
+    ra_count = 0U;
+  }
+
+  /* Duży zapis: po opróżnieniu bufora (kolejność zapisów) prosto na urządzenie. */
+  if (count >= USBH_CACHE_SECTORS)
+  {
+    res = cache_flush();
+    return (res == RES_OK) ? cache_dev_write(lun, buff, sector, count) : res;
+  }
+
+  /* Doklejenie możliwe, gdy zapis zaczyna się w buforze albo tuż za nim i mieści się. */
+  if (wr_count != 0U
+      && (lun != wr_lun || sector < wr_start || sector > wr_start + wr_count
+          || sector + count > wr_start + USBH_CACHE_SECTORS))
+  {
+    res = cache_flush();
+    if (res != RES_OK)
+    {
+      return res;
+    }
+  }
+
+  if (wr_count == 0U)
+  {
+    wr_start = sector;
+    wr_lun   = lun;
+  }
+  memcpy(wr_buf + (sector - wr_start) * USB_DEFAULT_BLOCK_SIZE, buff, count * USB_DEFAULT_BLOCK_SIZE);
+  if (sector + count - wr_start > wr_count)
+  {
+    wr_count = sector + count - wr_start;
+  }
+
+  return (wr_count == USBH_CACHE_SECTORS) ? cache_flush() : RES_OK;
+}
+#endif /* _USE_WRITE == 1 */
+
+void USBH_DiskCache_Drop(void)
+{
+  wr_count = 0U;
+  ra_count = 0U;
+  rd_next  = 0xFFFFFFFFU;
+}
+
+#else /* USBH_CACHE_SECTORS == 0: bez cache, tylko liczniki */
+
+static DRESULT cache_flush(void)
+{
+  return RES_OK;
+}
+
+void USBH_DiskCache_Drop(void)
+{
+}
+
+DRESULT USBH_read(BYTE lun, BYTE *buff, DWORD sector, UINT count)
+{
+  cache_stats.read_requests++;
+  cache_stats.read_sectors += count;
+  return cache_dev_read(lun, buff, sector, count);
+}
+
+#if _USE_WRITE == 1
+DRESULT USBH_write(BYTE lun, const BYTE *buff, DWORD sector, UINT count)
+{
+  cache_stats.write_requests++;
+  cache_stats.write_sectors += count;
+  return cache_dev_write(lun, buff, sector, count);
+}
+#endif /* _USE_WRITE == 1 */
+
+#endif /* USBH_CACHE_SECTORS > 0 */
+
+/* Nowa inicjalizacja albo nośnik niegotowy: bufory mogą należeć do poprzedniego
+ * pendrive'a (read-ahead z jego FAT, zapis nieudany przed wyjęciem) - porzucane. */
+DSTATUS USBH_initialize(BYTE lun)
+{
+  USBH_DiskCache_Drop();
+  return USBH_initialize_raw(lun);
+}
+
+DSTATUS USBH_status(BYTE lun)
+{
+  DSTATUS res = USBH_status_raw(lun);
+  if (res != RES_OK)
+  {
+    USBH_DiskCache_Drop();
+  }
+  return res;
+}
+
+#if _USE_IOCTL == 1
+DRESULT USBH_ioctl(BYTE lun, BYTE cmd, void *buff)
+{
+  /* CTRL_SYNC (f_sync, f_close): zapis bufora przed potwierdzeniem. */
+  if (cmd == CTRL_SYNC)
+  {
+    return cache_flush();
+  }
+  return USBH_ioctl_raw(lun, cmd, buff);
+}
+#endif /* _USE_IOCTL == 1 */
 /* USER CODE END lastSection */
@@ -34,6 +34,40 @@ extern const Diskio_drvTypeDef  USBH_Driver;
 
 /* USER CODE BEGIN lastSection */
 /* can be used to modify / undefine previous code or add new definitions */
+
+/* Pamięć podręczna sektorów warstwy diskio (usbh_diskio.c, lastSection):
+ * - zapis: sąsiednie zapisy FatFs (okno FIL/FAT, pojedyncze sektory) sklejane w jeden
+ *   USBH_MSC_Write do USBH_CACHE_SECTORS sektorów; zapis opróżniany przy CTRL_SYNC
+ *   (f_sync/f_close), przy zapełnieniu, nieciągłym zapisie i odczycie nakładającym się,
+ * - odczyt: przy odczycie sekwencyjnym (sektor = koniec poprzedniego) doczytanie
+ *   z wyprzedzeniem USBH_CACHE_SECTORS sektorów; odczyty losowe bez zmian.
+ * Żądania >= USBH_CACHE_SECTORS sektorów idą bezpośrednio. 0 = cache wyłączony.
+ * Uwaga: dane sprzed CTRL_SYNC mogą jeszcze być w RAM - pendrive wyjmować po f_close.
+ * Bufory są porzucane w disk_initialize, przy disk_status niegotowym i w
+ * USBH_DiskCache_Drop (wołać z USBH_UserProcess przy HOST_USER_DISCONNECTION). */
+#ifndef USBH_CACHE_SECTORS
+#define USBH_CACHE_SECTORS  16U     /* 8 KiB na bufor (zapis + odczyt = 16 KiB RAM) */
+#endif
+
+typedef struct
+{
+  uint32_t read_requests;       /* wywołania disk_read */
+  uint32_t read_sectors;
+  uint32_t read_hit_sectors;    /* sektory podane z bufora read-ahead */
+  uint32_t write_requests;      /* wywołania disk_write */
+  uint32_t write_sectors;
+  uint32_t flushes;             /* zapisy bufora na urządzenie */
+  uint32_t dev_reads;           /* transfery USBH_MSC_Read */
+  uint32_t dev_read_sectors;
+  uint32_t dev_read_ms;         /* czas w USBH_MSC_Read (przepustowość = sektory / czas) */
+  uint32_t dev_writes;          /* transfery USBH_MSC_Write */
+  uint32_t dev_write_sectors;
+  uint32_t dev_write_ms;
+} USBH_DiskCacheStatsTypeDef;
+
+void USBH_DiskCache_GetStats(USBH_DiskCacheStatsTypeDef *stats);
+void USBH_DiskCache_ResetStats(void);
+void USBH_DiskCache_Drop(void);
 /* USER CODE END lastSection */
 
 #endif /* __USBH_DISKIO_H */